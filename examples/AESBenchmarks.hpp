@@ -0,0 +1,154 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * AESBenchmarks.hpp
+ *
+ */
+
+#ifndef LABYNKYR_EXAMPLES_AESBENCHMARKS_HPP_
+#define LABYNKYR_EXAMPLES_AESBENCHMARKS_HPP_
+
+#include "src/labynkyr/search/verify/AES128Kernels.hpp"
+#include "src/labynkyr/search/verify/AES128KeyVerifier.hpp"
+#include "src/labynkyr/search/verify/AES128LastRoundKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/AES128NIEncryptUnrolledKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/AESLongKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/BitslicedAES128KeyVerifier.hpp"
+#include "src/labynkyr/search/verify/KeyVerifier.hpp"
+
+#include <stdint.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace labynkyr {
+
+/**
+ *
+ * Measures the rate at which each AES-128 verifier checks keys on a single core.  2^keyCountBits keys are passed to each verifier in
+ * blocks of BlockKeys, as a PEU would pass them, and the kernel the AES128KeyVerifierFactory selects automatically is marked.  The
+ * AES-192 and AES-256 verifiers are timed last, on the same number of keys.
+ */
+class AESBenchmarks {
+public:
+	enum {
+		BlockKeys = 4096
+	};
+
+	/**
+	 *
+	 * @param keyCountBits each verifier will check 2^keyCountBits keys
+	 */
+	AESBenchmarks(uint32_t keyCountBits)
+	: keyCountBits(keyCountBits)
+	, plaintext({0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff})
+	, ciphertext({0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a})
+	{
+	}
+
+	~AESBenchmarks() {}
+
+	void run() const {
+		using namespace search;
+
+		std::cout << "Checking 2^" << keyCountBits << " AES-128 keys on one core" << std::endl;
+		std::cout << "----------------------" << std::endl;
+		AES128NIEncryptUnrolledKeyVerifier unrolledVerifier(plaintext, ciphertext);
+		runVerifier("Unrolled x4", unrolledVerifier);
+		AES128Kernel const fastest = AES128Kernels::fastestSupported();
+		for(AES128Kernel const kernel : AES128Kernels::supported()) {
+			AES128KeyVerifier verifier(plaintext, ciphertext, kernel);
+			runVerifier(AES128Kernels::name(kernel) + ((kernel == fastest) ? " *" : ""), verifier);
+		}
+		std::cout << "(* selected by AES128KeyVerifierFactory)" << std::endl;
+		AES128LastRoundKeyVerifier lastRoundVerifier(plaintext, ciphertext);
+		runVerifier("Last round", lastRoundVerifier);
+		for(BitslicedAES128Width const width : {Bitsliced64Width, Bitsliced128Width, Bitsliced256Width}) {
+			BitslicedAES128KeyVerifier verifier(plaintext, ciphertext, width);
+			runVerifier(BitslicedAES128::name(width), verifier);
+		}
+		for(AESLongKeyKernel const kernel : {AESNI4LongKeyKernel, AESNI8LongKeyKernel}) {
+			AES192KeyVerifier verifier(plaintext, ciphertext, plaintext, ciphertext, kernel);
+			runVerifier(AESLongKeyKernels<192>::name(kernel), verifier);
+		}
+		for(AESLongKeyKernel const kernel : {AESNI4LongKeyKernel, AESNI8LongKeyKernel}) {
+			AES256KeyVerifier verifier(plaintext, ciphertext, plaintext, ciphertext, kernel);
+			runVerifier(AESLongKeyKernels<256>::name(kernel), verifier);
+		}
+	}
+private:
+	uint32_t const keyCountBits;
+	std::vector<uint8_t> const plaintext;
+	std::vector<uint8_t> const ciphertext;
+
+	template<uint32_t KeyLenBits>
+	void runVerifier(std::string const & name, search::KeyVerifier<KeyLenBits> & verifier) const {
+		// Distinct keys, none of which is correct
+		std::vector<uint8_t> keys(BlockKeys * (KeyLenBits / 8));
+		for(uint32_t index = 0 ; index < keys.size() ; index++) {
+			keys[index] = static_cast<uint8_t>(index * 151 + 1);
+		}
+		uint64_t const keyCount = 1ULL << keyCountBits;
+		auto const begin = std::chrono::high_resolution_clock::now();
+		for(uint64_t checked = 0 ; checked < keyCount ; checked += BlockKeys) {
+			keys[0]++;
+			verifier.checkKeys(keys.data(), BlockKeys);
+		}
+		verifier.flush();
+		auto const end = std::chrono::high_resolution_clock::now();
+
+		double const seconds = std::chrono::duration<double>(end - begin).count();
+		double const keysPerSecond = (seconds > 0) ? static_cast<double>(verifier.keysChecked()) / seconds : 0.0;
+		std::cout << std::left << std::setw(20) << name << std::right << std::fixed;
+		std::cout << " keys: " << verifier.keysChecked();
+		std::cout << "  time: " << std::setprecision(4) << seconds << " s";
+		std::cout << "  keys/s: " << std::setprecision(0) << keysPerSecond << std::endl;
+	}
+};
+
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_EXAMPLES_AESBENCHMARKS_HPP_ */
@@ -0,0 +1,202 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * DESBenchmarks.hpp
+ *
+ */
+
+#ifndef LABYNKYR_EXAMPLES_DESBENCHMARKS_HPP_
+#define LABYNKYR_EXAMPLES_DESBENCHMARKS_HPP_
+
+#include "src/labynkyr/search/enumerate/ActiveNodeFinder.hpp"
+#include "src/labynkyr/search/enumerate/WeightFinder.hpp"
+#include "src/labynkyr/search/verify/BitslicedDES.hpp"
+#include "src/labynkyr/search/verify/DESRoundKeyVerifier.hpp"
+#include "src/labynkyr/search/PathCountSearch.hpp"
+#include "src/labynkyr/search/SearchTask.hpp"
+#include "src/labynkyr/BigInt.hpp"
+#include "src/labynkyr/WeightTable.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace labynkyr {
+
+/**
+ *
+ * Measures DESRoundKeyVerifier on a single core: first the rate at which candidate round keys (and the 256 DES keys behind each) are
+ * checked, and then a full search over a synthetic last round attack on DES, with a PathCountSearch<8, 6, uint32_t, uint8_t> enumerating
+ * approximately 2^budgetBits candidate round keys.  In the synthetic attack the correct 6-bit subkey is ranked 2nd in every distinguishing
+ * vector.
+ */
+class DESBenchmarks {
+public:
+	enum {
+		VerifierKeys = 1 << 12
+	};
+
+	/**
+	 *
+	 * @param budgetBits the search will enumerate approximately 2^budgetBits round keys
+	 */
+	DESBenchmarks(uint32_t budgetBits)
+	: budgetBits(budgetBits)
+	, desKey({0x13, 0x34, 0x57, 0x79, 0x9B, 0xBC, 0xDF, 0xF1})
+	, plaintext({0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF})
+	, ciphertext({0x85, 0xE8, 0x13, 0x54, 0x0F, 0x0A, 0xB4, 0x05})
+	{
+	}
+
+	~DESBenchmarks() {}
+
+	void run() const {
+		using namespace search;
+
+		std::cout << "Checking " << VerifierKeys << " DES round keys on one core" << std::endl;
+		std::cout << "----------------------" << std::endl;
+		for(BitslicedDESWidth const width : {BitslicedDES64Width, BitslicedDES256Width}) {
+			runVerifier(width);
+		}
+		std::cout << std::endl;
+		runSearch();
+	}
+private:
+	uint32_t const budgetBits;
+	std::vector<uint8_t> const desKey;
+	std::vector<uint8_t> const plaintext;
+	std::vector<uint8_t> const ciphertext;
+
+	void runVerifier(search::BitslicedDESWidth width) const {
+		using namespace search;
+
+		// Distinct round keys, none of which is correct
+		std::vector<uint8_t> keys(VerifierKeys * 6);
+		for(uint32_t index = 0 ; index < keys.size() ; index++) {
+			keys[index] = static_cast<uint8_t>(index * 151 + 1);
+		}
+		DESRoundKeyVerifier verifier(plaintext, ciphertext, 16, width);
+		auto const begin = std::chrono::high_resolution_clock::now();
+		verifier.checkKeys(keys.data(), VerifierKeys);
+		verifier.flush();
+		auto const end = std::chrono::high_resolution_clock::now();
+
+		double const seconds = std::chrono::duration<double>(end - begin).count();
+		double const keysPerSecond = (seconds > 0) ? static_cast<double>(verifier.keysChecked()) / seconds : 0.0;
+		std::cout << std::left << std::setw(20) << BitslicedDES::name(width) << std::right << std::fixed;
+		std::cout << " round keys: " << verifier.keysChecked();
+		std::cout << "  time: " << std::setprecision(4) << seconds << " s";
+		std::cout << "  round keys/s: " << std::setprecision(0) << keysPerSecond;
+		std::cout << "  DES keys/s: " << std::setprecision(0) << keysPerSecond * 256 << std::endl;
+	}
+
+	void runSearch() const {
+		using namespace search;
+
+		std::vector<uint8_t> const roundKey = BitslicedDES::roundKey(desKey, 16);
+		WeightTable<8, 6, uint32_t> const weightTable(syntheticWeights(roundKey));
+		WeightFinder<8, 6, uint32_t> const weightFinder(weightTable);
+		BigInt<48> const depth = BigInt<48>(1) << budgetBits;
+		auto const weightAndSize = weightFinder.findBestWeight(depth);
+		SearchTask<8, 6, uint32_t> const task(0, weightAndSize.first, weightTable);
+		ActiveNodeFinder<8, 6, uint32_t> const activeNodeFinder(weightTable, weightAndSize.first);
+
+		std::cout << "Searching all round keys with weight below " << weightAndSize.first << " (" << weightAndSize.second << " keys)" << std::endl;
+		std::cout << "----------------------" << std::endl;
+		DESRoundKeyVerifier verifier(plaintext, ciphertext, 16);
+		PathCountSearch<8, 6, uint32_t, uint8_t> search(verifier);
+		auto const begin = std::chrono::high_resolution_clock::now();
+		search.searchWithANFForest(task, activeNodeFinder);
+		verifier.flush();
+		auto const end = std::chrono::high_resolution_clock::now();
+
+		double const seconds = std::chrono::duration<double>(end - begin).count();
+		std::cout << "round keys checked: " << verifier.keysChecked();
+		std::cout << "  time: " << std::fixed << std::setprecision(4) << seconds << " s" << std::endl;
+		if(verifier.success()) {
+			std::cout << "Found DES key ";
+			for(uint8_t const byte : verifier.getDESKey()) {
+				std::cout << std::hex << std::setw(2) << std::setfill('0') << static_cast<uint32_t>(byte);
+			}
+			std::cout << std::dec << std::setfill(' ') << std::endl;
+		} else {
+			std::cout << "DES key not found within the budget" << std::endl;
+		}
+	}
+
+	/**
+	 *
+	 * @return pseudo-random weights, with the subkeys of roundKey given the 2nd lowest weight in each distinguishing vector
+	 */
+	std::vector<uint32_t> syntheticWeights(std::vector<uint8_t> const & roundKey) const {
+		std::vector<uint32_t> weights(8 * 64);
+		uint32_t state = 0x2545F491;
+		for(uint32_t vectorIndex = 0 ; vectorIndex < 8 ; vectorIndex++) {
+			std::vector<uint32_t> vector(64);
+			for(uint32_t subkey = 0 ; subkey < 64 ; subkey++) {
+				state = state * 1664525 + 1013904223;
+				vector[subkey] = (state >> 16) % 1024;
+			}
+			uint32_t correctSubkey = 0;
+			for(uint32_t bit = 0 ; bit < 6 ; bit++) {
+				uint32_t const keyBit = vectorIndex * 6 + bit;
+				correctSubkey |= ((roundKey[keyBit / 8] >> (keyBit % 8)) & 1) << bit;
+			}
+			std::vector<uint32_t> sorted(vector);
+			std::sort(sorted.begin(), sorted.end());
+			auto const fourth = std::find(vector.begin(), vector.end(), sorted[1]);
+			std::iter_swap(fourth, vector.begin() + correctSubkey);
+			std::copy(vector.begin(), vector.end(), weights.begin() + vectorIndex * 64);
+		}
+		return weights;
+	}
+};
+
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_EXAMPLES_DESBENCHMARKS_HPP_ */
@@ -45,8 +45,12 @@
  *
  */
 
+#include "examples/AESBenchmarks.hpp"
+#include "examples/DESBenchmarks.hpp"
+#include "examples/ForestBenchmarks.hpp"
 #include "examples/RankExamples.hpp"
 #include "examples/SearchExamples.hpp"
+#include "examples/SharedMemoryBenchmarks.hpp"
 #include "examples/SimulationExamples.hpp"
 #include "examples/SimulatedHWCPA.hpp"
 
@@ -67,6 +71,11 @@ void help() {
 	std::cout << "            [Example #3] correct key rank is 2^34.5170" << std::endl;
 	std::cout << "  3) ./examples simulate-rank <traceCount> <snr> <rngSeed> <precisionBits>" << std::endl;
 	std::cout << "  4) ./examples simulate-search <traceCount> <snr> <rngSeed> <precisionBits> <peuCount> <budgetBits> <preferredTaskSizeBits>" << std::endl;
+	std::cout << "  5) ./examples bench-forest <budgetBits>" << std::endl;
+	std::cout << "  6) ./examples bench-shm <keyCountBits> <slotCount> <blockKeys>" << std::endl;
+	std::cout << "  7) ./examples shm-consumer <ringName> <plaintextHex> <ciphertextHex>" << std::endl;
+	std::cout << "  8) ./examples bench-aes <keyCountBits>" << std::endl;
+	std::cout << "  9) ./examples bench-des <budgetBits>" << std::endl;
 }
 
 void logParallelSearchConfig(uint32_t peuCount, uint32_t budgetBits, uint32_t preferredTaskSizeBits) {
@@ -121,9 +130,9 @@ void logSimulatedCPAConfig(labynkyr::SimulatedHWCPA const & simulator) {
  * 		         budgetBits - the total number of the most likely keys to aim to search will be taken to be 2^budgetBits
  *    preferredTaskSizeBits - the total number of keys to search within each sequential search task will be taken to be 2^preferredTaskSizeBits
  *
- * Note that the fairly simple concurrency design of labynkyr means that the processing of individual search tasks cannot be interrupted,
- * so if one task finds the key, the time taken to find that key can be reported, but the program must wait for the other search tasks
- * to complete before it can exit.  Consequently, using the total program execution time can be misleading.
+ * Once any PEU finds the key, a cancellation token shared by the pool is raised and the search tasks still being processed on the
+ * other PEUs return early (within one batch of candidate keys, or one column of the ANF graph), so the program exits shortly after
+ * the key is found.  The time taken to find the key and the total time spent searching are both reported.
  *
  * SIMULATED EXAMPLES
  * ============================================================================================================================
@@ -144,6 +153,44 @@ void logSimulatedCPAConfig(labynkyr::SimulatedHWCPA const & simulator) {
  * simulate-search can simulate the same set of information leakage, and will use the DPA attack results to search for keys.  It will
  * use peuCount parallel execution units to search up to the 2^budgetBits most likely key candidates.  Each sequential search task will
  * contain at least 2^preferredTaskSizeBits candidates.
+ *
+ * BENCHMARKS
+ * ============================================================================================================================
+ * See examples/ForestBenchmarks.hpp.
+ *
+ * 		1) ./examples bench-forest <budgetBits>
+ *
+ * bench-forest enumerates a single sequential ANF/Forest task of approximately 2^budgetBits keys using weight table #2, once with the
+ * linked (Arena-backed) candidate key trees and once with the flat per-vector node arrays, and reports keys per second and the bytes of
+ * candidate key storage used per key.  Verification is replaced with a simple counter.
+ *
+ * See examples/SharedMemoryBenchmarks.hpp.
+ *
+ * 		1) ./examples bench-shm <keyCountBits> <slotCount> <blockKeys>
+ * 		2) ./examples shm-consumer <ringName> <plaintextHex> <ciphertextHex>
+ *
+ * bench-shm forks a consumer process and sends it 2^keyCountBits keys through a SharedMemoryKeyVerifier ring of slotCount blocks of
+ * blockKeys keys, and reports keys per second.  The consumer only counts the keys it receives.
+ *
+ * shm-consumer is a reference external verifier.  It attaches to a ring created by a SharedMemoryKeyVerifierFactory (one ring per PEU,
+ * named <prefix>-<index>) and checks every key it receives with AES-128 against the given plaintext and ciphertext, until the search
+ * closes the ring.
+ *
+ * See examples/AESBenchmarks.hpp.
+ *
+ * 		1) ./examples bench-aes <keyCountBits>
+ *
+ * bench-aes checks 2^keyCountBits AES-128 keys on a single core with AES128NIEncryptUnrolledKeyVerifier and with AES128KeyVerifier
+ * using each kernel the CPU supports (4- and 8-way AES-NI, and VAES on 256- and 512-bit registers), and reports keys per second.  The
+ * kernel AES128KeyVerifierFactory selects is marked.  AES128LastRoundKeyVerifier, which takes round 10 keys from
+ * last round attacks, BitslicedAES128KeyVerifier, for hosts without AES-NI, and the AES-192 and AES-256 verifiers are timed last.
+ *
+ * See examples/DESBenchmarks.hpp.
+ *
+ * 		1) ./examples bench-des <budgetBits>
+ *
+ * bench-des times DESRoundKeyVerifier on 64- and 256-bit registers, and then runs a PathCountSearch over approximately 2^budgetBits
+ * round 16 keys of a synthetic last round attack on DES, completing each round key to the full DES key.
  */
 int main(int argc, char* argv[]) {
 	if(argc == 3 && (std::string(argv[1])).compare("rank") == 0) {
@@ -233,6 +280,26 @@ int main(int argc, char* argv[]) {
 		std::cout << "----------------------" << std::endl;
 		labynkyr::SimulationExamples simulator(simulatedCpa);
 		simulator.search<uint32_t>(precision, peuCount, budgetBits, preferredTaskSizeBits);
+	} else if(argc == 3 && (std::string(argv[1])).compare("bench-forest") == 0) {
+		uint32_t const budgetBits = std::stoi(std::string(argv[2]));
+		labynkyr::ForestBenchmarks<uint32_t> benchmarks(budgetBits);
+		benchmarks.run();
+	} else if(argc == 5 && (std::string(argv[1])).compare("bench-shm") == 0) {
+		uint32_t const keyCountBits = std::stoi(std::string(argv[2]));
+		uint32_t const slotCount = std::stoi(std::string(argv[3]));
+		uint64_t const blockKeys = std::stoull(std::string(argv[4]));
+		labynkyr::SharedMemoryBenchmarks benchmarks(keyCountBits, slotCount, blockKeys);
+		benchmarks.run();
+	} else if(argc == 5 && (std::string(argv[1])).compare("shm-consumer") == 0) {
+		labynkyr::SharedMemoryBenchmarks::consume(std::string(argv[2]), std::string(argv[3]), std::string(argv[4]));
+	} else if(argc == 3 && (std::string(argv[1])).compare("bench-aes") == 0) {
+		uint32_t const keyCountBits = std::stoi(std::string(argv[2]));
+		labynkyr::AESBenchmarks benchmarks(keyCountBits);
+		benchmarks.run();
+	} else if(argc == 3 && (std::string(argv[1])).compare("bench-des") == 0) {
+		uint32_t const budgetBits = std::stoi(std::string(argv[2]));
+		labynkyr::DESBenchmarks benchmarks(budgetBits);
+		benchmarks.run();
 	} else {
 		help();
 	}
@@ -0,0 +1,174 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * ForestBenchmarks.hpp
+ *
+ */
+
+#ifndef LABYNKYR_EXAMPLES_FORESTBENCHMARKS_HPP_
+#define LABYNKYR_EXAMPLES_FORESTBENCHMARKS_HPP_
+
+#include "src/labynkyr/search/enumerate/ActiveNodeFinder.hpp"
+#include "src/labynkyr/search/enumerate/WeightFinder.hpp"
+#include "src/labynkyr/search/parallel/ANFForestSearchTaskRunner.hpp"
+#include "src/labynkyr/search/verify/KeyVerifier.hpp"
+#include "src/labynkyr/search/SearchTask.hpp"
+#include "src/labynkyr/BigInt.hpp"
+#include "src/labynkyr/Key.hpp"
+#include "src/labynkyr/WeightTable.hpp"
+
+#include "examples/SampleWeightTables.hpp"
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace labynkyr {
+
+/**
+ *
+ * A KeyVerifier that only counts candidates, so that the benchmarks measure the cost of enumeration rather than verification.
+ */
+class CountingKeyVerifier : public search::KeyVerifier<128> {
+public:
+	CountingKeyVerifier()
+	: search::KeyVerifier<128>()
+	, count(0)
+	{
+	}
+
+	~CountingKeyVerifier() {}
+
+	void checkKey(std::vector<uint8_t> const & candidateKeyBytes) override {
+		count++;
+	}
+
+	void checkKeys(uint8_t const * candidateKeys, uint64_t keyCount) override {
+		count += keyCount;
+	}
+
+	uint64_t keysChecked() const override {
+		return count;
+	}
+
+	bool success() const override {
+		return false;
+	}
+
+	Key<128> correctKey() override {
+		throw std::logic_error("Counting verifier never finds the key");
+	}
+
+	void flush() override {}
+private:
+	uint64_t count;
+};
+
+/**
+ *
+ * Compares the two candidate key representations available to the ANF/Forest algorithm (linked trees in an Arena, and flat per-vector
+ * node arrays) on the weight table from search example #2.  A single sequential task containing approximately 2^budgetBits keys is
+ * enumerated with each representation, and the throughput and memory used per candidate key are reported.
+ */
+template<typename WeightType>
+class ForestBenchmarks {
+public:
+	/**
+	 *
+	 * @param budgetBits each task will contain approximately 2^budgetBits key candidates
+	 */
+	ForestBenchmarks(uint32_t budgetBits)
+	: budgetBits(budgetBits)
+	{
+	}
+
+	~ForestBenchmarks() {}
+
+	void run() const {
+		using namespace search;
+
+		auto const weightTable = SampleWeightTables::rank_2_30<WeightType>();
+		WeightFinder<16, 8, WeightType> const weightFinder(weightTable);
+		BigInt<128> const depth = BigInt<128>(1) << budgetBits;
+		auto const weightAndSize = weightFinder.findBestWeight(depth);
+		SearchTask<16, 8, WeightType> const task(0, weightAndSize.first, weightTable);
+		ActiveNodeFinder<16, 8, WeightType> const activeNodeFinder(weightTable, weightAndSize.first);
+
+		std::cout << "Enumerating all keys with weight below " << weightAndSize.first << " (" << weightAndSize.second << " keys)" << std::endl;
+		std::cout << "----------------------" << std::endl;
+		runLayout(task, activeNodeFinder, weightAndSize.second, LinkedForestLayout);
+		runLayout(task, activeNodeFinder, weightAndSize.second, FlatForestLayout);
+	}
+private:
+	uint32_t const budgetBits;
+
+	void runLayout(search::SearchTask<16, 8, WeightType> const & task, search::ActiveNodeFinder<16, 8, WeightType> const & activeNodeFinder,
+			BigInt<128> const & taskSize, search::ForestLayout forestLayout) const {
+		using namespace search;
+
+		CountingKeyVerifier verifier;
+		ANFForestSearchTaskRunner<16, 8, WeightType, uint8_t> runner(task, taskSize, activeNodeFinder, forestLayout);
+		runner.processSequentially(verifier);
+
+		double const seconds = std::chrono::duration<double>(runner.getDuration()).count();
+		uint64_t const keys = verifier.keysChecked();
+		double const keysPerSecond = (seconds > 0) ? static_cast<double>(keys) / seconds : 0.0;
+		double const bytesPerKey = (keys > 0) ? static_cast<double>(runner.getArenaBytesUsed()) / static_cast<double>(keys) : 0.0;
+		std::cout << std::left << std::setw(16) << runner.methodName() << std::right << std::fixed;
+		std::cout << " keys: " << keys;
+		std::cout << "  time: " << std::setprecision(4) << seconds << " s";
+		std::cout << "  keys/s: " << std::setprecision(0) << keysPerSecond;
+		std::cout << "  bytes used: " << runner.getArenaBytesUsed();
+		std::cout << "  bytes/key: " << std::setprecision(4) << bytesPerKey << std::endl;
+	}
+};
+
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_EXAMPLES_FORESTBENCHMARKS_HPP_ */
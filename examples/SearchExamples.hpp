@@ -48,6 +48,8 @@
 #ifndef LABYNKYR_EXAMPLES_SEARCHEXAMPLES_HPP_
 #define LABYNKYR_EXAMPLES_SEARCHEXAMPLES_HPP_
 
+#include "src/labynkyr/search/parallel/EnvironmentManager.hpp"
+#include "src/labynkyr/search/parallel/PEUPlacement.hpp"
 #include "src/labynkyr/search/parallel/PEUPool.hpp"
 #include "src/labynkyr/search/parallel/WorkScheduler.hpp"
 #include "src/labynkyr/search/verify/AES128NIEncryptUnrolledKeyVerifier.hpp"
@@ -192,7 +194,10 @@ private:
 
 		// 1:1 mapping between enumerator and verifier instances
 		uint32_t const verifierCount = peuCount;
-		PEUPool<16, 8, WeightType, uint8_t> peuPool(peuCount, verifierFactory, verifierCount, 100UL);
+		// Pin one PEU per physical core (avoiding SMT siblings) spread across the NUMA nodes, with each verifier allocated on its PEU's node
+		EnvironmentManager::getInstance().logTopology();
+		PEUPlacement const placement = PEUPlacement::physicalCoresFirst(EnvironmentManager::getInstance().topology());
+		PEUPool<16, 8, WeightType, uint8_t> peuPool(peuCount, verifierFactory, verifierCount, 10000000UL, LockingQueueImplementation, placement);
 
 		// Aim to search the first 2^budgetBits key candidates
 		SearchSpecBuilder<128> const searchSpecBuilder(budgetBits);
@@ -202,7 +207,7 @@ private:
 		EffortAllocation<16, 8, WeightType> effort(searchSpec, weightTable, preferredTaskSizeBits);
 
 		// Run the enumeration
-		WorkScheduler<16, 8, WeightType, uint8_t> scheduler(100UL);
+		WorkScheduler<16, 8, WeightType, uint8_t> scheduler(10000000UL);
 		scheduler.runSearch(peuPool, effort);
 		// Print results
 		bool const keyFound = peuPool.isKeyFound();
@@ -0,0 +1,177 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SharedMemoryBenchmarks.hpp
+ *
+ */
+
+#ifndef LABYNKYR_EXAMPLES_SHAREDMEMORYBENCHMARKS_HPP_
+#define LABYNKYR_EXAMPLES_SHAREDMEMORYBENCHMARKS_HPP_
+
+#include "src/labynkyr/search/verify/AES128NIEncryptUnrolledKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/SharedMemoryKeyConsumer.hpp"
+#include "src/labynkyr/search/verify/SharedMemoryKeyVerifier.hpp"
+
+#include "src/labynkyr/Key.hpp"
+
+#include "examples/ForestBenchmarks.hpp"
+
+#include <stdint.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace labynkyr {
+
+/**
+ *
+ * Measures how quickly candidate keys can be handed to a verifier in another process through a SharedMemoryKeyVerifier.  A consumer
+ * process is forked which only counts the keys it receives, and 2^keyCountBits AES-128 sized keys are sent to it in blocks, as a PEU
+ * would send them.
+ */
+class SharedMemoryBenchmarks {
+public:
+	/**
+	 *
+	 * @param keyCountBits 2^keyCountBits keys will be sent
+	 * @param slotCount the number of blocks in the ring
+	 * @param blockKeys the number of keys in each block
+	 */
+	SharedMemoryBenchmarks(uint32_t keyCountBits, uint32_t slotCount, uint64_t blockKeys)
+	: keyCountBits(keyCountBits)
+	, slotCount(slotCount)
+	, blockKeys(blockKeys)
+	{
+	}
+
+	~SharedMemoryBenchmarks() {}
+
+	void run() const {
+		using namespace search;
+
+		std::stringstream name;
+		name << "/labynkyr-bench-" << ::getpid();
+		uint64_t const keyCount = 1ULL << keyCountBits;
+		std::unique_ptr<SharedMemoryKeyVerifier<128>> verifier(new SharedMemoryKeyVerifier<128>(name.str(), slotCount, blockKeys));
+
+		pid_t const consumerPid = ::fork();
+		if(consumerPid < 0) {
+			throw std::runtime_error("Unable to fork the consumer process");
+		} else if(consumerPid == 0) {
+			CountingKeyVerifier countingVerifier;
+			SharedMemoryKeyConsumer<128> consumer(name.str(), countingVerifier);
+			consumer.run();
+			::_exit(countingVerifier.keysChecked() == keyCount ? 0 : 1);
+		}
+
+		// The keys are generated once, so that only the cost of crossing the process boundary is measured
+		std::vector<uint8_t> keys(blockKeys * 16);
+		for(uint64_t keyIndex = 0 ; keyIndex < blockKeys ; keyIndex++) {
+			for(uint32_t byteIndex = 0 ; byteIndex < 8 ; byteIndex++) {
+				keys[keyIndex * 16 + byteIndex] = static_cast<uint8_t>(keyIndex >> (byteIndex * 8));
+			}
+		}
+
+		auto const begin = std::chrono::high_resolution_clock::now();
+		for(uint64_t sent = 0 ; sent < keyCount ; sent += blockKeys) {
+			verifier->checkKeys(keys.data(), std::min(blockKeys, keyCount - sent));
+		}
+		verifier->flush();
+		auto const end = std::chrono::high_resolution_clock::now();
+		uint64_t const keysVerified = verifier->keysVerified();
+		verifier.reset();
+
+		int status = 0;
+		::waitpid(consumerPid, &status, 0);
+		double const seconds = std::chrono::duration<double>(end - begin).count();
+		double const keysPerSecond = (seconds > 0) ? static_cast<double>(keysVerified) / seconds : 0.0;
+		std::cout << "Ring of " << slotCount << " blocks of " << blockKeys << " keys" << std::fixed << std::endl;
+		std::cout << "keys: " << keysVerified;
+		std::cout << "  time: " << std::setprecision(4) << seconds << " s";
+		std::cout << "  keys/s: " << std::setprecision(0) << keysPerSecond;
+		std::cout << "  MB/s: " << std::setprecision(1) << keysPerSecond * 16 / 1e6;
+		std::cout << "  consumer: " << ((WIFEXITED(status) && WEXITSTATUS(status) == 0) ? "ok" : "FAILED") << std::endl;
+	}
+
+	/**
+	 *
+	 * A reference external verifier: attach to the ring created for one PEU by a SharedMemoryKeyVerifierFactory, and check the keys it
+	 * receives with AES-128 against a known plaintext and ciphertext pair until the search closes the ring.
+	 *
+	 * @param ringName
+	 * @param plaintextHex 32 hex digits
+	 * @param ciphertextHex 32 hex digits
+	 */
+	static void consume(std::string const & ringName, std::string const & plaintextHex, std::string const & ciphertextHex) {
+		using namespace search;
+
+		AES128NIEncryptUnrolledKeyVerifier aesVerifier(Key<128>(plaintextHex).asBytes(), Key<128>(ciphertextHex).asBytes());
+		SharedMemoryKeyConsumer<128> consumer(ringName, aesVerifier, std::chrono::seconds(60));
+		consumer.run();
+		std::cout << "Verified " << aesVerifier.keysChecked() << " keys";
+		if(aesVerifier.success()) {
+			std::cout << ", found key";
+			for(uint8_t const byte : aesVerifier.correctKey().asBytes()) {
+				std::cout << " " << std::hex << std::setw(2) << std::setfill('0') << static_cast<uint32_t>(byte);
+			}
+			std::cout << std::dec << std::endl;
+		} else {
+			std::cout << ", key not found" << std::endl;
+		}
+	}
+private:
+	uint32_t const keyCountBits;
+	uint32_t const slotCount;
+	uint64_t const blockKeys;
+};
+
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_EXAMPLES_SHAREDMEMORYBENCHMARKS_HPP_ */
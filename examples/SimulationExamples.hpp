@@ -168,13 +168,13 @@ public:
 		std::vector<uint8_t> const ciphertext = {0x0a, 0x94, 0x0b, 0xb5, 0x41, 0x6e, 0xf0, 0x45, 0xf1, 0xc3, 0x94, 0x58, 0xc6, 0x53, 0xea, 0x5a};
 		search::AES128NIEncryptUnrolledKeyVerifierFactory verifierFactory(plaintext, ciphertext);
 
-		search::PEUPool<16, 8, WeightType, uint8_t> peuPool(peuCount, verifierFactory, peuCount, 1000UL);
+		search::PEUPool<16, 8, WeightType, uint8_t> peuPool(peuCount, verifierFactory, peuCount, 10000000UL);
 
 		search::SearchSpecBuilder<128> searchSpecBuilder(totalEffortBits);
 		auto const searchSpec = searchSpecBuilder.createSpec();
 		search::EffortAllocation<16, 8, WeightType> effort(searchSpec, *weightTable.get(), preferredJobSizeBits);
 
-		search::WorkScheduler<16, 8, WeightType, uint8_t> scheduler(1000UL);;
+		search::WorkScheduler<16, 8, WeightType, uint8_t> scheduler(10000000UL);;
 		scheduler.runSearch(peuPool, effort);
 
 		// Print results
@@ -200,9 +200,12 @@ public:
 					return weightsBegin[i1] < weightsBegin[i2];
 				}
 			);
+			// Permute the weights using the sorted indexes, rather than sorting a second time
+			std::vector<WeightType> const unsortedWeights(weightsBegin, weightsBegin + VectorSize);
+			for(uint64_t sortedIndex = 0 ; sortedIndex < VectorSize ; sortedIndex++) {
+				weightsBegin[sortedIndex] = unsortedWeights[indexesBegin[sortedIndex]];
+			}
 		}
-		// Sort again to actual sort
-		sortAscending();
 	}
 
 	/**
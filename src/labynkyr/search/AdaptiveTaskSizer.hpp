@@ -0,0 +1,216 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * AdaptiveTaskSizer.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_ADAPTIVETASKSIZER_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_ADAPTIVETASKSIZER_HPP_
+
+#include "labynkyr/BigInt.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Chooses the size of SearchTasks from the measured cost of the tasks completed so far, so that each task takes roughly a target amount of
+ * wall-clock time.  The cost of a task is modelled as a fixed setup cost (e.g. building the ANF graph) plus a cost per key, and the model
+ * is fitted by least squares to the completed tasks.  Older tasks are given exponentially less weight, so the model follows the changes in
+ * setup cost as the search moves through the weight bands.
+ *
+ * If the setup cost exceeds the target duration, tasks are sized so that verifying the keys takes as long as the setup, rather than
+ * spending most of the time in setup.
+ *
+ * @tparam KeyLenBits the length of the key in bits
+ */
+template<uint32_t KeyLenBits>
+class AdaptiveTaskSizer {
+public:
+	/**
+	 *
+	 * @param targetTaskDuration the preferred wall-clock time taken to process each task
+	 * @param initialJobSizeBits the task size, in bits, used until the first task has been measured
+	 * @param minJobSizeBits the smallest task size, in bits, that will be suggested
+	 * @param maxJobSizeBits the largest task size, in bits, that will be suggested
+	 * @throws std::invalid_argument
+	 */
+	AdaptiveTaskSizer(std::chrono::nanoseconds targetTaskDuration, double initialJobSizeBits, double minJobSizeBits, double maxJobSizeBits)
+	: targetSeconds(std::chrono::duration<double>(targetTaskDuration).count())
+	, minJobSizeBits(minJobSizeBits)
+	, maxJobSizeBits(maxJobSizeBits)
+	, decayFactor(0.75)
+	, jobSizeBits(std::min(std::max(initialJobSizeBits, minJobSizeBits), maxJobSizeBits))
+	, samples(0)
+	, sumWeights(0.0)
+	, sumKeys(0.0)
+	, sumSeconds(0.0)
+	, sumKeysSquared(0.0)
+	, sumKeysSeconds(0.0)
+	, setupSeconds(0.0)
+	, secondsPerKey(0.0)
+	{
+		if(targetTaskDuration.count() <= 0) {
+			throw std::invalid_argument("The target task duration must be positive");
+		}
+		if(minJobSizeBits < 0.0 || minJobSizeBits > maxJobSizeBits || maxJobSizeBits > KeyLenBits) {
+			std::stringstream error;
+			error << "Task size bounds must satisfy 0 <= " << minJobSizeBits << " <= " << maxJobSizeBits << " <= " << KeyLenBits;
+			throw std::invalid_argument(error.str().c_str());
+		}
+	}
+
+	~AdaptiveTaskSizer() {}
+
+	/**
+	 *
+	 * Update the cost model with a completed task, and choose the size of subsequent tasks
+	 *
+	 * @param keyCount the number of keys in the task
+	 * @param duration the time taken to process the task
+	 */
+	void recordTask(BigInt<KeyLenBits> const & keyCount, std::chrono::nanoseconds duration) {
+		double const keys = keyCount.template convert_to<double>();
+		double const seconds = std::chrono::duration<double>(duration).count();
+		sumWeights = sumWeights * decayFactor + 1.0;
+		sumKeys = sumKeys * decayFactor + keys;
+		sumSeconds = sumSeconds * decayFactor + seconds;
+		sumKeysSquared = sumKeysSquared * decayFactor + keys * keys;
+		sumKeysSeconds = sumKeysSeconds * decayFactor + keys * seconds;
+		samples++;
+		fitModel();
+		chooseJobSize();
+	}
+
+	/**
+	 *
+	 * @return the preferred size of the next task, in the form 2^preferredJobSizeBits keys
+	 */
+	double preferredJobSizeBits() const {
+		return jobSizeBits;
+	}
+
+	/**
+	 *
+	 * @return the number of tasks recorded
+	 */
+	uint64_t sampleCount() const {
+		return samples;
+	}
+
+	/**
+	 *
+	 * @return the estimated fixed cost of processing a task (zero until a task has been recorded)
+	 */
+	std::chrono::nanoseconds estimatedSetupCost() const {
+		return std::chrono::nanoseconds(static_cast<int64_t>(setupSeconds * 1e9));
+	}
+
+	/**
+	 *
+	 * @return the estimated number of keys verified per second, excluding setup (zero until a task has been recorded)
+	 */
+	double estimatedKeysPerSecond() const {
+		return (secondsPerKey > 0.0) ? 1.0 / secondsPerKey : 0.0;
+	}
+private:
+	double const targetSeconds;
+	double const minJobSizeBits;
+	double const maxJobSizeBits;
+	// The weight given to the existing measurements each time a new task is recorded
+	double const decayFactor;
+	double jobSizeBits;
+	uint64_t samples;
+	double sumWeights;
+	double sumKeys;
+	double sumSeconds;
+	double sumKeysSquared;
+	double sumKeysSeconds;
+	double setupSeconds;
+	double secondsPerKey;
+
+	void fitModel() {
+		double const determinant = sumWeights * sumKeysSquared - sumKeys * sumKeys;
+		if(determinant > 1e-9 * sumWeights * sumKeysSquared) {
+			secondsPerKey = (sumWeights * sumKeysSeconds - sumKeys * sumSeconds) / determinant;
+			setupSeconds = (sumSeconds - secondsPerKey * sumKeys) / sumWeights;
+			if(setupSeconds < 0.0 && sumKeysSquared > 0.0) {
+				// Fit through the origin instead
+				setupSeconds = 0.0;
+				secondsPerKey = sumKeysSeconds / sumKeysSquared;
+			}
+		} else {
+			// All tasks so far were the same size, so the setup cost cannot be separated from the cost per key
+			secondsPerKey = -1.0;
+		}
+		if(secondsPerKey <= 0.0) {
+			setupSeconds = 0.0;
+			secondsPerKey = (sumKeys > 0.0) ? sumSeconds / sumKeys : 0.0;
+		}
+	}
+
+	void chooseJobSize() {
+		if(secondsPerKey <= 0.0) {
+			jobSizeBits = maxJobSizeBits;
+			return;
+		}
+		double const verifySeconds = std::max(targetSeconds - setupSeconds, setupSeconds);
+		double const keys = verifySeconds / secondsPerKey;
+		double const bits = (keys > 1.0) ? std::log2(keys) : 0.0;
+		jobSizeBits = std::min(std::max(bits, minJobSizeBits), maxJobSizeBits);
+	}
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_ADAPTIVETASKSIZER_HPP_ */
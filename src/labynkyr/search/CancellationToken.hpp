@@ -0,0 +1,114 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * CancellationToken.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_CANCELLATIONTOKEN_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_CANCELLATIONTOKEN_HPP_
+
+#include <atomic>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * A flag shared between all the threads taking part in a search, used to ask in-flight search tasks to stop early.
+ *
+ * The token is raised as soon as any thread's KeyVerifier reports success (or by the WorkScheduler when the search ends).  Enumeration
+ * algorithms poll the token at bounded intervals -- once per batch of candidate keys, and once per column of the path count graph while
+ * the ANF graph is being built -- and return as soon as they see it raised.  Cancellation is cooperative: a task that has been cancelled
+ * simply returns without enumerating the rest of its keys.
+ */
+class CancellationToken {
+public:
+	CancellationToken()
+	: cancelled(false)
+	{
+	}
+
+	~CancellationToken() {}
+
+	/**
+	 *
+	 * Raise the token, asking all tasks polling it to stop
+	 */
+	void cancel() {
+		cancelled.store(true, std::memory_order_release);
+	}
+
+	/**
+	 *
+	 * @return true if the token has been raised
+	 */
+	bool isCancelled() const {
+		return cancelled.load(std::memory_order_acquire);
+	}
+
+	/**
+	 *
+	 * Lower the token so that it may be used for another search
+	 */
+	void reset() {
+		cancelled.store(false, std::memory_order_release);
+	}
+private:
+	std::atomic<bool> cancelled;
+
+	/**
+	 * Overriden copy constructor
+	 */
+	CancellationToken(CancellationToken const &);
+
+	/**
+	 * Overriden assignment operator
+	 */
+	CancellationToken & operator=(CancellationToken const &);
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_CANCELLATIONTOKEN_HPP_ */
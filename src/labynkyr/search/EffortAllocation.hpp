@@ -56,6 +56,7 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <list>
 #include <utility>
 
@@ -155,6 +156,26 @@ public:
 		return allocatedTasks.size();
 	}
 
+	/**
+	 *
+	 * @return the maximum key weight of the SearchTasks that have not yet been removed (zero if there are none)
+	 */
+	WeightType maximumTaskWeight() const {
+		WeightType maxWeight = 0;
+		for(auto const & task : allocatedTasks) {
+			maxWeight = std::max(maxWeight, task.second.getMaxKeyWeight());
+		}
+		return maxWeight;
+	}
+
+	/**
+	 *
+	 * @return true if there are SearchTasks that have not yet been removed
+	 */
+	bool isTasksAvailable() const {
+		return !allocatedTasks.empty();
+	}
+
 	/**
 	 *
 	 * @return remove the SearchTask containing the next most likely set of key candidates from the internal list. A pair
@@ -0,0 +1,153 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * FirstSubkeyRange.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_FIRSTSUBKEYRANGE_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_FIRSTSUBKEYRANGE_HPP_
+
+#include <stdint.h>
+
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * The first subkey values of a search task that have not yet been started, shared between the thread enumerating the task and the threads
+ * that may take part of it away.
+ *
+ * The enumerating thread claims the first subkeys one at a time, in ascending order.  Another thread may split off the upper half of the
+ * subkeys not yet claimed, and search them itself.  As claimed subkeys are never split off, and split off subkeys are never claimed, each key
+ * is enumerated exactly once.
+ */
+class FirstSubkeyRange {
+public:
+	/**
+	 *
+	 * @param begin the first subkey of the range
+	 * @param end one past the last subkey of the range
+	 * @throws std::invalid_argument if the range is empty
+	 */
+	FirstSubkeyRange(uint64_t begin, uint64_t end)
+	: next(begin)
+	, end(end)
+	, mutex()
+	{
+		if(begin >= end) {
+			std::stringstream error;
+			error << "First subkey range [" << begin << ", " << end << ") must be non-empty";
+			throw std::invalid_argument(error.str().c_str());
+		}
+	}
+
+	~FirstSubkeyRange() {}
+
+	/**
+	 *
+	 * Claim the next subkey to enumerate
+	 *
+	 * @param subkey set to the claimed subkey
+	 * @return false if every subkey has been claimed or split off
+	 */
+	bool claim(uint64_t & subkey) {
+		std::unique_lock<std::mutex> lock(mutex);
+		if(next == end) {
+			return false;
+		}
+		subkey = next++;
+		return true;
+	}
+
+	/**
+	 *
+	 * Split off the upper half of the subkeys not yet claimed.  At least two must remain, so that the enumerating thread keeps one.
+	 *
+	 * @param splitBegin set to the first subkey split off
+	 * @param splitEnd set to one past the last subkey split off
+	 * @return false if too few subkeys remain to split
+	 */
+	bool split(uint64_t & splitBegin, uint64_t & splitEnd) {
+		std::unique_lock<std::mutex> lock(mutex);
+		if(end - next < 2) {
+			return false;
+		}
+		splitBegin = next + (end - next) / 2;
+		splitEnd = end;
+		end = splitBegin;
+		return true;
+	}
+
+	/**
+	 *
+	 * @return one past the last subkey that has not been split off
+	 */
+	uint64_t getEnd() const {
+		std::unique_lock<std::mutex> lock(mutex);
+		return end;
+	}
+private:
+	uint64_t next;
+	uint64_t end;
+	mutable std::mutex mutex;
+
+	/**
+	 * Overriden copy constructor
+	 */
+	FirstSubkeyRange(FirstSubkeyRange const &);
+
+	/**
+	 * Overriden assignment operator
+	 */
+	FirstSubkeyRange & operator=(FirstSubkeyRange const &);
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_FIRSTSUBKEYRANGE_HPP_ */
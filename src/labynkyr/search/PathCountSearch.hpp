@@ -50,10 +50,19 @@
 
 #include "labynkyr/rank/GraphCoordinate.hpp"
 #include "labynkyr/search/enumerate/ActiveNodeFinder.hpp"
+#include "labynkyr/search/enumerate/Arena.hpp"
+#include "labynkyr/search/enumerate/CandidateKeyForest.hpp"
+#include "labynkyr/search/enumerate/FlatCandidateKeyForest.hpp"
+#include "labynkyr/search/enumerate/FlatCandidateKeyStore.hpp"
+#include "labynkyr/search/enumerate/OrderedEnumeration.hpp"
 #include "labynkyr/search/enumerate/PathCountEnumerationGraph.hpp"
 #include "labynkyr/search/enumerate/SortedEnumeration.hpp"
+#include "labynkyr/search/enumerate/SortedWeightTable.hpp"
 #include "labynkyr/search/verify/FullKeyBuilder.hpp"
+#include "labynkyr/search/verify/KeyBatch.hpp"
 #include "labynkyr/search/verify/KeyVerifier.hpp"
+#include "labynkyr/search/CancellationToken.hpp"
+#include "labynkyr/search/FirstSubkeyRange.hpp"
 #include "labynkyr/search/SearchTask.hpp"
 #include "labynkyr/BigInt.hpp"
 #include "labynkyr/WeightTable.hpp"
@@ -61,6 +70,7 @@
 #include <stdint.h>
 
 #include <set>
+#include <sstream>
 #include <stdexcept>
 
 namespace labynkyr {
@@ -90,11 +100,62 @@ public:
 	 */
 	PathCountSearch(KeyVerifier<KeyLenBits> & keyVerifier)
 	: keyVerifier(keyVerifier)
+	, keyBatchSize(KeyBatch<KeyLenBits>::DefaultBatchSize)
+	, cancellationToken(0)
+	, memoryLimitBytes(0)
+	{
+	}
+
+	/**
+	 *
+	 * @param keyVerifier the verifier used to check whether a key candidate is correct
+	 * @param keyBatchSize the number of candidate keys handed to the verifier in each call to KeyVerifier#checkKeys
+	 */
+	PathCountSearch(KeyVerifier<KeyLenBits> & keyVerifier, uint64_t keyBatchSize)
+	: keyVerifier(keyVerifier)
+	, keyBatchSize(keyBatchSize)
+	, cancellationToken(0)
+	, memoryLimitBytes(0)
+	{
+	}
+
+	/**
+	 *
+	 * @param keyVerifier the verifier used to check whether a key candidate is correct
+	 * @param keyBatchSize the number of candidate keys handed to the verifier in each call to KeyVerifier#checkKeys
+	 * @param cancellationToken a token shared with other concurrent searches.  The search polls the token at bounded intervals and
+	 * returns early once it is raised, and raises it if this search finds the key.  May be null.
+	 */
+	PathCountSearch(KeyVerifier<KeyLenBits> & keyVerifier, uint64_t keyBatchSize, CancellationToken * cancellationToken)
+	: keyVerifier(keyVerifier)
+	, keyBatchSize(keyBatchSize)
+	, cancellationToken(cancellationToken)
+	, memoryLimitBytes(0)
 	{
 	}
 
 	~PathCountSearch() {}
 
+	/**
+	 *
+	 * Limit the memory the ANF/Forest methods may use to store candidate keys.  The limit covers the trees (or flat nodes) and the rows of
+	 * the path count graph, and is checked once per column while the graph is built.  As no key is verified until the graph is complete, a
+	 * search that exceeds the limit throws before verifying anything, and the task can be retried in smaller pieces.
+	 *
+	 * @param memoryLimitBytes the limit in bytes, or 0 for no limit
+	 */
+	void setMemoryLimit(uint64_t memoryLimitBytes) {
+		this->memoryLimitBytes = memoryLimitBytes;
+	}
+
+	/**
+	 *
+	 * @return the limit on the memory used by the ANF/Forest methods, or 0 if there is no limit
+	 */
+	uint64_t getMemoryLimit() const {
+		return memoryLimitBytes;
+	}
+
 	/**
 	 *
 	 * Enumerate keys using the ActiveNodeFinder/Forest algorithm as described in:
@@ -107,9 +168,217 @@ public:
 	 * @param activeNodeFinder the set of active nodes in the path count graph
 	 */
 	void searchWithANFForest(SearchTask<VecCount, VecLenBits, WeightType> const & task, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder) {
+		Arena arena;
+		searchWithANFForest(task, activeNodeFinder, arena);
+	}
+
+	/**
+	 *
+	 * Enumerate keys using the ActiveNodeFinder/Forest algorithm, storing the candidate key trees in the supplied arena.  The arena is reset
+	 * before the search begins and is left holding the trees when the search ends, so that Arena#bytesUsed reports the memory used by the task.
+	 *
+	 * @param task
+	 * @param activeNodeFinder the set of active nodes in the path count graph
+	 * @param arena
+	 * @throws std::bad_alloc
+	 * @throws std::length_error if the memory limit is exceeded
+	 */
+	void searchWithANFForest(SearchTask<VecCount, VecLenBits, WeightType> const & task, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder, Arena & arena) {
+		FirstSubkeyRange firstSubkeys(task.getFirstSubkeyBegin(), task.getFirstSubkeyEnd());
+		searchWithANFForest(task, activeNodeFinder, arena, firstSubkeys);
+	}
+
+	/**
+	 *
+	 * As above, but the candidate keys are only verified for the first subkeys claimed from firstSubkeys, so that another thread may split
+	 * off the first subkeys not yet started while the search runs
+	 *
+	 * @param task
+	 * @param activeNodeFinder the set of active nodes in the path count graph
+	 * @param arena
+	 * @param firstSubkeys a range within the task's range of first subkeys
+	 * @throws std::bad_alloc
+	 * @throws std::length_error if the memory limit is exceeded
+	 */
+	void searchWithANFForest(SearchTask<VecCount, VecLenBits, WeightType> const & task, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder, Arena & arena,
+			FirstSubkeyRange & firstSubkeys) {
+		arena.reset();
+		searchWithANF<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>>(task, activeNodeFinder, arena, firstSubkeys);
+	}
+
+	/**
+	 *
+	 * Enumerate keys using the ActiveNodeFinder/Forest algorithm, storing the candidate keys in the flat, index-based FlatCandidateKeyForest
+	 * representation rather than as linked trees.
+	 *
+	 * @param task
+	 * @param activeNodeFinder the set of active nodes in the path count graph
+	 */
+	void searchWithANFFlatForest(SearchTask<VecCount, VecLenBits, WeightType> const & task, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder) {
+		FlatCandidateKeyStore<VecCount, VecLenBits, SubkeyType> store;
+		searchWithANFFlatForest(task, activeNodeFinder, store);
+	}
+
+	/**
+	 *
+	 * Enumerate keys using the ActiveNodeFinder/Forest algorithm and the flat forest representation, storing the nodes in the supplied store.
+	 * The store is reset before the search begins and is left holding the nodes when the search ends.
+	 *
+	 * @param task
+	 * @param activeNodeFinder the set of active nodes in the path count graph
+	 * @param store
+	 * @throws std::length_error if the memory limit is exceeded
+	 */
+	void searchWithANFFlatForest(SearchTask<VecCount, VecLenBits, WeightType> const & task, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder,
+			FlatCandidateKeyStore<VecCount, VecLenBits, SubkeyType> & store) {
+		FirstSubkeyRange firstSubkeys(task.getFirstSubkeyBegin(), task.getFirstSubkeyEnd());
+		searchWithANFFlatForest(task, activeNodeFinder, store, firstSubkeys);
+	}
+
+	/**
+	 *
+	 * As above, but the candidate keys are only verified for the first subkeys claimed from firstSubkeys, so that another thread may split
+	 * off the first subkeys not yet started while the search runs
+	 *
+	 * @param task
+	 * @param activeNodeFinder the set of active nodes in the path count graph
+	 * @param store
+	 * @param firstSubkeys a range within the task's range of first subkeys
+	 * @throws std::length_error if the memory limit is exceeded
+	 */
+	void searchWithANFFlatForest(SearchTask<VecCount, VecLenBits, WeightType> const & task, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder,
+			FlatCandidateKeyStore<VecCount, VecLenBits, SubkeyType> & store, FirstSubkeyRange & firstSubkeys) {
+		store.reset();
+		searchWithANF<FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType>>(task, activeNodeFinder, store, firstSubkeys);
+	}
+
+	/**
+	 *
+	 * Enumerate keys using the Sorted algorithm as described in:
+	 *
+	 * How low can you go? Using side-channel data to enhance brute-force key recovery
+	 * Jake Longo and Daniel P. Martin and Luke Mather and Elisabeth Oswald and Benjamin Sach and Martijn Stam
+	 * http://eprint.iacr.org/2016/609
+	 *
+	 * @param maxKeyWeight keys with weights up to (but not inclusive) of this value will be enumerated
+	 * @param weightTable an integer representation of the distinguishing scores.  A sorted copy of the table will be made; prefer the
+	 * SortedWeightTable overload if the same table is searched repeatedly.
+	 */
+	void searchWithSorted(WeightType maxKeyWeight, WeightTable<VecCount, VecLenBits, WeightType> const & weightTable) {
+		SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const sortedWeightTable(weightTable);
+		searchWithSorted(maxKeyWeight, sortedWeightTable);
+	}
+
+	/**
+	 *
+	 * Enumerate keys using the Sorted algorithm, using a pre-sorted snapshot of the weight table.
+	 *
+	 * @param maxKeyWeight keys with weights up to (but not inclusive) of this value will be enumerated
+	 * @param sortedWeightTable a pre-sorted snapshot of the weight table.  This is not modified, and so may be shared between searches.
+	 */
+	void searchWithSorted(WeightType maxKeyWeight, SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable) {
+		searchWithSorted(maxKeyWeight, sortedWeightTable, 0, VectorSize);
+	}
+
+	/**
+	 *
+	 * Enumerate keys using the Sorted algorithm, restricted to keys whose first subkey lies in [firstSubkeyBegin, firstSubkeyEnd).
+	 *
+	 * @param maxKeyWeight keys with weights up to (but not inclusive) of this value will be enumerated
+	 * @param sortedWeightTable a pre-sorted snapshot of the weight table.  This is not modified, and so may be shared between searches.
+	 * @param firstSubkeyBegin
+	 * @param firstSubkeyEnd
+	 */
+	void searchWithSorted(WeightType maxKeyWeight, SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable,
+			uint64_t firstSubkeyBegin, uint64_t firstSubkeyEnd) {
+		if(cancellationToken != 0) {
+			SortedEnumeration<VecCount, VecLenBits, WeightType, SubkeyType> enumerator(keyVerifier, sortedWeightTable, keyBatchSize, *cancellationToken);
+			enumerator.enumerate(maxKeyWeight, firstSubkeyBegin, firstSubkeyEnd);
+		} else {
+			SortedEnumeration<VecCount, VecLenBits, WeightType, SubkeyType> enumerator(keyVerifier, sortedWeightTable, keyBatchSize);
+			enumerator.enumerate(maxKeyWeight, firstSubkeyBegin, firstSubkeyEnd);
+		}
+	}
+
+	/**
+	 *
+	 * Enumerate keys using the Sorted algorithm, restricted to keys whose first subkey is claimed from firstSubkeys (see
+	 * SortedEnumeration#enumerate), so that another thread may split off the first subkeys not yet started while the search runs.
+	 *
+	 * @param maxKeyWeight keys with weights up to (but not inclusive) of this value will be enumerated
+	 * @param sortedWeightTable a pre-sorted snapshot of the weight table.  This is not modified, and so may be shared between searches.
+	 * @param firstSubkeys
+	 */
+	void searchWithSorted(WeightType maxKeyWeight, SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable,
+			FirstSubkeyRange & firstSubkeys) {
+		if(cancellationToken != 0) {
+			SortedEnumeration<VecCount, VecLenBits, WeightType, SubkeyType> enumerator(keyVerifier, sortedWeightTable, keyBatchSize, *cancellationToken);
+			enumerator.enumerate(0, maxKeyWeight, firstSubkeys);
+		} else {
+			SortedEnumeration<VecCount, VecLenBits, WeightType, SubkeyType> enumerator(keyVerifier, sortedWeightTable, keyBatchSize);
+			enumerator.enumerate(0, maxKeyWeight, firstSubkeys);
+		}
+	}
+
+	/**
+	 *
+	 * Enumerate the keys of a task with the Sorted algorithm.  Sorted walks the key space depth-first and stores only the current partial
+	 * key, so it is the fallback for tasks whose candidate key trees would not fit in memory.
+	 *
+	 * @param task keys with weights in [task.getMinKeyWeight(), task.getMaxKeyWeight()) and a first subkey within the task's range are enumerated
+	 * @param sortedWeightTable a pre-sorted snapshot of the task's weight table
+	 */
+	void searchWithSorted(SearchTask<VecCount, VecLenBits, WeightType> const & task, SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable) {
+		if(cancellationToken != 0) {
+			SortedEnumeration<VecCount, VecLenBits, WeightType, SubkeyType> enumerator(keyVerifier, sortedWeightTable, keyBatchSize, *cancellationToken);
+			enumerator.enumerate(task.getMinKeyWeight(), task.getMaxKeyWeight(), task.getFirstSubkeyBegin(), task.getFirstSubkeyEnd());
+		} else {
+			SortedEnumeration<VecCount, VecLenBits, WeightType, SubkeyType> enumerator(keyVerifier, sortedWeightTable, keyBatchSize);
+			enumerator.enumerate(task.getMinKeyWeight(), task.getMaxKeyWeight(), task.getFirstSubkeyBegin(), task.getFirstSubkeyEnd());
+		}
+	}
+
+	/**
+	 *
+	 * Enumerate the keys of a task in ascending order of weight (see OrderedEnumeration), so that the most likely keys of the task are
+	 * verified first.
+	 *
+	 * @param task keys with weights in [task.getMinKeyWeight(), task.getMaxKeyWeight()) and a first subkey within the task's range are enumerated
+	 * @param sortedWeightTable a pre-sorted snapshot of the task's weight table
+	 */
+	void searchWithOrdered(SearchTask<VecCount, VecLenBits, WeightType> const & task, SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable) {
+		if(cancellationToken != 0) {
+			OrderedEnumeration<VecCount, VecLenBits, WeightType, SubkeyType> enumerator(keyVerifier, sortedWeightTable, keyBatchSize, *cancellationToken);
+			enumerator.enumerate(task.getMinKeyWeight(), task.getMaxKeyWeight(), task.getFirstSubkeyBegin(), task.getFirstSubkeyEnd());
+		} else {
+			OrderedEnumeration<VecCount, VecLenBits, WeightType, SubkeyType> enumerator(keyVerifier, sortedWeightTable, keyBatchSize);
+			enumerator.enumerate(task.getMinKeyWeight(), task.getMaxKeyWeight(), task.getFirstSubkeyBegin(), task.getFirstSubkeyEnd());
+		}
+	}
+private:
+	KeyVerifier<KeyLenBits> & keyVerifier;
+	uint64_t const keyBatchSize;
+	CancellationToken * cancellationToken;
+	uint64_t memoryLimitBytes;
+
+	bool isCancelled() const {
+		return cancellationToken != 0 && cancellationToken->isCancelled();
+	}
+
+	/**
+	 *
+	 * The ANF/Forest traversal, shared by both candidate key representations.  The graph is built for every first subkey, but candidate keys
+	 * are only verified for the first subkeys claimed from firstSubkeys.
+	 *
+	 * @tparam ForestType CandidateKeyForest or FlatCandidateKeyForest
+	 * @tparam StorageType the storage backing ForestType (Arena or FlatCandidateKeyStore)
+	 */
+	template<typename ForestType, typename StorageType>
+	void searchWithANF(SearchTask<VecCount, VecLenBits, WeightType> const & task, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder, StorageType & storage,
+			FirstSubkeyRange & firstSubkeys) {
 		auto const & weightTable = task.getWeightTable();
 
-		PathCountEnumerationGraph<VecCount, VecLenBits, WeightType, SubkeyType> graph(task);
+		PathCountEnumerationGraph<VecCount, VecLenBits, WeightType, SubkeyType, ForestType> graph(task);
 
 		WeightType breakWeight = task.getMaxKeyWeight();
 		for(uint32_t vectorIndex = VecCount ; vectorIndex > 1 ; vectorIndex--) {
@@ -124,6 +393,13 @@ public:
 				if(weightIndex > breakWeight) {
 					break;
 				}
+				// Building the graph can take a long time for large tasks, so poll for cancellation once per column
+				if(isCancelled()) {
+					return;
+				}
+				if(memoryLimitBytes != 0) {
+					checkMemoryLimit(graph.bytesUsed() + storage.bytesUsed());
+				}
 				for(uint64_t subkeyIndex = VectorSize ; subkeyIndex > 0 ; subkeyIndex--) {
 					rank::GraphCoordinate const coord(vectorIndex - 1, subkeyIndex - 1, weightIndex);
 					rank::GraphCoordinate const rightChildIndex = graph.rightChildIndex(coord);
@@ -131,7 +407,7 @@ public:
 					if(rightChildIndex.isReject() == false) {
 						auto const & rightSet = graph.rightChild(rightChildIndex);
 						auto & setAtCoord = graph.at(coord);
-						setAtCoord.merge(rightSet, subkeyIndex - 1);
+						merge(setAtCoord, rightSet, subkeyIndex - 1, vectorIndex - 1, storage);
 					}
 				}
 			}
@@ -139,36 +415,48 @@ public:
 			graph.rotateBuffers();
 		}
 		// Can skip all but nodes with weight 0 in the last vector
-		for(uint64_t subkeyIndex = VectorSize ; subkeyIndex > 0 ; subkeyIndex--) {
-			if(keyVerifier.success()) break;
-			rank::GraphCoordinate const coord(0, subkeyIndex - 1, 0);
+		KeyBatch<KeyLenBits> keyBatch(keyVerifier, keyBatchSize, cancellationToken);
+		uint64_t subkey = 0;
+		while(!keyBatch.isStopped() && firstSubkeys.claim(subkey)) {
+			rank::GraphCoordinate const coord(0, subkey, 0);
 			rank::GraphCoordinate const rightChildIndex = graph.rightChildIndex(coord);
 
 			if(rightChildIndex.isReject() == false) {
 				auto const & rightSet = graph.rightChild(rightChildIndex);
 				auto & setAtCoord = graph.at(coord);
-				setAtCoord.verifyMergeCandidates(keyVerifier, rightSet, subkeyIndex - 1);
+				verifyMergeCandidates(keyBatch, setAtCoord, rightSet, subkey, storage);
 			}
 		}
+		keyBatch.flush();
 	}
 
-	/**
-	 *
-	 * Enumerate keys using the Sorted algorithm as described in:
-	 *
-	 * How low can you go? Using side-channel data to enhance brute-force key recovery
-	 * Jake Longo and Daniel P. Martin and Luke Mather and Elisabeth Oswald and Benjamin Sach and Martijn Stam
-	 * http://eprint.iacr.org/2016/609
-	 *
-	 * @param weightTable an integer representation of the distinguishing scores.  This object will be sorted, so copy
-	 * before use if it is to be re-used in original form elsewhere.
-	 */
-	void searchWithSorted(WeightType maxKeyWeight, WeightTable<VecCount, VecLenBits, WeightType> & weightTable) {
-		SortedEnumeration<VecCount, VecLenBits, WeightType, SubkeyType> enumerator(keyVerifier, weightTable);
-		enumerator.enumerate(maxKeyWeight);
+	void checkMemoryLimit(uint64_t bytesUsed) const {
+		if(bytesUsed > memoryLimitBytes) {
+			std::stringstream error;
+			error << "ANF/Forest search used " << bytesUsed << " bytes, exceeding the limit of " << memoryLimitBytes << " bytes";
+			throw std::length_error(error.str().c_str());
+		}
+	}
+
+	static void merge(CandidateKeyForest<VecCount, VecLenBits, SubkeyType> & forest, CandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & other,
+			SubkeyType nextValue, uint32_t, Arena & arena) {
+		forest.merge(other, nextValue, arena);
+	}
+
+	static void merge(FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType> & forest, FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & other,
+			SubkeyType nextValue, uint32_t vectorIndex, FlatCandidateKeyStore<VecCount, VecLenBits, SubkeyType> & store) {
+		forest.merge(other, nextValue, vectorIndex, store);
+	}
+
+	static void verifyMergeCandidates(KeyBatch<KeyLenBits> & keyBatch, CandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & forest,
+			CandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & other, SubkeyType nextValue, Arena &) {
+		forest.verifyMergeCandidates(keyBatch, other, nextValue);
+	}
+
+	static void verifyMergeCandidates(KeyBatch<KeyLenBits> & keyBatch, FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & forest,
+			FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & other, SubkeyType nextValue, FlatCandidateKeyStore<VecCount, VecLenBits, SubkeyType> & store) {
+		forest.verifyMergeCandidates(keyBatch, other, nextValue, store);
 	}
-private:
-	KeyVerifier<KeyLenBits> & keyVerifier;
 };
 
 } /*namespace search */
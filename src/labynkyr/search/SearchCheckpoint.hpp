@@ -0,0 +1,451 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SearchCheckpoint.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_SEARCHCHECKPOINT_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_SEARCHCHECKPOINT_HPP_
+
+#include "labynkyr/search/SearchSpec.hpp"
+#include "labynkyr/search/SearchTask.hpp"
+#include "labynkyr/search/SearchTaskGenerator.hpp"
+#include "labynkyr/BigInt.hpp"
+#include "labynkyr/WeightTable.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <list>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * A SearchCheckpoint records the progress of a parallel search so that it can be resumed after the process is stopped.  It contains:
+ * 		- a hash of the weight table the search was planned against
+ * 		- the search plan: every SearchTask, identified by its index in the plan, with its weight bounds and key count
+ * 		- the set of tasks that have been fully enumerated and verified
+ *
+ * A checkpoint is written with save(), which writes to a temporary file and renames it over the destination so that the file on disk is
+ * always either the previous or the new checkpoint, never a partial one.  It is read back with the file constructor, which checks the
+ * file was written for the same weight table.  remainingTasks() returns only the unfinished tasks, ready to be passed to the
+ * EffortAllocation pre-allocated task constructor.
+ *
+ * The budget of a search can be extended with extendBudget(), which appends tasks for the keys beyond the deepest planned weight, so that
+ * a finished search can be continued deeper without repeating any work.
+ *
+ * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
+ * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
+ * @tparam WeightType the integer type used to store weights (e.g uint32_t)
+ */
+template<uint32_t VecCount, uint32_t VecLenBits, typename WeightType>
+class SearchCheckpoint {
+public:
+	enum {
+		KeyLenBits = VecCount * VecLenBits,
+		FormatVersion = 1
+	};
+
+	using TaskList = std::list<std::pair<BigInt<KeyLenBits>, SearchTask<VecCount, VecLenBits, WeightType>>>;
+
+	/**
+	 *
+	 * Create a checkpoint for a new search, in which no tasks have been completed
+	 *
+	 * @param weightTable the weight table the tasks were planned against
+	 * @param plannedTasks the search plan, in the form returned by EffortAllocation#getAllocatedTasks
+	 */
+	SearchCheckpoint(WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, TaskList const & plannedTasks)
+	: weightTable(weightTable)
+	, weightTableHash(hashWeightTable(weightTable))
+	{
+		for(auto const & task : plannedTasks) {
+			addTask(task.second.getMinKeyWeight(), task.second.getMaxKeyWeight(), task.first);
+		}
+	}
+
+	/**
+	 *
+	 * Load a checkpoint previously written by save()
+	 *
+	 * @param weightTable the weight table the search was planned against
+	 * @param path
+	 * @throws std::runtime_error if the file cannot be read or is malformed
+	 * @throws std::invalid_argument if the checkpoint was written for a different weight table
+	 */
+	SearchCheckpoint(WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, std::string const & path)
+	: weightTable(weightTable)
+	, weightTableHash(hashWeightTable(weightTable))
+	{
+		std::ifstream input(path.c_str());
+		if(!input.good()) {
+			std::stringstream error;
+			error << "Unable to open checkpoint file " << path;
+			throw std::runtime_error(error.str().c_str());
+		}
+		read(input, path);
+	}
+
+	~SearchCheckpoint() {}
+
+	/**
+	 *
+	 * Atomically and durably replace the file at path with the current state of the checkpoint.  The new contents are written to
+	 * path.tmp and synced to disk before the rename, and the directory is synced after it, so that a power loss leaves either the old
+	 * or the new checkpoint in place and never a truncated one.
+	 *
+	 * @param path
+	 * @throws std::runtime_error if the file cannot be written
+	 */
+	void save(std::string const & path) const {
+		std::string const temporaryPath = path + ".tmp";
+		std::stringstream contents;
+		write(contents);
+		writeAndSync(temporaryPath, contents.str());
+		if(rename(temporaryPath.c_str(), path.c_str()) != 0) {
+			std::stringstream error;
+			error << "Unable to move checkpoint file " << temporaryPath << " to " << path;
+			throw std::runtime_error(error.str().c_str());
+		}
+		syncDirectory(path);
+	}
+
+	/**
+	 *
+	 * Record that a task has been fully enumerated and verified
+	 *
+	 * @param task a task in the plan
+	 * @throws std::invalid_argument if the task is not part of the plan
+	 */
+	void markCompleted(SearchTask<VecCount, VecLenBits, WeightType> const & task) {
+		completedTaskIds.insert(taskId(task));
+	}
+
+	/**
+	 *
+	 * @param task a task in the plan
+	 * @return the index of the task in the plan
+	 * @throws std::invalid_argument if the task is not part of the plan
+	 */
+	uint32_t taskId(SearchTask<VecCount, VecLenBits, WeightType> const & task) const {
+		auto const iter = taskIds.find(std::make_pair(task.getMinKeyWeight(), task.getMaxKeyWeight()));
+		if(iter == taskIds.end()) {
+			std::stringstream error;
+			error << "Search task [" << static_cast<uint64_t>(task.getMinKeyWeight()) << ", " << static_cast<uint64_t>(task.getMaxKeyWeight());
+			error << ") is not part of the checkpointed search plan";
+			throw std::invalid_argument(error.str().c_str());
+		}
+		return iter->second;
+	}
+
+	/**
+	 *
+	 * @param taskId
+	 * @return true if the task has been recorded as completed
+	 */
+	bool isCompleted(uint32_t taskId) const {
+		return completedTaskIds.count(taskId) != 0;
+	}
+
+	/**
+	 *
+	 * @return the tasks in the plan that have not been completed, most likely keys first
+	 */
+	TaskList remainingTasks() const {
+		TaskList remaining;
+		for(uint32_t taskId = 0 ; taskId < plannedTasks.size() ; taskId++) {
+			if(!isCompleted(taskId)) {
+				PlannedTask const & planned = plannedTasks[taskId];
+				SearchTask<VecCount, VecLenBits, WeightType> const task(planned.minKeyWeight, planned.maxKeyWeight, weightTable);
+				remaining.push_back(std::make_pair(planned.keyCount, task));
+			}
+		}
+		return remaining;
+	}
+
+	/**
+	 *
+	 * Extend the search plan to cover a larger search.  Tasks are generated for the new total effort exactly as EffortAllocation would,
+	 * and only the keys with a weight at or above the deepest planned weight are added; a generated task straddling that weight is
+	 * trimmed.  Previously planned tasks, and their completion state, are unchanged.
+	 *
+	 * @param totalEffort the new global search specification
+	 * @param preferredJobSizeBits each new SearchTask will aim to contain 2^preferredJobSizeBits key candidates
+	 * @return the number of tasks added to the plan
+	 */
+	uint32_t extendBudget(SearchSpec<KeyLenBits> const & totalEffort, uint32_t preferredJobSizeBits) {
+		uint32_t const initialTaskCount = plannedTasks.size();
+		SearchTaskGenerator<VecCount, VecLenBits, WeightType> taskGenerator(weightTable, totalEffort.deepestKey() + 1);
+		WeightType const plannedMaxWeight = maximumPlannedWeight();
+		BigInt<KeyLenBits> const plannedKeyCount = taskGenerator.keysBelowWeight(plannedMaxWeight);
+		while(taskGenerator.isTasksAvailable()) {
+			auto const keysAllocatedCount = taskGenerator.keysAllocatedCount();
+			auto const task = taskGenerator.nextTask(preferredJobSizeBits);
+			if(task.getMaxKeyWeight() <= plannedMaxWeight) {
+				continue;
+			} else if(task.getMinKeyWeight() < plannedMaxWeight) {
+				addTask(plannedMaxWeight, task.getMaxKeyWeight(), taskGenerator.keysAllocatedCount() - plannedKeyCount);
+			} else {
+				addTask(task.getMinKeyWeight(), task.getMaxKeyWeight(), taskGenerator.keysAllocatedCount() - keysAllocatedCount);
+			}
+		}
+		return plannedTasks.size() - initialTaskCount;
+	}
+
+	/**
+	 *
+	 * @return the number of tasks in the plan
+	 */
+	uint32_t taskCount() const {
+		return plannedTasks.size();
+	}
+
+	/**
+	 *
+	 * @return the number of tasks recorded as completed
+	 */
+	uint32_t completedCount() const {
+		return completedTaskIds.size();
+	}
+
+	/**
+	 *
+	 * @return the weight up to which (but not inclusive) keys are covered by the plan, or zero if the plan is empty
+	 */
+	WeightType maximumPlannedWeight() const {
+		WeightType maxWeight = 0;
+		for(auto const & planned : plannedTasks) {
+			maxWeight = (planned.maxKeyWeight > maxWeight) ? planned.maxKeyWeight : maxWeight;
+		}
+		return maxWeight;
+	}
+
+	uint64_t getWeightTableHash() const {
+		return weightTableHash;
+	}
+
+	/**
+	 *
+	 * @param weightTable
+	 * @return a 64-bit FNV-1a hash of the dimensions and weights of the table
+	 */
+	static uint64_t hashWeightTable(WeightTable<VecCount, VecLenBits, WeightType> const & weightTable) {
+		uint64_t hash = 14695981039346656037ULL;
+		auto const mix = [&hash](uint64_t value) {
+			for(uint32_t byteIndex = 0 ; byteIndex < 8 ; byteIndex++) {
+				hash ^= (value >> (byteIndex * 8)) & 0xFF;
+				hash *= 1099511628211ULL;
+			}
+		};
+		mix(VecCount);
+		mix(VecLenBits);
+		for(auto const weight : weightTable.allWeights()) {
+			mix(static_cast<uint64_t>(weight));
+		}
+		return hash;
+	}
+private:
+	/**
+	 *
+	 * Write contents to the file at path, replacing it, and fsync the file before returning
+	 *
+	 * @throws std::runtime_error
+	 */
+	static void writeAndSync(std::string const & path, std::string const & contents) {
+		int const fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if(fd < 0) {
+			std::stringstream error;
+			error << "Unable to open checkpoint file " << path;
+			throw std::runtime_error(error.str().c_str());
+		}
+		size_t written = 0;
+		bool ok = true;
+		while(ok && written < contents.size()) {
+			ssize_t const result = ::write(fd, contents.data() + written, contents.size() - written);
+			if(result < 0 && errno != EINTR) {
+				ok = false;
+			} else if(result > 0) {
+				written += static_cast<size_t>(result);
+			}
+		}
+		ok = ok && (fsync(fd) == 0);
+		ok = (close(fd) == 0) && ok;
+		if(!ok) {
+			std::stringstream error;
+			error << "Unable to write checkpoint file " << path;
+			throw std::runtime_error(error.str().c_str());
+		}
+	}
+
+	/**
+	 *
+	 * fsync the directory containing path, so that a rename into it is durable
+	 *
+	 * @throws std::runtime_error
+	 */
+	static void syncDirectory(std::string const & path) {
+		size_t const separator = path.find_last_of('/');
+		std::string const directory = (separator == std::string::npos) ? "." : (separator == 0 ? "/" : path.substr(0, separator));
+		int const fd = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+		if(fd < 0) {
+			std::stringstream error;
+			error << "Unable to open checkpoint directory " << directory;
+			throw std::runtime_error(error.str().c_str());
+		}
+		bool const ok = (fsync(fd) == 0);
+		close(fd);
+		if(!ok) {
+			std::stringstream error;
+			error << "Unable to sync checkpoint directory " << directory;
+			throw std::runtime_error(error.str().c_str());
+		}
+	}
+
+	struct PlannedTask {
+		WeightType minKeyWeight;
+		WeightType maxKeyWeight;
+		BigInt<KeyLenBits> keyCount;
+	};
+
+	WeightTable<VecCount, VecLenBits, WeightType> const & weightTable;
+	uint64_t const weightTableHash;
+	std::vector<PlannedTask> plannedTasks;
+	std::map<std::pair<WeightType, WeightType>, uint32_t> taskIds;
+	std::set<uint32_t> completedTaskIds;
+
+	void addTask(WeightType minKeyWeight, WeightType maxKeyWeight, BigInt<KeyLenBits> keyCount) {
+		PlannedTask const planned = {minKeyWeight, maxKeyWeight, keyCount};
+		taskIds[std::make_pair(minKeyWeight, maxKeyWeight)] = plannedTasks.size();
+		plannedTasks.push_back(planned);
+	}
+
+	/**
+	 *
+	 * The checkpoint is stored as plain text:
+	 * 		labynkyr-checkpoint <version>
+	 * 		weight-table-hash <hash>
+	 * 		tasks <count>
+	 * 		<minKeyWeight> <maxKeyWeight> <keyCount>		(one line per task, in plan order)
+	 * 		completed <count>
+	 * 		<taskId>										(one line per completed task)
+	 */
+	void write(std::ostream & output) const {
+		output << "labynkyr-checkpoint " << FormatVersion << "\n";
+		output << "weight-table-hash " << weightTableHash << "\n";
+		output << "tasks " << plannedTasks.size() << "\n";
+		for(auto const & planned : plannedTasks) {
+			output << static_cast<uint64_t>(planned.minKeyWeight) << " " << static_cast<uint64_t>(planned.maxKeyWeight) << " " << planned.keyCount << "\n";
+		}
+		output << "completed " << completedTaskIds.size() << "\n";
+		for(auto const taskId : completedTaskIds) {
+			output << taskId << "\n";
+		}
+	}
+
+	void read(std::istream & input, std::string const & path) {
+		std::string header;
+		uint32_t version = 0;
+		std::string hashLabel;
+		uint64_t fileHash = 0;
+		std::string tasksLabel;
+		uint64_t taskCount = 0;
+		input >> header >> version >> hashLabel >> fileHash >> tasksLabel >> taskCount;
+		if(!input.good() || header != "labynkyr-checkpoint" || version != FormatVersion || hashLabel != "weight-table-hash" || tasksLabel != "tasks") {
+			throwMalformed(path);
+		}
+		if(fileHash != weightTableHash) {
+			std::stringstream error;
+			error << "Checkpoint file " << path << " was written for a different weight table";
+			throw std::invalid_argument(error.str().c_str());
+		}
+		for(uint64_t taskIndex = 0 ; taskIndex < taskCount ; taskIndex++) {
+			uint64_t minKeyWeight = 0;
+			uint64_t maxKeyWeight = 0;
+			BigInt<KeyLenBits> keyCount = 0;
+			input >> minKeyWeight >> maxKeyWeight >> keyCount;
+			if(!input.good()) {
+				throwMalformed(path);
+			}
+			addTask(static_cast<WeightType>(minKeyWeight), static_cast<WeightType>(maxKeyWeight), keyCount);
+		}
+		std::string completedLabel;
+		uint64_t completedCount = 0;
+		input >> completedLabel >> completedCount;
+		if(input.fail() || completedLabel != "completed") {
+			throwMalformed(path);
+		}
+		for(uint64_t completedIndex = 0 ; completedIndex < completedCount ; completedIndex++) {
+			uint64_t taskId = 0;
+			input >> taskId;
+			if(input.fail() || taskId >= plannedTasks.size()) {
+				throwMalformed(path);
+			}
+			completedTaskIds.insert(taskId);
+		}
+	}
+
+	static void throwMalformed(std::string const & path) {
+		std::stringstream error;
+		error << "Checkpoint file " << path << " is malformed";
+		throw std::runtime_error(error.str().c_str());
+	}
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_SEARCHCHECKPOINT_HPP_ */
@@ -52,6 +52,10 @@
 
 #include <stdint.h>
 
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
 namespace labynkyr {
 namespace search {
 
@@ -61,6 +65,10 @@ namespace search {
  *
  * Labynkyr will sequentially enumerate and verify the key candidates defined by the weight range.
  *
+ * A SearchTask may additionally be restricted to the keys whose first subkey (the subkey targeted by the first distinguishing vector) lies
+ * in a range [firstSubkeyBegin, firstSubkeyEnd).  By default the range covers every subkey value.  Restricting the first subkey partitions the
+ * keys in the weight range, which allows a single task to be split into independent pieces and processed in parallel.
+ *
  * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
  * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
  * @tparam WeightType the integer type used to store weights (e.g uint32_t)
@@ -68,6 +76,11 @@ namespace search {
 template<uint32_t VecCount, uint32_t VecLenBits, typename WeightType>
 class SearchTask {
 public:
+	enum {
+		// Number of distinguishing scores in each distinguishing vector
+		VectorSize = 1UL << VecLenBits
+	};
+
 	/**
 	 *
 	 * @param minKeyWeight the lowest weight at which keys will be enumerated
@@ -78,13 +91,42 @@ public:
 	: minKeyWeight(minKeyWeight)
 	, maxKeyWeight(maxKeyWeight)
 	, weightTable(weightTable)
+	, firstSubkeyBegin(0)
+	, firstSubkeyEnd(VectorSize)
 	{
 	}
 
+	/**
+	 *
+	 * @param minKeyWeight the lowest weight at which keys will be enumerated
+	 * @param maxKeyWeight the weight up to (but not inclusive) that keys will be enumerated
+	 * @param weightTable an integer representation of the distinguishing scores
+	 * @param firstSubkeyBegin only keys whose first subkey is at least this value will be enumerated
+	 * @param firstSubkeyEnd only keys whose first subkey is less than this value will be enumerated
+	 * @throws std::invalid_argument if the subkey range is empty or exceeds the number of subkey values
+	 */
+	SearchTask(WeightType minKeyWeight, WeightType maxKeyWeight, WeightTable<VecCount, VecLenBits, WeightType> const & weightTable,
+			uint64_t firstSubkeyBegin, uint64_t firstSubkeyEnd)
+	: minKeyWeight(minKeyWeight)
+	, maxKeyWeight(maxKeyWeight)
+	, weightTable(weightTable)
+	, firstSubkeyBegin(firstSubkeyBegin)
+	, firstSubkeyEnd(firstSubkeyEnd)
+	{
+		if(firstSubkeyBegin >= firstSubkeyEnd || firstSubkeyEnd > VectorSize) {
+			std::stringstream error;
+			error << "First subkey range [" << firstSubkeyBegin << ", " << firstSubkeyEnd << ") must be non-empty and within [0, ";
+			error << VectorSize << ")";
+			throw std::invalid_argument(error.str().c_str());
+		}
+	}
+
 	SearchTask(SearchTask const & other)
 	: minKeyWeight(other.getMinKeyWeight())
 	, maxKeyWeight(other.getMaxKeyWeight())
 	, weightTable(other.getWeightTable())
+	, firstSubkeyBegin(other.getFirstSubkeyBegin())
+	, firstSubkeyEnd(other.getFirstSubkeyEnd())
 	{
 	}
 
@@ -123,10 +165,66 @@ public:
 	bool isInitialTask() const {
 		return (minKeyWeight == weightTable.minimumWeight() || minKeyWeight == 0);
 	}
+
+	/**
+	 *
+	 * @return the smallest first subkey value that will be enumerated
+	 */
+	uint64_t getFirstSubkeyBegin() const {
+		return firstSubkeyBegin;
+	}
+
+	/**
+	 *
+	 * @return keys with a first subkey up to (but not inclusive) of this value will be enumerated
+	 */
+	uint64_t getFirstSubkeyEnd() const {
+		return firstSubkeyEnd;
+	}
+
+	/**
+	 *
+	 * @param subkey
+	 * @return true if keys with this first subkey value are part of the task
+	 */
+	bool isFirstSubkeyIncluded(uint64_t subkey) const {
+		return subkey >= firstSubkeyBegin && subkey < firstSubkeyEnd;
+	}
+
+	/**
+	 *
+	 * @return true if the task covers more than one first subkey value, and so can be split
+	 */
+	bool isSplittable() const {
+		return firstSubkeyEnd - firstSubkeyBegin > 1;
+	}
+
+	/**
+	 *
+	 * Split the task into two tasks over the same weight range, by halving the range of first subkey values.  Together the two tasks
+	 * enumerate exactly the keys of this task.
+	 *
+	 * @return the lower and upper halves
+	 * @throws std::logic_error if the task is not splittable
+	 */
+	std::pair<SearchTask, SearchTask> splitByFirstSubkey() const {
+		if(!isSplittable()) {
+			std::stringstream error;
+			error << "Search task covers a single first subkey value and cannot be split";
+			throw std::logic_error(error.str().c_str());
+		}
+		uint64_t const middle = firstSubkeyBegin + (firstSubkeyEnd - firstSubkeyBegin) / 2;
+		return std::make_pair(
+			SearchTask(minKeyWeight, maxKeyWeight, weightTable, firstSubkeyBegin, middle),
+			SearchTask(minKeyWeight, maxKeyWeight, weightTable, middle, firstSubkeyEnd)
+		);
+	}
 private:
 	WeightType const minKeyWeight;
 	WeightType const maxKeyWeight;
 	WeightTable<VecCount, VecLenBits, WeightType> const & weightTable;
+	uint64_t const firstSubkeyBegin;
+	uint64_t const firstSubkeyEnd;
 };
 
 } /*namespace search */
@@ -87,11 +87,12 @@ public:
 	 *
 	 * @param weightTable an integer representation of the distinguishing scores
 	 * @param maxKeysAllocatableCount the maximum number of keys this generator can allocate (starting from the most likely key).  This
-	 * limit is approximate, as large amounts of keys are likely to share the same weight value.
+	 * limit is approximate, as large amounts of keys are likely to share the same weight value.  Only the weights needed to reach
+	 * this limit are ranked.
 	 */
 	SearchTaskGenerator(WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, BigInt<KeyLenBits> maxKeysAllocatableCount)
 	: weightTable(weightTable)
-	, weightFinder(weightTable)
+	, weightFinder(weightTable, maxKeysAllocatableCount)
 	, keysAllocated(0)
 	, nextMinWeight(0)
 	, nextMaxWeight(0)
@@ -219,6 +220,29 @@ public:
 	BigInt<KeyLenBits> getMaxKeysAllocatableCount() const {
 		return maxKeysAllocatableCount;
 	}
+
+	/**
+	 *
+	 * @return an upper bound on the maximum key weight of any task this generator can produce
+	 */
+	WeightType maximumTaskWeight() const {
+		return weightFinder.rankedWeightBound();
+	}
+
+	/**
+	 *
+	 * @param weight
+	 * @return the number of keys with a weight strictly less than weight.  Weights beyond those ranked by the generator (see
+	 * WeightFinder#rankedWeightBound) are clamped to the bound.
+	 */
+	BigInt<KeyLenBits> keysBelowWeight(WeightType weight) const {
+		if(weight == 0) {
+			return 0;
+		} else if(weight >= weightFinder.list().size()) {
+			return weightFinder.list()[0];
+		}
+		return weightFinder.list()[weightFinder.list().size() - weight];
+	}
 private:
 	WeightTable<VecCount, VecLenBits, WeightType> const & weightTable;
 	WeightFinder<VecCount, VecLenBits, WeightType> weightFinder;
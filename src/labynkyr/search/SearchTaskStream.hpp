@@ -0,0 +1,232 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SearchTaskStream.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_SEARCHTASKSTREAM_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_SEARCHTASKSTREAM_HPP_
+
+#include "labynkyr/search/AdaptiveTaskSizer.hpp"
+#include "labynkyr/search/SearchSpec.hpp"
+#include "labynkyr/search/SearchTaskGenerator.hpp"
+#include "labynkyr/search/SearchTask.hpp"
+#include "labynkyr/BigInt.hpp"
+#include "labynkyr/WeightTable.hpp"
+
+#include <stdint.h>
+
+#include <list>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * A lazy alternative to EffortAllocation.  Divides a global SearchSpec into the same sequence of SearchTasks, but only generates each task
+ * when it is removed from the stream, rather than materialising the whole plan up front.  A parallel search can therefore start as soon
+ * as the first task is available, and only needs to hold a bounded number of tasks at any one time.
+ *
+ * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
+ * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
+ * @tparam WeightType the integer type used to score weights (e.g uint32_t)
+ */
+template<uint32_t VecCount, uint32_t VecLenBits, typename WeightType>
+class SearchTaskStream {
+public:
+	enum {
+		KeyLenBits = VecCount * VecLenBits
+	};
+
+	/**
+	 *
+	 * @param totalEffort
+	 * @param weightTable
+	 * @param preferredJobSizeBits each discrete SearchTask will aim to contain 2^preferredJobSizeBits key candidates
+	 * @throws std::logic_error
+	 */
+	SearchTaskStream(SearchSpec<KeyLenBits> const & totalEffort, WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, uint32_t preferredJobSizeBits)
+	: weightTable(weightTable)
+	, taskGenerator(weightTable, totalEffort.deepestKey() + 1)
+	, preferredFirstJobSizeBits(preferredJobSizeBits)
+	, preferredJobSizeBits(preferredJobSizeBits)
+	, taskSizer(0)
+	{
+		skipToOffset(totalEffort);
+	}
+
+	/**
+	 *
+	 * @param totalEffort
+	 * @param weightTable
+	 * @param preferredFirstJobSizeBits the first SearchTask will aim to contain 2^preferredFirstJobSizeBits key candidates
+	 * @param preferredJobSizeBits each subsequent discrete SearchTask will aim to contain 2^preferredJobSizeBits key candidates
+	 * @throws std::logic_error
+	 */
+	SearchTaskStream(SearchSpec<KeyLenBits> const & totalEffort, WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, uint32_t preferredFirstJobSizeBits,
+			uint32_t preferredJobSizeBits)
+	: weightTable(weightTable)
+	, taskGenerator(weightTable, totalEffort.deepestKey() + 1)
+	, preferredFirstJobSizeBits(preferredFirstJobSizeBits)
+	, preferredJobSizeBits(preferredJobSizeBits)
+	, taskSizer(0)
+	{
+		skipToOffset(totalEffort);
+	}
+
+	/**
+	 *
+	 * Size every task after the first adaptively.  The WorkScheduler records the time taken by each completed task in the AdaptiveTaskSizer,
+	 * and the size of each subsequent task is taken from it when the task is generated.
+	 *
+	 * @param totalEffort
+	 * @param weightTable
+	 * @param preferredFirstJobSizeBits the first SearchTask will aim to contain 2^preferredFirstJobSizeBits key candidates.  Keeping this
+	 * small gives fast results for the most likely keys.
+	 * @param taskSizer chooses the size of each subsequent SearchTask.  Must outlive the stream.
+	 * @throws std::logic_error
+	 */
+	SearchTaskStream(SearchSpec<KeyLenBits> const & totalEffort, WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, uint32_t preferredFirstJobSizeBits,
+			AdaptiveTaskSizer<KeyLenBits> & taskSizer)
+	: weightTable(weightTable)
+	, taskGenerator(weightTable, totalEffort.deepestKey() + 1)
+	, preferredFirstJobSizeBits(preferredFirstJobSizeBits)
+	, preferredJobSizeBits(preferredFirstJobSizeBits)
+	, taskSizer(&taskSizer)
+	{
+		skipToOffset(totalEffort);
+	}
+
+	~SearchTaskStream() {}
+
+	WeightTable<VecCount, VecLenBits, WeightType> const & getWeightTable() const {
+		return weightTable;
+	}
+
+	/**
+	 *
+	 * @return the AdaptiveTaskSizer used to choose task sizes, or null if tasks have a fixed preferred size
+	 */
+	AdaptiveTaskSizer<KeyLenBits> * getTaskSizer() const {
+		return taskSizer;
+	}
+
+	/**
+	 *
+	 * @return an upper bound on the maximum key weight of any task in the stream
+	 */
+	WeightType maximumTaskWeight() const {
+		return taskGenerator.maximumTaskWeight();
+	}
+
+	/**
+	 *
+	 * @return true if there are further SearchTasks to remove from the stream
+	 */
+	bool isTasksAvailable() const {
+		return !pendingTasks.empty() || taskGenerator.isTasksAvailable();
+	}
+
+	/**
+	 *
+	 * @return generate the SearchTask containing the next most likely set of key candidates. A pair
+	 *		{number_of_keys_in_task, SearchTask}
+	 * will be returned.
+	 * @throws std::logic_error if no further tasks are available
+	 */
+	std::pair<BigInt<KeyLenBits>, SearchTask<VecCount, VecLenBits, WeightType>> removeNextTask() {
+		if(!isTasksAvailable()) {
+			std::stringstream output;
+			output << "No further search task available.";
+			throw std::logic_error(output.str().c_str());
+		}
+		if(!pendingTasks.empty()) {
+			auto const nextTask = pendingTasks.front();
+			pendingTasks.pop_front();
+			return nextTask;
+		}
+		return generateTask();
+	}
+private:
+	WeightTable<VecCount, VecLenBits, WeightType> const & weightTable;
+	SearchTaskGenerator<VecCount, VecLenBits, WeightType> taskGenerator;
+	uint32_t const preferredFirstJobSizeBits;
+	uint32_t const preferredJobSizeBits;
+	AdaptiveTaskSizer<KeyLenBits> * const taskSizer;
+	// Holds the task straddling the offset, which has been generated before it is requested
+	std::list<std::pair<BigInt<KeyLenBits>, SearchTask<VecCount, VecLenBits, WeightType>>> pendingTasks;
+
+	/**
+	 *
+	 * Discard tasks in the same way as EffortAllocation: the first task retained is the first whose keys take the cumulative count past
+	 * the offset, so the offset boundary will be somewhere in the middle of it.
+	 */
+	void skipToOffset(SearchSpec<KeyLenBits> const & totalEffort) {
+		if(totalEffort.hasOffset()) {
+			while(taskGenerator.isTasksAvailable()) {
+				auto const nextTask = generateTask();
+				if(taskGenerator.keysAllocatedCount() > totalEffort.getOffset()) {
+					pendingTasks.push_back(nextTask);
+					break;
+				}
+			}
+		}
+	}
+
+	std::pair<BigInt<KeyLenBits>, SearchTask<VecCount, VecLenBits, WeightType>> generateTask() {
+		auto const keysAllocatedCount = taskGenerator.keysAllocatedCount();
+		auto const task = (keysAllocatedCount == 0) ? taskGenerator.nextTask(preferredFirstJobSizeBits)
+			: (taskSizer != 0) ? taskGenerator.nextTask(taskSizer->preferredJobSizeBits()) : taskGenerator.nextTask(preferredJobSizeBits);
+		auto const batchSize = taskGenerator.keysAllocatedCount() - keysAllocatedCount;
+		return std::make_pair(batchSize, task);
+	}
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_SEARCHTASKSTREAM_HPP_ */
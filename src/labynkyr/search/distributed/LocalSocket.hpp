@@ -0,0 +1,276 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * LocalSocket.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_DISTRIBUTED_LOCALSOCKET_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_DISTRIBUTED_LOCALSOCKET_HPP_
+
+#ifdef __linux__
+	#include <errno.h>
+	#include <string.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#endif
+
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace labynkyr {
+namespace search {
+
+#ifdef __linux__
+
+/**
+ *
+ * A Unix domain stream socket carrying newline-terminated text messages.  Received bytes are buffered until a whole line is available, so
+ * a socket can be drained with receive() whenever poll() reports it readable, and the complete lines then taken with nextLine().
+ *
+ * Only available on Linux.
+ */
+class LocalSocket {
+public:
+	~LocalSocket() {
+		::close(descriptor);
+	}
+
+	/**
+	 *
+	 * Create a socket listening for connections at path.  Any existing file at path is removed first.
+	 *
+	 * @param path
+	 * @return the listening socket
+	 * @throws std::runtime_error
+	 */
+	static std::unique_ptr<LocalSocket> listen(std::string const & path) {
+		std::unique_ptr<LocalSocket> socket(new LocalSocket(newDescriptor()));
+		sockaddr_un const address = socketAddress(path);
+		::unlink(path.c_str());
+		if(::bind(socket->descriptor, reinterpret_cast<sockaddr const *>(&address), sizeof(address)) != 0 || ::listen(socket->descriptor, SOMAXCONN) != 0) {
+			throwError("Unable to listen on " + path);
+		}
+		return socket;
+	}
+
+	/**
+	 *
+	 * @param path
+	 * @return a socket connected to the listening socket at path
+	 * @throws std::runtime_error
+	 */
+	static std::unique_ptr<LocalSocket> connect(std::string const & path) {
+		std::unique_ptr<LocalSocket> socket(new LocalSocket(newDescriptor()));
+		sockaddr_un const address = socketAddress(path);
+		if(::connect(socket->descriptor, reinterpret_cast<sockaddr const *>(&address), sizeof(address)) != 0) {
+			throwError("Unable to connect to " + path);
+		}
+		return socket;
+	}
+
+	/**
+	 *
+	 * @return the next pending connection on a listening socket
+	 * @throws std::runtime_error
+	 */
+	std::unique_ptr<LocalSocket> accept() {
+		int const connection = ::accept(descriptor, 0, 0);
+		if(connection < 0) {
+			throwError("Unable to accept a connection");
+		}
+		return std::unique_ptr<LocalSocket>(new LocalSocket(connection));
+	}
+
+	/**
+	 *
+	 * Send a message.  A newline is appended.
+	 *
+	 * @param line
+	 * @return false if the peer has closed the connection
+	 */
+	bool sendLine(std::string const & line) {
+		std::string const message = line + "\n";
+		size_t sent = 0;
+		while(sent < message.size()) {
+			ssize_t const count = ::send(descriptor, message.data() + sent, message.size() - sent, MSG_NOSIGNAL);
+			if(count < 0 && errno == EINTR) {
+				continue;
+			} else if(count <= 0) {
+				return false;
+			}
+			sent += count;
+		}
+		return true;
+	}
+
+	/**
+	 *
+	 * Read whatever is available on the socket into the buffer, blocking if nothing is available.
+	 *
+	 * @return false if the peer has closed the connection
+	 */
+	bool receive() {
+		char chunk[ChunkSizeBytes];
+		while(true) {
+			ssize_t const count = ::recv(descriptor, chunk, sizeof(chunk), 0);
+			if(count < 0 && errno == EINTR) {
+				continue;
+			} else if(count <= 0) {
+				return false;
+			}
+			buffer.append(chunk, count);
+			return true;
+		}
+	}
+
+	/**
+	 *
+	 * Take the next complete line from the buffer
+	 *
+	 * @param line set to the line, without its newline
+	 * @return false if no complete line has been received
+	 */
+	bool nextLine(std::string & line) {
+		size_t const end = buffer.find('\n');
+		if(end == std::string::npos) {
+			return false;
+		}
+		line = buffer.substr(0, end);
+		buffer.erase(0, end + 1);
+		return true;
+	}
+
+	/**
+	 *
+	 * Block until a complete line has been received
+	 *
+	 * @param line set to the line, without its newline
+	 * @return false if the peer closed the connection first
+	 */
+	bool readLine(std::string & line) {
+		while(!nextLine(line)) {
+			if(!receive()) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 *
+	 * Shut down both directions of the connection, waking any thread blocked in receive()
+	 */
+	void shutdown() {
+		::shutdown(descriptor, SHUT_RDWR);
+	}
+
+	/**
+	 *
+	 * @return the file descriptor, for use with poll()
+	 */
+	int getDescriptor() const {
+		return descriptor;
+	}
+private:
+	enum {
+		ChunkSizeBytes = 4096
+	};
+
+	int const descriptor;
+	std::string buffer;
+
+	LocalSocket(int descriptor)
+	: descriptor(descriptor)
+	{
+	}
+
+	/**
+	 *
+	 * Overriden copy constructor
+	 */
+	LocalSocket(LocalSocket const & other);
+
+	/**
+	 *
+	 * Overriden assignment operator
+	 */
+	LocalSocket & operator=(LocalSocket const & other);
+
+	static int newDescriptor() {
+		int const descriptor = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if(descriptor < 0) {
+			throwError("Unable to create a socket");
+		}
+		return descriptor;
+	}
+
+	static sockaddr_un socketAddress(std::string const & path) {
+		sockaddr_un address;
+		::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if(path.size() >= sizeof(address.sun_path)) {
+			std::stringstream error;
+			error << "Socket path " << path << " is longer than " << (sizeof(address.sun_path) - 1) << " characters";
+			throw std::invalid_argument(error.str().c_str());
+		}
+		::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+		return address;
+	}
+
+	static void throwError(std::string const & message) {
+		std::stringstream error;
+		error << message << ": " << ::strerror(errno);
+		throw std::runtime_error(error.str().c_str());
+	}
+};
+
+#endif
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_DISTRIBUTED_LOCALSOCKET_HPP_ */
@@ -0,0 +1,425 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * TaskLeaseCoordinator.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_DISTRIBUTED_TASKLEASECOORDINATOR_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_DISTRIBUTED_TASKLEASECOORDINATOR_HPP_
+
+#include "labynkyr/search/distributed/LocalSocket.hpp"
+#include "labynkyr/search/distributed/TaskLeaseMessage.hpp"
+#include "labynkyr/search/EffortAllocation.hpp"
+#include "labynkyr/search/SearchCheckpoint.hpp"
+#include "labynkyr/search/SearchTask.hpp"
+#include "labynkyr/BigInt.hpp"
+#include "labynkyr/Key.hpp"
+
+#ifdef __linux__
+	#include <poll.h>
+	#include <unistd.h>
+#endif
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+#ifdef __linux__
+
+/**
+ *
+ * Distributes the SearchTasks of an EffortAllocation over worker processes (see TaskLeaseWorker), in place of partitioning the budget by
+ * hand with SearchSpecBuilder::setOffset.  Workers connect to a Unix domain socket; it is expected that each host runs a coordinator or
+ * relays connections to one.
+ *
+ * Tasks are handed out as leases, most likely keys first.  A lease that is not reported done within the lease timeout, or whose worker
+ * disconnects, is returned to the front of the queue and leased again, so a slow or failed worker cannot lose part of the key space.  A task
+ * is complete once any lease for it is reported done; a late report for an expired lease is still counted, and still stops the search if
+ * it found the key.
+ *
+ * The coordinator aggregates the number of keys checked and whether the key was found.  Once the key is found, or every task is complete,
+ * it sends stop to every connected worker and run() returns.
+ *
+ * Workers must be planned against the same weight table; this is checked with the same hash used by SearchCheckpoint.
+ *
+ * Only available on Linux.
+ *
+ * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
+ * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
+ * @tparam WeightType the integer type used to store weights (e.g uint32_t)
+ */
+template<uint32_t VecCount, uint32_t VecLenBits, typename WeightType>
+class TaskLeaseCoordinator {
+public:
+	enum {
+		KeyLenBits = VecCount * VecLenBits
+	};
+
+	/**
+	 *
+	 * @param socketPath the path of the Unix domain socket workers connect to.  Any existing file at the path is replaced.
+	 * @param tasks the search plan.  The tasks are removed from the allocation.
+	 * @param leaseTimeout the time a worker has to report a leased task done before it is leased to another worker
+	 * @throws std::runtime_error if the socket cannot be created
+	 */
+	TaskLeaseCoordinator(std::string const & socketPath, EffortAllocation<VecCount, VecLenBits, WeightType> & tasks, std::chrono::nanoseconds leaseTimeout)
+	: socketPath(socketPath)
+	, weightTableHash(SearchCheckpoint<VecCount, VecLenBits, WeightType>::hashWeightTable(tasks.getWeightTable()))
+	, leaseTimeout(leaseTimeout)
+	, listener(LocalSocket::listen(socketPath))
+	, nextLeaseId(0)
+	, taskCount(0)
+	, tasksCompleted(0)
+	, leasesExpired(0)
+	, keysChecked(0)
+	, keyFound(false)
+	{
+		while(tasks.isTasksAvailable()) {
+			pendingTasks.push_back(tasks.removeNextTask());
+			taskCount++;
+		}
+	}
+
+	~TaskLeaseCoordinator() {
+		::unlink(socketPath.c_str());
+	}
+
+	/**
+	 *
+	 * Lease tasks to workers until the key is found or every task has been completed, then stop all connected workers
+	 */
+	void run() {
+		while(!keyFound && tasksCompleted < taskCount) {
+			std::vector<pollfd> descriptors(1 + workers.size());
+			descriptors[0].fd = listener->getDescriptor();
+			descriptors[0].events = POLLIN;
+			for(size_t index = 0 ; index < workers.size() ; index++) {
+				descriptors[index + 1].fd = workers[index]->getDescriptor();
+				descriptors[index + 1].events = POLLIN;
+			}
+			::poll(descriptors.data(), descriptors.size(), pollTimeoutMilliseconds());
+			// Serve the existing workers before accepting new ones, so the indices into workers are still valid
+			for(size_t index = workers.size() ; index > 0 ; index--) {
+				if(descriptors[index].revents != 0) {
+					serveWorker(index - 1);
+				}
+			}
+			if(descriptors[0].revents & POLLIN) {
+				workers.push_back(listener->accept());
+			}
+			expireLeases();
+		}
+		for(auto & worker : workers) {
+			worker->sendLine(TaskLeaseMessage<KeyLenBits>(StopMessage).format());
+		}
+		validatedWorkers.clear();
+		workers.clear();
+	}
+
+	/**
+	 *
+	 * @return true if a worker found the correct key
+	 */
+	bool isKeyFound() const {
+		return keyFound;
+	}
+
+	/**
+	 *
+	 * @return the value of the correct key, if found
+	 * @throws std::logic_error
+	 */
+	Key<KeyLenBits> correctKey() const {
+		if(!keyFound) {
+			throw std::logic_error("No worker found the correct key");
+		}
+		return Key<KeyLenBits>(correctKeyBytes);
+	}
+
+	/**
+	 *
+	 * @return the total number of keys checked by all workers, including the keys in leases that expired but were later reported
+	 */
+	uint64_t keysVerified() const {
+		return keysChecked;
+	}
+
+	/**
+	 *
+	 * @return the number of tasks in the search plan
+	 */
+	uint32_t getTaskCount() const {
+		return taskCount;
+	}
+
+	/**
+	 *
+	 * @return the number of tasks reported done
+	 */
+	uint32_t getTasksCompleted() const {
+		return tasksCompleted;
+	}
+
+	/**
+	 *
+	 * @return the number of leases that timed out or were held by a worker that disconnected, and whose tasks were returned to the queue
+	 */
+	uint32_t getLeasesExpired() const {
+		return leasesExpired;
+	}
+private:
+	typedef std::pair<BigInt<KeyLenBits>, SearchTask<VecCount, VecLenBits, WeightType>> TaskDefinition;
+
+	struct Lease {
+		TaskDefinition task;
+		LocalSocket * worker;
+		std::chrono::steady_clock::time_point deadline;
+	};
+
+	std::string const socketPath;
+	uint64_t const weightTableHash;
+	std::chrono::nanoseconds const leaseTimeout;
+	std::unique_ptr<LocalSocket> listener;
+	std::vector<std::unique_ptr<LocalSocket>> workers;
+	// The workers whose Hello carried the coordinator's weight table hash; only these may request leases or report tasks
+	std::set<LocalSocket const *> validatedWorkers;
+	std::deque<TaskDefinition> pendingTasks;
+	std::map<uint64_t, Lease> leases;
+	// The tasks of expired leases, so a late report can still complete them
+	std::map<uint64_t, SearchTask<VecCount, VecLenBits, WeightType>> expiredLeases;
+	// Weight bounds of the tasks reported done
+	std::set<std::pair<WeightType, WeightType>> completedTasks;
+	uint64_t nextLeaseId;
+	uint32_t taskCount;
+	uint32_t tasksCompleted;
+	uint32_t leasesExpired;
+	uint64_t keysChecked;
+	bool keyFound;
+	std::vector<uint8_t> correctKeyBytes;
+
+	/**
+	 *
+	 * Overriden copy constructor
+	 */
+	TaskLeaseCoordinator(TaskLeaseCoordinator const & other);
+
+	/**
+	 *
+	 * Overriden assignment operator
+	 */
+	TaskLeaseCoordinator & operator=(TaskLeaseCoordinator const & other);
+
+	/**
+	 *
+	 * Handle every complete message from a worker, and drop the worker if it disconnected or broke the protocol
+	 */
+	void serveWorker(size_t index) {
+		LocalSocket & worker = *workers[index];
+		bool connected = worker.receive();
+		std::string line;
+		while(connected && worker.nextLine(line)) {
+			try {
+				connected = handleMessage(worker, TaskLeaseMessage<KeyLenBits>::parse(line));
+			} catch(std::runtime_error const &) {
+				connected = false;
+			}
+		}
+		if(!connected) {
+			releaseLeases(&worker);
+			validatedWorkers.erase(&worker);
+			workers.erase(workers.begin() + index);
+		}
+	}
+
+	/**
+	 *
+	 * Requests and reports are only accepted from a worker that has sent a valid Hello, so that no task is planned or reported against a
+	 * different weight table
+	 *
+	 * @return false if the worker should be disconnected
+	 */
+	bool handleMessage(LocalSocket & worker, TaskLeaseMessage<KeyLenBits> const & message) {
+		if(message.type != HelloMessage && validatedWorkers.count(&worker) == 0) {
+			worker.sendLine(TaskLeaseMessage<KeyLenBits>(RejectMessage).format());
+			return false;
+		}
+		switch(message.type) {
+			case HelloMessage:
+				if(message.weightTableHash != weightTableHash) {
+					worker.sendLine(TaskLeaseMessage<KeyLenBits>(RejectMessage).format());
+					return false;
+				}
+				validatedWorkers.insert(&worker);
+				return true;
+			case RequestMessage:
+				return worker.sendLine(nextLease(worker).format());
+			case DoneMessage:
+				recordDone(message);
+				return true;
+			default:
+				return false;
+		}
+	}
+
+	TaskLeaseMessage<KeyLenBits> nextLease(LocalSocket & worker) {
+		if(keyFound) {
+			return TaskLeaseMessage<KeyLenBits>(StopMessage);
+		}
+		// Skip tasks completed by a late report after their lease had expired
+		while(!pendingTasks.empty() && isCompleted(pendingTasks.front().second)) {
+			pendingTasks.pop_front();
+		}
+		if(pendingTasks.empty()) {
+			return TaskLeaseMessage<KeyLenBits>(WaitMessage);
+		}
+		Lease const lease = {pendingTasks.front(), &worker, std::chrono::steady_clock::now() + leaseTimeout};
+		pendingTasks.pop_front();
+		uint64_t const leaseId = nextLeaseId++;
+		leases.insert(std::make_pair(leaseId, lease));
+		auto const & task = lease.task.second;
+		return TaskLeaseMessage<KeyLenBits>::lease(leaseId, task.getMinKeyWeight(), task.getMaxKeyWeight(), lease.task.first);
+	}
+
+	void recordDone(TaskLeaseMessage<KeyLenBits> const & message) {
+		keysChecked += message.keysChecked;
+		if(message.keyFound && !keyFound) {
+			keyFound = true;
+			correctKeyBytes = message.key;
+		}
+		auto const iter = leases.find(message.leaseId);
+		if(iter != leases.end()) {
+			markCompleted(iter->second.task.second);
+			leases.erase(iter);
+		} else {
+			// The lease expired, but its task may not have been completed by anyone else yet
+			auto const expired = expiredLeases.find(message.leaseId);
+			if(expired != expiredLeases.end()) {
+				markCompleted(expired->second);
+				expiredLeases.erase(expired);
+			}
+		}
+	}
+
+	bool isCompleted(SearchTask<VecCount, VecLenBits, WeightType> const & task) const {
+		return completedTasks.count(std::make_pair(task.getMinKeyWeight(), task.getMaxKeyWeight())) > 0;
+	}
+
+	void markCompleted(SearchTask<VecCount, VecLenBits, WeightType> const & task) {
+		if(completedTasks.insert(std::make_pair(task.getMinKeyWeight(), task.getMaxKeyWeight())).second) {
+			tasksCompleted++;
+		}
+	}
+
+	/**
+	 *
+	 * Return the task of every lease that has passed its deadline to the front of the queue
+	 */
+	void expireLeases() {
+		auto const now = std::chrono::steady_clock::now();
+		auto iter = leases.begin();
+		while(iter != leases.end()) {
+			if(iter->second.deadline <= now) {
+				requeue(iter->first, iter->second);
+				leases.erase(iter++);
+			} else {
+				++iter;
+			}
+		}
+	}
+
+	/**
+	 *
+	 * Return the tasks of every lease held by a disconnected worker to the front of the queue
+	 */
+	void releaseLeases(LocalSocket const * worker) {
+		auto iter = leases.begin();
+		while(iter != leases.end()) {
+			if(iter->second.worker == worker) {
+				requeue(iter->first, iter->second);
+				leases.erase(iter++);
+			} else {
+				++iter;
+			}
+		}
+	}
+
+	void requeue(uint64_t leaseId, Lease const & lease) {
+		pendingTasks.push_front(lease.task);
+		expiredLeases.insert(std::make_pair(leaseId, lease.task.second));
+		leasesExpired++;
+	}
+
+	/**
+	 *
+	 * @return the time until the earliest lease deadline, so expired leases are noticed promptly
+	 */
+	int pollTimeoutMilliseconds() const {
+		int64_t timeout = std::chrono::duration_cast<std::chrono::milliseconds>(leaseTimeout).count() + 1;
+		auto const now = std::chrono::steady_clock::now();
+		for(auto const & lease : leases) {
+			int64_t const remaining = std::chrono::duration_cast<std::chrono::milliseconds>(lease.second.deadline - now).count() + 1;
+			timeout = std::min(timeout, std::max<int64_t>(remaining, 0));
+		}
+		return static_cast<int>(std::min<int64_t>(timeout, 1000));
+	}
+};
+
+#endif
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_DISTRIBUTED_TASKLEASECOORDINATOR_HPP_ */
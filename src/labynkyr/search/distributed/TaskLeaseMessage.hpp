@@ -0,0 +1,243 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * TaskLeaseMessage.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_DISTRIBUTED_TASKLEASEMESSAGE_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_DISTRIBUTED_TASKLEASEMESSAGE_HPP_
+
+#include "labynkyr/BigInt.hpp"
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * The messages exchanged between a TaskLeaseCoordinator and its TaskLeaseWorkers
+ */
+enum TaskLeaseMessageType {
+	// worker -> coordinator: "hello <weight-table-hash>"
+	HelloMessage,
+	// worker -> coordinator: "request"
+	RequestMessage,
+	// worker -> coordinator: "done <lease-id> <keys-checked> <key-found> [<key-hex>]"
+	DoneMessage,
+	// coordinator -> worker: "lease <lease-id> <min-key-weight> <max-key-weight> <key-count>"
+	LeaseMessage,
+	// coordinator -> worker: "wait", no task is free but some are still leased to other workers
+	WaitMessage,
+	// coordinator -> worker: "stop", the search is over
+	StopMessage,
+	// coordinator -> worker: "reject", the worker's weight table does not match the coordinator's
+	RejectMessage
+};
+
+/**
+ *
+ * A single message of the task leasing protocol.  Each message is one line of text, so the protocol can be inspected by hand.  Only the
+ * fields relevant to the message type are used.
+ *
+ * @tparam KeyLenBits the length of the key in bits
+ */
+template<uint32_t KeyLenBits>
+struct TaskLeaseMessage {
+	TaskLeaseMessageType type;
+	uint64_t weightTableHash;
+	uint64_t leaseId;
+	uint64_t minKeyWeight;
+	uint64_t maxKeyWeight;
+	BigInt<KeyLenBits> keyCount;
+	uint64_t keysChecked;
+	bool keyFound;
+	// The correct key in little-endian byte form, if keyFound
+	std::vector<uint8_t> key;
+
+	TaskLeaseMessage(TaskLeaseMessageType type)
+	: type(type)
+	, weightTableHash(0)
+	, leaseId(0)
+	, minKeyWeight(0)
+	, maxKeyWeight(0)
+	, keyCount(0)
+	, keysChecked(0)
+	, keyFound(false)
+	{
+	}
+
+	static TaskLeaseMessage<KeyLenBits> hello(uint64_t weightTableHash) {
+		TaskLeaseMessage<KeyLenBits> message(HelloMessage);
+		message.weightTableHash = weightTableHash;
+		return message;
+	}
+
+	static TaskLeaseMessage<KeyLenBits> lease(uint64_t leaseId, uint64_t minKeyWeight, uint64_t maxKeyWeight, BigInt<KeyLenBits> const & keyCount) {
+		TaskLeaseMessage<KeyLenBits> message(LeaseMessage);
+		message.leaseId = leaseId;
+		message.minKeyWeight = minKeyWeight;
+		message.maxKeyWeight = maxKeyWeight;
+		message.keyCount = keyCount;
+		return message;
+	}
+
+	static TaskLeaseMessage<KeyLenBits> done(uint64_t leaseId, uint64_t keysChecked, bool keyFound, std::vector<uint8_t> const & key) {
+		TaskLeaseMessage<KeyLenBits> message(DoneMessage);
+		message.leaseId = leaseId;
+		message.keysChecked = keysChecked;
+		message.keyFound = keyFound;
+		message.key = key;
+		return message;
+	}
+
+	/**
+	 *
+	 * @return the message as a single line of text, without a newline
+	 */
+	std::string format() const {
+		std::stringstream output;
+		switch(type) {
+			case HelloMessage:
+				output << "hello " << weightTableHash;
+				break;
+			case RequestMessage:
+				output << "request";
+				break;
+			case DoneMessage:
+				output << "done " << leaseId << " " << keysChecked << " " << (keyFound ? 1 : 0);
+				if(keyFound) {
+					output << " ";
+					for(auto const keyByte : key) {
+						output << std::setfill('0') << std::setw(2) << std::hex << static_cast<uint32_t>(keyByte);
+					}
+				}
+				break;
+			case LeaseMessage:
+				output << "lease " << leaseId << " " << minKeyWeight << " " << maxKeyWeight << " " << keyCount;
+				break;
+			case WaitMessage:
+				output << "wait";
+				break;
+			case StopMessage:
+				output << "stop";
+				break;
+			case RejectMessage:
+				output << "reject";
+				break;
+		}
+		return output.str();
+	}
+
+	/**
+	 *
+	 * @param line a message produced by format()
+	 * @return the parsed message
+	 * @throws std::runtime_error if the line is not a valid message
+	 */
+	static TaskLeaseMessage<KeyLenBits> parse(std::string const & line) {
+		std::stringstream input(line);
+		std::string name;
+		input >> name;
+		if(name == "hello") {
+			TaskLeaseMessage<KeyLenBits> message(HelloMessage);
+			input >> message.weightTableHash;
+			return checked(input, message, line);
+		} else if(name == "request") {
+			return TaskLeaseMessage<KeyLenBits>(RequestMessage);
+		} else if(name == "done") {
+			TaskLeaseMessage<KeyLenBits> message(DoneMessage);
+			uint32_t keyFound = 0;
+			input >> message.leaseId >> message.keysChecked >> keyFound;
+			message.keyFound = (keyFound != 0);
+			if(message.keyFound) {
+				std::string hexKey;
+				input >> hexKey;
+				for(size_t index = 0 ; index + 1 < hexKey.size() ; index += 2) {
+					uint32_t keyByte = 0;
+					::sscanf(hexKey.c_str() + index, "%2x", &keyByte);
+					message.key.push_back(static_cast<uint8_t>(keyByte));
+				}
+			}
+			return checked(input, message, line);
+		} else if(name == "lease") {
+			TaskLeaseMessage<KeyLenBits> message(LeaseMessage);
+			input >> message.leaseId >> message.minKeyWeight >> message.maxKeyWeight >> message.keyCount;
+			return checked(input, message, line);
+		} else if(name == "wait") {
+			return TaskLeaseMessage<KeyLenBits>(WaitMessage);
+		} else if(name == "stop") {
+			return TaskLeaseMessage<KeyLenBits>(StopMessage);
+		} else if(name == "reject") {
+			return TaskLeaseMessage<KeyLenBits>(RejectMessage);
+		}
+		throwMalformed(line);
+		return TaskLeaseMessage<KeyLenBits>(StopMessage);
+	}
+private:
+	static TaskLeaseMessage<KeyLenBits> const & checked(std::stringstream const & input, TaskLeaseMessage<KeyLenBits> const & message, std::string const & line) {
+		if(input.fail()) {
+			throwMalformed(line);
+		}
+		return message;
+	}
+
+	static void throwMalformed(std::string const & line) {
+		std::stringstream error;
+		error << "Malformed task lease message: \"" << line << "\"";
+		throw std::runtime_error(error.str().c_str());
+	}
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_DISTRIBUTED_TASKLEASEMESSAGE_HPP_ */
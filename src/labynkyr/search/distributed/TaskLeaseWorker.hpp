@@ -0,0 +1,258 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * TaskLeaseWorker.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_DISTRIBUTED_TASKLEASEWORKER_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_DISTRIBUTED_TASKLEASEWORKER_HPP_
+
+#include "labynkyr/search/distributed/LocalSocket.hpp"
+#include "labynkyr/search/distributed/TaskLeaseMessage.hpp"
+#include "labynkyr/search/parallel/PEUPool.hpp"
+#include "labynkyr/search/parallel/WorkScheduler.hpp"
+#include "labynkyr/search/EffortAllocation.hpp"
+#include "labynkyr/search/SearchCheckpoint.hpp"
+#include "labynkyr/search/SearchTask.hpp"
+#include "labynkyr/WeightTable.hpp"
+
+#include <stdint.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+#ifdef __linux__
+
+/**
+ *
+ * A worker process in a distributed search.  Connects to a TaskLeaseCoordinator, and repeatedly leases a SearchTask, searches it on a local
+ * PEUPool, and reports the number of keys checked and whether the key was found.
+ *
+ * A background thread listens for the coordinator's replies, so that a stop broadcast (sent when another worker finds the key) cancels the
+ * task in progress rather than waiting for it to finish.  The cancelled task is not reported done.
+ *
+ * Only available on Linux.
+ *
+ * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
+ * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
+ * @tparam WeightType the integer type used to store weights (e.g uint32_t)
+ * @tparam SubkeyType the integer type used to store a subkey valyue (e.g uint8_t for a typical 8-bit DPA attack)
+ */
+template<uint32_t VecCount, uint32_t VecLenBits, typename WeightType, typename SubkeyType>
+class TaskLeaseWorker {
+public:
+	enum {
+		KeyLenBits = VecCount * VecLenBits
+	};
+
+	/**
+	 *
+	 * @param socketPath the path of the coordinator's Unix domain socket
+	 * @param weightTable the weight table the search was planned against.  Must match the coordinator's.
+	 * @param peuPool the PEUs each leased task is searched on
+	 * @param sleepNanoseconds passed to the WorkScheduler for each leased task
+	 * @param retryInterval the time to wait before asking again, when every remaining task is leased to another worker
+	 */
+	TaskLeaseWorker(std::string const & socketPath, WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, PEUPool<VecCount, VecLenBits, WeightType, SubkeyType> & peuPool,
+			uint64_t sleepNanoseconds, std::chrono::nanoseconds retryInterval)
+	: socketPath(socketPath)
+	, weightTable(weightTable)
+	, peuPool(peuPool)
+	, scheduler(sleepNanoseconds)
+	, retryInterval(retryInterval)
+	, tasksCompleted(0)
+	, stopped(false)
+	{
+	}
+
+	~TaskLeaseWorker() {}
+
+	/**
+	 *
+	 * Lease and search tasks until the coordinator sends stop or closes the connection.  May only be called once.
+	 *
+	 * @throws std::runtime_error if the coordinator cannot be reached
+	 * @throws std::invalid_argument if the coordinator rejects the weight table
+	 * @throws std::exception if any PEU encounters an exception
+	 */
+	void run() {
+		connection = LocalSocket::connect(socketPath);
+		connection->sendLine(TaskLeaseMessage<KeyLenBits>::hello(SearchCheckpoint<VecCount, VecLenBits, WeightType>::hashWeightTable(weightTable)).format());
+		std::thread listener(&TaskLeaseWorker::listen, this);
+		try {
+			leaseTasks();
+		} catch(...) {
+			connection->shutdown();
+			listener.join();
+			throw;
+		}
+		connection->shutdown();
+		listener.join();
+	}
+
+	/**
+	 *
+	 * @return the number of leased tasks this worker searched to completion and reported done
+	 */
+	uint32_t getTasksCompleted() const {
+		return tasksCompleted;
+	}
+private:
+	std::string const socketPath;
+	WeightTable<VecCount, VecLenBits, WeightType> const & weightTable;
+	PEUPool<VecCount, VecLenBits, WeightType, SubkeyType> & peuPool;
+	WorkScheduler<VecCount, VecLenBits, WeightType, SubkeyType> scheduler;
+	std::chrono::nanoseconds const retryInterval;
+	uint32_t tasksCompleted;
+	std::unique_ptr<LocalSocket> connection;
+	// Replies from the coordinator, other than stop, waiting to be handled
+	std::deque<TaskLeaseMessage<KeyLenBits>> replies;
+	// Set when the coordinator sends stop or closes the connection
+	bool stopped;
+	std::mutex mutex;
+	std::condition_variable replyReceived;
+
+	/**
+	 *
+	 * Overriden copy constructor
+	 */
+	TaskLeaseWorker(TaskLeaseWorker const & other);
+
+	/**
+	 *
+	 * Overriden assignment operator
+	 */
+	TaskLeaseWorker & operator=(TaskLeaseWorker const & other);
+
+	void leaseTasks() {
+		while(true) {
+			// If the coordinator has closed the connection, the listener will see it and raise the stopped flag
+			connection->sendLine(TaskLeaseMessage<KeyLenBits>(RequestMessage).format());
+			std::unique_lock<std::mutex> lock(mutex);
+			replyReceived.wait(lock, [this] { return stopped || !replies.empty(); });
+			// Replies received before the connection closed are handled first, so a rejection is always reported
+			if(replies.empty()) {
+				return;
+			}
+			TaskLeaseMessage<KeyLenBits> const reply = replies.front();
+			replies.pop_front();
+			if(reply.type == RejectMessage) {
+				throw std::invalid_argument("The coordinator's weight table does not match the worker's");
+			} else if(reply.type == WaitMessage) {
+				// Every remaining task is leased elsewhere; one may be returned if its lease expires
+				if(replyReceived.wait_for(lock, retryInterval, [this] { return stopped; })) {
+					return;
+				}
+			} else if(reply.type == LeaseMessage) {
+				lock.unlock();
+				if(!searchLease(reply)) {
+					return;
+				}
+			}
+		}
+	}
+
+	/**
+	 *
+	 * @return false if the search was stopped by the coordinator before the task was completed
+	 */
+	bool searchLease(TaskLeaseMessage<KeyLenBits> const & lease) {
+		SearchTask<VecCount, VecLenBits, WeightType> const task(static_cast<WeightType>(lease.minKeyWeight), static_cast<WeightType>(lease.maxKeyWeight), weightTable);
+		std::list<std::pair<BigInt<KeyLenBits>, SearchTask<VecCount, VecLenBits, WeightType>>> const taskList = {std::make_pair(lease.keyCount, task)};
+		EffortAllocation<VecCount, VecLenBits, WeightType> tasks(taskList);
+		uint64_t const keysBefore = peuPool.keysVerified();
+		scheduler.runSearch(peuPool, tasks);
+		if(scheduler.wasLastSearchInterrupted()) {
+			return false;
+		}
+		tasksCompleted++;
+		bool const keyFound = peuPool.isKeyFound();
+		std::vector<uint8_t> const key = keyFound ? peuPool.correctKey().asBytes() : std::vector<uint8_t>();
+		return connection->sendLine(TaskLeaseMessage<KeyLenBits>::done(lease.leaseId, peuPool.keysVerified() - keysBefore, keyFound, key).format());
+	}
+
+	/**
+	 *
+	 * Runs on the listener thread until the connection is closed
+	 */
+	void listen() {
+		std::string line;
+		try {
+			while(connection->readLine(line)) {
+				TaskLeaseMessage<KeyLenBits> const message = TaskLeaseMessage<KeyLenBits>::parse(line);
+				std::lock_guard<std::mutex> lock(mutex);
+				if(message.type == StopMessage) {
+					break;
+				}
+				replies.push_back(message);
+				replyReceived.notify_all();
+			}
+		} catch(std::runtime_error const &) {
+			// A malformed message is treated as the coordinator closing the connection
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		stopped = true;
+		scheduler.requestStop();
+		replyReceived.notify_all();
+	}
+};
+
+#endif
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_DISTRIBUTED_TASKLEASEWORKER_HPP_ */
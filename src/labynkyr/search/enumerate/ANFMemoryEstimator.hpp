@@ -0,0 +1,235 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * ANFMemoryEstimator.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_ANFMEMORYESTIMATOR_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_ANFMEMORYESTIMATOR_HPP_
+
+#include "labynkyr/search/enumerate/ActiveNodeFinder.hpp"
+#include "labynkyr/search/enumerate/CandidateKeyForest.hpp"
+#include "labynkyr/search/enumerate/CandidateKeyTree.hpp"
+#include "labynkyr/search/enumerate/FlatCandidateKeyForest.hpp"
+#include "labynkyr/search/enumerate/FlatCandidateKeyStore.hpp"
+#include "labynkyr/search/SearchTask.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Predicts the memory the ANF/Forest algorithm will need for a SearchTask, before any candidate keys are stored.
+ *
+ * The algorithm stores one tree (or flat node) for every merge of a non-empty forest, and a forest at weight w of distinguishing vector v
+ * is non-empty exactly when some completion of the partial key through the remaining vectors lands in [minKeyWeight, maxKeyWeight).  These
+ * 'live' weights are found with the same path count recurrence used for rank estimation, run backwards from the last vector over a bitset,
+ * so the number of trees at each vector is a popcount of the active weights against the shifted live weights.  The count is exact; the
+ * cost is one pass over a bitset of maxKeyWeight bits per distinct weight in each vector.
+ *
+ * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
+ * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
+ * @tparam WeightType the integer type used to store weights (e.g uint32_t)
+ * @tparam SubkeyType the integer type used to store a subkey valyue (e.g uint8_t for a typical 8-bit DPA attack)
+ */
+template<uint32_t VecCount, uint32_t VecLenBits, typename WeightType, typename SubkeyType>
+class ANFMemoryEstimator {
+public:
+	enum {
+		// Number of distinguishing scores in each distinguishing vector
+		VectorSize = 1UL << VecLenBits
+	};
+
+	/**
+	 *
+	 * @param task
+	 * @param activeNodeFinder the set of active nodes that will be used to search the task
+	 */
+	ANFMemoryEstimator(SearchTask<VecCount, VecLenBits, WeightType> const & task, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder)
+	: maxKeyWeight(task.getMaxKeyWeight())
+	, treeCounts(VecCount, 0)
+	, forestCounts(VecCount, 0)
+	{
+		countTrees(task, activeNodeFinder);
+	}
+
+	~ANFMemoryEstimator() {}
+
+	/**
+	 *
+	 * @param vectorIndex
+	 * @return the number of trees (or flat nodes) that will be stored for the distinguishing vector.  Always zero for the first vector, whose
+	 * merges are verified directly.
+	 */
+	uint64_t treeCount(uint32_t vectorIndex) const {
+		return treeCounts[vectorIndex];
+	}
+
+	/**
+	 *
+	 * @return the number of trees (or flat nodes) that will be stored for the task
+	 */
+	uint64_t treeCount() const {
+		uint64_t count = 0;
+		for(auto const trees : treeCounts) {
+			count += trees;
+		}
+		return count;
+	}
+
+	/**
+	 *
+	 * @return the number of non-empty forests that will be built for the task
+	 */
+	uint64_t forestCount() const {
+		uint64_t count = 0;
+		for(auto const forests : forestCounts) {
+			count += forests;
+		}
+		return count;
+	}
+
+	/**
+	 *
+	 * The memory used by PathCountSearch#searchWithANFFlatForest: the nodes of the FlatCandidateKeyStore and the two rows of the path count
+	 * graph.
+	 *
+	 * @return the estimated number of bytes
+	 */
+	uint64_t flatForestBytes() const {
+		return treeCount() * sizeof(typename FlatCandidateKeyStore<VecCount, VecLenBits, SubkeyType>::Node)
+			+ graphBytes<FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType>>();
+	}
+
+	/**
+	 *
+	 * The memory used by PathCountSearch#searchWithANFForest: the trees allocated from the Arena and the two rows of the path count graph.
+	 * Forests double their capacity as they grow, so each forest of n trees holds at most max(InitialTreeCapacity, 2n) trees.  This is an
+	 * upper bound unless a forest has to be copied to a new Arena block while it grows.
+	 *
+	 * @return the estimated number of bytes
+	 */
+	uint64_t linkedForestBytes() const {
+		typedef CandidateKeyForest<VecCount, VecLenBits, SubkeyType> Forest;
+		uint64_t const treeCapacity = 2 * treeCount() + Forest::InitialTreeCapacity * forestCount();
+		return treeCapacity * sizeof(CandidateKeyTree<VecCount, VecLenBits, SubkeyType>) + graphBytes<Forest>();
+	}
+private:
+	WeightType const maxKeyWeight;
+	std::vector<uint64_t> treeCounts;
+	std::vector<uint64_t> forestCounts;
+
+	template<typename ForestType>
+	uint64_t graphBytes() const {
+		return 2 * static_cast<uint64_t>(maxKeyWeight) * sizeof(ForestType);
+	}
+
+	void countTrees(SearchTask<VecCount, VecLenBits, WeightType> const & task, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder) {
+		auto const & weightTable = task.getWeightTable();
+		uint64_t const wordCount = (static_cast<uint64_t>(maxKeyWeight) + 63) / 64;
+		// Live weights after the last vector: those of a complete key within the task
+		std::vector<uint64_t> live(wordCount, 0);
+		for(uint64_t weight = task.getMinKeyWeight() ; weight < maxKeyWeight ; weight++) {
+			live[weight / 64] |= 1ULL << (weight % 64);
+		}
+		std::vector<uint64_t> active(wordCount);
+		std::vector<uint64_t> shifted(wordCount);
+		std::vector<uint64_t> nextLive(wordCount);
+		for(uint32_t vectorIndex = VecCount - 1 ; vectorIndex > 0 ; vectorIndex--) {
+			std::fill(active.begin(), active.end(), 0);
+			for(auto const weight : activeNodeFinder.nextWeightIndexes(vectorIndex)) {
+				if(weight >= maxKeyWeight) {
+					break;
+				}
+				active[weight / 64] |= 1ULL << (weight % 64);
+			}
+			std::map<WeightType, uint64_t> multiplicities;
+			for(uint64_t subkeyIndex = 0 ; subkeyIndex < VectorSize ; subkeyIndex++) {
+				multiplicities[weightTable.weight(vectorIndex, subkeyIndex)]++;
+			}
+			std::fill(nextLive.begin(), nextLive.end(), 0);
+			for(auto const & entry : multiplicities) {
+				shiftDown(live, entry.first, shifted);
+				uint64_t merges = 0;
+				for(uint64_t wordIndex = 0 ; wordIndex < wordCount ; wordIndex++) {
+					merges += __builtin_popcountll(active[wordIndex] & shifted[wordIndex]);
+					nextLive[wordIndex] |= shifted[wordIndex];
+				}
+				treeCounts[vectorIndex] += merges * entry.second;
+			}
+			for(uint64_t wordIndex = 0 ; wordIndex < wordCount ; wordIndex++) {
+				forestCounts[vectorIndex] += __builtin_popcountll(active[wordIndex] & nextLive[wordIndex]);
+			}
+			live.swap(nextLive);
+		}
+	}
+
+	/**
+	 *
+	 * Set bit w of output to bit w + shift of input
+	 */
+	static void shiftDown(std::vector<uint64_t> const & input, WeightType shift, std::vector<uint64_t> & output) {
+		uint64_t const wordShift = static_cast<uint64_t>(shift) / 64;
+		uint32_t const bitShift = static_cast<uint64_t>(shift) % 64;
+		for(uint64_t wordIndex = 0 ; wordIndex < output.size() ; wordIndex++) {
+			uint64_t const source = wordIndex + wordShift;
+			uint64_t word = (source < input.size()) ? input[source] >> bitShift : 0;
+			if(bitShift != 0 && source + 1 < input.size()) {
+				word |= input[source + 1] << (64 - bitShift);
+			}
+			output[wordIndex] = word;
+		}
+	}
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_ANFMEMORYESTIMATOR_HPP_ */
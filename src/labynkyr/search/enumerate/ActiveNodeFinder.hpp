@@ -52,9 +52,11 @@
 
 #include <stdint.h>
 
-#include <memory>
+#include <algorithm>
+#include <functional>
 #include <set>
 #include <stdexcept>
+#include <thread>
 #include <vector>
 
 namespace labynkyr {
@@ -63,8 +65,17 @@ namespace search {
 /**
  *
  * ActiveNodeFinder traverses the path count graph associated with a WeightTable, and identifies the weights that are required to be
- * visited by an enumeration algorithm.  The class stores these weights in a list of sets.  An enumeration algorithm can take these
- * sets and save computation by merging and updating only the nodes stored in each set.
+ * visited by an enumeration algorithm.  An enumeration algorithm can take these weights and save computation by merging and updating only
+ * the nodes they identify.
+ *
+ * The active weights of each distinguishing vector are found with a dense bitset over the weights below maxWeight: the bitset for the next
+ * vector is the union of the current bitset shifted by each distinct weight in the current vector, so each level costs one pass over the
+ * bitset per distinct weight rather than one set insertion per (weight, subkey) pair.  The passes over disjoint ranges of the bitset are
+ * independent, so large levels can be built by several threads.  Each level is then stored as a sorted array of weights for fast ordered
+ * iteration.
+ *
+ * maxWeight should be the largest maximum key weight of the tasks that will be searched, not the maximum weight in the table: no weight
+ * at or beyond it is needed, and the cost of building and storing the levels grows with it.
  *
  * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
  * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
@@ -75,7 +86,60 @@ class ActiveNodeFinder {
 public:
 	enum {
 		// Number of distinguishing scores in each distinguishing vector
-		VectorSize = 1UL << VecLenBits
+		VectorSize = 1UL << VecLenBits,
+		// Levels with fewer bitset words than this per thread are built on a single thread
+		MinimumWordsPerThread = 4096
+	};
+
+	/**
+	 *
+	 * The active weights of a single distinguishing vector, in ascending order
+	 */
+	class ActiveWeights {
+	public:
+		typedef typename std::vector<WeightType>::const_iterator const_iterator;
+
+		ActiveWeights() {}
+
+		ActiveWeights(std::vector<WeightType> && weights)
+		: weights(std::move(weights))
+		{
+		}
+
+		const_iterator begin() const {
+			return weights.begin();
+		}
+
+		const_iterator end() const {
+			return weights.end();
+		}
+
+		/**
+		 *
+		 * @return the number of active weights
+		 */
+		uint64_t size() const {
+			return weights.size();
+		}
+
+		/**
+		 *
+		 * @param weight
+		 * @return 1 if the weight is active, and 0 otherwise
+		 */
+		uint64_t count(uint64_t weight) const {
+			return std::binary_search(weights.begin(), weights.end(), weight) ? 1 : 0;
+		}
+
+		/**
+		 *
+		 * @return the number of bytes allocated to store the weights
+		 */
+		uint64_t bytesUsed() const {
+			return weights.capacity() * sizeof(WeightType);
+		}
+	private:
+		std::vector<WeightType> weights;
 	};
 
 	/**
@@ -84,33 +148,24 @@ public:
 	 * first distinguishing vector. Weight 0 is the only weight required in the first distinguishing for enumeration and rank to be possible
 	 *
 	 * @param integerScores
-	 * @param maxWeight
+	 * @param maxWeight only weights strictly below maxWeight are considered
 	 */
 	ActiveNodeFinder(WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, WeightType const maxWeight)
 	{
-		// Zero-th vector just has first column
-		std::set<uint64_t> * firstSet = new std::set<uint64_t>();
-		firstSet->insert(0);
-		validIndexes.push_back(std::unique_ptr<std::set<uint64_t>>(firstSet));
-		// Rest of the vectors
-		for(uint64_t vectorIndex = 1 ; vectorIndex < VecCount ; vectorIndex++) {
-			std::vector<bool> bitset(maxWeight);
-			std::set<uint64_t> * indexes = new std::set<uint64_t>();
-
-			uint64_t const previousVectorIndex = vectorIndex - 1;
-			std::set<uint64_t> const & previousVectorCols = *validIndexes[previousVectorIndex].get();
-
-			for(auto relativeColIndex : previousVectorCols) {
-				for(uint64_t rowIndex = VectorSize ; rowIndex > 0 ; rowIndex--) {
-					WeightType const weight = weightTable.weight(previousVectorIndex, rowIndex - 1);
-					if(relativeColIndex + weight < maxWeight && !bitset[relativeColIndex + weight]) {
-						indexes->insert(relativeColIndex + weight);
-						bitset[relativeColIndex + weight] = true;
-					}
-				}
-			}
-			validIndexes.push_back(std::unique_ptr<std::set<uint64_t>>(indexes));
-		}
+		findActiveWeights(weightTable, maxWeight, 1);
+	}
+
+	/**
+	 *
+	 * As above, but levels large enough to benefit are built by up to threadCount threads
+	 *
+	 * @param integerScores
+	 * @param maxWeight only weights strictly below maxWeight are considered
+	 * @param threadCount
+	 */
+	ActiveNodeFinder(WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, WeightType const maxWeight, uint32_t threadCount)
+	{
+		findActiveWeights(weightTable, maxWeight, std::max<uint32_t>(threadCount, 1));
 	}
 
 	~ActiveNodeFinder() {}
@@ -118,17 +173,106 @@ public:
 	/**
 	 *
 	 * @param vectorIndex
-	 * @return the set of weights that are 'active' for the specified distinguishing vector.
+	 * @return the weights that are 'active' for the specified distinguishing vector, in ascending order.
 	 * @throws std::length_error
 	 */
-	std::set<uint64_t> const & nextWeightIndexes(uint64_t vectorIndex) const {
+	ActiveWeights const & nextWeightIndexes(uint64_t vectorIndex) const {
 		if(vectorIndex >= validIndexes.size()) {
 			throw std::length_error("Invalid vector index");
 		}
-		return *validIndexes[vectorIndex].get();
+		return validIndexes[vectorIndex];
+	}
+
+	/**
+	 *
+	 * @return the number of bytes allocated to store the active weights of every distinguishing vector
+	 */
+	uint64_t bytesUsed() const {
+		uint64_t bytes = 0;
+		for(auto const & level : validIndexes) {
+			bytes += level.bytesUsed();
+		}
+		return bytes;
 	}
 private:
-	std::vector<std::unique_ptr<std::set<uint64_t>>> validIndexes;
+	std::vector<ActiveWeights> validIndexes;
+
+	void findActiveWeights(WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, WeightType const maxWeight, uint32_t threadCount) {
+		uint64_t const wordCount = (static_cast<uint64_t>(maxWeight) + 63) / 64;
+		// Zero-th vector just has first column
+		std::vector<uint64_t> previous(wordCount, 0);
+		if(maxWeight > 0) {
+			previous[0] = 1;
+		}
+		validIndexes.push_back(ActiveWeights(std::vector<WeightType>(1, 0)));
+		// Rest of the vectors
+		std::vector<uint64_t> next(wordCount);
+		for(uint64_t vectorIndex = 1 ; vectorIndex < VecCount ; vectorIndex++) {
+			std::set<WeightType> shiftSet;
+			for(uint64_t rowIndex = 0 ; rowIndex < VectorSize ; rowIndex++) {
+				shiftSet.insert(weightTable.weight(vectorIndex - 1, rowIndex));
+			}
+			std::vector<WeightType> const shifts(shiftSet.begin(), shiftSet.end());
+			uint32_t const threads = std::min<uint64_t>(threadCount, std::max<uint64_t>(wordCount / MinimumWordsPerThread, 1));
+			if(threads == 1) {
+				shiftUnion(previous, shifts, next, 0, wordCount);
+			} else {
+				std::vector<std::thread> workers;
+				uint64_t const wordsPerThread = (wordCount + threads - 1) / threads;
+				for(uint32_t thread = 0 ; thread < threads ; thread++) {
+					uint64_t const begin = std::min(wordCount, thread * wordsPerThread);
+					uint64_t const end = std::min(wordCount, begin + wordsPerThread);
+					workers.push_back(std::thread(&ActiveNodeFinder::shiftUnion, std::cref(previous), std::cref(shifts), std::ref(next), begin, end));
+				}
+				for(auto & worker : workers) {
+					worker.join();
+				}
+			}
+			// Clear the bits at or beyond maxWeight in the last word
+			if(maxWeight % 64 != 0) {
+				next[wordCount - 1] &= (1ULL << (maxWeight % 64)) - 1;
+			}
+			validIndexes.push_back(ActiveWeights(setBits(next)));
+			previous.swap(next);
+		}
+	}
+
+	/**
+	 *
+	 * Set words [begin, end) of output to the union of input shifted left by each of the shifts
+	 */
+	static void shiftUnion(std::vector<uint64_t> const & input, std::vector<WeightType> const & shifts, std::vector<uint64_t> & output, uint64_t begin, uint64_t end) {
+		std::fill(output.begin() + begin, output.begin() + end, 0);
+		for(auto const shift : shifts) {
+			uint64_t const wordShift = static_cast<uint64_t>(shift) / 64;
+			uint32_t const bitShift = static_cast<uint64_t>(shift) % 64;
+			for(uint64_t wordIndex = std::max(begin, wordShift) ; wordIndex < end ; wordIndex++) {
+				uint64_t const source = wordIndex - wordShift;
+				uint64_t word = input[source] << bitShift;
+				if(bitShift != 0 && source > 0) {
+					word |= input[source - 1] >> (64 - bitShift);
+				}
+				output[wordIndex] |= word;
+			}
+		}
+	}
+
+	static std::vector<WeightType> setBits(std::vector<uint64_t> const & bitset) {
+		uint64_t count = 0;
+		for(auto const word : bitset) {
+			count += __builtin_popcountll(word);
+		}
+		std::vector<WeightType> weights;
+		weights.reserve(count);
+		for(uint64_t wordIndex = 0 ; wordIndex < bitset.size() ; wordIndex++) {
+			uint64_t word = bitset[wordIndex];
+			while(word != 0) {
+				weights.push_back(static_cast<WeightType>(wordIndex * 64 + __builtin_ctzll(word)));
+				word &= word - 1;
+			}
+		}
+		return weights;
+	}
 };
 
 } /*namespace search */
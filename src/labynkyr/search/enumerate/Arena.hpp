@@ -0,0 +1,313 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * Arena.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_ARENA_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_ARENA_HPP_
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#include <new>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * A bump allocator used to hold the candidate key trees built by the ANF/Forest enumeration algorithm.
+ *
+ * Memory is requested from the system in large blocks, and individual allocations simply advance a pointer through the current
+ * block.  Nothing is freed individually; all memory is released in bulk when the arena is reset or destroyed.  One arena is intended
+ * to be used by one search task at a time, and the class is not thread-safe.
+ *
+ * On Linux the blocks can optionally be backed by huge pages.  If explicit huge pages are not available, the arena falls back to
+ * regular pages with a transparent huge page hint.
+ */
+class Arena {
+public:
+	enum {
+		DefaultBlockSizeBytes = 1UL << 21,
+		HugePageSizeBytes = 1UL << 21
+	};
+
+	/**
+	 *
+	 * Construct an arena using the default block size and regular pages
+	 */
+	Arena()
+	: blockSizeBytes(DefaultBlockSizeBytes)
+	, useHugePages(false)
+	, cursor(0)
+	, blockEnd(0)
+	, used(0)
+	, reserved(0)
+	{
+	}
+
+	/**
+	 *
+	 * @param blockSizeBytes the number of bytes to request from the system each time the arena runs out of space
+	 * @param useHugePages if true, attempt to back each block with huge pages (Linux only; ignored elsewhere)
+	 */
+	Arena(uint64_t blockSizeBytes, bool useHugePages)
+	: blockSizeBytes(blockSizeBytes)
+	, useHugePages(useHugePages)
+	, cursor(0)
+	, blockEnd(0)
+	, used(0)
+	, reserved(0)
+	{
+	}
+
+	~Arena() {
+		release();
+	}
+
+	/**
+	 *
+	 * @param bytes
+	 * @param alignment must be a power of two
+	 * @return a pointer to bytes of uninitialised memory, valid until the arena is reset or destroyed
+	 * @throws std::bad_alloc
+	 */
+	void * allocate(uint64_t bytes, uint64_t alignment) {
+		uint8_t * aligned = alignUp(cursor, alignment);
+		if(cursor == 0 || aligned + bytes > blockEnd) {
+			newBlock(bytes + alignment);
+			aligned = alignUp(cursor, alignment);
+		}
+		used += (aligned + bytes) - cursor;
+		cursor = aligned + bytes;
+		return aligned;
+	}
+
+	/**
+	 *
+	 * @param count
+	 * @return uninitialised storage for count objects of type T
+	 * @throws std::bad_alloc
+	 */
+	template<typename T>
+	T * allocateArray(uint64_t count) {
+		return static_cast<T *>(allocate(count * sizeof(T), alignof(T)));
+	}
+
+	/**
+	 *
+	 * Attempt to grow the most recent allocation in place.
+	 *
+	 * @param ptr a pointer previously returned by allocate
+	 * @param oldBytes the size of the allocation at ptr
+	 * @param newBytes the requested new size
+	 * @return true if the allocation at ptr now has newBytes available, false if it must be moved by the caller
+	 */
+	bool extend(void * ptr, uint64_t oldBytes, uint64_t newBytes) {
+		uint8_t * const end = static_cast<uint8_t *>(ptr) + oldBytes;
+		if(ptr == 0 || end != cursor || static_cast<uint8_t *>(ptr) + newBytes > blockEnd) {
+			return false;
+		}
+		used += newBytes - oldBytes;
+		cursor = static_cast<uint8_t *>(ptr) + newBytes;
+		return true;
+	}
+
+	/**
+	 *
+	 * Invalidate all allocations, keeping the first block for re-use
+	 */
+	void reset() {
+		while(blocks.size() > 1) {
+			freeBlock(blocks.back());
+			blocks.pop_back();
+		}
+		if(blocks.empty()) {
+			cursor = 0;
+			blockEnd = 0;
+		} else {
+			cursor = blocks.front().memory;
+			blockEnd = blocks.front().memory + blocks.front().size;
+		}
+		used = 0;
+		reserved = blocks.empty() ? 0 : blocks.front().size;
+	}
+
+	/**
+	 *
+	 * Invalidate all allocations and return all memory to the system
+	 */
+	void release() {
+		for(auto & block : blocks) {
+			freeBlock(block);
+		}
+		blocks.clear();
+		cursor = 0;
+		blockEnd = 0;
+		used = 0;
+		reserved = 0;
+	}
+
+	/**
+	 *
+	 * @return the number of bytes handed out by the arena (including alignment padding) since it was last reset
+	 */
+	uint64_t bytesUsed() const {
+		return used;
+	}
+
+	/**
+	 *
+	 * @return the number of bytes currently requested from the system
+	 */
+	uint64_t bytesReserved() const {
+		return reserved;
+	}
+
+	/**
+	 *
+	 * @return the number of blocks currently requested from the system
+	 */
+	uint64_t blockCount() const {
+		return blocks.size();
+	}
+
+	/**
+	 *
+	 * @return true if at least one block is backed by explicit huge pages
+	 */
+	bool isHugePageBacked() const {
+		for(auto & block : blocks) {
+			if(block.hugePages) {
+				return true;
+			}
+		}
+		return false;
+	}
+private:
+	struct Block {
+		uint8_t * memory;
+		uint64_t size;
+		bool mapped;
+		bool hugePages;
+	};
+
+	uint64_t const blockSizeBytes;
+	bool const useHugePages;
+	std::vector<Block> blocks;
+	uint8_t * cursor;
+	uint8_t * blockEnd;
+	uint64_t used;
+	uint64_t reserved;
+
+	/**
+	 * Overriden copy constructor
+	 */
+	Arena(Arena const &);
+
+	/**
+	 * Overriden assignment operator
+	 */
+	Arena & operator=(Arena const &);
+
+	static uint8_t * alignUp(uint8_t * ptr, uint64_t alignment) {
+		uintptr_t const value = reinterpret_cast<uintptr_t>(ptr);
+		return reinterpret_cast<uint8_t *>((value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+	}
+
+	void newBlock(uint64_t minimumBytes) {
+		uint64_t size = (minimumBytes > blockSizeBytes) ? minimumBytes : blockSizeBytes;
+		Block block = {0, 0, false, false};
+		#ifdef __linux__
+		if(useHugePages) {
+			size = ((size + HugePageSizeBytes - 1) / HugePageSizeBytes) * HugePageSizeBytes;
+			void * memory = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+			if(memory != MAP_FAILED) {
+				block.hugePages = true;
+			} else {
+				// No explicit huge pages reserved on this host; fall back to transparent huge pages
+				memory = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if(memory == MAP_FAILED) {
+					throw std::bad_alloc();
+				}
+				madvise(memory, size, MADV_HUGEPAGE);
+			}
+			block.memory = static_cast<uint8_t *>(memory);
+			block.mapped = true;
+		}
+		#endif
+		if(block.memory == 0) {
+			block.memory = static_cast<uint8_t *>(malloc(size));
+			if(block.memory == 0) {
+				throw std::bad_alloc();
+			}
+		}
+		block.size = size;
+		blocks.push_back(block);
+		cursor = block.memory;
+		blockEnd = block.memory + size;
+		reserved += size;
+	}
+
+	static void freeBlock(Block const & block) {
+		#ifdef __linux__
+		if(block.mapped) {
+			munmap(block.memory, block.size);
+			return;
+		}
+		#endif
+		free(block.memory);
+	}
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_ARENA_HPP_ */
@@ -48,12 +48,18 @@
 #ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_CANDIDATEKEYFOREST_HPP_
 #define LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_CANDIDATEKEYFOREST_HPP_
 
+#include "labynkyr/search/enumerate/Arena.hpp"
 #include "labynkyr/search/enumerate/CandidateKeyTree.hpp"
+#include "labynkyr/search/verify/KeyBatch.hpp"
 #include "labynkyr/search/verify/KeyVerifier.hpp"
 
 #include "labynkyr/Key.hpp"
 
-#include <forward_list>
+#include <stdint.h>
+
+#include <memory>
+#include <new>
+#include <vector>
 
 namespace labynkyr {
 namespace search {
@@ -63,6 +69,10 @@ namespace search {
  * The ActiveNodeFinder/Forest algorithm stores candidate keys in a tree.  This trades off memory at the cost of some computation when keys
  * are built to be verified.
  *
+ * A forest is a lightweight handle onto a contiguous array of trees allocated from an Arena.  All merges into a given forest are performed
+ * consecutively by the enumeration algorithm, so the array can almost always be grown in place.  Forests never free their trees: the memory
+ * is released in bulk when the Arena is reset or destroyed, which must not happen until verification has finished.
+ *
  * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
  * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
  * @tparam SubkeyType the integer type used to store a subkey valyue (e.g uint8_t for a typical 8-bit DPA attack)
@@ -71,13 +81,17 @@ template<uint32_t VecCount, uint32_t VecLenBits, typename SubkeyType>
 class CandidateKeyForest {
 public:
 	enum {
-		KeyLenBits = VecCount * VecLenBits
+		KeyLenBits = VecCount * VecLenBits,
+		KeyLenBytes = (KeyLenBits + 7) / 8,
+		InitialTreeCapacity = 4
 	};
 
 	CandidateKeyForest(uint64_t forestSize)
-	: forestSize(forestSize)
+	: trees(0)
+	, treeCount(0)
+	, treeCapacity(0)
+	, forestSize(forestSize)
 	{
-		forest = std::make_shared<std::vector<std::unique_ptr<CandidateKeyTree<VecCount, VecLenBits, SubkeyType>>>>();
 	}
 
 	~CandidateKeyForest() {}
@@ -88,18 +102,16 @@ public:
 	 *
 	 * @param verifier
 	 */
-	void verifyKeys(KeyVerifier<KeyLenBits> & verifier) {
+	void verifyKeys(KeyVerifier<KeyLenBits> & verifier) const {
+		KeyBatch<KeyLenBits> keyBatch(verifier);
 		std::vector<SubkeyType> keyValues(VecCount);
-		for(auto & tree : *forest.get()) {
-			if(tree->size() > 0 && !verifier.success()) {
-				uint32_t const keyBitLength = VecCount * VecLenBits;
-				uint32_t const byteCount = (keyBitLength % 8 != 0) ? (keyBitLength / 8) + 1 : keyBitLength / 8;
-				std::vector<uint8_t> keyBytes(byteCount);
-				std::vector<SubkeyType> keyValues(VecCount);
-
-				tree->buildAndVerifyKeys(keyValues, keyBytes, 0, verifier);
+		uint8_t currentKey[KeyLenBytes] = {};
+		for(auto const & tree : *this) {
+			if(tree.size() > 0 && !keyBatch.isStopped()) {
+				tree.buildAndVerifyKeys(keyValues, currentKey, keyBatch, 0);
 			}
 		}
+		keyBatch.flush();
 	}
 
 	/**
@@ -110,19 +122,39 @@ public:
 		return forestSize;
 	}
 
+	/**
+	 *
+	 * @return the number of trees in the forest
+	 */
+	uint32_t getTreeCount() const {
+		return treeCount;
+	}
+
+	CandidateKeyTree<VecCount, VecLenBits, SubkeyType> const * begin() const {
+		return trees;
+	}
+
+	CandidateKeyTree<VecCount, VecLenBits, SubkeyType> const * end() const {
+		return trees + treeCount;
+	}
+
 	/**
 	 *
 	 * Update this forest by merging in the candidates from a second forest, and given the next subkey value to use.
 	 *
 	 * @param other
 	 * @param nextValue
+	 * @param arena the arena holding this forest's trees.  The same arena must be used for every merge into this forest.
+	 * @throws std::bad_alloc
 	 */
-	void merge(CandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & other, SubkeyType nextValue) {
+	void merge(CandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & other, SubkeyType nextValue, Arena & arena) {
 		if(other.size() > 0) {
-			auto * newTree = new CandidateKeyTree<VecCount, VecLenBits, SubkeyType>(nextValue, other.getForest(), other.size());
-			std::unique_ptr<CandidateKeyTree<VecCount, VecLenBits, SubkeyType>> newTreePtr(newTree);
-			forest->push_back(std::move(newTreePtr));
-			forestSize += newTree->size();
+			if(treeCount == treeCapacity) {
+				grow(arena);
+			}
+			new (trees + treeCount) CandidateKeyTree<VecCount, VecLenBits, SubkeyType>(nextValue, other.begin(), other.getTreeCount(), other.size());
+			treeCount++;
+			forestSize += other.size();
 		}
 	}
 
@@ -136,40 +168,57 @@ public:
 	 * @param nextValue
 	 */
 	void verifyMergeCandidates(KeyVerifier<KeyLenBits> & verifier, CandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & other, SubkeyType nextValue) const {
-		if(other.size() > 0) {
-			CandidateKeyTree<VecCount, VecLenBits, SubkeyType> mergeTree(nextValue, other.getForest(), other.size());
+		KeyBatch<KeyLenBits> keyBatch(verifier);
+		verifyMergeCandidates(keyBatch, other, nextValue);
+		keyBatch.flush();
+	}
 
-			uint32_t const byteCount = (KeyLenBits % 8 != 0) ? (KeyLenBits / 8) + 1 : KeyLenBits / 8;
-			std::vector<uint8_t> keyBytes(byteCount);
+	/**
+	 *
+	 * As above, but adds the candidate keys to an existing batch so that a single batch can be shared across many calls.  The caller
+	 * is responsible for flushing the batch.
+	 *
+	 * @param keyBatch
+	 * @param other
+	 * @param nextValue
+	 */
+	void verifyMergeCandidates(KeyBatch<KeyLenBits> & keyBatch, CandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & other, SubkeyType nextValue) const {
+		if(other.size() > 0) {
+			CandidateKeyTree<VecCount, VecLenBits, SubkeyType> const mergeTree(nextValue, other.begin(), other.getTreeCount(), other.size());
 			std::vector<SubkeyType> keyValues(VecCount);
-			if(mergeTree.size() > 0) {
-				mergeTree.buildAndVerifyKeys(keyValues, keyBytes, 0, verifier);
-			}
+			uint8_t currentKey[KeyLenBytes] = {};
+			mergeTree.buildAndVerifyKeys(keyValues, currentKey, keyBatch, 0);
 		}
 	}
 
-	std::shared_ptr<std::vector<std::unique_ptr<CandidateKeyTree<VecCount, VecLenBits, SubkeyType>>>> getForest() const {
-		return forest;
-	}
-
-	static std::unique_ptr<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>> emptySet() {
-		auto * forest = new CandidateKeyForest<VecCount, VecLenBits, SubkeyType>(0);
-		return std::unique_ptr<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>>(forest);
+	static CandidateKeyForest<VecCount, VecLenBits, SubkeyType> emptySet() {
+		return CandidateKeyForest<VecCount, VecLenBits, SubkeyType>(0);
 	}
 
-	static std::unique_ptr<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>> rejectStateSet() {
+	static CandidateKeyForest<VecCount, VecLenBits, SubkeyType> rejectStateSet() {
 		return acceptStateSet();
 	}
 
-	static std::unique_ptr<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>> acceptStateSet() {
-		auto * forest = new CandidateKeyForest<VecCount, VecLenBits, SubkeyType>(1);
-		return std::unique_ptr<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>>(forest);
+	static CandidateKeyForest<VecCount, VecLenBits, SubkeyType> acceptStateSet() {
+		return CandidateKeyForest<VecCount, VecLenBits, SubkeyType>(1);
 	}
 private:
-	std::shared_ptr<std::vector<std::unique_ptr<CandidateKeyTree<VecCount, VecLenBits, SubkeyType>>>> forest;
+	CandidateKeyTree<VecCount, VecLenBits, SubkeyType> * trees;
+	uint32_t treeCount;
+	uint32_t treeCapacity;
 	uint64_t forestSize;
-};
 
+	void grow(Arena & arena) {
+		typedef CandidateKeyTree<VecCount, VecLenBits, SubkeyType> Tree;
+		uint32_t const newCapacity = (treeCapacity == 0) ? InitialTreeCapacity : treeCapacity * 2;
+		if(!arena.extend(trees, treeCapacity * sizeof(Tree), newCapacity * sizeof(Tree))) {
+			Tree * const newTrees = arena.allocateArray<Tree>(newCapacity);
+			std::uninitialized_copy(trees, trees + treeCount, newTrees);
+			trees = newTrees;
+		}
+		treeCapacity = newCapacity;
+	}
+};
 
 } /*namespace search */
 } /*namespace labynkyr */
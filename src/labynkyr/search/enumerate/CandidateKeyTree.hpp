@@ -49,10 +49,12 @@
 #define LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_CANDIDATEKEYTREE_HPP_
 
 #include "labynkyr/search/verify/FullKeyBuilder.hpp"
-#include "labynkyr/search/verify/KeyVerifier.hpp"
+#include "labynkyr/search/verify/KeyBatch.hpp"
 
-#include <forward_list>
-#include <memory>
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
 
 namespace labynkyr {
 namespace search {
@@ -62,6 +64,8 @@ namespace search {
  * The ActiveNodeFinder/Forest algorithm stores candidate keys in a tree.  This trades off memory at the cost of some computation when keys are
  * constructed from their subkey parts in the verification phase.
  *
+ * Trees are stored by value in contiguous arrays owned by an Arena (see CandidateKeyForest), and the children of a tree are the trees held
+ * by the forest it was merged from.  A tree does not own its children.
  *
  * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
  * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
@@ -71,13 +75,22 @@ template<uint32_t VecCount, uint32_t VecLenBits, typename SubkeyType>
 class CandidateKeyTree {
 public:
 	enum {
-		KeyLenBits = VecLenBits * VecCount
+		KeyLenBits = VecLenBits * VecCount,
+		KeyLenBytes = (KeyLenBits + 7) / 8
 	};
 
-	CandidateKeyTree(SubkeyType value, std::shared_ptr<std::vector<std::unique_ptr<CandidateKeyTree<VecCount, VecLenBits, SubkeyType>>>> children, uint64_t forestSize)
-	: value(value)
-	, children(children)
+	/**
+	 *
+	 * @param value the subkey value represented by this tree
+	 * @param children pointer to the first of childCount contiguous child trees
+	 * @param childCount
+	 * @param forestSize the number of candidate keys stored in the children
+	 */
+	CandidateKeyTree(SubkeyType value, CandidateKeyTree<VecCount, VecLenBits, SubkeyType> const * children, uint32_t childCount, uint64_t forestSize)
+	: children(children)
 	, treeSize(forestSize)
+	, childCount(childCount)
+	, value(value)
 	{
 	}
 
@@ -89,26 +102,55 @@ public:
 		return value;
 	}
 
-	std::shared_ptr<std::vector<std::unique_ptr<CandidateKeyTree<VecCount, VecLenBits, SubkeyType>>>> getChildren() const {
+	/**
+	 *
+	 * @return pointer to the first child tree
+	 */
+	CandidateKeyTree<VecCount, VecLenBits, SubkeyType> const * getChildren() const {
 		return children;
 	}
 
 	/**
 	 *
-	 * Iterates through the tree, constructs all candidate keys, and verifiers using the supplied verifier.
+	 * @return the number of child trees
+	 */
+	uint32_t getChildCount() const {
+		return childCount;
+	}
+
+	/**
+	 *
+	 * Iterates through the tree, constructs all candidate keys, and adds them to the batch for verification.
+	 *
+	 * @param keyValues a vector of length VecCount, to store the candidate keys in subkey form
+	 * @param keyBatch the batch the candidate keys are written into, in byte format
+	 * @param index
+	 */
+	void buildAndVerifyKeys(std::vector<SubkeyType> & keyValues, KeyBatch<KeyLenBits> & keyBatch, uint32_t index) const {
+		uint8_t currentKey[KeyLenBytes];
+		FullKeyBuilder<VecCount, VecLenBits, SubkeyType>::fullKey(keyValues, currentKey);
+		buildAndVerifyKeys(keyValues, currentKey, keyBatch, index);
+	}
+
+	/**
+	 *
+	 * As above, but the key is also carried in byte form.  Only the subkey belonging to each tree is rewritten on the way down, rather than
+	 * rebuilding every candidate key from all of its subkeys.
 	 *
 	 * @param keyValues a vector of length VecCount, to store the candidate keys in subkey form
-	 * @param fullKeyBytes a vector of length KeyLenBits / 8, to store the candidate keys in byte format
-	 * @param verifier
+	 * @param currentKey a buffer of KeyLenBytes bytes holding the key in byte form.  Subkeys before index must already be set.
+	 * @param keyBatch the batch the candidate keys are written into, in byte format
+	 * @param index
 	 */
-	void buildAndVerifyKeys(std::vector<SubkeyType> & keyValues, std::vector<uint8_t> & fullKeyBytes, uint32_t index, KeyVerifier<KeyLenBits> & verifier) {
+	void buildAndVerifyKeys(std::vector<SubkeyType> & keyValues, uint8_t * currentKey, KeyBatch<KeyLenBits> & keyBatch, uint32_t index) const {
 		keyValues[index] = value;
+		FullKeyBuilder<VecCount, VecLenBits, SubkeyType>::setSubkey(index, value, currentKey);
 		if(index == keyValues.size() - 1) {
-			FullKeyBuilder<VecCount, VecLenBits, SubkeyType>::fullKey(keyValues, fullKeyBytes);
-			verifier.checkKey(fullKeyBytes);
-		} else if(size() > 0 && !verifier.success()) {
-			for(auto & child : *children.get()) {
-				child->buildAndVerifyKeys(keyValues, fullKeyBytes, index + 1, verifier);
+			std::copy(currentKey, currentKey + KeyLenBytes, keyBatch.nextKey());
+			keyBatch.commit();
+		} else if(size() > 0 && !keyBatch.isStopped()) {
+			for(uint32_t childIndex = 0 ; childIndex < childCount ; childIndex++) {
+				children[childIndex].buildAndVerifyKeys(keyValues, currentKey, keyBatch, index + 1);
 			}
 		}
 	}
@@ -121,9 +163,10 @@ public:
 		return treeSize;
 	}
 private:
-	SubkeyType const value;
-	std::shared_ptr<std::vector<std::unique_ptr<CandidateKeyTree<VecCount, VecLenBits, SubkeyType>>>> children;
+	CandidateKeyTree<VecCount, VecLenBits, SubkeyType> const * children;
 	uint64_t treeSize;
+	uint32_t childCount;
+	SubkeyType value;
 };
 
 } /*namespace search */
@@ -0,0 +1,215 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * FlatCandidateKeyForest.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_FLATCANDIDATEKEYFOREST_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_FLATCANDIDATEKEYFOREST_HPP_
+
+#include "labynkyr/search/enumerate/FlatCandidateKeyStore.hpp"
+#include "labynkyr/search/verify/FullKeyBuilder.hpp"
+#include "labynkyr/search/verify/KeyBatch.hpp"
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * A flat, index-based alternative to CandidateKeyForest.  The forest is a range of consecutive nodes within the FlatCandidateKeyStore
+ * array for a single distinguishing vector.  All merges into a given forest must be performed consecutively, which is the case for the
+ * ANF/Forest enumeration algorithm.
+ *
+ * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
+ * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
+ * @tparam SubkeyType the integer type used to store a subkey valyue (e.g uint8_t for a typical 8-bit DPA attack)
+ */
+template<uint32_t VecCount, uint32_t VecLenBits, typename SubkeyType>
+class FlatCandidateKeyForest {
+public:
+	enum {
+		KeyLenBits = VecCount * VecLenBits
+	};
+
+	FlatCandidateKeyForest(uint64_t forestSize)
+	: firstNode(0)
+	, nodeCount(0)
+	, forestSize(forestSize)
+	{
+	}
+
+	~FlatCandidateKeyForest() {}
+
+	/**
+	 *
+	 * Call to verify all candidate keys stored within the forest.  The forest must belong to the first distinguishing vector.
+	 *
+	 * @param verifier
+	 * @param store
+	 */
+	void verifyKeys(KeyVerifier<KeyLenBits> & verifier, FlatCandidateKeyStore<VecCount, VecLenBits, SubkeyType> const & store) const {
+		if(nodeCount > 0 && !verifier.success()) {
+			KeyBatch<KeyLenBits> keyBatch(verifier);
+			std::vector<SubkeyType> keyValues(VecCount);
+			store.buildAndVerifyKeys(0, firstNode, nodeCount, keyValues, keyBatch);
+			keyBatch.flush();
+		}
+	}
+
+	/**
+	 *
+	 * @return the total number of candidate keys stored in the forest
+	 */
+	uint64_t size() const {
+		return forestSize;
+	}
+
+	/**
+	 *
+	 * @return the offset of the first node of the forest
+	 */
+	uint32_t getFirstNode() const {
+		return firstNode;
+	}
+
+	/**
+	 *
+	 * @return the number of nodes (trees) in the forest
+	 */
+	uint32_t getNodeCount() const {
+		return nodeCount;
+	}
+
+	/**
+	 *
+	 * Update this forest by merging in the candidates from a second forest, and given the next subkey value to use.
+	 *
+	 * @param other a forest belonging to distinguishing vector vectorIndex + 1
+	 * @param nextValue
+	 * @param vectorIndex the distinguishing vector this forest belongs to
+	 * @param store
+	 * @throws std::logic_error if another forest for the same distinguishing vector has been merged into since this one
+	 */
+	void merge(FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & other, SubkeyType nextValue, uint32_t vectorIndex,
+			FlatCandidateKeyStore<VecCount, VecLenBits, SubkeyType> & store) {
+		if(other.size() > 0) {
+			uint32_t const index = store.addNode(vectorIndex, nextValue, other.getFirstNode(), other.getNodeCount(), other.size());
+			if(nodeCount == 0) {
+				firstNode = index;
+			} else if(index != firstNode + nodeCount) {
+				throw std::logic_error("Merges into a flat candidate key forest must be consecutive");
+			}
+			nodeCount++;
+			forestSize += other.size();
+		}
+	}
+
+	/**
+	 *
+	 * Verify the candidate keys that would be generated by merging this forest with a second forest, and given the next subkey value to use.
+	 * This forest will not be modified, as the final set of merges required by the enumeration algorithm do not need to be re-used.
+	 *
+	 * @param verifier
+	 * @param other a forest belonging to the second distinguishing vector
+	 * @param nextValue
+	 * @param store
+	 */
+	void verifyMergeCandidates(KeyVerifier<KeyLenBits> & verifier, FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & other,
+			SubkeyType nextValue, FlatCandidateKeyStore<VecCount, VecLenBits, SubkeyType> const & store) const {
+		KeyBatch<KeyLenBits> keyBatch(verifier);
+		verifyMergeCandidates(keyBatch, other, nextValue, store);
+		keyBatch.flush();
+	}
+
+	/**
+	 *
+	 * As above, but adds the candidate keys to an existing batch so that a single batch can be shared across many calls.  The caller
+	 * is responsible for flushing the batch.
+	 *
+	 * @param keyBatch
+	 * @param other a forest belonging to the second distinguishing vector
+	 * @param nextValue
+	 * @param store
+	 */
+	void verifyMergeCandidates(KeyBatch<KeyLenBits> & keyBatch, FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & other,
+			SubkeyType nextValue, FlatCandidateKeyStore<VecCount, VecLenBits, SubkeyType> const & store) const {
+		if(other.size() > 0) {
+			std::vector<SubkeyType> keyValues(VecCount);
+			keyValues[0] = nextValue;
+			if(VecCount == 1) {
+				FullKeyBuilder<VecCount, VecLenBits, SubkeyType>::fullKey(keyValues, keyBatch.nextKey());
+				keyBatch.commit();
+			} else if(!keyBatch.isStopped()) {
+				store.buildAndVerifyKeys(1, other.getFirstNode(), other.getNodeCount(), keyValues, keyBatch);
+			}
+		}
+	}
+
+	static FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType> emptySet() {
+		return FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType>(0);
+	}
+
+	static FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType> rejectStateSet() {
+		return acceptStateSet();
+	}
+
+	static FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType> acceptStateSet() {
+		return FlatCandidateKeyForest<VecCount, VecLenBits, SubkeyType>(1);
+	}
+private:
+	uint32_t firstNode;
+	uint32_t nodeCount;
+	uint64_t forestSize;
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_FLATCANDIDATEKEYFOREST_HPP_ */
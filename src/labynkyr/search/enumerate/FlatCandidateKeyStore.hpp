@@ -0,0 +1,231 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * FlatCandidateKeyStore.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_FLATCANDIDATEKEYSTORE_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_FLATCANDIDATEKEYSTORE_HPP_
+
+#include "labynkyr/search/verify/FullKeyBuilder.hpp"
+#include "labynkyr/search/verify/KeyBatch.hpp"
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Storage for the flat, index-based alternative to CandidateKeyTree.  The candidate key trees built by the ANF/Forest algorithm are stored
+ * as one contiguous array of nodes per distinguishing vector.  Each node holds a subkey value, the offset of its first child within the
+ * array for the next distinguishing vector, the number of children and the number of candidate keys below it.
+ *
+ * Keys are built by an iterative depth-first walk over the arrays rather than by recursion through pointers.  The key is held in byte form
+ * during the walk, and only the subkey at the current depth is rewritten as the walk moves between nodes.
+ *
+ * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
+ * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
+ * @tparam SubkeyType the integer type used to store a subkey valyue (e.g uint8_t for a typical 8-bit DPA attack)
+ */
+template<uint32_t VecCount, uint32_t VecLenBits, typename SubkeyType>
+class FlatCandidateKeyStore {
+public:
+	enum {
+		KeyLenBits = VecCount * VecLenBits,
+		KeyLenBytes = (KeyLenBits + 7) / 8
+	};
+
+	struct Node {
+		uint64_t subtreeSize;
+		uint32_t firstChild;
+		uint32_t childCount;
+		SubkeyType value;
+	};
+
+	FlatCandidateKeyStore()
+	: nodes(VecCount)
+	{
+	}
+
+	~FlatCandidateKeyStore() {}
+
+	/**
+	 *
+	 * Append a node to the array for the given distinguishing vector.
+	 *
+	 * @param vectorIndex
+	 * @param value the subkey value represented by the node
+	 * @param firstChild the offset of the first child in the array for distinguishing vector vectorIndex + 1
+	 * @param childCount
+	 * @param subtreeSize the number of candidate keys below the node
+	 * @return the offset of the new node
+	 * @throws std::length_error
+	 */
+	uint32_t addNode(uint32_t vectorIndex, SubkeyType value, uint32_t firstChild, uint32_t childCount, uint64_t subtreeSize) {
+		std::vector<Node> & vectorNodes = nodes[vectorIndex];
+		if(vectorNodes.size() == std::numeric_limits<uint32_t>::max()) {
+			std::stringstream error;
+			error << "Flat candidate key store is limited to " << std::numeric_limits<uint32_t>::max() << " nodes per distinguishing vector";
+			throw std::length_error(error.str().c_str());
+		}
+		Node const node = {subtreeSize, firstChild, childCount, value};
+		vectorNodes.push_back(node);
+		return static_cast<uint32_t>(vectorNodes.size() - 1);
+	}
+
+	/**
+	 *
+	 * @param vectorIndex
+	 * @param nodeIndex
+	 * @return the node at offset nodeIndex in the array for distinguishing vector vectorIndex
+	 */
+	Node const & node(uint32_t vectorIndex, uint32_t nodeIndex) const {
+		return nodes[vectorIndex][nodeIndex];
+	}
+
+	/**
+	 *
+	 * @param vectorIndex
+	 * @return the number of nodes stored for distinguishing vector vectorIndex
+	 */
+	uint64_t nodeCount(uint32_t vectorIndex) const {
+		return nodes[vectorIndex].size();
+	}
+
+	/**
+	 *
+	 * Walks the nodes [firstNode, firstNode + count) for distinguishing vector vectorIndex and all of their descendants, constructs all
+	 * candidate keys and adds them to the batch for verification.
+	 *
+	 * @param vectorIndex
+	 * @param firstNode
+	 * @param count
+	 * @param keyValues a vector of length VecCount, to store the candidate keys in subkey form.  Entries before vectorIndex must already be set.
+	 * @param keyBatch the batch the candidate keys are written into, in byte format
+	 */
+	void buildAndVerifyKeys(uint32_t vectorIndex, uint32_t firstNode, uint32_t count, std::vector<SubkeyType> & keyValues,
+			KeyBatch<KeyLenBits> & keyBatch) const {
+		typedef FullKeyBuilder<VecCount, VecLenBits, SubkeyType> KeyBuilder;
+		uint8_t currentKey[KeyLenBytes];
+		KeyBuilder::fullKey(keyValues, currentKey);
+		uint32_t cursor[VecCount];
+		uint32_t end[VecCount];
+		uint32_t depth = vectorIndex;
+		cursor[depth] = firstNode;
+		end[depth] = firstNode + count;
+		while(true) {
+			if(cursor[depth] == end[depth]) {
+				if(depth == vectorIndex) {
+					break;
+				}
+				depth--;
+				cursor[depth]++;
+				continue;
+			}
+			Node const & current = nodes[depth][cursor[depth]];
+			keyValues[depth] = current.value;
+			KeyBuilder::setSubkey(depth, current.value, currentKey);
+			if(depth == VecCount - 1) {
+				std::copy(currentKey, currentKey + KeyLenBytes, keyBatch.nextKey());
+				keyBatch.commit();
+				cursor[depth]++;
+			} else if(keyBatch.isStopped()) {
+				cursor[depth]++;
+			} else {
+				depth++;
+				cursor[depth] = current.firstChild;
+				end[depth] = current.firstChild + current.childCount;
+			}
+		}
+	}
+
+	/**
+	 *
+	 * Remove all nodes, keeping the allocated capacity for re-use
+	 */
+	void reset() {
+		for(auto & vectorNodes : nodes) {
+			vectorNodes.clear();
+		}
+	}
+
+	/**
+	 *
+	 * @return the number of bytes occupied by the stored nodes
+	 */
+	uint64_t bytesUsed() const {
+		uint64_t bytes = 0;
+		for(auto const & vectorNodes : nodes) {
+			bytes += vectorNodes.size() * sizeof(Node);
+		}
+		return bytes;
+	}
+
+	/**
+	 *
+	 * @return the number of bytes allocated to store nodes
+	 */
+	uint64_t bytesReserved() const {
+		uint64_t bytes = 0;
+		for(auto const & vectorNodes : nodes) {
+			bytes += vectorNodes.capacity() * sizeof(Node);
+		}
+		return bytes;
+	}
+private:
+	std::vector<std::vector<Node>> nodes;
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_FLATCANDIDATEKEYSTORE_HPP_ */
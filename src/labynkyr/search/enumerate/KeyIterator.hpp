@@ -0,0 +1,260 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * KeyIterator.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_KEYITERATOR_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_KEYITERATOR_HPP_
+
+#include "labynkyr/search/enumerate/SortedWeightTable.hpp"
+#include "labynkyr/search/verify/FullKeyBuilder.hpp"
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+#include "labynkyr/search/SearchTask.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * A pull-based alternative to driving a KeyVerifier: the caller asks for the next block of candidate keys of a SearchTask, and may stop,
+ * interleave several iterators, or hand the keys to an external tool between calls.  No threads or callbacks are involved, and keys are
+ * written in bulk without a virtual call per key.
+ *
+ * The keys are produced by the Sorted algorithm (see SortedEnumeration) with its loop nest replaced by an explicit stack of positions,
+ * one per distinguishing vector, so the enumeration can be suspended after any key.  The state is O(VecCount) and the keys come out in
+ * the same order as SortedEnumeration.
+ *
+ * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
+ * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
+ * @tparam WeightType the integer type used to store weights (e.g uint32_t)
+ * @tparam SubkeyType the integer type used to store a subkey valyue (e.g uint8_t for a typical 8-bit DPA attack)
+ */
+template<uint32_t VecCount, uint32_t VecLenBits, typename WeightType, typename SubkeyType>
+class KeyIterator {
+public:
+	enum {
+		KeyLenBits = VecCount * VecLenBits,
+		KeyLenBytes = KeyVerifier<KeyLenBits>::KeyLenBytes,
+		// Number of distinguishing scores in each distinguishing vector
+		VectorSize = 1UL << VecLenBits
+	};
+
+	/**
+	 *
+	 * @param task keys with weights in [task.getMinKeyWeight(), task.getMaxKeyWeight()) and a first subkey within the task's range are enumerated
+	 * @param sortedWeightTable a pre-sorted snapshot of the task's weight table.  Must outlive the iterator, and may be shared between iterators.
+	 */
+	KeyIterator(SearchTask<VecCount, VecLenBits, WeightType> const & task, SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable)
+	: sortedWeightTable(sortedWeightTable)
+	, minKeyWeight(task.getMinKeyWeight())
+	, maxKeyWeight(task.getMaxKeyWeight())
+	, firstSubkeyBegin(task.getFirstSubkeyBegin())
+	, firstSubkeyEnd(task.getFirstSubkeyEnd())
+	, depth(0)
+	, finished(false)
+	, keyCount(0)
+	{
+		std::fill(cursor, cursor + VecCount, 0);
+		std::fill(prefixWeight, prefixWeight + VecCount, 0);
+		std::fill(currentKey, currentKey + KeyLenBytes, 0);
+	}
+
+	~KeyIterator() {}
+
+	/**
+	 *
+	 * Write up to maxKeys further candidate keys, each of KeyLenBytes bytes, into keys.
+	 *
+	 * @param keys space for maxKeys * KeyLenBytes bytes
+	 * @param maxKeys
+	 * @return the number of keys written.  This is less than maxKeys only once the enumeration is finished, and 0 on every later call.
+	 */
+	uint64_t next(uint8_t * keys, uint64_t maxKeys) {
+		uint64_t produced = 0;
+		while(produced < maxKeys && !finished) {
+			if(cursor[depth] == VectorSize) {
+				pop();
+			} else if(depth == VecCount - 1) {
+				produced += nextLeaves(keys + produced * KeyLenBytes, maxKeys - produced);
+			} else {
+				descend();
+			}
+		}
+		keyCount += produced;
+		return produced;
+	}
+
+	/**
+	 *
+	 * As above, with the keys written into a vector, which is resized to hold exactly the keys written.
+	 *
+	 * @param batch
+	 * @param maxKeys
+	 * @return the number of keys written
+	 */
+	uint64_t next(std::vector<uint8_t> & batch, uint64_t maxKeys) {
+		batch.resize(maxKeys * KeyLenBytes);
+		uint64_t const produced = next(batch.data(), maxKeys);
+		batch.resize(produced * KeyLenBytes);
+		return produced;
+	}
+
+	/**
+	 *
+	 * @return true once every key of the task has been returned
+	 */
+	bool isFinished() const {
+		return finished;
+	}
+
+	/**
+	 *
+	 * @return the number of keys returned so far
+	 */
+	uint64_t keysEnumerated() const {
+		return keyCount;
+	}
+private:
+	SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable;
+	WeightType const minKeyWeight;
+	WeightType const maxKeyWeight;
+	uint64_t const firstSubkeyBegin;
+	uint64_t const firstSubkeyEnd;
+	// The next sorted index to try in each distinguishing vector up to and including depth
+	uint64_t cursor[VecCount];
+	// The weight of the partial key fixed before each distinguishing vector
+	uint64_t prefixWeight[VecCount];
+	// Byte representation of the current partial key candidate.  Each level only rewrites its own subkey.
+	uint8_t currentKey[KeyLenBytes];
+	uint32_t depth;
+	bool finished;
+	uint64_t keyCount;
+
+	bool isSubkeyIncluded(uint32_t vectorIndex, SubkeyType subkey) const {
+		return vectorIndex != 0 || (subkey >= firstSubkeyBegin && subkey < firstSubkeyEnd);
+	}
+
+	/**
+	 *
+	 * All subkeys of the current distinguishing vector have been tried: return to the previous one
+	 */
+	void pop() {
+		if(depth == 0) {
+			finished = true;
+		} else {
+			depth--;
+			cursor[depth]++;
+		}
+	}
+
+	/**
+	 *
+	 * Try the next subkey of an inner distinguishing vector, moving on to the next vector if any key within the task can still be reached
+	 */
+	void descend() {
+		uint64_t const weight = prefixWeight[depth] + sortedWeightTable.weight(depth, cursor[depth]);
+		if(weight + sortedWeightTable.remainingMinimumWeight(depth) >= maxKeyWeight) {
+			// Weights are sorted, so no later subkey can reach a key within the task either
+			cursor[depth] = VectorSize;
+			return;
+		}
+		SubkeyType const subkey = sortedWeightTable.subkey(depth, cursor[depth]);
+		if(weight + sortedWeightTable.remainingMaximumWeight(depth) < minKeyWeight || !isSubkeyIncluded(depth, subkey)) {
+			cursor[depth]++;
+			return;
+		}
+		FullKeyBuilder<VecCount, VecLenBits, SubkeyType>::setSubkey(depth, subkey, currentKey);
+		depth++;
+		prefixWeight[depth] = weight;
+		cursor[depth] = 0;
+	}
+
+	/**
+	 *
+	 * Emit up to maxKeys keys from the last distinguishing vector
+	 *
+	 * @return the number of keys written
+	 */
+	uint64_t nextLeaves(uint8_t * keys, uint64_t maxKeys) {
+		uint64_t produced = 0;
+		uint64_t index = cursor[depth];
+		while(index < VectorSize && produced < maxKeys) {
+			uint64_t const weight = prefixWeight[depth] + sortedWeightTable.weight(depth, index);
+			if(weight >= maxKeyWeight) {
+				index = VectorSize;
+				break;
+			}
+			SubkeyType const subkey = sortedWeightTable.subkey(depth, index);
+			if(weight >= minKeyWeight && isSubkeyIncluded(depth, subkey)) {
+				FullKeyBuilder<VecCount, VecLenBits, SubkeyType>::setSubkey(depth, subkey, currentKey);
+				std::copy(currentKey, currentKey + KeyLenBytes, keys + produced * KeyLenBytes);
+				produced++;
+			}
+			index++;
+		}
+		cursor[depth] = index;
+		return produced;
+	}
+
+	/**
+	 * Overriden copy constructor
+	 */
+	KeyIterator(KeyIterator const &);
+
+	/**
+	 * Overriden assignment operator
+	 */
+	KeyIterator & operator=(KeyIterator const &);
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_KEYITERATOR_HPP_ */
@@ -0,0 +1,287 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * OrderedEnumeration.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_ORDEREDENUMERATION_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_ORDEREDENUMERATION_HPP_
+
+#include "labynkyr/search/enumerate/SortedWeightTable.hpp"
+#include "labynkyr/search/verify/FullKeyBuilder.hpp"
+#include "labynkyr/search/verify/KeyBatch.hpp"
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+#include "labynkyr/search/CancellationToken.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Enumerates the keys within a weight band in likelihood order: every key of weight w is verified before any key of weight w + 1.  This
+ * matters when verification is expensive and the key is likely to be near the start of the band.
+ *
+ * A best-first search over tuples of sorted indexes would also give this order, but it has to expand every key lighter than the band
+ * before reaching it, and its frontier grows with the number of keys output.  Instead, the band is visited one weight at a time in
+ * ascending order.  For each target weight, a depth-first walk over the sorted weights (as in SortedEnumeration) only descends into a
+ * subkey if the rest of the key can make up exactly the remaining weight, which is checked against a bitset of the sums reachable by the
+ * remaining distinguishing vectors.  Every partial key visited therefore leads to at least one key of the target weight, and the memory
+ * used is the reachable sums plus the current key.
+ *
+ * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
+ * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
+ * @tparam WeightType the integer type used to store weights (e.g uint32_t)
+ * @tparam SubkeyType the integer type used to store a subkey valyue (e.g uint8_t for a typical 8-bit DPA attack)
+ */
+template<uint32_t VecCount, uint32_t VecLenBits, typename WeightType, typename SubkeyType>
+class OrderedEnumeration {
+public:
+	enum {
+		KeyLenBits = VecCount * VecLenBits,
+		// Number of distinguishing scores in each distinguishing vector
+		VectorSize = 1UL << VecLenBits
+	};
+
+	/**
+	 *
+	 * @param keyVerifier
+	 * @param sortedWeightTable a pre-sorted snapshot of the weight table
+	 */
+	OrderedEnumeration(KeyVerifier<KeyLenBits> & keyVerifier, SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable)
+	: sortedWeightTable(sortedWeightTable)
+	, keyBatch(keyVerifier)
+	, firstSubkeyBegin(0)
+	, firstSubkeyEnd(VectorSize)
+	{
+	}
+
+	/**
+	 *
+	 * @param keyVerifier
+	 * @param sortedWeightTable a pre-sorted snapshot of the weight table
+	 * @param keyBatchSize the number of candidate keys handed to the verifier in each call to KeyVerifier#checkKeys
+	 */
+	OrderedEnumeration(KeyVerifier<KeyLenBits> & keyVerifier, SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable,
+			uint64_t keyBatchSize)
+	: sortedWeightTable(sortedWeightTable)
+	, keyBatch(keyVerifier, keyBatchSize)
+	, firstSubkeyBegin(0)
+	, firstSubkeyEnd(VectorSize)
+	{
+	}
+
+	/**
+	 *
+	 * @param keyVerifier
+	 * @param sortedWeightTable a pre-sorted snapshot of the weight table
+	 * @param keyBatchSize the number of candidate keys handed to the verifier in each call to KeyVerifier#checkKeys
+	 * @param cancellationToken polled once per batch of keys; the enumeration returns early once it is raised.  The token is raised if
+	 * this enumeration finds the key.
+	 */
+	OrderedEnumeration(KeyVerifier<KeyLenBits> & keyVerifier, SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable,
+			uint64_t keyBatchSize, CancellationToken & cancellationToken)
+	: sortedWeightTable(sortedWeightTable)
+	, keyBatch(keyVerifier, keyBatchSize, &cancellationToken)
+	, firstSubkeyBegin(0)
+	, firstSubkeyEnd(VectorSize)
+	{
+	}
+
+	~OrderedEnumeration() {}
+
+	/**
+	 *
+	 * Enumerate the keys with weights in [minKeyWeight, maxKeyWeight) whose first subkey value lies in [firstSubkeyBegin, firstSubkeyEnd), in
+	 * ascending order of weight.  Keys of equal weight are enumerated in no particular order.
+	 *
+	 * @param minKeyWeight
+	 * @param maxKeyWeight
+	 * @param firstSubkeyBegin
+	 * @param firstSubkeyEnd
+	 */
+	void enumerate(WeightType minKeyWeight, WeightType maxKeyWeight, uint64_t firstSubkeyBegin, uint64_t firstSubkeyEnd) {
+		this->firstSubkeyBegin = firstSubkeyBegin;
+		this->firstSubkeyEnd = firstSubkeyEnd;
+		findReachableSums(maxKeyWeight);
+		std::fill(currentKey, currentKey + KeyLenBytes, 0);
+		for(uint64_t targetWeight = minKeyWeight ; targetWeight < maxKeyWeight ; targetWeight++) {
+			if(!isReachable(0, targetWeight)) {
+				continue;
+			}
+			if(enumerateVector(0, targetWeight)) {
+				break;
+			}
+		}
+		keyBatch.flush();
+	}
+private:
+	enum {
+		KeyLenBytes = KeyBatch<KeyLenBits>::KeyLenBytes
+	};
+
+	SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable;
+	KeyBatch<KeyLenBits> keyBatch;
+	// Byte representation of the current partial key candidate.  Each level only rewrites its own subkey.
+	uint8_t currentKey[KeyLenBytes];
+	uint64_t firstSubkeyBegin;
+	uint64_t firstSubkeyEnd;
+	// Bit w of reachableSums[v] is set if distinguishing vectors v onwards can contribute exactly weight w.  The first vector only counts
+	// the subkeys within the first subkey range.
+	std::vector<std::vector<uint64_t>> reachableSums;
+
+	bool isSubkeyIncluded(uint32_t vectorIndex, SubkeyType subkey) const {
+		return vectorIndex != 0 || (subkey >= firstSubkeyBegin && subkey < firstSubkeyEnd);
+	}
+
+	bool isReachable(uint32_t vectorIndex, uint64_t weight) const {
+		return (reachableSums[vectorIndex][weight / 64] >> (weight % 64)) & 1;
+	}
+
+	/**
+	 *
+	 * Build the reachable sums below maxKeyWeight, from the last distinguishing vector backwards
+	 */
+	void findReachableSums(WeightType maxKeyWeight) {
+		uint64_t const wordCount = (static_cast<uint64_t>(maxKeyWeight) + 63) / 64;
+		reachableSums.assign(VecCount + 1, std::vector<uint64_t>(wordCount, 0));
+		if(maxKeyWeight == 0) {
+			return;
+		}
+		reachableSums[VecCount][0] = 1;
+		for(uint32_t vectorIndex = VecCount ; vectorIndex > 0 ; vectorIndex--) {
+			std::set<WeightType> shifts;
+			for(uint64_t subkeyIndex = 0 ; subkeyIndex < VectorSize ; subkeyIndex++) {
+				if(isSubkeyIncluded(vectorIndex - 1, sortedWeightTable.subkey(vectorIndex - 1, subkeyIndex))) {
+					shifts.insert(sortedWeightTable.weight(vectorIndex - 1, subkeyIndex));
+				}
+			}
+			std::vector<uint64_t> const & input = reachableSums[vectorIndex];
+			std::vector<uint64_t> & output = reachableSums[vectorIndex - 1];
+			for(auto const shift : shifts) {
+				uint64_t const wordShift = static_cast<uint64_t>(shift) / 64;
+				uint32_t const bitShift = static_cast<uint64_t>(shift) % 64;
+				for(uint64_t wordIndex = wordShift ; wordIndex < wordCount ; wordIndex++) {
+					uint64_t const source = wordIndex - wordShift;
+					uint64_t word = input[source] << bitShift;
+					if(bitShift != 0 && source > 0) {
+						word |= input[source - 1] >> (64 - bitShift);
+					}
+					output[wordIndex] |= word;
+				}
+			}
+			if(maxKeyWeight % 64 != 0) {
+				output[wordCount - 1] &= (1ULL << (maxKeyWeight % 64)) - 1;
+			}
+		}
+	}
+
+	/**
+	 *
+	 * Enumerate the keys whose subkeys from vectorIndex onwards contribute exactly remainingWeight
+	 *
+	 * @return true if the enumeration should stop because the verifier has found the key or the search has been cancelled
+	 */
+	bool enumerateVector(uint32_t vectorIndex, uint64_t remainingWeight) {
+		if(vectorIndex == VecCount - 1) {
+			return enumerateLastVector(remainingWeight);
+		}
+		uint64_t const remainingMinimumWeight = sortedWeightTable.remainingMinimumWeight(vectorIndex);
+		for(uint64_t sortedIndex = 0 ; sortedIndex < VectorSize ; sortedIndex++) {
+			uint64_t const contrib = sortedWeightTable.weight(vectorIndex, sortedIndex);
+			if(contrib + remainingMinimumWeight > remainingWeight) {
+				break;
+			}
+			SubkeyType const subkey = sortedWeightTable.subkey(vectorIndex, sortedIndex);
+			if(!isReachable(vectorIndex + 1, remainingWeight - contrib) || !isSubkeyIncluded(vectorIndex, subkey)) {
+				continue;
+			}
+			FullKeyBuilder<VecCount, VecLenBits, SubkeyType>::setSubkey(vectorIndex, subkey, currentKey);
+			if(enumerateVector(vectorIndex + 1, remainingWeight - contrib)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 *
+	 * The subkeys of the last vector with weight exactly remainingWeight are contiguous in sorted order, so are found by binary search
+	 */
+	bool enumerateLastVector(uint64_t remainingWeight) {
+		uint32_t const vectorIndex = VecCount - 1;
+		uint64_t low = 0;
+		uint64_t high = VectorSize;
+		while(low < high) {
+			uint64_t const middle = low + (high - low) / 2;
+			if(sortedWeightTable.weight(vectorIndex, middle) < remainingWeight) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+		for(uint64_t sortedIndex = low ; sortedIndex < VectorSize && sortedWeightTable.weight(vectorIndex, sortedIndex) == remainingWeight ; sortedIndex++) {
+			SubkeyType const subkey = sortedWeightTable.subkey(vectorIndex, sortedIndex);
+			if(!isSubkeyIncluded(vectorIndex, subkey)) {
+				continue;
+			}
+			FullKeyBuilder<VecCount, VecLenBits, SubkeyType>::setSubkey(vectorIndex, subkey, currentKey);
+			std::copy(currentKey, currentKey + KeyLenBytes, keyBatch.nextKey());
+			if(keyBatch.commit() && keyBatch.isStopped()) {
+				return true;
+			}
+		}
+		return false;
+	}
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_ORDEREDENUMERATION_HPP_ */
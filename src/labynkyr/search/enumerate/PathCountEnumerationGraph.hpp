@@ -55,7 +55,7 @@
 
 #include <stdint.h>
 
-#include <memory>
+#include <algorithm>
 #include <vector>
 
 namespace labynkyr {
@@ -74,8 +74,9 @@ namespace search {
  * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
  * @tparam WeightType the integer type used to score weights (e.g uint32_t)
  * @tparam SubkeyType the integer type used to store a subkey valyue (e.g uint8_t for a typical 8-bit DPA attack)
+ * @tparam ForestType the type used to store the candidate keys at each node (CandidateKeyForest or FlatCandidateKeyForest)
  */
-template<uint32_t VecCount, uint32_t VecLenBits, typename WeightType, typename SubkeyType>
+template<uint32_t VecCount, uint32_t VecLenBits, typename WeightType, typename SubkeyType, typename ForestType = CandidateKeyForest<VecCount, VecLenBits, SubkeyType>>
 class PathCountEnumerationGraph {
 public:
 	enum {
@@ -91,15 +92,11 @@ public:
 	 */
 	PathCountEnumerationGraph(SearchTask<VecCount, VecLenBits, WeightType> const & task)
 	: task(task)
-	, rejectStateSet(CandidateKeyForest<VecCount, VecLenBits, SubkeyType>::rejectStateSet())
-	, acceptStateSet(CandidateKeyForest<VecCount, VecLenBits, SubkeyType>::acceptStateSet())
-	, current(task.getMaxKeyWeight())
-	, previous(task.getMaxKeyWeight())
+	, rejectStateSet(ForestType::rejectStateSet())
+	, acceptStateSet(ForestType::acceptStateSet())
+	, current(task.getMaxKeyWeight(), ForestType::emptySet())
+	, previous(task.getMaxKeyWeight(), ForestType::emptySet())
 	{
-		// Fill current with reject state sets
-		for(uint64_t index = 0 ; index < current.size() ; index++) {
-			current[index] = CandidateKeyForest<VecCount, VecLenBits, SubkeyType>::emptySet();
-		}
 	}
 
 	~PathCountEnumerationGraph() {}
@@ -111,8 +108,8 @@ public:
 	 * @param coord
 	 * @param value
 	 */
-	void set(rank::GraphCoordinate const & coord, std::unique_ptr<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>> value) {
-		current.at(coord.getWeightIndex()) = std::move(value);
+	void set(rank::GraphCoordinate const & coord, ForestType const & value) {
+		current.at(coord.getWeightIndex()) = value;
 	}
 
 	/**
@@ -120,8 +117,8 @@ public:
 	 * @return remove and return the forest stored at the first position in the graph.  This should only be called once the
 	 * graph traversal is complete. This will contain the set of all keys to be tested.
 	 */
-	std::unique_ptr<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>> removeFirst() {
-		return std::move(current[0]);
+	ForestType removeFirst() {
+		return current[0];
 	}
 
 	/**
@@ -129,13 +126,13 @@ public:
 	 * @param rightChildIndex an index relative to the entire graph
 	 * @return the forest stored within the graph at that index
 	 */
-	CandidateKeyForest<VecCount, VecLenBits, SubkeyType> const & rightChild(rank::GraphCoordinate const & rightChildIndex) {
+	ForestType const & rightChild(rank::GraphCoordinate const & rightChildIndex) {
 		if(rightChildIndex.isAccept()) {
-			return *acceptStateSet.get();
+			return acceptStateSet;
 		} else if(rightChildIndex.isReject()) {
-			return *rejectStateSet.get();
+			return rejectStateSet;
 		}
-		return *previous.at(rightChildIndex.getWeightIndex()).get();
+		return previous.at(rightChildIndex.getWeightIndex());
 	}
 
 	/**
@@ -170,8 +167,8 @@ public:
 		}
 	}
 
-	CandidateKeyForest<VecCount, VecLenBits, SubkeyType> & at(rank::GraphCoordinate const & coord) {
-		return *current.at(coord.getWeightIndex()).get();
+	ForestType & at(rank::GraphCoordinate const & coord) {
+		return current.at(coord.getWeightIndex());
 	}
 
 	/**
@@ -180,29 +177,28 @@ public:
 	 * except for the case that the new distinguishing vector is the final (zeroth) one.
 	 */
 	void rotateBuffers() {
-		// Copy current into previous
-		uint64_t offset = 0;
-		for(auto & keySet : current) {
-			previous[offset].reset();
-			previous[offset] = std::move(keySet);
-			offset++;
-		}
-		// Fill current with empty forests
-		for(uint64_t index = 0 ; index < current.size() ; index++) {
-			current[index].reset();
-			current[index] = std::move(CandidateKeyForest<VecCount, VecLenBits, SubkeyType>::emptySet());
-		}
+		// Forests are handles onto storage owned by the caller, so the rows can be swapped and cleared without freeing any trees
+		current.swap(previous);
+		std::fill(current.begin(), current.end(), ForestType::emptySet());
 	}
 
-	std::vector<std::unique_ptr<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>>> & previousRow() {
+	std::vector<ForestType> & previousRow() {
 		return previous;
 	}
+
+	/**
+	 *
+	 * @return the number of bytes allocated to the two rows of forests.  The trees themselves are held by the caller's storage.
+	 */
+	uint64_t bytesUsed() const {
+		return (current.capacity() + previous.capacity()) * sizeof(ForestType);
+	}
 private:
 	SearchTask<VecCount, VecLenBits, WeightType> const & task;
-	std::unique_ptr<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>> rejectStateSet;
-	std::unique_ptr<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>> acceptStateSet;
-	std::vector<std::unique_ptr<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>>> current;
-	std::vector<std::unique_ptr<CandidateKeyForest<VecCount, VecLenBits, SubkeyType>>> previous;
+	ForestType const rejectStateSet;
+	ForestType const acceptStateSet;
+	std::vector<ForestType> current;
+	std::vector<ForestType> previous;
 };
 
 } /* namespace search */
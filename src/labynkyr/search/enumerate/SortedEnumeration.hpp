@@ -48,14 +48,17 @@
 #ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_SORTEDENUMERATION_HPP_
 #define LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_SORTEDENUMERATION_HPP_
 
+#include "labynkyr/search/enumerate/SortedWeightTable.hpp"
 #include "labynkyr/search/verify/FullKeyBuilder.hpp"
+#include "labynkyr/search/verify/KeyBatch.hpp"
 #include "labynkyr/search/verify/KeyVerifier.hpp"
-#include "labynkyr/WeightTable.hpp"
+#include "labynkyr/search/CancellationToken.hpp"
+#include "labynkyr/search/FirstSubkeyRange.hpp"
 
 #include <stdint.h>
 
-#include <stdexcept>
-#include <vector>
+#include <algorithm>
+#include <type_traits>
 
 namespace labynkyr {
 namespace search {
@@ -68,8 +71,8 @@ namespace search {
  * Jake Longo and Daniel P. Martin and Luke Mather and Elisabeth Oswald and Benjamin Sach and Martijn Stam
  * http://eprint.iacr.org/2016/609
  *
- * The Sorted algorithm requires the weight table to be sorted in ascending order.  You need to copy the table before it does this
- * if you wish to re-use the original form of the table elsewhere.
+ * The Sorted algorithm requires the weight table to be sorted in ascending order.  This is supplied as a SortedWeightTable, which
+ * may be shared between many SortedEnumeration instances.
  *
  * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
  * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
@@ -88,54 +91,196 @@ public:
 	/**
 	 *
 	 * @param keyVerifier
-	 * @param weightTable
+	 * @param sortedWeightTable a pre-sorted snapshot of the weight table
 	 */
-	SortedEnumeration(KeyVerifier<KeyLenBits> & keyVerifier, WeightTable<VecCount, VecLenBits, WeightType> & weightTable)
-	: keyVerifier(keyVerifier)
-	, weightTable(weightTable)
-	, indexes(VecCount * VectorSize)
-	, partialSums(VecCount)
-	, keyValue(VecCount)
+	SortedEnumeration(KeyVerifier<KeyLenBits> & keyVerifier, SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable)
+	: sortedWeightTable(sortedWeightTable)
+	, keyBatch(keyVerifier)
+	, minKeyWeight(0)
+	, firstSubkeyBegin(0)
+	, firstSubkeyEnd(VectorSize)
+	{
+	}
+
+	/**
+	 *
+	 * @param keyVerifier
+	 * @param sortedWeightTable a pre-sorted snapshot of the weight table
+	 * @param keyBatchSize the number of candidate keys handed to the verifier in each call to KeyVerifier#checkKeys
+	 */
+	SortedEnumeration(KeyVerifier<KeyLenBits> & keyVerifier, SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable,
+			uint64_t keyBatchSize)
+	: sortedWeightTable(sortedWeightTable)
+	, keyBatch(keyVerifier, keyBatchSize)
+	, minKeyWeight(0)
+	, firstSubkeyBegin(0)
+	, firstSubkeyEnd(VectorSize)
+	{
+	}
+
+	/**
+	 *
+	 * @param keyVerifier
+	 * @param sortedWeightTable a pre-sorted snapshot of the weight table
+	 * @param keyBatchSize the number of candidate keys handed to the verifier in each call to KeyVerifier#checkKeys
+	 * @param cancellationToken polled once per batch of keys; the enumeration returns early once it is raised.  The token is raised if
+	 * this enumeration finds the key.
+	 */
+	SortedEnumeration(KeyVerifier<KeyLenBits> & keyVerifier, SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable,
+			uint64_t keyBatchSize, CancellationToken & cancellationToken)
+	: sortedWeightTable(sortedWeightTable)
+	, keyBatch(keyVerifier, keyBatchSize, &cancellationToken)
+	, minKeyWeight(0)
+	, firstSubkeyBegin(0)
+	, firstSubkeyEnd(VectorSize)
 	{
-		// Sort weights and track indexes
-		weightTable.template sortAscendingAndTrackIndexes<SubkeyType>(indexes);
-		// Partial sums
-		for(uint64_t vectorIndex = VecCount - 1 ; vectorIndex > 0 ; vectorIndex--) {
-			uint64_t const relVectorIndex = vectorIndex - 1;
-			partialSums[relVectorIndex] = weightTable.weight(relVectorIndex + 1, 0);
-			partialSums[relVectorIndex] += partialSums[relVectorIndex + 1];
-		}
-		// Create key value and key byte objects to store working keys
-		uint32_t const byteCount = (KeyLenBits % 8 != 0) ? (KeyLenBits / 8) + 1 : KeyLenBits / 8;
-		keyBytes.resize(byteCount);
 	}
 
 	~SortedEnumeration() {}
 
 	void enumerate(WeightType maxKeyWeight) {
-		recurse(0, 0, maxKeyWeight);
+		enumerate(maxKeyWeight, 0, VectorSize);
+	}
+
+	/**
+	 *
+	 * Enumerate only the keys whose first subkey value lies in [firstSubkeyBegin, firstSubkeyEnd)
+	 *
+	 * @param maxKeyWeight
+	 * @param firstSubkeyBegin
+	 * @param firstSubkeyEnd
+	 */
+	void enumerate(WeightType maxKeyWeight, uint64_t firstSubkeyBegin, uint64_t firstSubkeyEnd) {
+		enumerate(0, maxKeyWeight, firstSubkeyBegin, firstSubkeyEnd);
+	}
+
+	/**
+	 *
+	 * Enumerate only the keys with weights in [minKeyWeight, maxKeyWeight) whose first subkey value lies in [firstSubkeyBegin, firstSubkeyEnd).
+	 * Partial keys that cannot reach minKeyWeight even with the largest remaining weights are skipped.
+	 *
+	 * @param minKeyWeight
+	 * @param maxKeyWeight
+	 * @param firstSubkeyBegin
+	 * @param firstSubkeyEnd
+	 */
+	void enumerate(WeightType minKeyWeight, WeightType maxKeyWeight, uint64_t firstSubkeyBegin, uint64_t firstSubkeyEnd) {
+		this->minKeyWeight = minKeyWeight;
+		this->firstSubkeyBegin = firstSubkeyBegin;
+		this->firstSubkeyEnd = firstSubkeyEnd;
+		std::fill(currentKey, currentKey + KeyLenBytes, 0);
+		enumerateVector<0>(0, maxKeyWeight, IsLastVector<0>());
+		keyBatch.flush();
+	}
+
+	/**
+	 *
+	 * Enumerate only the keys with weights in [minKeyWeight, maxKeyWeight) whose first subkey value is claimed from firstSubkeys.  The first
+	 * subkeys are claimed one at a time in ascending order, rather than in order of weight, so that another thread may split off the
+	 * subkeys not yet started while the enumeration runs.
+	 *
+	 * @param minKeyWeight
+	 * @param maxKeyWeight
+	 * @param firstSubkeys
+	 */
+	void enumerate(WeightType minKeyWeight, WeightType maxKeyWeight, FirstSubkeyRange & firstSubkeys) {
+		this->minKeyWeight = minKeyWeight;
+		std::fill(currentKey, currentKey + KeyLenBytes, 0);
+		uint64_t subkey = 0;
+		while(!keyBatch.isStopped() && firstSubkeys.claim(subkey)) {
+			firstSubkeyBegin = subkey;
+			firstSubkeyEnd = subkey + 1;
+			if(enumerateVector<0>(0, maxKeyWeight, IsLastVector<0>())) {
+				break;
+			}
+		}
+		keyBatch.flush();
 	}
 private:
-	KeyVerifier<KeyLenBits> & keyVerifier;
-	WeightTable<VecCount, VecLenBits, WeightType> & weightTable;
-	std::vector<SubkeyType> indexes;
-	std::vector<WeightType> partialSums;
-	std::vector<SubkeyType> keyValue;
-	std::vector<uint8_t> keyBytes;
-
-	void recurse(uint32_t vectorIndex, WeightType weight, WeightType maxKeyWeight) {
-		for(SubkeyType subkeyIndex = 0 ; subkeyIndex < VectorSize ; subkeyIndex++) {
-			keyValue[vectorIndex] = indexes[vectorIndex * VectorSize + subkeyIndex];
-			WeightType const contrib = weightTable.weight(vectorIndex, subkeyIndex);
-			if(weight + contrib + partialSums[vectorIndex] >= maxKeyWeight || keyVerifier.success()) {
+	enum {
+		KeyLenBytes = KeyBatch<KeyLenBits>::KeyLenBytes
+	};
+
+	// Tag selecting the leaf (final distinguishing vector) or inner loop of the unrolled loop nest
+	template<uint32_t VectorIndex>
+	struct IsLastVector : std::integral_constant<bool, VectorIndex == VecCount - 1> {};
+
+	SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const & sortedWeightTable;
+	KeyBatch<KeyLenBits> keyBatch;
+	// Byte representation of the current partial key candidate.  Each level of the loop nest only rewrites its own subkey.
+	uint8_t currentKey[KeyLenBytes];
+	WeightType minKeyWeight;
+	uint64_t firstSubkeyBegin;
+	uint64_t firstSubkeyEnd;
+
+	/**
+	 *
+	 * @return false if the subkey is for the first distinguishing vector and outside the requested range
+	 */
+	template<uint32_t VectorIndex>
+	bool isSubkeyIncluded(SubkeyType subkey) const {
+		return VectorIndex != 0 || (subkey >= firstSubkeyBegin && subkey < firstSubkeyEnd);
+	}
+
+	/**
+	 *
+	 * One level of the loop nest, for a distinguishing vector before the last.  The nest is unrolled at compile time, one function
+	 * per distinguishing vector.
+	 *
+	 * @return true if the enumeration should stop because the verifier has found the key or the search has been cancelled
+	 */
+	template<uint32_t VectorIndex>
+	bool enumerateVector(WeightType weight, WeightType maxKeyWeight, std::false_type) {
+		WeightType const remainingWeight = sortedWeightTable.remainingMinimumWeight(VectorIndex);
+		uint64_t const remainingMaximumWeight = sortedWeightTable.remainingMaximumWeight(VectorIndex);
+		for(uint64_t sortedIndex = 0 ; sortedIndex < VectorSize ; sortedIndex++) {
+			WeightType const contrib = sortedWeightTable.weight(VectorIndex, sortedIndex);
+			if(weight + contrib + remainingWeight >= maxKeyWeight) {
+				break;
+			}
+			if(weight + contrib + remainingMaximumWeight < minKeyWeight) {
+				continue;
+			}
+			SubkeyType const subkey = sortedWeightTable.subkey(VectorIndex, sortedIndex);
+			if(!isSubkeyIncluded<VectorIndex>(subkey)) {
+				continue;
+			}
+			FullKeyBuilder<VecCount, VecLenBits, SubkeyType>::setSubkey(VectorIndex, subkey, currentKey);
+			if(enumerateVector<VectorIndex + 1>(weight + contrib, maxKeyWeight, IsLastVector<VectorIndex + 1>())) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**
+	 *
+	 * The innermost level of the loop nest.  The verifier (and cancellation token) is only polled when a full batch of keys has been
+	 * handed to it, rather than once per candidate.
+	 *
+	 * @return true if the enumeration should stop because the verifier has found the key or the search has been cancelled
+	 */
+	template<uint32_t VectorIndex>
+	bool enumerateVector(WeightType weight, WeightType maxKeyWeight, std::true_type) {
+		for(uint64_t sortedIndex = 0 ; sortedIndex < VectorSize ; sortedIndex++) {
+			WeightType const contrib = sortedWeightTable.weight(VectorIndex, sortedIndex);
+			if(weight + contrib >= maxKeyWeight) {
 				break;
-			} else if(vectorIndex == VecCount - 1) {
-				FullKeyBuilder<VecCount, VecLenBits, SubkeyType>::fullKey(keyValue, keyBytes);
-				keyVerifier.checkKey(keyBytes);
-			} else {
-				recurse(vectorIndex + 1, weight + contrib, maxKeyWeight);
+			}
+			if(weight + contrib < minKeyWeight) {
+				continue;
+			}
+			SubkeyType const subkey = sortedWeightTable.subkey(VectorIndex, sortedIndex);
+			if(!isSubkeyIncluded<VectorIndex>(subkey)) {
+				continue;
+			}
+			FullKeyBuilder<VecCount, VecLenBits, SubkeyType>::setSubkey(VectorIndex, subkey, currentKey);
+			std::copy(currentKey, currentKey + KeyLenBytes, keyBatch.nextKey());
+			if(keyBatch.commit() && keyBatch.isStopped()) {
+				return true;
 			}
 		}
+		return false;
 	}
 };
 
@@ -0,0 +1,171 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SortedWeightTable.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_SORTEDWEIGHTTABLE_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_SORTEDWEIGHTTABLE_HPP_
+
+#include "labynkyr/WeightTable.hpp"
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * An immutable snapshot of a WeightTable in the form required by the Sorted enumeration algorithm.  The snapshot contains:
+ * 		- the weights of each distinguishing vector sorted in ascending order
+ * 		- the original subkey value associated with each sorted weight
+ * 		- for each distinguishing vector, the sum of the minimum weights of all subsequent vectors
+ * 		- for each distinguishing vector, the sum of the maximum weights of all subsequent vectors
+ *
+ * The snapshot is built once per search and is never modified afterwards, so a single instance can be shared read-only by any number
+ * of concurrently executing enumeration tasks.
+ *
+ * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
+ * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
+ * @tparam WeightType the integer type used to store weights (e.g uint32_t)
+ * @tparam SubkeyType the integer type used to store a subkey valyue (e.g uint8_t for a typical 8-bit DPA attack)
+ */
+template<uint32_t VecCount, uint32_t VecLenBits, typename WeightType, typename SubkeyType>
+class SortedWeightTable {
+public:
+	enum {
+		// Number of distinguishing scores in each distinguishing vector
+		VectorSize = 1UL << VecLenBits
+	};
+
+	/**
+	 *
+	 * @param weightTable an integer representation of the distinguishing scores.  The table is copied, and will not be modified.
+	 */
+	SortedWeightTable(WeightTable<VecCount, VecLenBits, WeightType> const & weightTable)
+	: sortedTable(weightTable)
+	, indexes(VecCount * VectorSize)
+	, partialSums(VecCount)
+	, partialMaximumSums(VecCount)
+	{
+		// Sort weights and track indexes
+		sortedTable.template sortAscendingAndTrackIndexes<SubkeyType>(indexes);
+		// Partial sums of the minimum weight in each subsequent vector
+		partialSums[VecCount - 1] = 0;
+		for(uint64_t vectorIndex = VecCount - 1 ; vectorIndex > 0 ; vectorIndex--) {
+			uint64_t const relVectorIndex = vectorIndex - 1;
+			partialSums[relVectorIndex] = sortedTable.weight(relVectorIndex + 1, 0);
+			partialSums[relVectorIndex] += partialSums[relVectorIndex + 1];
+		}
+		// Partial sums of the maximum weight in each subsequent vector
+		partialMaximumSums[VecCount - 1] = 0;
+		for(uint64_t vectorIndex = VecCount - 1 ; vectorIndex > 0 ; vectorIndex--) {
+			uint64_t const relVectorIndex = vectorIndex - 1;
+			partialMaximumSums[relVectorIndex] = sortedTable.weight(relVectorIndex + 1, VectorSize - 1);
+			partialMaximumSums[relVectorIndex] += partialMaximumSums[relVectorIndex + 1];
+		}
+	}
+
+	~SortedWeightTable() {}
+
+	/**
+	 *
+	 * @param vectorIndex
+	 * @param sortedIndex the position of the weight after sorting
+	 * @return the sortedIndex-th smallest weight in the vectorIndex distinguishing vector
+	 */
+	WeightType weight(uint32_t vectorIndex, uint64_t sortedIndex) const {
+		return sortedTable.weight(vectorIndex, sortedIndex);
+	}
+
+	/**
+	 *
+	 * @param vectorIndex
+	 * @param sortedIndex the position of the weight after sorting
+	 * @return the subkey value associated with the sortedIndex-th smallest weight in the vectorIndex distinguishing vector
+	 */
+	SubkeyType subkey(uint32_t vectorIndex, uint64_t sortedIndex) const {
+		return indexes[vectorIndex * VectorSize + sortedIndex];
+	}
+
+	/**
+	 *
+	 * @param vectorIndex
+	 * @return the sum of the minimum weights in all distinguishing vectors after vectorIndex.  This is the smallest weight that must
+	 * be added to a partial key candidate fixed up to and including vectorIndex.
+	 */
+	WeightType remainingMinimumWeight(uint32_t vectorIndex) const {
+		return partialSums[vectorIndex];
+	}
+
+	/**
+	 *
+	 * @param vectorIndex
+	 * @return the sum of the maximum weights in all distinguishing vectors after vectorIndex.  This is the largest weight that can be
+	 * added to a partial key candidate fixed up to and including vectorIndex.
+	 */
+	uint64_t remainingMaximumWeight(uint32_t vectorIndex) const {
+		return partialMaximumSums[vectorIndex];
+	}
+
+	/**
+	 *
+	 * @return the weights, sorted per vector in ascending order
+	 */
+	WeightTable<VecCount, VecLenBits, WeightType> const & getSortedTable() const {
+		return sortedTable;
+	}
+private:
+	WeightTable<VecCount, VecLenBits, WeightType> sortedTable;
+	std::vector<SubkeyType> indexes;
+	std::vector<WeightType> partialSums;
+	std::vector<uint64_t> partialMaximumSums;
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_ENUMERATE_SORTEDWEIGHTTABLE_HPP_ */
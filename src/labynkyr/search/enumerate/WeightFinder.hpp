@@ -54,6 +54,7 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <cmath>
 #include <utility>
 #include <vector>
@@ -91,8 +92,27 @@ public:
 	 */
 	WeightFinder(WeightTable<VecCount, VecLenBits, WeightType> const & weightTable)
 	: weightTable(weightTable)
+	, rankList(rank::PathCountRank<VecCount, VecLenBits, WeightType>::rankAllWeights(weightTable.maximumWeight(), weightTable))
 	, maxWeight(weightTable.maximumWeight())
-	, rankList(rank::PathCountRank<VecCount, VecLenBits, WeightType>::rankAllWeights(maxWeight, weightTable))
+	{
+	}
+
+	/**
+	 *
+	 * Construct from a WeightTable, only ranking the weights needed to reach a given depth.  The path count rank estimation algorithm is run
+	 * with a bound that starts just above the minimum weight in the table and doubles, until the rank of the bound is at least depth (or
+	 * the bound reaches the maximum weight in the table).  For search budgets far smaller than the key space, this is considerably faster
+	 * than ranking every weight in the table.
+	 *
+	 * The list of ranks then only covers the weights up to the bound, but all ranks within it are exact.
+	 *
+	 * @param weightTable
+	 * @param depth the deepest key that will be searched
+	 */
+	WeightFinder(WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, BigInt<KeyLenBits> depth)
+	: weightTable(weightTable)
+	, rankList(rankUpToDepth(weightTable, depth))
+	, maxWeight(rankList.size())
 	{
 	}
 
@@ -105,8 +125,8 @@ public:
 	 */
 	WeightFinder(WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, std::vector<BigInt<KeyLenBits>> const & rankList)
 	: weightTable(weightTable)
-	, maxWeight(weightTable.maximumWeight())
 	, rankList(rankList)
+	, maxWeight(weightTable.maximumWeight())
 	{
 	}
 
@@ -154,10 +174,32 @@ public:
 	std::vector<BigInt<KeyLenBits>> const & list() const {
 		return rankList;
 	}
+
+	/**
+	 *
+	 * @return the bound on the weights ranked.  The list contains the ranks of the weights {rankedWeightBound(),...,1}.
+	 */
+	WeightType rankedWeightBound() const {
+		return rankList.size();
+	}
 private:
 	WeightTable<VecCount, VecLenBits, WeightType> const & weightTable;
-	WeightType const maxWeight;
 	std::vector<BigInt<KeyLenBits>> const rankList;
+	WeightType const maxWeight;
+
+	static std::vector<BigInt<KeyLenBits>> rankUpToDepth(WeightTable<VecCount, VecLenBits, WeightType> const & weightTable, BigInt<KeyLenBits> const & depth) {
+		uint64_t const minimumWeight = weightTable.minimumWeight();
+		uint64_t const maximumWeight = weightTable.maximumWeight();
+		uint64_t step = 1;
+		while(true) {
+			uint64_t const bound = std::min(minimumWeight + step, maximumWeight);
+			auto ranks = rank::PathCountRank<VecCount, VecLenBits, WeightType>::rankAllWeights(bound, weightTable);
+			if(bound == maximumWeight || ranks[0] >= depth) {
+				return ranks;
+			}
+			step *= 2;
+		}
+	}
 };
 
 } /*namespace search */
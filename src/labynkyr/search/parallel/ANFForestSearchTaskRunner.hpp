@@ -51,17 +51,48 @@
 #include "labynkyr/search/parallel/SearchTaskRunner.hpp"
 
 #include "labynkyr/search/enumerate/ActiveNodeFinder.hpp"
+#include "labynkyr/search/enumerate/ANFMemoryEstimator.hpp"
+#include "labynkyr/search/enumerate/Arena.hpp"
+#include "labynkyr/search/enumerate/FlatCandidateKeyStore.hpp"
+#include "labynkyr/search/enumerate/SortedWeightTable.hpp"
+#include "labynkyr/search/verify/KeyBatch.hpp"
 #include "labynkyr/search/PathCountSearch.hpp"
 
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
 namespace labynkyr {
 namespace search {
 
+/**
+ *
+ * Selects the representation used by ANFForestSearchTaskRunner to store candidate keys
+ */
+enum ForestLayout {
+	// CandidateKeyForest: trees linked by pointer and allocated from an Arena
+	LinkedForestLayout,
+	// FlatCandidateKeyForest: contiguous per-vector node arrays, walked iteratively
+	FlatForestLayout
+};
+
 /**
  *
  * ANFForestSearchTaskRunner implements SearchTaskRunner and wraps an instance of the ANF/Forest enumeration algorithm.
  *
  * The ActiveNodeFinder is assumed to be already generated.
  *
+ * A task may be given a memory budget for its candidate keys.  The memory a task needs is estimated with ANFMemoryEstimator before the
+ * path count graph is built, and the budget is enforced while it is built.  A task that would exceed the budget is split into two weight
+ * sub-bands, each searched (and split again if necessary) in turn.  A band of a single weight that still exceeds the budget is searched
+ * with the Sorted algorithm, which walks the keys depth-first without storing them.
+ *
+ * Without a memory budget, the candidate keys are verified one first subkey at a time, so that the ones not yet started can be split off by
+ * splitRemainder while the runner is being processed.  The runner split off builds the path count graph again.  A task with a memory budget
+ * may search several weight bands over the same first subkeys, and so does not support splitRemainder.
+ *
  * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
  * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
  * @tparam WeightType the integer type used to store weights (e.g uint32_t)
@@ -83,15 +114,87 @@ public:
 	ANFForestSearchTaskRunner(SearchTask<VecCount, VecLenBits, WeightType> const & task, BigInt<KeyLenBits> expectedTaskSize, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder)
 	: SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>(task, expectedTaskSize)
 	, activeNodeFinder(activeNodeFinder)
+	, forestLayout(LinkedForestLayout)
+	, arenaBlockSizeBytes(Arena::DefaultBlockSizeBytes)
+	, useHugePages(false)
+	, memoryBudgetBytes(0)
+	, arenaBytesUsed(0)
+	, arenaBytesReserved(0)
+	, weightBandCount(0)
+	, sortedBandCount(0)
+	{
+	}
+
+	/**
+	 *
+	 * @param task
+	 * @param expectedTaskSize
+	 * @param activeNodeFinder
+	 * @param arenaBlockSizeBytes the block size of the Arena used to store the candidate key trees for this task
+	 * @param useHugePages if true, attempt to back the Arena with huge pages
+	 */
+	ANFForestSearchTaskRunner(SearchTask<VecCount, VecLenBits, WeightType> const & task, BigInt<KeyLenBits> expectedTaskSize, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder,
+			uint64_t arenaBlockSizeBytes, bool useHugePages)
+	: SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>(task, expectedTaskSize)
+	, activeNodeFinder(activeNodeFinder)
+	, forestLayout(LinkedForestLayout)
+	, arenaBlockSizeBytes(arenaBlockSizeBytes)
+	, useHugePages(useHugePages)
+	, memoryBudgetBytes(0)
+	, arenaBytesUsed(0)
+	, arenaBytesReserved(0)
+	, weightBandCount(0)
+	, sortedBandCount(0)
+	{
+	}
+
+	/**
+	 *
+	 * @param task
+	 * @param expectedTaskSize
+	 * @param activeNodeFinder
+	 * @param forestLayout the representation used to store the candidate keys for this task
+	 */
+	ANFForestSearchTaskRunner(SearchTask<VecCount, VecLenBits, WeightType> const & task, BigInt<KeyLenBits> expectedTaskSize, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder,
+			ForestLayout forestLayout)
+	: SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>(task, expectedTaskSize)
+	, activeNodeFinder(activeNodeFinder)
+	, forestLayout(forestLayout)
+	, arenaBlockSizeBytes(Arena::DefaultBlockSizeBytes)
+	, useHugePages(false)
+	, memoryBudgetBytes(0)
+	, arenaBytesUsed(0)
+	, arenaBytesReserved(0)
+	, weightBandCount(0)
+	, sortedBandCount(0)
+	{
+	}
+
+	/**
+	 *
+	 * @param task
+	 * @param expectedTaskSize
+	 * @param activeNodeFinder
+	 * @param forestLayout the representation used to store the candidate keys for this task
+	 * @param memoryBudgetBytes the most memory the candidate keys of the task may use at once, or 0 for no limit
+	 */
+	ANFForestSearchTaskRunner(SearchTask<VecCount, VecLenBits, WeightType> const & task, BigInt<KeyLenBits> expectedTaskSize, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder,
+			ForestLayout forestLayout, uint64_t memoryBudgetBytes)
+	: ANFForestSearchTaskRunner(task, expectedTaskSize, activeNodeFinder, forestLayout, Arena::DefaultBlockSizeBytes, false, memoryBudgetBytes)
 	{
 	}
 
 	~ANFForestSearchTaskRunner() {}
 
 	void processSequentially(KeyVerifier<KeyLenBits> & keyVerifier) override {
-		PathCountSearch<VecCount, VecLenBits, WeightType, SubkeyType> pathCountSearch(keyVerifier);
+		PathCountSearch<VecCount, VecLenBits, WeightType, SubkeyType> pathCountSearch(keyVerifier, KeyBatch<KeyLenBits>::DefaultBatchSize, this->cancellationToken);
+		pathCountSearch.setMemoryLimit(memoryBudgetBytes);
 		auto const start = std::chrono::high_resolution_clock::now();
-		pathCountSearch.searchWithANFForest(this->task, activeNodeFinder);
+		if(memoryBudgetBytes == 0) {
+			searchWithANF(this->task, pathCountSearch, this->remainingFirstSubkeys);
+		} else {
+			searchWithinBudget(this->task, pathCountSearch, keyVerifier);
+		}
 		auto const end = std::chrono::high_resolution_clock::now();
 		this->duration = std::chrono::duration<uint64_t, std::nano>(end - start);
 		// Check whether found the key
@@ -100,10 +203,189 @@ public:
 	}
 
 	std::string methodName() const override {
-		return "ANF/Forest";
+		return (forestLayout == FlatForestLayout) ? "ANF/FlatForest" : "ANF/Forest";
+	}
+
+	/**
+	 *
+	 * Splits the range of first subkey values.  Each half builds the path count graph for the remaining distinguishing vectors again, but
+	 * only merges and verifies the candidate keys for its own first subkeys.
+	 */
+	std::pair<std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>, std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>> split() const override {
+		if(!this->task.isSplittable()) {
+			return SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>::split();
+		}
+		auto const halves = this->task.splitByFirstSubkey();
+		BigInt<KeyLenBits> const lowerSize = this->expectedTaskSize / 2;
+		std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> lower(
+			new ANFForestSearchTaskRunner(halves.first, lowerSize, activeNodeFinder, forestLayout, arenaBlockSizeBytes, useHugePages, memoryBudgetBytes)
+		);
+		std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> upper(
+			new ANFForestSearchTaskRunner(halves.second, this->expectedTaskSize - lowerSize, activeNodeFinder, forestLayout, arenaBlockSizeBytes, useHugePages, memoryBudgetBytes)
+		);
+		return std::make_pair(std::move(lower), std::move(upper));
+	}
+
+	/**
+	 *
+	 * The runner split off uses the same forest layout and arena settings
+	 */
+	std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> splitRemainder() override {
+		BigInt<KeyLenBits> size(0);
+		auto const remainder = (memoryBudgetBytes == 0) ? this->splitRemainingTask(size) : std::unique_ptr<SearchTask<VecCount, VecLenBits, WeightType> const>();
+		if(remainder.get() == 0) {
+			return std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>();
+		}
+		return std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>(
+			new ANFForestSearchTaskRunner(*remainder, size, activeNodeFinder, forestLayout, arenaBlockSizeBytes, useHugePages, memoryBudgetBytes)
+		);
+	}
+
+	/**
+	 *
+	 * @return the representation used to store the candidate keys for this task
+	 */
+	ForestLayout getForestLayout() const {
+		return forestLayout;
+	}
+
+	/**
+	 *
+	 * @return the most memory the candidate keys of the task may use at once, or 0 for no limit
+	 */
+	uint64_t getMemoryBudget() const {
+		return memoryBudgetBytes;
+	}
+
+	uint64_t peakMemoryBytes() const override {
+		return arenaBytesReserved;
+	}
+
+	/**
+	 *
+	 * @return the number of weight bands searched with the ANF/Forest algorithm.  This is 1 unless the task was split to fit its memory
+	 * budget.  Only valid once the task has been processed.
+	 */
+	uint64_t getWeightBandCount() const {
+		return weightBandCount;
+	}
+
+	/**
+	 *
+	 * @return the number of single-weight bands that did not fit the memory budget and were searched with the Sorted algorithm instead.
+	 * Only valid once the task has been processed.
+	 */
+	uint64_t getSortedBandCount() const {
+		return sortedBandCount;
+	}
+
+	/**
+	 *
+	 * @return the largest number of bytes of candidate key trees (or flat forest nodes) allocated at once while processing the task.  Only
+	 * valid once the task has been processed.
+	 */
+	uint64_t getArenaBytesUsed() const {
+		return arenaBytesUsed;
+	}
+
+	/**
+	 *
+	 * @return the largest number of bytes the arena (or flat forest node store) requested from the system at once while processing the task.
+	 * Only valid once the task has been processed.
+	 */
+	uint64_t getArenaBytesReserved() const {
+		return arenaBytesReserved;
 	}
 private:
+	ANFForestSearchTaskRunner(SearchTask<VecCount, VecLenBits, WeightType> const & task, BigInt<KeyLenBits> expectedTaskSize, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder,
+			ForestLayout forestLayout, uint64_t arenaBlockSizeBytes, bool useHugePages, uint64_t memoryBudgetBytes)
+	: SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>(task, expectedTaskSize)
+	, activeNodeFinder(activeNodeFinder)
+	, forestLayout(forestLayout)
+	, arenaBlockSizeBytes(arenaBlockSizeBytes)
+	, useHugePages(useHugePages)
+	, memoryBudgetBytes(memoryBudgetBytes)
+	, arenaBytesUsed(0)
+	, arenaBytesReserved(0)
+	, weightBandCount(0)
+	, sortedBandCount(0)
+	{
+	}
+
 	ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder;
+	ForestLayout const forestLayout;
+	uint64_t const arenaBlockSizeBytes;
+	bool const useHugePages;
+	uint64_t const memoryBudgetBytes;
+	uint64_t arenaBytesUsed;
+	uint64_t arenaBytesReserved;
+	uint64_t weightBandCount;
+	uint64_t sortedBandCount;
+	// Built the first time a band falls back to the Sorted algorithm
+	std::unique_ptr<SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const> sortedWeightTable;
+
+	/**
+	 *
+	 * Search a whole task, or one weight band of it, with the ANF/Forest algorithm, verifying the first subkeys claimed from firstSubkeys
+	 */
+	void searchWithANF(SearchTask<VecCount, VecLenBits, WeightType> const & band, PathCountSearch<VecCount, VecLenBits, WeightType, SubkeyType> & pathCountSearch,
+			FirstSubkeyRange & firstSubkeys) {
+		weightBandCount++;
+		if(forestLayout == FlatForestLayout) {
+			FlatCandidateKeyStore<VecCount, VecLenBits, SubkeyType> store;
+			pathCountSearch.searchWithANFFlatForest(band, activeNodeFinder, store, firstSubkeys);
+			arenaBytesUsed = std::max(arenaBytesUsed, store.bytesUsed());
+			arenaBytesReserved = std::max(arenaBytesReserved, store.bytesReserved());
+		} else {
+			// The arena lives only for the duration of the band, and all trees are released together when it goes out of scope
+			Arena arena(arenaBlockSizeBytes, useHugePages);
+			pathCountSearch.searchWithANFForest(band, activeNodeFinder, arena, firstSubkeys);
+			arenaBytesUsed = std::max(arenaBytesUsed, arena.bytesUsed());
+			arenaBytesReserved = std::max(arenaBytesReserved, arena.bytesReserved());
+		}
+	}
+
+	/**
+	 *
+	 * Search a band with the ANF/Forest algorithm if it is estimated to fit the memory budget, and otherwise (or if the build exceeds the
+	 * budget after all) search its lower and upper halves separately.  Keys are only verified once a build has completed, so no key is
+	 * verified twice.
+	 */
+	void searchWithinBudget(SearchTask<VecCount, VecLenBits, WeightType> const & band, PathCountSearch<VecCount, VecLenBits, WeightType, SubkeyType> & pathCountSearch,
+			KeyVerifier<KeyLenBits> & keyVerifier) {
+		ANFMemoryEstimator<VecCount, VecLenBits, WeightType, SubkeyType> const estimator(band, activeNodeFinder);
+		uint64_t const estimatedBytes = (forestLayout == FlatForestLayout) ? estimator.flatForestBytes() : estimator.linkedForestBytes();
+		if(estimatedBytes <= memoryBudgetBytes) {
+			try {
+				FirstSubkeyRange bandSubkeys(band.getFirstSubkeyBegin(), band.getFirstSubkeyEnd());
+				searchWithANF(band, pathCountSearch, bandSubkeys);
+				return;
+			} catch(std::length_error const &) {
+				// The build outgrew the estimate; fall through and split the band
+			}
+		}
+		WeightType const minKeyWeight = band.getMinKeyWeight();
+		WeightType const maxKeyWeight = band.getMaxKeyWeight();
+		if(maxKeyWeight - minKeyWeight > 1) {
+			WeightType const middle = minKeyWeight + (maxKeyWeight - minKeyWeight) / 2;
+			SearchTask<VecCount, VecLenBits, WeightType> const lower(minKeyWeight, middle, band.getWeightTable(), band.getFirstSubkeyBegin(), band.getFirstSubkeyEnd());
+			SearchTask<VecCount, VecLenBits, WeightType> const upper(middle, maxKeyWeight, band.getWeightTable(), band.getFirstSubkeyBegin(), band.getFirstSubkeyEnd());
+			searchWithinBudget(lower, pathCountSearch, keyVerifier);
+			if(!isStopped(keyVerifier)) {
+				searchWithinBudget(upper, pathCountSearch, keyVerifier);
+			}
+		} else {
+			if(!sortedWeightTable) {
+				sortedWeightTable.reset(new SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType>(band.getWeightTable()));
+			}
+			sortedBandCount++;
+			pathCountSearch.searchWithSorted(band, *sortedWeightTable);
+		}
+	}
+
+	bool isStopped(KeyVerifier<KeyLenBits> & keyVerifier) const {
+		return keyVerifier.success() || (this->cancellationToken != 0 && this->cancellationToken->isCancelled());
+	}
 };
 
 } /*namespace search */
@@ -0,0 +1,340 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * CPUTopology.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_CPUTOPOLOGY_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_CPUTOPOLOGY_HPP_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * A logical CPU (hardware thread) and its position in the machine
+ */
+struct LogicalCPU {
+	// The operating system's index for the CPU, as used for thread affinity
+	uint32_t id;
+	// The physical package (socket)
+	uint32_t package;
+	// The physical core within the package.  Logical CPUs with the same package and core are SMT siblings.
+	uint32_t core;
+	// The NUMA node
+	uint32_t node;
+};
+
+/**
+ *
+ * Describes the logical CPUs, physical cores, packages and NUMA nodes of the host.
+ *
+ * On Linux the topology is read from /sys/devices/system.  Elsewhere, or if sysfs cannot be read, each of the std::thread::hardware_concurrency()
+ * logical CPUs is reported as a separate physical core on a single NUMA node.
+ */
+class CPUTopology {
+public:
+	/**
+	 *
+	 * @param cpus
+	 * @throws std::invalid_argument if cpus is empty
+	 */
+	CPUTopology(std::vector<LogicalCPU> const & cpus)
+	: cpus(cpus)
+	{
+		if(cpus.empty()) {
+			std::stringstream error;
+			error << "A CPU topology must contain at least one logical CPU";
+			throw std::invalid_argument(error.str().c_str());
+		}
+	}
+
+	~CPUTopology() {}
+
+	/**
+	 *
+	 * @return the topology of the host system
+	 */
+	static CPUTopology detect() {
+		std::vector<LogicalCPU> detected;
+		#ifdef __linux__
+			detected = readSysfs();
+		#endif
+		if(detected.empty()) {
+			uint32_t const count = std::max(std::thread::hardware_concurrency(), 1U);
+			for(uint32_t cpu = 0 ; cpu < count ; cpu++) {
+				LogicalCPU const logicalCPU = {cpu, 0, cpu, 0};
+				detected.push_back(logicalCPU);
+			}
+		}
+		return CPUTopology(detected);
+	}
+
+	/**
+	 *
+	 * Parse a Linux CPU list, such as "0-3,8,10-11"
+	 *
+	 * @param list
+	 * @return the CPU indices in the list, in order
+	 * @throws std::invalid_argument if the list is malformed
+	 */
+	static std::vector<uint32_t> parseCPUList(std::string const & list) {
+		std::vector<uint32_t> indices;
+		std::stringstream stream(list);
+		std::string range;
+		while(std::getline(stream, range, ',')) {
+			range.erase(std::remove_if(range.begin(), range.end(), [](char c) { return c == ' ' || c == '\n'; }), range.end());
+			if(range.empty()) {
+				continue;
+			}
+			std::size_t const dash = range.find('-');
+			uint32_t const first = parseIndex(range.substr(0, dash), list);
+			uint32_t const last = (dash == std::string::npos) ? first : parseIndex(range.substr(dash + 1), list);
+			if(last < first) {
+				std::stringstream error;
+				error << "Malformed CPU list '" << list << "'";
+				throw std::invalid_argument(error.str().c_str());
+			}
+			for(uint32_t index = first ; index <= last ; index++) {
+				indices.push_back(index);
+			}
+		}
+		return indices;
+	}
+
+	/**
+	 *
+	 * @return every logical CPU, ordered by id
+	 */
+	std::vector<LogicalCPU> const & logicalCPUs() const {
+		return cpus;
+	}
+
+	uint32_t logicalCPUCount() const {
+		return cpus.size();
+	}
+
+	uint32_t physicalCoreCount() const {
+		std::set<std::pair<uint32_t, uint32_t>> cores;
+		for(auto const & cpu : cpus) {
+			cores.insert(std::make_pair(cpu.package, cpu.core));
+		}
+		return cores.size();
+	}
+
+	uint32_t packageCount() const {
+		std::set<uint32_t> packages;
+		for(auto const & cpu : cpus) {
+			packages.insert(cpu.package);
+		}
+		return packages.size();
+	}
+
+	uint32_t nodeCount() const {
+		std::set<uint32_t> nodes;
+		for(auto const & cpu : cpus) {
+			nodes.insert(cpu.node);
+		}
+		return nodes.size();
+	}
+
+	/**
+	 *
+	 * @param cpuId
+	 * @return the NUMA node of the logical CPU
+	 * @throws std::invalid_argument if there is no such logical CPU
+	 */
+	uint32_t nodeOf(uint32_t cpuId) const {
+		for(auto const & cpu : cpus) {
+			if(cpu.id == cpuId) {
+				return cpu.node;
+			}
+		}
+		std::stringstream error;
+		error << "No logical CPU " << cpuId;
+		throw std::invalid_argument(error.str().c_str());
+	}
+
+	/**
+	 *
+	 * Orders the logical CPUs so that SMT siblings are avoided for as long as possible: the first logical CPU of every physical core, then
+	 * the second, and so on.  Within each round the physical cores are taken from each NUMA node in turn, so that consecutive PEUs are spread
+	 * across the nodes.  Taking the first physicalCoreCount() entries gives one logical CPU per physical core.
+	 *
+	 * @return logical CPU ids
+	 */
+	std::vector<uint32_t> physicalCoresFirst() const {
+		// Group the logical CPUs of each core, and the cores of each node
+		std::map<std::pair<uint32_t, uint32_t>, std::vector<uint32_t>> coreCPUs;
+		std::map<uint32_t, std::vector<std::pair<uint32_t, uint32_t>>> nodeCores;
+		for(auto const & cpu : cpus) {
+			auto const core = std::make_pair(cpu.package, cpu.core);
+			if(coreCPUs[core].empty()) {
+				nodeCores[cpu.node].push_back(core);
+			}
+			coreCPUs[core].push_back(cpu.id);
+		}
+		std::vector<uint32_t> order;
+		for(uint32_t sibling = 0 ; order.size() < cpus.size() ; sibling++) {
+			for(uint32_t coreIndex = 0 ; coreIndex < cpus.size() ; coreIndex++) {
+				for(auto const & node : nodeCores) {
+					if(coreIndex < node.second.size()) {
+						auto const & siblings = coreCPUs[node.second[coreIndex]];
+						if(sibling < siblings.size()) {
+							order.push_back(siblings[sibling]);
+						}
+					}
+				}
+			}
+		}
+		return order;
+	}
+
+	/**
+	 *
+	 * @return a human-readable description of the topology
+	 */
+	std::string report() const {
+		std::stringstream report;
+		report << logicalCPUCount() << " logical CPUs, " << physicalCoreCount() << " physical cores, " << packageCount() << " packages, ";
+		report << nodeCount() << " NUMA nodes" << std::endl;
+		std::map<uint32_t, std::vector<uint32_t>> nodeCPUs;
+		for(auto const & cpu : cpus) {
+			nodeCPUs[cpu.node].push_back(cpu.id);
+		}
+		for(auto const & node : nodeCPUs) {
+			report << "  node " << node.first << ": CPUs";
+			for(auto const cpu : node.second) {
+				report << " " << cpu;
+			}
+			report << std::endl;
+		}
+		return report.str();
+	}
+private:
+	std::vector<LogicalCPU> cpus;
+
+	static uint32_t parseIndex(std::string const & text, std::string const & list) {
+		if(text.empty() || text.find_first_not_of("0123456789") != std::string::npos) {
+			std::stringstream error;
+			error << "Malformed CPU list '" << list << "'";
+			throw std::invalid_argument(error.str().c_str());
+		}
+		return std::stoul(text);
+	}
+
+	static bool readFile(std::string const & path, std::string & contents) {
+		std::ifstream file(path.c_str());
+		if(!file) {
+			return false;
+		}
+		std::getline(file, contents);
+		return true;
+	}
+
+	/**
+	 *
+	 * @return the logical CPUs described by sysfs, or an empty vector if sysfs could not be read
+	 */
+	static std::vector<LogicalCPU> readSysfs() {
+		std::vector<LogicalCPU> detected;
+		try {
+			std::string contents;
+			if(!readFile("/sys/devices/system/cpu/online", contents)) {
+				return detected;
+			}
+			std::map<uint32_t, uint32_t> cpuNodes;
+			std::string nodeList;
+			if(readFile("/sys/devices/system/node/online", nodeList)) {
+				for(auto const node : parseCPUList(nodeList)) {
+					std::stringstream path;
+					path << "/sys/devices/system/node/node" << node << "/cpulist";
+					std::string cpuList;
+					if(readFile(path.str(), cpuList)) {
+						for(auto const cpu : parseCPUList(cpuList)) {
+							cpuNodes[cpu] = node;
+						}
+					}
+				}
+			}
+			for(auto const cpu : parseCPUList(contents)) {
+				std::stringstream prefix;
+				prefix << "/sys/devices/system/cpu/cpu" << cpu << "/topology/";
+				std::string package;
+				std::string core;
+				if(!readFile(prefix.str() + "physical_package_id", package) || !readFile(prefix.str() + "core_id", core)) {
+					return std::vector<LogicalCPU>();
+				}
+				LogicalCPU const logicalCPU = {
+					cpu,
+					static_cast<uint32_t>(std::stol(package) < 0 ? 0 : std::stol(package)),
+					static_cast<uint32_t>(std::stol(core) < 0 ? 0 : std::stol(core)),
+					cpuNodes.count(cpu) ? cpuNodes[cpu] : 0
+				};
+				detected.push_back(logicalCPU);
+			}
+		} catch(std::exception const &) {
+			return std::vector<LogicalCPU>();
+		}
+		return detected;
+	}
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_CPUTOPOLOGY_HPP_ */
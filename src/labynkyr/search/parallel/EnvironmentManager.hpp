@@ -48,6 +48,8 @@
 #ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_ENVIRONMENTMANAGER_HPP_
 #define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_ENVIRONMENTMANAGER_HPP_
 
+#include "labynkyr/search/parallel/CPUTopology.hpp"
+
 #include "labynkyr/BigInt.hpp"
 #include "labynkyr/BigReal.hpp"
 
@@ -59,6 +61,7 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace labynkyr {
 namespace search {
@@ -115,6 +118,24 @@ public:
 		}
 	}
 
+	/**
+	 *
+	 * Log the peak memory used to store candidate keys by each PEU
+	 *
+	 * @param peakBytesPerPEU indexed by PEU
+	 */
+	void logMemoryUsage(std::vector<uint64_t> const & peakBytesPerPEU) {
+		if(!suppressLogging) {
+			std::stringstream log;
+			log << "[INFO] Peak candidate key memory per PEU (MiB):";
+			for(auto const bytes : peakBytesPerPEU) {
+				log << " " << std::fixed << std::setprecision(1) << (static_cast<double>(bytes) / (1024.0 * 1024.0));
+			}
+			log << std::endl;
+			std::cout << log.str();
+		}
+	}
+
 	/**
 	 *
 	 * @param suppressLogging if set to true, logging information will not be printed to stdout
@@ -159,6 +180,28 @@ public:
 		return std::thread::hardware_concurrency();
 	}
 
+	/**
+	 *
+	 * Determine the logical CPUs, physical cores, packages and NUMA nodes of the system.  Use the result with PEUPlacement to pin PEUs.
+	 *
+	 * @return
+	 */
+	CPUTopology topology() const {
+		return CPUTopology::detect();
+	}
+
+	/**
+	 *
+	 * Log a description of the system topology
+	 */
+	void logTopology() const {
+		if(!suppressLogging) {
+			std::stringstream log;
+			log << "[INFO] Topology: " << topology().report();
+			std::cout << log.str();
+		}
+	}
+
 	/**
 	 *
 	 * @return the singleton EnvironmentManager instance
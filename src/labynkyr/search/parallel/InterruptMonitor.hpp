@@ -0,0 +1,131 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * InterruptMonitor.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_INTERRUPTMONITOR_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_INTERRUPTMONITOR_HPP_
+
+#include <signal.h>
+
+#include <csignal>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Catches SIGINT and SIGTERM so that a long-running search can write a final checkpoint before exiting, rather than being killed
+ * mid-search.  The signal handler only sets a flag; the WorkScheduler polls the flag on each tick.
+ *
+ * Only one set of handlers exists per process, so all members are static.
+ */
+class InterruptMonitor {
+public:
+	/**
+	 *
+	 * Lower the flag and install handlers for SIGINT and SIGTERM, saving the handlers they replace
+	 */
+	static void install() {
+		flag() = 0;
+		if(!installed()) {
+			struct sigaction action;
+			action.sa_handler = handleSignal;
+			sigemptyset(&action.sa_mask);
+			action.sa_flags = 0;
+			sigaction(SIGINT, &action, &previousActions()[0]);
+			sigaction(SIGTERM, &action, &previousActions()[1]);
+			installed() = true;
+		}
+	}
+
+	/**
+	 *
+	 * Restore the SIGINT and SIGTERM handlers that were in place when install() was called
+	 */
+	static void uninstall() {
+		if(installed()) {
+			sigaction(SIGINT, &previousActions()[0], 0);
+			sigaction(SIGTERM, &previousActions()[1], 0);
+			installed() = false;
+		}
+	}
+
+	/**
+	 *
+	 * @return true if SIGINT or SIGTERM has been received since install() was called
+	 */
+	static bool isInterrupted() {
+		return flag() != 0;
+	}
+private:
+	static volatile std::sig_atomic_t & flag() {
+		static volatile std::sig_atomic_t interrupted = 0;
+		return interrupted;
+	}
+
+	static bool & installed() {
+		static bool handlersInstalled = false;
+		return handlersInstalled;
+	}
+
+	/**
+	 *
+	 * @return the actions for SIGINT and SIGTERM saved by install()
+	 */
+	static struct sigaction * previousActions() {
+		static struct sigaction actions[2];
+		return actions;
+	}
+
+	static void handleSignal(int) {
+		flag() = 1;
+	}
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_INTERRUPTMONITOR_HPP_ */
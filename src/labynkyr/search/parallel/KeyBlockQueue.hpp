@@ -0,0 +1,195 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * KeyBlockQueue.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_KEYBLOCKQUEUE_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_KEYBLOCKQUEUE_HPP_
+
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * A bounded single-producer/single-consumer queue of candidate key blocks, used to hand keys from an enumerating PEU to a verifier thread.
+ * The blocks are preallocated, and the producer writes keys straight into the block at the tail while the consumer verifies the block at
+ * the head in place.  Neither side takes a lock or blocks: reserve() and front() return 0 when the queue is full or empty respectively.
+ *
+ * @tparam KeyLenBits the length of the key in bits
+ */
+template<uint32_t KeyLenBits>
+class KeyBlockQueue {
+public:
+	enum {
+		KeyLenBytes = KeyVerifier<KeyLenBits>::KeyLenBytes,
+		CacheLineBytes = 64
+	};
+
+	/**
+	 *
+	 * @param slotCount the number of blocks in the queue
+	 * @param blockKeys the maximum number of keys in each block
+	 * @throws std::invalid_argument if either is zero
+	 */
+	KeyBlockQueue(uint32_t slotCount, uint64_t blockKeys)
+	: slotCount(slotCount)
+	, blockKeys(blockKeys)
+	, keys(slotCount * blockKeys * KeyLenBytes)
+	, keyCounts(slotCount)
+	, head(0)
+	, tail(0)
+	{
+		if(slotCount == 0 || blockKeys == 0) {
+			std::stringstream error;
+			error << "A key block queue requires at least one block of at least one key.  Requested " << slotCount << " blocks of " << blockKeys << " keys";
+			throw std::invalid_argument(error.str().c_str());
+		}
+	}
+
+	~KeyBlockQueue() {}
+
+	/**
+	 *
+	 * Producer: the block at the tail of the queue, to write keys into
+	 *
+	 * @return the block, or 0 if the queue is full
+	 */
+	uint8_t * reserve() {
+		uint64_t const currentTail = tail.load(std::memory_order_relaxed);
+		if(currentTail - head.load(std::memory_order_acquire) == slotCount) {
+			return 0;
+		}
+		return keys.data() + (currentTail % slotCount) * blockKeys * KeyLenBytes;
+	}
+
+	/**
+	 *
+	 * Producer: add the block returned by the last call to reserve to the queue
+	 *
+	 * @param keyCount the number of keys written to the block
+	 */
+	void publish(uint64_t keyCount) {
+		uint64_t const currentTail = tail.load(std::memory_order_relaxed);
+		keyCounts[currentTail % slotCount] = keyCount;
+		tail.store(currentTail + 1, std::memory_order_release);
+	}
+
+	/**
+	 *
+	 * Consumer: the block at the head of the queue
+	 *
+	 * @param keyCount set to the number of keys in the block
+	 * @return the block, or 0 if the queue is empty
+	 */
+	uint8_t const * front(uint64_t & keyCount) const {
+		uint64_t const currentHead = head.load(std::memory_order_relaxed);
+		if(currentHead == tail.load(std::memory_order_acquire)) {
+			return 0;
+		}
+		keyCount = keyCounts[currentHead % slotCount];
+		return keys.data() + (currentHead % slotCount) * blockKeys * KeyLenBytes;
+	}
+
+	/**
+	 *
+	 * Consumer: remove the block at the head of the queue, once its keys have been verified
+	 */
+	void pop() {
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	/**
+	 *
+	 * @return true if every published block has been popped
+	 */
+	bool isEmpty() const {
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+
+	/**
+	 *
+	 * @return the maximum number of keys in each block
+	 */
+	uint64_t getBlockKeys() const {
+		return blockKeys;
+	}
+private:
+	uint32_t const slotCount;
+	uint64_t const blockKeys;
+	std::vector<uint8_t> keys;
+	std::vector<uint64_t> keyCounts;
+	// Each index is written by one side only, so they are kept on separate cache lines
+	uint8_t padding0[CacheLineBytes];
+	std::atomic<uint64_t> head;
+	uint8_t padding1[CacheLineBytes];
+	std::atomic<uint64_t> tail;
+	uint8_t padding2[CacheLineBytes];
+
+	/**
+	 *
+	 * Overriden copy constructor
+	 */
+	KeyBlockQueue(KeyBlockQueue<KeyLenBits> const & other);
+
+	/**
+	 *
+	 * Overriden assignment operator
+	 */
+	KeyBlockQueue<KeyLenBits> & operator=(KeyBlockQueue<KeyLenBits> const & other);
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_KEYBLOCKQUEUE_HPP_ */
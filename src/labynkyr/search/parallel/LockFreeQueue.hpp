@@ -0,0 +1,312 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * LockFreeQueue.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_LOCKFREEQUEUE_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_LOCKFREEQUEUE_HPP_
+
+#include "labynkyr/search/parallel/Queue.hpp"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * A multi-producer multi-consumer queue, usable wherever a Queue is expected.  Putting and taking items does not take a lock: each slot of
+ * a ring buffer carries a sequence number that tells producers and consumers whether it is free or full (after D. Vyukov's bounded MPMC
+ * queue).
+ *
+ * Like a Queue, put never blocks.  A producer that finds the ring buffer full places the item on an overflow list protected by a mutex, and
+ * later items follow it there until the consumers have emptied the list.  The ring buffer should be sized so that this is rare: a PEU that
+ * finishes a task must never wait for a consumer that may already have stopped taking from the queue.
+ *
+ * Only consumers that block in blockingTake use a mutex and condition variable, and producers only touch them when a consumer is waiting.
+ *
+ * @tparam T
+ */
+template<typename T>
+class LockFreeQueue : public Queue<T> {
+public:
+	enum {
+		DefaultCapacity = 1024,
+		CacheLineBytes = 64
+	};
+
+	LockFreeQueue()
+	: cells(new Cell[DefaultCapacity])
+	, mask(DefaultCapacity - 1)
+	, enqueuePosition(0)
+	, dequeuePosition(0)
+	, overflowCount(0)
+	, overflow()
+	, overflowMutex()
+	, waiterCount(0)
+	, wakeCount(0)
+	{
+		initialiseCells();
+	}
+
+	/**
+	 *
+	 * @param capacity the number of items held by the ring buffer
+	 * @throws std::invalid_argument if capacity is not a power of two of at least 2
+	 */
+	LockFreeQueue(uint64_t capacity)
+	: cells(0)
+	, mask(capacity - 1)
+	, enqueuePosition(0)
+	, dequeuePosition(0)
+	, overflowCount(0)
+	, overflow()
+	, overflowMutex()
+	, waiterCount(0)
+	, wakeCount(0)
+	{
+		if(capacity < 2 || (capacity & (capacity - 1)) != 0) {
+			std::stringstream error;
+			error << "Lock-free queue capacity must be a power of two of at least 2.  Requested " << capacity;
+			throw std::invalid_argument(error.str().c_str());
+		}
+		cells.reset(new Cell[capacity]);
+		initialiseCells();
+	}
+
+	~LockFreeQueue() {
+		T * item = tryTake();
+		while(item != 0) {
+			delete item;
+			item = tryTake();
+		}
+	}
+
+	void put(std::unique_ptr<T> obj) override {
+		// While items are overflowing, keep adding to the list so that they are taken in order
+		if(overflowCount.load() == 0 && tryPut(obj.get())) {
+			obj.release();
+		} else {
+			std::unique_lock<std::mutex> lock(overflowMutex);
+			overflow.push_back(std::move(obj));
+			overflowCount.fetch_add(1);
+		}
+		// Pairs with the increment of waiterCount in blockingTake: either the consumer sees the item, or this thread sees the consumer
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(waiterCount.load() > 0) {
+			std::unique_lock<std::mutex> lock(waitMutex);
+			itemAdded.notify_one();
+		}
+	}
+
+	std::unique_ptr<T> nonBlockingTake() override {
+		return std::unique_ptr<T>(tryTakeAny());
+	}
+
+	std::unique_ptr<T> blockingTake(std::chrono::nanoseconds timeout) override {
+		T * item = tryTakeAny();
+		if(item == 0) {
+			std::unique_lock<std::mutex> lock(waitMutex);
+			uint64_t const seenWakeCount = wakeCount;
+			waiterCount.fetch_add(1);
+			itemAdded.wait_for(lock, timeout, [&]() {
+				item = tryTakeAny();
+				return item != 0 || wakeCount != seenWakeCount;
+			});
+			waiterCount.fetch_sub(1);
+		}
+		return std::unique_ptr<T>(item);
+	}
+
+	void wakeWaiters() override {
+		std::unique_lock<std::mutex> lock(waitMutex);
+		wakeCount++;
+		itemAdded.notify_all();
+	}
+
+	/**
+	 *
+	 * @return true if the queue held no items at the moment of the call.  Items being put concurrently may or may not be seen.
+	 */
+	bool isEmpty() const override {
+		return enqueuePosition.load() == dequeuePosition.load() && overflowCount.load() == 0;
+	}
+
+	/**
+	 *
+	 * @return the number of items held by the ring buffer before further items overflow
+	 */
+	uint64_t capacity() const {
+		return mask + 1;
+	}
+
+	/**
+	 *
+	 * @return the number of items currently on the overflow list
+	 */
+	uint64_t overflowSize() const {
+		return overflowCount.load();
+	}
+private:
+	struct Cell {
+		std::atomic<uint64_t> sequence;
+		T * item;
+	};
+
+	std::unique_ptr<Cell[]> cells;
+	uint64_t const mask;
+	// Producers and consumers update different positions, so keep them on separate cache lines
+	uint8_t padding0[CacheLineBytes];
+	std::atomic<uint64_t> enqueuePosition;
+	uint8_t padding1[CacheLineBytes];
+	std::atomic<uint64_t> dequeuePosition;
+	uint8_t padding2[CacheLineBytes];
+
+	// Items put while the ring buffer was full.  The count lets producers and consumers skip the mutex while the list is empty.
+	std::atomic<uint64_t> overflowCount;
+	std::deque<std::unique_ptr<T>> overflow;
+	std::mutex overflowMutex;
+
+	std::atomic<uint32_t> waiterCount;
+	uint64_t wakeCount;
+	std::mutex waitMutex;
+	std::condition_variable itemAdded;
+
+	void initialiseCells() {
+		for(uint64_t index = 0 ; index <= mask ; index++) {
+			cells[index].sequence.store(index, std::memory_order_relaxed);
+			cells[index].item = 0;
+		}
+	}
+
+	bool tryPut(T * item) {
+		uint64_t position = enqueuePosition.load(std::memory_order_relaxed);
+		Cell * cell;
+		while(true) {
+			cell = &cells[position & mask];
+			uint64_t const sequence = cell->sequence.load(std::memory_order_acquire);
+			int64_t const difference = static_cast<int64_t>(sequence - position);
+			if(difference == 0) {
+				if(enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if(difference < 0) {
+				// Full
+				return false;
+			} else {
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+		cell->item = item;
+		cell->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	T * tryTake() {
+		uint64_t position = dequeuePosition.load(std::memory_order_relaxed);
+		Cell * cell;
+		while(true) {
+			cell = &cells[position & mask];
+			uint64_t const sequence = cell->sequence.load(std::memory_order_acquire);
+			int64_t const difference = static_cast<int64_t>(sequence - (position + 1));
+			if(difference == 0) {
+				if(dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if(difference < 0) {
+				// Empty
+				return 0;
+			} else {
+				position = dequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+		T * const item = cell->item;
+		cell->sequence.store(position + mask + 1, std::memory_order_release);
+		return item;
+	}
+
+	/**
+	 *
+	 * Take from the ring buffer, which holds the older items, and then from the overflow list
+	 */
+	T * tryTakeAny() {
+		T * const item = tryTake();
+		if(item != 0 || overflowCount.load() == 0) {
+			return item;
+		}
+		std::unique_lock<std::mutex> lock(overflowMutex);
+		if(overflow.empty()) {
+			return 0;
+		}
+		T * const overflowed = overflow.front().release();
+		overflow.pop_front();
+		overflowCount.fetch_sub(1);
+		return overflowed;
+	}
+
+	/**
+	 * Overriden copy constructor
+	 */
+	LockFreeQueue(LockFreeQueue const &);
+
+	/**
+	 * Overriden assignment operator
+	 */
+	LockFreeQueue & operator=(LockFreeQueue const &);
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_LOCKFREEQUEUE_HPP_ */
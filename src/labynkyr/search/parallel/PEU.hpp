@@ -50,11 +50,18 @@
 
 #include "labynkyr/search/parallel/Queue.hpp"
 #include "labynkyr/search/parallel/SearchTaskRunner.hpp"
+#include "labynkyr/search/parallel/ThreadAffinity.hpp"
+#include "labynkyr/search/parallel/WorkStealingQueues.hpp"
 #include "labynkyr/search/verify/KeyVerifier.hpp"
+#include "labynkyr/search/CancellationToken.hpp"
 
 #include <stdint.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <sstream>
 #include <stdexcept>
 #include <thread>
 
@@ -63,9 +70,22 @@ namespace search {
 
 /**
  *
- * A PEU operates in a single-thread managed by itself, and reads from a queue of SearchTasks to be executed sequentially on the thread.
+ * A PEU operates in a single-thread managed by itself, and reads from a queue of SearchTasks to be executed sequentially on the thread.  While
+ * the queue is empty the PEU blocks on it, rather than polling, and is woken as soon as a task is added or the PEU is stopped.  Once the
+ * search has been cancelled the PEU blocks until it is stopped.  The timed waits are only a safety net against a missed notification, and
+ * never shorter than MinIdleWaitNanoseconds, so an idle PEU uses no CPU.
  *
- * Each PEU is given a KeyVerifier instance that will be supplied to SearchTaskRunner instances.
+ * Each PEU is given a KeyVerifier instance that will be supplied to SearchTaskRunner instances.  A PEU may also be given a CancellationToken
+ * shared with the other PEUs in a pool; the token is handed to every SearchTaskRunner, and raised when this PEU finds the key.  Once the
+ * token is raised the PEU stops taking new tasks from the read queue.
+ *
+ * Alternatively, a PEU may read from a set of WorkStealingQueues shared with the other PEUs in a pool, in which case it takes tasks from its
+ * own deque and steals from the other PEUs' deques when its own is empty.  When other PEUs are idle, a PEU splits the task it has just taken
+ * (see SearchTaskRunner#split), keeps one half, and pushes the other half onto its own deque for an idle PEU to steal.  This keeps all PEUs
+ * busy towards the end of a search, when fewer tasks than PEUs remain.  While it processes a task, the PEU also publishes it to the
+ * WorkStealingQueues, so that a PEU which becomes idle later can split off the first subkeys not yet started (see
+ * SearchTaskRunner#splitRemainder).  The completed task is then narrowed to the part this PEU searched before it is placed on the write
+ * queue.
  *
  * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
  * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
@@ -76,10 +96,13 @@ template<uint32_t VecCount, uint32_t VecLenBits, typename WeightType, typename S
 class PEU {
 public:
 	enum {
-		KeyLenBits = VecCount * VecLenBits
+		KeyLenBits = VecCount * VecLenBits,
+		// The shortest time an idle PEU waits before re-checking its state without having been notified
+		MinIdleWaitNanoseconds = 100000000
 	};
 
 	using QueueType = Queue<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>;
+	using StealingQueuesType = WorkStealingQueues<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>;
 
 	/**
 	 *
@@ -105,20 +128,85 @@ public:
 	 * @param keyVerifier
 	 * @param readQueue the PEU will take fresh SearchTaskRunners to execute from this queue
 	 * @param writeQueue the PEU will place completed SearchTaskRunners on this queue
-	 * @param sleepNanoseconds when not processing a SearchTaskRunner, the PEU will check the read queue every sleepNanoseconds
+	 * @param sleepNanoseconds when not processing a SearchTaskRunner, the PEU waits for a task on the read queue for at most sleepNanoseconds
+	 * (but no less than MinIdleWaitNanoseconds) before checking whether it has been stopped, unless it is notified first
 	 */
 	PEU(uint32_t uuid, KeyVerifier<KeyLenBits> & keyVerifier, QueueType & readQueue, QueueType & writeQueue, uint64_t sleepNanoseconds)
 	: uuid(uuid)
 	, keyVerifier(keyVerifier)
-	, readQueue(readQueue)
+	, readQueue(&readQueue)
+	, stealingQueues(0)
+	, writeQueue(writeQueue)
+	, sleepNanoseconds(sleepNanoseconds)
+	, cancellationToken(0)
+	, pinnedCPU(-1)
+	, workerThread(0)
+	, isStop(true)
+	, exceptionThrown(false)
+	, peakMemoryBytes(0)
+	{
+	}
+
+	/**
+	 *
+	 * @param uuid
+	 * @param keyVerifier
+	 * @param readQueue the PEU will take fresh SearchTaskRunners to execute from this queue
+	 * @param writeQueue the PEU will place completed SearchTaskRunners on this queue
+	 * @param sleepNanoseconds when not processing a SearchTaskRunner, the PEU waits for a task on the read queue for at most sleepNanoseconds
+	 * (but no less than MinIdleWaitNanoseconds) before checking whether it has been stopped, unless it is notified first
+	 * @param cancellationToken a token shared with the other PEUs, used to stop in-flight tasks once any PEU finds the key
+	 */
+	PEU(uint32_t uuid, KeyVerifier<KeyLenBits> & keyVerifier, QueueType & readQueue, QueueType & writeQueue, uint64_t sleepNanoseconds,
+			CancellationToken & cancellationToken)
+	: uuid(uuid)
+	, keyVerifier(keyVerifier)
+	, readQueue(&readQueue)
+	, stealingQueues(0)
 	, writeQueue(writeQueue)
 	, sleepNanoseconds(sleepNanoseconds)
+	, cancellationToken(&cancellationToken)
+	, pinnedCPU(-1)
 	, workerThread(0)
 	, isStop(true)
 	, exceptionThrown(false)
+	, peakMemoryBytes(0)
 	{
 	}
 
+	/**
+	 *
+	 * @param uuid the index of this PEU's own deque within readQueues
+	 * @param keyVerifier
+	 * @param readQueues the PEU will take fresh SearchTaskRunners to execute from its own deque, or steal them from the other deques
+	 * @param writeQueue the PEU will place completed SearchTaskRunners on this queue
+	 * @param sleepNanoseconds when not processing a SearchTaskRunner, the PEU waits for a task on the read queues for at most sleepNanoseconds
+	 * (but no less than MinIdleWaitNanoseconds) before checking whether it has been stopped, unless it is notified first
+	 * @param cancellationToken a token shared with the other PEUs, used to stop in-flight tasks once any PEU finds the key
+	 * @throws std::invalid_argument if uuid is not a valid deque index
+	 */
+	PEU(uint32_t uuid, KeyVerifier<KeyLenBits> & keyVerifier, StealingQueuesType & readQueues, QueueType & writeQueue, uint64_t sleepNanoseconds,
+			CancellationToken & cancellationToken)
+	: uuid(uuid)
+	, keyVerifier(keyVerifier)
+	, readQueue(0)
+	, stealingQueues(&readQueues)
+	, writeQueue(writeQueue)
+	, sleepNanoseconds(sleepNanoseconds)
+	, cancellationToken(&cancellationToken)
+	, pinnedCPU(-1)
+	, workerThread(0)
+	, isStop(true)
+	, exceptionThrown(false)
+	, peakMemoryBytes(0)
+	{
+		if(uuid >= readQueues.workerCount()) {
+			std::stringstream error;
+			error << "PEU " << uuid << " has no deque in a set of " << readQueues.workerCount() << " work stealing queues";
+			throw std::invalid_argument(error.str().c_str());
+		}
+	}
+
 	virtual ~PEU() {}
 
 	/**
@@ -141,11 +229,41 @@ public:
 			// Then not already stopped
 			isStop = true;
 			lock.unlock();
+			stopRequested.notify_all();
+			// Interrupt the wait for a new task
+			wakeReaders();
 			workerThread->join();
 			delete workerThread;
 		}
 	}
 
+	/**
+	 *
+	 * Pin the PEU's thread to a logical CPU.  Must be called before processAsynchronously.
+	 *
+	 * @param cpu
+	 */
+	void pinToCPU(uint32_t cpu) {
+		pinnedCPU = cpu;
+	}
+
+	/**
+	 *
+	 * @return the logical CPU the PEU's thread is pinned to, or -1 if it is not pinned
+	 */
+	int64_t getPinnedCPU() const {
+		return pinnedCPU;
+	}
+
+	/**
+	 *
+	 * @return the largest number of bytes any task processed by this PEU reserved to store candidate keys (see SearchTaskRunner#peakMemoryBytes).
+	 * May be read while the PEU is running.
+	 */
+	uint64_t getPeakMemoryBytes() const {
+		return peakMemoryBytes.load();
+	}
+
 	uint32_t getUUID() const {
 		return uuid;
 	}
@@ -173,45 +291,142 @@ public:
 private:
 	uint32_t const uuid;
 	KeyVerifier<KeyLenBits> & keyVerifier;
-	QueueType & readQueue;
+	QueueType * readQueue;
+	StealingQueuesType * stealingQueues;
 	QueueType & writeQueue;
 	uint64_t const sleepNanoseconds;
+	CancellationToken * cancellationToken;
+	int64_t pinnedCPU;
 
 	std::thread *workerThread;
 	bool isStop;
 	std::mutex mutex;
+	std::condition_variable stopRequested;
 
 	bool exceptionThrown;
 	std::exception_ptr exceptionPtr;
+	std::atomic<uint64_t> peakMemoryBytes;
 
 	friend class PEUThreadRunner;
 
 	void run() {
+		// Pin before anything is allocated, so that the memory used by each task is local to the PEU's NUMA node
+		if(pinnedCPU >= 0) {
+			ThreadAffinity::pinCurrentThread(pinnedCPU);
+		}
+		bool isIdle = false;
 		while(true) {
 			std::unique_lock<std::mutex> lock(mutex);
 			if(isStop) {
 				lock.unlock();
 				break;
 			}
+			// Once the search has been cancelled there is no point taking more work: wait to be stopped
+			if(cancellationToken != 0 && cancellationToken->isCancelled()) {
+				stopRequested.wait_for(lock, idleWait(), [&]() { return isStop; });
+				continue;
+			}
 			lock.unlock();
 			// Can now query the queue
-			auto job = readQueue.nonBlockingTake();
+			auto job = takeJob();
+			if(stealingQueues != 0 && (job.get() == 0) != isIdle) {
+				isIdle = !isIdle;
+				stealingQueues->setIdle(isIdle);
+			}
 			if(job.get() != 0) {
+				if(stealingQueues != 0) {
+					job = shareJob(std::move(job));
+				}
 				// If we've got a SearchTaskRunnner to run, run it
 				try {
+					if(cancellationToken != 0) {
+						job->setCancellationToken(*cancellationToken);
+					}
+					if(stealingQueues != 0) {
+						auto * const running = job.get();
+						stealingQueues->setRunning(uuid, [running]() { return running->splitRemainder(); });
+					}
 					job->processSequentially(keyVerifier);
+					if(stealingQueues != 0) {
+						stealingQueues->clearRunning(uuid);
+						job->trimToRemainder();
+					}
+					if(job->peakMemoryBytes() > peakMemoryBytes.load()) {
+						peakMemoryBytes.store(job->peakMemoryBytes());
+					}
+					if(cancellationToken != 0 && cancellationToken->isCancelled()) {
+						job->setCancelled();
+					}
+					// The key may only be seen once the verifier is flushed at the end of the task
+					if(cancellationToken != 0 && job->isKeyFound()) {
+						cancellationToken->cancel();
+						// Idle PEUs are blocked on the read queues; wake them so that they see the cancellation
+						wakeReaders();
+					}
 					writeQueue.put(std::move(job));
 				} catch(std::exception const & ex) {
+					// The job is about to be destroyed, so no other PEU may split it any more
+					if(stealingQueues != 0) {
+						stealingQueues->clearRunning(uuid);
+					}
 					// The task execution failed, set the exception_ptr for read elsewhere
 					std::unique_lock<std::mutex> lock(mutex);
 					exceptionThrown = true;
 					exceptionPtr = std::current_exception();
 					lock.unlock();
+					// Anyone waiting on the write queue for a completed task should check for the exception now
+					writeQueue.wakeWaiters();
 				}
-			} else {
-				std::this_thread::sleep_for(std::chrono::nanoseconds(sleepNanoseconds));
 			}
 		}
+		if(isIdle) {
+			stealingQueues->setIdle(false);
+		}
+	}
+
+	std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> takeJob() {
+		if(stealingQueues != 0) {
+			return stealingQueues->take(uuid, idleWait());
+		}
+		return readQueue->blockingTake(idleWait());
+	}
+
+	/**
+	 *
+	 * @return the safety net timeout for waits that are otherwise ended by a notification
+	 */
+	std::chrono::nanoseconds idleWait() const {
+		return std::chrono::nanoseconds(std::max<uint64_t>(sleepNanoseconds, MinIdleWaitNanoseconds));
+	}
+
+	/**
+	 *
+	 * Wake every PEU blocked waiting for a task on the read queue(s)
+	 */
+	void wakeReaders() {
+		if(stealingQueues != 0) {
+			stealingQueues->wakeAll();
+		} else {
+			readQueue->wakeWaiters();
+		}
+	}
+
+	/**
+	 *
+	 * Split the job once for every idle PEU, keeping the lower half each time and leaving the upper halves on this PEU's deque to be stolen
+	 */
+	std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> shareJob(std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> job) {
+		uint32_t splitCount = 0;
+		while(splitCount < stealingQueues->idleCount()) {
+			auto halves = job->split();
+			if(halves.first.get() == 0) {
+				break;
+			}
+			stealingQueues->putLocal(uuid, std::move(halves.second));
+			job = std::move(halves.first);
+			splitCount++;
+		}
+		return job;
 	}
 };
 
@@ -0,0 +1,136 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * PEUPlacement.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_PEUPLACEMENT_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_PEUPLACEMENT_HPP_
+
+#include "labynkyr/search/parallel/CPUTopology.hpp"
+
+#include <stdint.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Describes which logical CPU, if any, each PEU in a PEUPool is pinned to.
+ *
+ * Pinned PEUs do not migrate between cores or sockets, and the memory they allocate while processing tasks (candidate key forests, arenas)
+ * is placed on their own NUMA node.  The PEUPool also allocates each KeyVerifier on the node of the first PEU that uses it.
+ */
+class PEUPlacement {
+public:
+	/**
+	 *
+	 * PEUs are not pinned, and the operating system schedules them freely
+	 */
+	PEUPlacement()
+	: cpus()
+	{
+	}
+
+	/**
+	 *
+	 * @param cpus PEU i is pinned to logical CPU cpus[i % cpus.size()]
+	 * @throws std::invalid_argument if cpus is empty
+	 */
+	PEUPlacement(std::vector<uint32_t> const & cpus)
+	: cpus(cpus)
+	{
+		if(cpus.empty()) {
+			std::stringstream error;
+			error << "A pinned PEU placement requires at least one logical CPU";
+			throw std::invalid_argument(error.str().c_str());
+		}
+	}
+
+	~PEUPlacement() {}
+
+	/**
+	 *
+	 * Pin PEUs to one logical CPU per physical core, spread across the NUMA nodes, so that no two PEUs share a core while there are
+	 * physical cores to spare.  Additional PEUs are placed on SMT siblings.
+	 *
+	 * @param topology
+	 * @return the placement
+	 */
+	static PEUPlacement physicalCoresFirst(CPUTopology const & topology) {
+		return PEUPlacement(topology.physicalCoresFirst());
+	}
+
+	/**
+	 *
+	 * @return true if PEUs are pinned to logical CPUs
+	 */
+	bool isPinned() const {
+		return !cpus.empty();
+	}
+
+	/**
+	 *
+	 * @param peuIndex
+	 * @return the logical CPU for the PEU
+	 * @throws std::logic_error if the placement is not pinned
+	 */
+	uint32_t cpuFor(uint32_t peuIndex) const {
+		if(!isPinned()) {
+			throw std::logic_error("PEUs are not pinned to logical CPUs");
+		}
+		return cpus[peuIndex % cpus.size()];
+	}
+private:
+	std::vector<uint32_t> cpus;
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_PEUPLACEMENT_HPP_ */
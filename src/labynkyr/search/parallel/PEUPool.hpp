@@ -48,10 +48,18 @@
 #ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_PEUPOOL_HPP_
 #define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_PEUPOOL_HPP_
 
+#include "labynkyr/search/parallel/LockFreeQueue.hpp"
 #include "labynkyr/search/parallel/PEU.hpp"
+#include "labynkyr/search/parallel/PEUPlacement.hpp"
+#include "labynkyr/search/parallel/PipelinedKeyVerifier.hpp"
 #include "labynkyr/search/parallel/Queue.hpp"
 #include "labynkyr/search/parallel/SearchTaskRunner.hpp"
+#include "labynkyr/search/parallel/ThreadAffinity.hpp"
+#include "labynkyr/search/parallel/VerifierPipeline.hpp"
+#include "labynkyr/search/parallel/VerifierThread.hpp"
+#include "labynkyr/search/parallel/WorkStealingQueues.hpp"
 #include "labynkyr/search/verify/KeyVerifier.hpp"
+#include "labynkyr/search/CancellationToken.hpp"
 
 #include <stdint.h>
 
@@ -66,10 +74,30 @@
 namespace labynkyr {
 namespace search {
 
+/**
+ *
+ * Selects the implementation of the queue PEUs place completed SearchTaskRunners on
+ */
+enum QueueImplementation {
+	// Queue: a std::queue protected by a mutex
+	LockingQueueImplementation,
+	// LockFreeQueue: a ring buffer that producers and consumers access without taking a lock, overflowing onto a locked list when full
+	LockFreeQueueImplementation
+};
+
 /**
  *
  * A PEUPool encapsulates a group of PEUs
  *
+ * All PEUs in the pool share a single CancellationToken.  The token is raised as soon as any PEU's verifier finds the key, at which point
+ * every in-flight SearchTaskRunner returns within one batch of keys (or one column of the ANF graph), rather than running to completion.
+ * The token is also given to each KeyVerifier, so that a verifier blocked waiting on another process is released when the PEUs are stopped.
+ *
+ * Tasks are distributed across a set of WorkStealingQueues, one deque per PEU.  A PEU whose deque runs dry steals from the others, and a
+ * PEU that takes a task while other PEUs are idle splits it with them.
+ *
+ * Verification is synchronous by default, or may be pipelined onto a separate set of verifier threads (see VerifierPipeline).
+ *
  * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
  * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
  * @tparam WeightType the integer type used to store weights (e.g uint32_t)
@@ -83,57 +111,149 @@ public:
 	};
 
 	using QueueType = Queue<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>;
+	using StealingQueuesType = WorkStealingQueues<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>;
 
 	/**
 	 *
 	 * @param peuCount the number of PEUs to instantiate.  This should typically correspond to the number of physical cores on the host system.
 	 * @param verifierFactory a factory for building KeyVerifier instances
-	 * @param verifierCount the number of KeyVerifiers to instance.  If this is the same as peuCount, each PEU will get its own verifier.  This
-	 * is the fastest approach we've tested so far.  You can also specify a number that divides peuCount -- e.g. given 4 PEUs, you can specify
-	 * 2 verifiers, and each PEU will share a verifier instance with one other PEU.
-	 * @param peuSleepNanoseconds when not processing a SearchTaskRunner, the PEU will check the read queue every peuSleepNanoseconds
+	 * @param verifierCount the number of KeyVerifiers to instance, between 1 and peuCount.  If this is the same as peuCount, each PEU will get its
+	 * own verifier.  This is the fastest approach we've tested so far.  Otherwise the PEUs are divided into verifierCount groups of consecutive
+	 * PEUs, as evenly as possible, and the PEUs in each group share a verifier instance -- e.g. given 4 PEUs, you can specify 2 verifiers, and
+	 * each PEU will share a verifier instance with one other PEU.
+	 * @param peuSleepNanoseconds when not processing a SearchTaskRunner, a PEU waits for a task for at most peuSleepNanoseconds before
+	 * checking whether it has been stopped.  PEUs are woken as soon as a task is added, so this only bounds the time taken to stop.
 	 * @throws std::invalid_argument
 	 */
 	PEUPool(uint32_t peuCount, KeyVerifierFactory<KeyLenBits> & verifierFactory, uint32_t verifierCount, uint64_t peuSleepNanoseconds)
-	: verifiers(verifierCount)
+	: PEUPool(peuCount, verifierFactory, verifierCount, peuSleepNanoseconds, LockingQueueImplementation)
+	{
+	}
+
+	/**
+	 *
+	 * @param peuCount the number of PEUs to instantiate.  This should typically correspond to the number of physical cores on the host system.
+	 * @param verifierFactory a factory for building KeyVerifier instances
+	 * @param verifierCount the number of KeyVerifiers to instance, between 1 and peuCount
+	 * @param peuSleepNanoseconds when not processing a SearchTaskRunner, a PEU waits for a task for at most peuSleepNanoseconds before
+	 * checking whether it has been stopped
+	 * @param writeQueueImplementation the implementation of the queue completed SearchTaskRunners are placed on
+	 * @throws std::invalid_argument
+	 */
+	PEUPool(uint32_t peuCount, KeyVerifierFactory<KeyLenBits> & verifierFactory, uint32_t verifierCount, uint64_t peuSleepNanoseconds,
+			QueueImplementation writeQueueImplementation)
+	: PEUPool(peuCount, verifierFactory, verifierCount, peuSleepNanoseconds, writeQueueImplementation, PEUPlacement())
+	{
+	}
+
+	/**
+	 *
+	 * @param peuCount the number of PEUs to instantiate.  This should typically correspond to the number of physical cores on the host system.
+	 * @param verifierFactory a factory for building KeyVerifier instances
+	 * @param verifierCount the number of KeyVerifiers to instance, between 1 and peuCount
+	 * @param peuSleepNanoseconds when not processing a SearchTaskRunner, a PEU waits for a task for at most peuSleepNanoseconds before
+	 * checking whether it has been stopped
+	 * @param writeQueueImplementation the implementation of the queue completed SearchTaskRunners are placed on
+	 * @param placement the logical CPUs the PEUs are pinned to.  If pinned, each KeyVerifier is allocated while the constructing thread is
+	 * temporarily pinned to the CPU of the first PEU using it, so that it is local to that PEU's NUMA node.
+	 * @throws std::invalid_argument
+	 */
+	PEUPool(uint32_t peuCount, KeyVerifierFactory<KeyLenBits> & verifierFactory, uint32_t verifierCount, uint64_t peuSleepNanoseconds,
+			QueueImplementation writeQueueImplementation, PEUPlacement const & placement)
+	: PEUPool(peuCount, verifierFactory, verifierCount, peuSleepNanoseconds, writeQueueImplementation, placement, VerifierPipeline())
+	{
+	}
+
+	/**
+	 *
+	 * @param peuCount the number of PEUs to instantiate.  This should typically correspond to the number of physical cores on the host system.
+	 * @param verifierFactory a factory for building KeyVerifier instances
+	 * @param verifierCount if verification is synchronous, the number of KeyVerifiers to instance, between 1 and peuCount.  If verification is
+	 * pipelined, the number of verifier threads, each with its own KeyVerifier.  Any positive number of verifier threads may be used: if
+	 * there are fewer threads than PEUs, each thread serves a group of consecutive PEUs, and if there are more, each PEU is served by a group
+	 * of consecutive threads.  The groups are as even as possible.
+	 * @param peuSleepNanoseconds when not processing a SearchTaskRunner, a PEU waits for a task for at most peuSleepNanoseconds before
+	 * checking whether it has been stopped
+	 * @param writeQueueImplementation the implementation of the queue completed SearchTaskRunners are placed on
+	 * @param placement the logical CPUs the PEUs are pinned to.  If pinned, each KeyVerifier is allocated while the constructing thread is
+	 * temporarily pinned to the CPU of the first PEU using it, so that it is local to that PEU's NUMA node.  Verifier threads are not pinned.
+	 * @param pipeline whether verification is synchronous or pipelined
+	 * @throws std::invalid_argument
+	 */
+	PEUPool(uint32_t peuCount, KeyVerifierFactory<KeyLenBits> & verifierFactory, uint32_t verifierCount, uint64_t peuSleepNanoseconds,
+			QueueImplementation writeQueueImplementation, PEUPlacement const & placement, VerifierPipeline const & pipeline)
+	: readQueues(peuCount)
+	, writeQueue(newQueue(writeQueueImplementation))
+	, verifiers()
 	, peus(peuCount)
+	, verifierThreads()
 	{
 		// Check parameters are ok
-		if(peuCount % verifierCount != 0) {
+		if(verifierCount == 0 || (!pipeline.isPipelined() && verifierCount > peuCount)) {
 			std::stringstream error;
-			error << "Number of verifiers must divide the number of PEUs (verifiers must be distributed evenly).  Requested ";
+			error << "Number of verifiers must be between 1 and the number of PEUs.  Requested ";
 			error << peuCount << " PEUs, requested " << verifierCount << " verifiers";
 			throw std::invalid_argument(error.str().c_str());
 		}
-		// Instantiate the set of verifiers
+		// Instantiate the set of verifiers, or of verifier threads and the PEUs' pipelined verifiers
 		for(uint32_t verifierIndex = 0 ; verifierIndex < verifierCount ; verifierIndex++) {
+			std::unique_ptr<ScopedThreadAffinity> affinity;
+			if(placement.isPinned()) {
+				affinity.reset(new ScopedThreadAffinity(placement.cpuFor(firstPEUServed(verifierIndex, peuCount, verifierCount))));
+			}
 			auto verifier = verifierFactory.newVerifier();
-			verifiers[verifierIndex] = std::move(verifier);
+			verifier->setCancellationToken(cancellationToken);
+			if(pipeline.isPipelined()) {
+				verifierThreads.push_back(std::unique_ptr<VerifierThread<KeyLenBits>>(new VerifierThread<KeyLenBits>(std::move(verifier))));
+			} else {
+				verifiers.push_back(std::move(verifier));
+			}
+		}
+		if(pipeline.isPipelined()) {
+			for(uint32_t peuIndex = 0 ; peuIndex < peuCount ; peuIndex++) {
+				std::vector<VerifierThread<KeyLenBits> *> peuVerifierThreads;
+				for(uint32_t verifierIndex = 0 ; verifierIndex < verifierCount ; verifierIndex++) {
+					if(isServedBy(peuIndex, verifierIndex, peuCount, verifierCount)) {
+						peuVerifierThreads.push_back(verifierThreads[verifierIndex].get());
+					}
+				}
+				auto * verifier = new PipelinedKeyVerifier<KeyLenBits>(peuVerifierThreads, pipeline.getSlotCount(), pipeline.getBlockKeys());
+				verifier->setCancellationToken(cancellationToken);
+				verifiers.push_back(std::unique_ptr<KeyVerifier<KeyLenBits>>(verifier));
+			}
 		}
 		// Instantiate the set of PEUs
-		uint32_t const peusPerVerifier = peuCount / verifierCount;
-		uint32_t nextVerifierIndex = 0;
-		uint32_t currentVerifierAssignedCount = 0;
 		for(uint32_t peuIndex = 0 ; peuIndex < peuCount ; peuIndex++) {
-			// Check if new verifier needed
-			nextVerifierIndex = (currentVerifierAssignedCount == peusPerVerifier) ? nextVerifierIndex + 1 : nextVerifierIndex;
-			currentVerifierAssignedCount = currentVerifierAssignedCount % peusPerVerifier;
-			auto & verifier = *verifiers[nextVerifierIndex].get();
-			auto * peu = new PEU<VecCount, VecLenBits, WeightType, SubkeyType>(peuIndex, verifier, readQueue, writeQueue, peuSleepNanoseconds);
+			uint32_t const verifierIndex = pipeline.isPipelined() ? peuIndex : static_cast<uint64_t>(peuIndex) * verifierCount / peuCount;
+			auto & verifier = *verifiers[verifierIndex].get();
+			auto * peu = new PEU<VecCount, VecLenBits, WeightType, SubkeyType>(peuIndex, verifier, readQueues, *writeQueue, peuSleepNanoseconds, cancellationToken);
+			if(placement.isPinned()) {
+				peu->pinToCPU(placement.cpuFor(peuIndex));
+			}
 			std::unique_ptr<PEU<VecCount, VecLenBits, WeightType, SubkeyType>> peuPtr(peu);
 			peus[peuIndex] = std::move(peuPtr);
-			// Update counters
-			currentVerifierAssignedCount++;
 		}
 	}
 
-	virtual ~PEUPool() {}
+	/**
+	 *
+	 * Any verifier threads are stopped before the PEUs' pipelined verifiers, and the queues they consume, are destroyed
+	 */
+	virtual ~PEUPool() {
+		for(auto & verifierThread : verifierThreads) {
+			verifierThread->stop();
+		}
+	}
 
 	/**
 	 *
 	 * Start all PEUs listening for work
 	 */
 	void processAllPEUsAsynchronously() {
+		cancellationToken.reset();
+		for(auto & verifierThread : verifierThreads) {
+			verifierThread->start();
+		}
 		for(auto & peu : peus) {
 			peu->processAsynchronously();
 		}
@@ -141,10 +261,10 @@ public:
 
 	/**
 	 *
-	 * @param task place a new SearchTaskRunner on the read queue for the PEUs
+	 * @param task place a new SearchTaskRunner on the read queues for the PEUs.  Tasks are spread over the PEUs' deques in round-robin order.
 	 */
 	void addTasking(std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> task) {
-		readQueue.put(std::move(task));
+		readQueues.put(std::move(task));
 	}
 
 	/**
@@ -152,22 +272,27 @@ public:
 	 * @return the write queue completed SearchTaskRunner instances will be placed on
 	 */
 	Queue<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> & getWriteQueue() {
-		return writeQueue;
+		return *writeQueue;
 	}
 
 	/**
 	 *
-	 * Stop all PEUs from listening for work
+	 * Stop all PEUs from listening for work.  Any in-flight tasks are cancelled, rather than waited for.
 	 */
 	void stopAllPEUs() {
+		cancellationToken.cancel();
 		for(auto & peu : peus) {
 			peu->stop();
 		}
+		// Only once the PEUs have stopped, as a PEU may be waiting for a verifier thread to drain its queues
+		for(auto & verifierThread : verifierThreads) {
+			verifierThread->stop();
+		}
 	}
 
 	/**
 	 *
-	 * @throws std::exception if any PEU has caught an exception.  This exception will be re-thrown in this function call.
+	 * @throws std::exception if any PEU or verifier thread has caught an exception.  This exception will be re-thrown in this function call.
 	 */
 	void checkForThrownExceptions() {
 		for(auto & peu : peus) {
@@ -175,11 +300,17 @@ public:
 				std::rethrow_exception(peu->getExceptionPtr());
 			}
 		}
+		for(auto & verifierThread : verifierThreads) {
+			if(verifierThread->isExceptionThrown()) {
+				std::rethrow_exception(verifierThread->getExceptionPtr());
+			}
+		}
 	}
 
 	/**
 	 *
-	 * @return the set of KeyVerifier instances instantiated for the group of PEUs
+	 * @return the set of KeyVerifier instances used by the group of PEUs.  If verification is pipelined, these are the PEUs' PipelinedKeyVerifiers,
+	 * one per PEU.
 	 */
 	std::vector<std::unique_ptr<KeyVerifier<KeyLenBits>>> & getVerifiers() {
 		return verifiers;
@@ -213,6 +344,18 @@ public:
 		);
 	}
 
+	/**
+	 *
+	 * @return for each PEU, the largest number of bytes any of its tasks reserved to store candidate keys
+	 */
+	std::vector<uint64_t> peakMemoryBytes() const {
+		std::vector<uint64_t> peakBytes;
+		for(auto const & peu : peus) {
+			peakBytes.push_back(peu->getPeakMemoryBytes());
+		}
+		return peakBytes;
+	}
+
 	/**
 	 *
 	 * @return the value of the correct key, if found
@@ -227,6 +370,14 @@ public:
 		throw std::logic_error("The PEUs in this pool did not find the correct key");
 	}
 
+	/**
+	 *
+	 * @return the token shared by all PEUs in the pool
+	 */
+	CancellationToken & getCancellationToken() {
+		return cancellationToken;
+	}
+
 	uint32_t peuCount() const {
 		return peus.size();
 	}
@@ -235,10 +386,38 @@ public:
 		return peus;
 	}
 private:
-	QueueType readQueue;
-	QueueType writeQueue;
+	StealingQueuesType readQueues;
+	std::unique_ptr<QueueType> writeQueue;
+	CancellationToken cancellationToken;
 	std::vector<std::unique_ptr<KeyVerifier<KeyLenBits>>> verifiers;
 	std::vector<std::unique_ptr<PEU<VecCount, VecLenBits, WeightType, SubkeyType>>> peus;
+	std::vector<std::unique_ptr<VerifierThread<KeyLenBits>>> verifierThreads;
+
+	/**
+	 *
+	 * @return true if PEU peuIndex is served by verifier (or verifier thread) verifierIndex
+	 */
+	static bool isServedBy(uint32_t peuIndex, uint32_t verifierIndex, uint32_t peuCount, uint32_t verifierCount) {
+		if(verifierCount >= peuCount) {
+			return static_cast<uint64_t>(verifierIndex) * peuCount / verifierCount == peuIndex;
+		}
+		return static_cast<uint64_t>(peuIndex) * verifierCount / peuCount == verifierIndex;
+	}
+
+	static uint32_t firstPEUServed(uint32_t verifierIndex, uint32_t peuCount, uint32_t verifierCount) {
+		uint32_t peuIndex = 0;
+		while(!isServedBy(peuIndex, verifierIndex, peuCount, verifierCount)) {
+			peuIndex++;
+		}
+		return peuIndex;
+	}
+
+	static QueueType * newQueue(QueueImplementation implementation) {
+		if(implementation == LockFreeQueueImplementation) {
+			return new LockFreeQueue<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>();
+		}
+		return new QueueType();
+	}
 };
 
 } /* namespace search */
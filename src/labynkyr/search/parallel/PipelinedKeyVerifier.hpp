@@ -0,0 +1,272 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * PipelinedKeyVerifier.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_PIPELINEDKEYVERIFIER_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_PIPELINEDKEYVERIFIER_HPP_
+
+#include "labynkyr/search/parallel/KeyBlockQueue.hpp"
+#include "labynkyr/search/parallel/VerifierThread.hpp"
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+#include "labynkyr/search/CancellationToken.hpp"
+
+#include "labynkyr/Key.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * The KeyVerifier a PEU enumerates into when verification is pipelined (see VerifierPipeline).  Candidate keys are copied into blocks on
+ * one KeyBlockQueue per VerifierThread serving the PEU, and verified on those threads while the PEU carries on enumerating.  Full blocks
+ * go to the first queue with a free slot, starting after the queue last used, so the blocks are spread over the verifier threads; the PEU
+ * only waits when every queue is full.
+ *
+ * flush() publishes any partially filled block and waits until every queue has been drained, so success() is accurate after a flush, as
+ * the SearchTaskRunners require.  Must only be used by one thread.
+ *
+ * Once the CancellationToken given by setCancellationToken is raised, checkKeys and flush stop waiting for the verifier threads, and later
+ * keys are dropped, so that a PEU stopped in the middle of a task is not held up by blocks that will never be verified.
+ *
+ * If a verifier thread serving the PEU fails, the exception it caught is rethrown by checkKeys and flush rather than waiting for the
+ * thread's queue to drain.
+ *
+ * @tparam KeyLenBits the length of the key in bits
+ */
+template<uint32_t KeyLenBits>
+class PipelinedKeyVerifier : public KeyVerifier<KeyLenBits> {
+public:
+	/**
+	 *
+	 * @param verifierThreads the threads that will verify the keys.  A queue is created for, and added to, each of them, so they must
+	 * not be running.
+	 * @param slotCount the number of blocks in each queue
+	 * @param blockKeys the maximum number of keys in each block
+	 * @throws std::invalid_argument if verifierThreads is empty
+	 */
+	PipelinedKeyVerifier(std::vector<VerifierThread<KeyLenBits> *> const & verifierThreads, uint32_t slotCount, uint64_t blockKeys)
+	: KeyVerifier<KeyLenBits>()
+	, verifierThreads(verifierThreads)
+	, queues()
+	, queueIndex(0)
+	, block(0)
+	, blockKeyCount(0)
+	, blockKeys(blockKeys)
+	, count(0)
+	, cancellationToken(0)
+	{
+		if(verifierThreads.empty()) {
+			throw std::invalid_argument("A pipelined key verifier requires at least one verifier thread");
+		}
+		for(auto * verifierThread : verifierThreads) {
+			std::unique_ptr<KeyBlockQueue<KeyLenBits>> queue(new KeyBlockQueue<KeyLenBits>(slotCount, blockKeys));
+			verifierThread->addQueue(*queue);
+			queues.push_back(std::move(queue));
+		}
+	}
+
+	~PipelinedKeyVerifier() {}
+
+	void checkKey(std::vector<uint8_t> const & candidateKeyBytes) override {
+		checkKeys(candidateKeyBytes.data(), 1);
+	}
+
+	void checkKeys(uint8_t const * candidateKeys, uint64_t keyCount) override {
+		uint32_t const keyLenBytes = KeyVerifier<KeyLenBits>::KeyLenBytes;
+		count += keyCount;
+		while(keyCount > 0) {
+			if(block == 0) {
+				block = reserve();
+				if(block == 0) {
+					// The key has been found or the search cancelled: there is no need to verify the rest
+					return;
+				}
+			}
+			uint64_t const keysToCopy = std::min(keyCount, blockKeys - blockKeyCount);
+			std::copy(candidateKeys, candidateKeys + keysToCopy * keyLenBytes, block + blockKeyCount * keyLenBytes);
+			blockKeyCount += keysToCopy;
+			candidateKeys += keysToCopy * keyLenBytes;
+			keyCount -= keysToCopy;
+			if(blockKeyCount == blockKeys) {
+				publish();
+			}
+		}
+	}
+
+	/**
+	 *
+	 * @return the number of keys passed to this verifier
+	 */
+	uint64_t keysChecked() const override {
+		return count;
+	}
+
+	bool success() const override {
+		for(auto const * verifierThread : verifierThreads) {
+			if(verifierThread->isFound()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	Key<KeyLenBits> correctKey() override {
+		for(auto const * verifierThread : verifierThreads) {
+			if(verifierThread->isFound()) {
+				return verifierThread->correctKey();
+			}
+		}
+		throw std::logic_error("Key has not been found");
+	}
+
+	/**
+	 *
+	 * Publish any partially filled block, and wait until the verifier threads have verified every key sent so far
+	 */
+	void flush() override {
+		publish();
+		for(auto const & queue : queues) {
+			while(!queue->isEmpty() && !success() && !isCancelled()) {
+				checkForThrownExceptions();
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	/**
+	 *
+	 * Stop waiting for the verifier threads once the token is raised
+	 *
+	 * @param cancellationToken
+	 */
+	void setCancellationToken(CancellationToken & cancellationToken) override {
+		this->cancellationToken = &cancellationToken;
+	}
+private:
+	std::vector<VerifierThread<KeyLenBits> *> const verifierThreads;
+	std::vector<std::unique_ptr<KeyBlockQueue<KeyLenBits>>> queues;
+	uint32_t queueIndex;
+	uint8_t * block;
+	uint64_t blockKeyCount;
+	uint64_t const blockKeys;
+	uint64_t count;
+	// Null unless set by setCancellationToken
+	CancellationToken * cancellationToken;
+
+	/**
+	 *
+	 * Overriden copy constructor
+	 */
+	PipelinedKeyVerifier(PipelinedKeyVerifier<KeyLenBits> const & other);
+
+	/**
+	 *
+	 * Overriden assignment operator
+	 */
+	PipelinedKeyVerifier<KeyLenBits> & operator=(PipelinedKeyVerifier<KeyLenBits> const & other);
+
+	/**
+	 *
+	 * Wait for a free block on any queue, starting with the queue after the one last published to
+	 *
+	 * @return the block, or 0 if the key has been found or the search cancelled
+	 */
+	uint8_t * reserve() {
+		while(true) {
+			for(uint32_t attempt = 0 ; attempt < queues.size() ; attempt++) {
+				uint8_t * const freeBlock = queues[queueIndex]->reserve();
+				if(freeBlock != 0) {
+					return freeBlock;
+				}
+				queueIndex = (queueIndex + 1) % queues.size();
+			}
+			if(success() || isCancelled()) {
+				return 0;
+			}
+			checkForThrownExceptions();
+			std::this_thread::yield();
+		}
+	}
+
+	/**
+	 *
+	 * @throws std::exception the exception caught by any failed verifier thread, as its queue will never be drained
+	 */
+	void checkForThrownExceptions() const {
+		for(auto const * verifierThread : verifierThreads) {
+			if(verifierThread->isExceptionThrown()) {
+				std::rethrow_exception(verifierThread->getExceptionPtr());
+			}
+		}
+	}
+
+	bool isCancelled() const {
+		return cancellationToken != 0 && cancellationToken->isCancelled();
+	}
+
+	void publish() {
+		if(block != 0 && blockKeyCount > 0) {
+			queues[queueIndex]->publish(blockKeyCount);
+			queueIndex = (queueIndex + 1) % queues.size();
+			block = 0;
+			blockKeyCount = 0;
+		}
+	}
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_PIPELINEDKEYVERIFIER_HPP_ */
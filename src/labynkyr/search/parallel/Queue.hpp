@@ -48,6 +48,9 @@
 #ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_QUEUE_HPP_
 #define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_QUEUE_HPP_
 
+#include <stdint.h>
+
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -58,14 +61,19 @@ namespace search {
 
 /**
  *
- * Implementation of a thread-safe non-blocking queue.
+ * Implementation of a thread-safe queue, supporting both non-blocking takes and blocking takes with a timeout.
+ *
+ * The operations are virtual so that an alternative implementation (see LockFreeQueue) can be used wherever a Queue is expected.
  *
  * @tparam T
  */
 template<typename T>
 class Queue {
 public:
-	Queue() {}
+	Queue()
+	: wakeCount(0)
+	{
+	}
 
 	virtual ~Queue() {}
 
@@ -73,7 +81,7 @@ public:
 	 *
 	 * @param obj
 	 */
-	void put(std::unique_ptr<T> obj) {
+	virtual void put(std::unique_ptr<T> obj) {
         std::unique_lock<std::mutex> lock(mutex);
         internalQueue.push(std::move(obj));
         queueEmpty.notify_one();
@@ -83,7 +91,7 @@ public:
 	 *
 	 * @return
 	 */
-	std::unique_ptr<T> nonBlockingTake() {
+	virtual std::unique_ptr<T> nonBlockingTake() {
         std::unique_lock<std::mutex> lock(mutex);
         if(internalQueue.empty()) {
         	return std::unique_ptr<T>();
@@ -94,7 +102,37 @@ public:
         }
 	}
 
-	bool isEmpty() const {
+	/**
+	 *
+	 * Wait until an item is available, the timeout expires, or wakeWaiters() is called
+	 *
+	 * @param timeout
+	 * @return the item, or a null pointer if no item became available
+	 */
+	virtual std::unique_ptr<T> blockingTake(std::chrono::nanoseconds timeout) {
+		std::unique_lock<std::mutex> lock(mutex);
+		uint64_t const seenWakeCount = wakeCount;
+		queueEmpty.wait_for(lock, timeout, [&]() { return !internalQueue.empty() || wakeCount != seenWakeCount; });
+		if(internalQueue.empty()) {
+			return std::unique_ptr<T>();
+		}
+		std::unique_ptr<T> item = std::move(internalQueue.front());
+		internalQueue.pop();
+		return item;
+	}
+
+	/**
+	 *
+	 * Wake every thread currently waiting in blockingTake, e.g. to report an error or a request to stop.  Woken threads return a null pointer
+	 * if no item is available.
+	 */
+	virtual void wakeWaiters() {
+		std::unique_lock<std::mutex> lock(mutex);
+		wakeCount++;
+		queueEmpty.notify_all();
+	}
+
+	virtual bool isEmpty() const {
 		std::unique_lock<std::mutex> lock(mutex);
 		return internalQueue.empty();
 	}
@@ -102,6 +140,7 @@ private:
 	std::queue<std::unique_ptr<T>> internalQueue;
     mutable std::mutex mutex;
     std::condition_variable queueEmpty;
+    uint64_t wakeCount;
 };
 
 } /* namespace search */
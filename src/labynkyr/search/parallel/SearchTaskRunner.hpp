@@ -49,13 +49,17 @@
 #define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_SEARCHTASKRUNNER_HPP_
 
 #include "labynkyr/search/verify/KeyVerifier.hpp"
+#include "labynkyr/search/CancellationToken.hpp"
+#include "labynkyr/search/FirstSubkeyRange.hpp"
 #include "labynkyr/search/SearchTask.hpp"
 #include "labynkyr/BigInt.hpp"
 
 #include <stdint.h>
 
 #include <chrono>
+#include <memory>
 #include <string>
+#include <utility>
 
 namespace labynkyr {
 namespace search {
@@ -70,6 +74,12 @@ namespace search {
  *
  * This approach decouples the PEU from needing to know how to execute the enumeration task.
  *
+ * A PEU may also hand the runner a CancellationToken shared by the whole pool before calling processSequentially.  Implementing classes
+ * should poll the token at bounded intervals and return early once it is raised, so that in-flight tasks stop soon after any PEU finds the key.
+ *
+ * Implementing classes that enumerate the first subkeys claimed from remainingFirstSubkeys may also support splitRemainder, allowing an idle
+ * PEU to take over part of a task while it is still being processed.
+ *
  * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
  * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
  * @tparam WeightType the integer type used to store weights (e.g uint32_t)
@@ -92,6 +102,11 @@ public:
 	, expectedTaskSize(expectedTaskSize)
 	, keyFound(false)
 	, duration(0)
+	, cancellationToken(0)
+	, cancelled(false)
+	, remainingFirstSubkeys(task.getFirstSubkeyBegin(), task.getFirstSubkeyEnd())
+	, trimmedTask()
+	, trimmedTaskSize(expectedTaskSize)
 	{
 	}
 
@@ -106,8 +121,36 @@ public:
 	 */
 	virtual void processSequentially(KeyVerifier<KeyLenBits> & keyVerifier) = 0;
 
+	/**
+	 *
+	 * @param cancellationToken a token polled by processSequentially, allowing the task to be stopped early
+	 */
+	void setCancellationToken(CancellationToken & cancellationToken) {
+		this->cancellationToken = &cancellationToken;
+	}
+
+	/**
+	 *
+	 * Record that the cancellation token was raised while this task was being processed
+	 */
+	void setCancelled() {
+		cancelled = true;
+	}
+
+	/**
+	 *
+	 * @return true if the task may have returned before enumerating all of its keys, because the search was cancelled
+	 */
+	bool isCancelled() const {
+		return cancelled;
+	}
+
+	/**
+	 *
+	 * @return the task, narrowed by trimToRemainder to the first subkeys this runner enumerated
+	 */
 	SearchTask<VecCount, VecLenBits, WeightType> const & getTask() const {
-		return task;
+		return (trimmedTask.get() != 0) ? *trimmedTask : task;
 	}
 
 	/**
@@ -115,7 +158,7 @@ public:
 	 * @return the number of candidate keys the task will enumerate and verify
 	 */
 	BigInt<KeyLenBits> size() const {
-		return expectedTaskSize;
+		return trimmedTaskSize;
 	}
 
 	/**
@@ -139,11 +182,98 @@ public:
 	 * @return a human-readable name for the task
 	 */
 	virtual std::string methodName() const = 0;
+
+	/**
+	 *
+	 * @return the largest number of bytes the task reserved to store candidate keys at any one time.  Only valid once the task has been
+	 * processed.  The default implementation is for methods that store no more than the current key, and returns 0.
+	 */
+	virtual uint64_t peakMemoryBytes() const {
+		return 0;
+	}
+
+	/**
+	 *
+	 * Split an unprocessed task into two runners which together enumerate exactly the keys of this task, so that the pieces can be
+	 * processed by different PEUs.  The expected size of each piece is approximate.
+	 *
+	 * Implementing classes that support splitting should split their SearchTask with SearchTask#splitByFirstSubkey.  The default
+	 * implementation does not support splitting and returns a pair of null pointers.
+	 *
+	 * @return the two halves, or a pair of null pointers if the task cannot be split
+	 */
+	virtual std::pair<std::unique_ptr<SearchTaskRunner>, std::unique_ptr<SearchTaskRunner>> split() const {
+		return std::make_pair(std::unique_ptr<SearchTaskRunner>(), std::unique_ptr<SearchTaskRunner>());
+	}
+
+	/**
+	 *
+	 * Split off the upper half of the first subkeys this runner has not yet started, so that an idle PEU can search them while this runner
+	 * is still being processed.  May be called from any thread while processSequentially runs.  The runner does not enumerate the keys split
+	 * off, and once processing has finished, trimToRemainder narrows its task to the keys it did enumerate.
+	 *
+	 * The default implementation does not support splitting while running and returns a null pointer.
+	 *
+	 * @return a runner for the keys split off, or a null pointer if nothing could be split off
+	 */
+	virtual std::unique_ptr<SearchTaskRunner> splitRemainder() {
+		return std::unique_ptr<SearchTaskRunner>();
+	}
+
+	/**
+	 *
+	 * Narrow the task, and its expected size, to the first subkeys that were not split off by splitRemainder.  Must only be called once
+	 * processing has finished and no further calls to splitRemainder can be made.
+	 */
+	void trimToRemainder() {
+		uint64_t const end = remainingFirstSubkeys.getEnd();
+		if(end != task.getFirstSubkeyEnd()) {
+			trimmedTask.reset(new SearchTask<VecCount, VecLenBits, WeightType>(task.getMinKeyWeight(), task.getMaxKeyWeight(), task.getWeightTable(),
+					task.getFirstSubkeyBegin(), end));
+			trimmedTaskSize = sizeOfFirstSubkeys(end - task.getFirstSubkeyBegin());
+		}
+	}
 protected:
 	SearchTask<VecCount, VecLenBits, WeightType> const task;
 	BigInt<KeyLenBits> const expectedTaskSize;
 	bool keyFound;
 	std::chrono::duration<uint64_t, std::nano> duration;
+	// Null unless set by setCancellationToken
+	CancellationToken * cancellationToken;
+	bool cancelled;
+	// The first subkeys not yet started, shared with the PEUs that may split part of the task off while it runs
+	FirstSubkeyRange remainingFirstSubkeys;
+
+	/**
+	 *
+	 * Split off the upper half of the first subkeys not yet claimed from remainingFirstSubkeys, for implementing classes of splitRemainder
+	 *
+	 * @param size set to the approximate number of keys split off
+	 * @return the task covering the keys split off, or a null pointer if too few first subkeys remain
+	 */
+	std::unique_ptr<SearchTask<VecCount, VecLenBits, WeightType> const> splitRemainingTask(BigInt<KeyLenBits> & size) {
+		uint64_t splitBegin = 0;
+		uint64_t splitEnd = 0;
+		if(!remainingFirstSubkeys.split(splitBegin, splitEnd)) {
+			return std::unique_ptr<SearchTask<VecCount, VecLenBits, WeightType> const>();
+		}
+		size = sizeOfFirstSubkeys(splitEnd - splitBegin);
+		return std::unique_ptr<SearchTask<VecCount, VecLenBits, WeightType> const>(
+			new SearchTask<VecCount, VecLenBits, WeightType>(task.getMinKeyWeight(), task.getMaxKeyWeight(), task.getWeightTable(), splitBegin, splitEnd)
+		);
+	}
+private:
+	// Set by trimToRemainder if part of the task was split off
+	std::unique_ptr<SearchTask<VecCount, VecLenBits, WeightType> const> trimmedTask;
+	BigInt<KeyLenBits> trimmedTaskSize;
+
+	/**
+	 *
+	 * @return the approximate number of keys in subkeyCount of the task's first subkeys
+	 */
+	BigInt<KeyLenBits> sizeOfFirstSubkeys(uint64_t subkeyCount) const {
+		return expectedTaskSize / (task.getFirstSubkeyEnd() - task.getFirstSubkeyBegin()) * subkeyCount;
+	}
 };
 
 } /*namespace search */
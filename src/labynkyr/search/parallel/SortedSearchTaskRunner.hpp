@@ -50,8 +50,11 @@
 
 #include "labynkyr/search/parallel/SearchTaskRunner.hpp"
 
+#include "labynkyr/search/enumerate/SortedWeightTable.hpp"
+#include "labynkyr/search/verify/KeyBatch.hpp"
 #include "labynkyr/search/PathCountSearch.hpp"
-#include "labynkyr/WeightTable.hpp"
+
+#include <memory>
 
 namespace labynkyr {
 namespace search {
@@ -60,7 +63,11 @@ namespace search {
  *
  * SortedSearchTaskRunner implements SearchTaskRunner and wraps an instance of the Sorted enumeration algorithm.
  *
- * The Sorted algorithm requires the weight table to be sorted in ascending order.  This class will copy the weight table first.
+ * The Sorted algorithm requires the weight table to be sorted in ascending order.  Runners can share a single, read-only
+ * SortedWeightTable built once per search; if none is supplied, the runner will build its own.
+ *
+ * The first subkeys are enumerated one at a time, so that the ones not yet started can be split off by splitRemainder while the runner is
+ * being processed.
  *
  * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
  * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
@@ -74,9 +81,28 @@ public:
 		KeyLenBits = VecCount * VecLenBits
 	};
 
+	/**
+	 *
+	 * @param task
+	 * @param expectedTaskSize
+	 */
 	SortedSearchTaskRunner(SearchTask<VecCount, VecLenBits, WeightType> const & task, BigInt<KeyLenBits> expectedTaskSize)
 	: SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>(task, expectedTaskSize)
-	, weightTableCopy(task.getWeightTable())
+	, sortedWeightTable(std::make_shared<SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const>(task.getWeightTable()))
+	, maxKeyWeight(task.getMaxKeyWeight())
+	{
+	}
+
+	/**
+	 *
+	 * @param task
+	 * @param expectedTaskSize
+	 * @param sortedWeightTable a sorted snapshot of the task's weight table, shared read-only with other runners
+	 */
+	SortedSearchTaskRunner(SearchTask<VecCount, VecLenBits, WeightType> const & task, BigInt<KeyLenBits> expectedTaskSize,
+			std::shared_ptr<SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const> sortedWeightTable)
+	: SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>(task, expectedTaskSize)
+	, sortedWeightTable(sortedWeightTable)
 	, maxKeyWeight(task.getMaxKeyWeight())
 	{
 	}
@@ -84,9 +110,9 @@ public:
 	~SortedSearchTaskRunner() {}
 
 	void processSequentially(KeyVerifier<KeyLenBits> & keyVerifier) override {
-		PathCountSearch<VecCount, VecLenBits, WeightType, SubkeyType> pathCountSearch(keyVerifier);
+		PathCountSearch<VecCount, VecLenBits, WeightType, SubkeyType> pathCountSearch(keyVerifier, KeyBatch<KeyLenBits>::DefaultBatchSize, this->cancellationToken);
 		auto const start = std::chrono::high_resolution_clock::now();
-		pathCountSearch.searchWithSorted(maxKeyWeight, weightTableCopy);
+		pathCountSearch.searchWithSorted(maxKeyWeight, *sortedWeightTable.get(), this->remainingFirstSubkeys);
 		auto const end = std::chrono::high_resolution_clock::now();
 		this->duration = std::chrono::duration<uint64_t, std::nano>(end - start);
 		// Check whether found the key
@@ -97,8 +123,40 @@ public:
 	std::string methodName() const override {
 		return "Sorted";
 	}
+
+	/**
+	 *
+	 * Splits the range of first subkey values.  Both halves share the sorted weight table.
+	 */
+	std::pair<std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>, std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>> split() const override {
+		if(!this->task.isSplittable()) {
+			return SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>::split();
+		}
+		auto const halves = this->task.splitByFirstSubkey();
+		BigInt<KeyLenBits> const lowerSize = this->expectedTaskSize / 2;
+		std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> lower(
+			new SortedSearchTaskRunner(halves.first, lowerSize, sortedWeightTable)
+		);
+		std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> upper(
+			new SortedSearchTaskRunner(halves.second, this->expectedTaskSize - lowerSize, sortedWeightTable)
+		);
+		return std::make_pair(std::move(lower), std::move(upper));
+	}
+
+	/**
+	 *
+	 * The runner split off shares the sorted weight table
+	 */
+	std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> splitRemainder() override {
+		BigInt<KeyLenBits> size(0);
+		auto const remainder = this->splitRemainingTask(size);
+		if(remainder.get() == 0) {
+			return std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>();
+		}
+		return std::unique_ptr<SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>>(new SortedSearchTaskRunner(*remainder, size, sortedWeightTable));
+	}
 private:
-	WeightTable<VecCount, VecLenBits, WeightType> weightTableCopy;
+	std::shared_ptr<SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const> sortedWeightTable;
 	WeightType const maxKeyWeight;
 };
 
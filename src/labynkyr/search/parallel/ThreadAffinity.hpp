@@ -0,0 +1,157 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * ThreadAffinity.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_THREADAFFINITY_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_THREADAFFINITY_HPP_
+
+#include <stdint.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Binds the calling thread to a single logical CPU.
+ *
+ * Linux allocates physical memory on the NUMA node of the CPU that first touches it, so memory allocated and initialised by a pinned thread
+ * is local to that thread's node.  Pinning is only supported on Linux; elsewhere the functions report failure and do nothing.
+ */
+class ThreadAffinity {
+public:
+	/**
+	 *
+	 * @param cpu the operating system's index of the logical CPU
+	 * @return true if the calling thread is now bound to the CPU
+	 */
+	static bool pinCurrentThread(uint32_t cpu) {
+		#ifdef __linux__
+			if(cpu >= CPU_SETSIZE) {
+				return false;
+			}
+			cpu_set_t cpuSet;
+			CPU_ZERO(&cpuSet);
+			CPU_SET(cpu, &cpuSet);
+			return sched_setaffinity(0, sizeof(cpuSet), &cpuSet) == 0;
+		#else
+			return false;
+		#endif
+	}
+
+	/**
+	 *
+	 * @return the logical CPU the calling thread is currently running on, or -1 if unknown
+	 */
+	static int32_t currentCPU() {
+		#ifdef __linux__
+			return sched_getcpu();
+		#else
+			return -1;
+		#endif
+	}
+};
+
+/**
+ *
+ * Pins the calling thread to a logical CPU for the lifetime of the object, and restores the thread's original affinity on destruction.  Used
+ * to allocate data structures on the NUMA node of the thread that will use them.
+ */
+class ScopedThreadAffinity {
+public:
+	/**
+	 *
+	 * @param cpu the operating system's index of the logical CPU
+	 */
+	ScopedThreadAffinity(uint32_t cpu)
+	: isPinned(false)
+	{
+		#ifdef __linux__
+			if(sched_getaffinity(0, sizeof(originalCPUSet), &originalCPUSet) == 0) {
+				isPinned = ThreadAffinity::pinCurrentThread(cpu);
+			}
+		#endif
+	}
+
+	~ScopedThreadAffinity() {
+		#ifdef __linux__
+			if(isPinned) {
+				sched_setaffinity(0, sizeof(originalCPUSet), &originalCPUSet);
+			}
+		#endif
+	}
+
+	/**
+	 *
+	 * @return true if the thread was successfully pinned
+	 */
+	bool pinned() const {
+		return isPinned;
+	}
+private:
+	bool isPinned;
+	#ifdef __linux__
+		cpu_set_t originalCPUSet;
+	#endif
+
+	/**
+	 * Overriden copy constructor
+	 */
+	ScopedThreadAffinity(ScopedThreadAffinity const &);
+
+	/**
+	 * Overriden assignment operator
+	 */
+	ScopedThreadAffinity & operator=(ScopedThreadAffinity const &);
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_THREADAFFINITY_HPP_ */
@@ -0,0 +1,137 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * VerifierPipeline.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_VERIFIERPIPELINE_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_VERIFIERPIPELINE_HPP_
+
+#include <stdint.h>
+
+#include <sstream>
+#include <stdexcept>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Describes how the PEUs in a PEUPool verify the keys they enumerate.
+ *
+ * By default verification is synchronous: each PEU calls its KeyVerifier directly from the enumeration loop, so the PEU idles in whichever
+ * of enumeration or verification is the faster.  When pipelined, each PEU instead writes blocks of keys into lock-free single-producer/
+ * single-consumer queues (see PipelinedKeyVerifier), and a separate set of verifier threads (see VerifierThread) checks them concurrently.
+ * The number of verifier threads is the verifierCount given to the PEUPool, and need not be related to the number of PEUs.
+ */
+class VerifierPipeline {
+public:
+	enum {
+		DefaultSlotCount = 8,
+		DefaultBlockKeys = 1024
+	};
+
+	/**
+	 *
+	 * Verification is synchronous
+	 */
+	VerifierPipeline()
+	: slotCount(0)
+	, blockKeys(0)
+	{
+	}
+
+	/**
+	 *
+	 * Verification is pipelined
+	 *
+	 * @param slotCount the number of blocks in each queue between a PEU and a verifier thread
+	 * @param blockKeys the maximum number of keys in each block
+	 * @throws std::invalid_argument if either is zero
+	 */
+	VerifierPipeline(uint32_t slotCount, uint64_t blockKeys)
+	: slotCount(slotCount)
+	, blockKeys(blockKeys)
+	{
+		if(slotCount == 0 || blockKeys == 0) {
+			std::stringstream error;
+			error << "A verifier pipeline requires at least one block of at least one key.  Requested " << slotCount << " blocks of " << blockKeys << " keys";
+			throw std::invalid_argument(error.str().c_str());
+		}
+	}
+
+	~VerifierPipeline() {}
+
+	/**
+	 *
+	 * @return a pipeline using the default queue sizes
+	 */
+	static VerifierPipeline pipelined() {
+		return VerifierPipeline(DefaultSlotCount, DefaultBlockKeys);
+	}
+
+	/**
+	 *
+	 * @return true if verification runs on separate verifier threads
+	 */
+	bool isPipelined() const {
+		return slotCount != 0;
+	}
+
+	uint32_t getSlotCount() const {
+		return slotCount;
+	}
+
+	uint64_t getBlockKeys() const {
+		return blockKeys;
+	}
+private:
+	uint32_t slotCount;
+	uint64_t blockKeys;
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_VERIFIERPIPELINE_HPP_ */
@@ -0,0 +1,260 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * VerifierThread.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_VERIFIERTHREAD_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_VERIFIERTHREAD_HPP_
+
+#include "labynkyr/search/parallel/KeyBlockQueue.hpp"
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+
+#include "labynkyr/Key.hpp"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * A thread that owns a KeyVerifier and verifies the key blocks placed on one or more KeyBlockQueues by enumerating PEUs (see
+ * PipelinedKeyVerifier).  The queues are polled in turn; when all of them are empty the thread yields, and then sleeps for short periods
+ * until more keys arrive.
+ *
+ * Each block is flushed through the verifier before it is popped, so a producer that sees its queue empty knows every key it sent has
+ * been verified.  Once the key is found the verifier is no longer used by the thread, and later blocks are popped without being verified.
+ *
+ * If the verifier throws, the thread stores the exception and stops consuming its queues.  The exception is surfaced by the PEUPool, and
+ * by the PipelinedKeyVerifiers waiting on the thread.
+ *
+ * @tparam KeyLenBits the length of the key in bits
+ */
+template<uint32_t KeyLenBits>
+class VerifierThread {
+public:
+	enum {
+		// Number of consecutive empty polls of every queue before the thread starts to sleep between polls
+		SpinPollCount = 64,
+		IdleSleepMicroseconds = 50
+	};
+
+	/**
+	 *
+	 * @param verifier the verifier used to check every key this thread receives
+	 */
+	VerifierThread(std::unique_ptr<KeyVerifier<KeyLenBits>> verifier)
+	: verifier(std::move(verifier))
+	, queues()
+	, workerThread()
+	, isStop(true)
+	, found(false)
+	, count(0)
+	, exceptionThrown(false)
+	, exceptionPtr()
+	{
+	}
+
+	~VerifierThread() {
+		stop();
+	}
+
+	/**
+	 *
+	 * Add a queue for this thread to consume.  Must not be called while the thread is running.
+	 *
+	 * @param queue
+	 * @throws std::logic_error if the thread is running
+	 */
+	void addQueue(KeyBlockQueue<KeyLenBits> & queue) {
+		if(!isStop.load()) {
+			throw std::logic_error("Queues cannot be added to a running verifier thread");
+		}
+		queues.push_back(&queue);
+	}
+
+	/**
+	 *
+	 * Start the thread
+	 */
+	void start() {
+		if(isStop.load()) {
+			isStop.store(false);
+			workerThread = std::thread(&VerifierThread<KeyLenBits>::run, this);
+		}
+	}
+
+	/**
+	 *
+	 * Stop the thread.  Blocks still on the queues are left there.
+	 */
+	void stop() {
+		if(!isStop.load()) {
+			isStop.store(true);
+			workerThread.join();
+		}
+	}
+
+	/**
+	 *
+	 * @return true if the verifier has found the key.  May be called while the thread is running.
+	 */
+	bool isFound() const {
+		return found.load(std::memory_order_acquire);
+	}
+
+	/**
+	 *
+	 * @return the key found by the verifier
+	 * @throws std::logic_error if the key has not been found
+	 */
+	Key<KeyLenBits> correctKey() const {
+		if(!isFound()) {
+			throw std::logic_error("Key has not been found");
+		}
+		return verifier->correctKey();
+	}
+
+	/**
+	 *
+	 * @return the number of keys this thread has verified.  May be called while the thread is running.
+	 */
+	uint64_t keysChecked() const {
+		return count.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 *
+	 * @return true if the verifier threw an exception, after which the thread stopped.  May be called while the thread is running.
+	 */
+	bool isExceptionThrown() const {
+		return exceptionThrown.load(std::memory_order_acquire);
+	}
+
+	/**
+	 *
+	 * @return the exception thrown by the verifier, if isExceptionThrown() is true
+	 */
+	std::exception_ptr const & getExceptionPtr() const {
+		return exceptionPtr;
+	}
+private:
+	std::unique_ptr<KeyVerifier<KeyLenBits>> verifier;
+	std::vector<KeyBlockQueue<KeyLenBits> *> queues;
+	std::thread workerThread;
+	std::atomic<bool> isStop;
+	std::atomic<bool> found;
+	std::atomic<uint64_t> count;
+	std::atomic<bool> exceptionThrown;
+	// Written once, before exceptionThrown is set
+	std::exception_ptr exceptionPtr;
+
+	/**
+	 *
+	 * Overriden copy constructor
+	 */
+	VerifierThread(VerifierThread<KeyLenBits> const & other);
+
+	/**
+	 *
+	 * Overriden assignment operator
+	 */
+	VerifierThread<KeyLenBits> & operator=(VerifierThread<KeyLenBits> const & other);
+
+	void run() {
+		uint32_t emptyPolls = 0;
+		try {
+			while(!isStop.load(std::memory_order_relaxed)) {
+				bool progress = false;
+				for(auto * queue : queues) {
+					uint64_t keyCount = 0;
+					uint8_t const * const block = queue->front(keyCount);
+					if(block != 0) {
+						verifyBlock(block, keyCount);
+						queue->pop();
+						progress = true;
+					}
+				}
+				if(progress) {
+					emptyPolls = 0;
+				} else if(emptyPolls < SpinPollCount) {
+					emptyPolls++;
+					std::this_thread::yield();
+				} else {
+					std::this_thread::sleep_for(std::chrono::microseconds(IdleSleepMicroseconds));
+				}
+			}
+		} catch(std::exception const & ex) {
+			// The verifier failed, set the exception_ptr for read elsewhere.  The block being verified is left on its queue.
+			exceptionPtr = std::current_exception();
+			exceptionThrown.store(true, std::memory_order_release);
+		}
+	}
+
+	void verifyBlock(uint8_t const * block, uint64_t keyCount) {
+		if(found.load(std::memory_order_relaxed)) {
+			return;
+		}
+		verifier->checkKeys(block, keyCount);
+		verifier->flush();
+		count.fetch_add(keyCount, std::memory_order_relaxed);
+		if(verifier->success()) {
+			found.store(true, std::memory_order_release);
+		}
+	}
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_VERIFIERTHREAD_HPP_ */
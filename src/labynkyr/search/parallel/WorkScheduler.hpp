@@ -49,26 +49,52 @@
 #define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_WORKSCHEDULER_HPP_
 
 #include "labynkyr/search/enumerate/ActiveNodeFinder.hpp"
+#include "labynkyr/search/enumerate/SortedWeightTable.hpp"
 #include "labynkyr/search/parallel/ANFForestSearchTaskRunner.hpp"
 #include "labynkyr/search/parallel/EnvironmentManager.hpp"
+#include "labynkyr/search/parallel/InterruptMonitor.hpp"
+#include "labynkyr/search/parallel/OrderedSearchTaskRunner.hpp"
 #include "labynkyr/search/parallel/PEUPool.hpp"
 #include "labynkyr/search/parallel/SortedSearchTaskRunner.hpp"
 #include "labynkyr/search/EffortAllocation.hpp"
+#include "labynkyr/search/SearchCheckpoint.hpp"
+#include "labynkyr/search/SearchTaskStream.hpp"
 
 #include <stdint.h>
 
+#include <atomic>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
-#include <thread>
+#include <limits>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 namespace labynkyr {
 namespace search {
 
 /**
  *
- * WorkScheduler manages a pool of PEUs.  It will take a pre-defined EffortAllocation and manage the distribution of the associated SearchTasks
- * amongst a set of PEUs in parallel.
+ * Selects the method WorkScheduler uses to search every task after the initial one
+ */
+enum TaskSearchMethod {
+	// ANFForestSearchTaskRunner: the keys of a task are verified in no particular order
+	ANFForestSearchMethod,
+	// OrderedSearchTaskRunner: the keys of a task are verified in ascending order of weight, for when verification is expensive
+	OrderedSearchMethod
+};
+
+/**
+ *
+ * WorkScheduler manages a pool of PEUs.  It will take a pre-defined EffortAllocation (or a SearchTaskStream) and manage the distribution of the
+ * associated SearchTasks amongst a set of PEUs in parallel.  The PEUs are started before any task is enqueued, so the first task can be
+ * processed while later tasks are still being generated.
+ *
+ * PEUs may split tasks between themselves while the search runs, so a task counts as complete once SearchTaskRunners covering every one of
+ * its first subkey values have completed.
  *
  * @tparam VecCount the number of distinguishing vectors in the attack (e.g 16 for SubBytes attacks on an AES-128 key)
  * @tparam VecLenBits the number bits of the key targeted by each subkey recovery attack (e.g 8 for SubBytes attacks on an AES-128 key)
@@ -84,12 +110,18 @@ public:
 
 	/**
 	 *
-	 * @param sleepNanoseconds the scheduler will check internal queues for completed search tasks every sleepNanoseconds.
+	 * @param sleepNanoseconds the scheduler waits for completed search tasks for at most sleepNanoseconds before checking for interrupts and
+	 * checkpoint deadlines.  The scheduler is woken as soon as a task completes or a PEU throws an exception, so this does not affect the time
+	 * taken to report the key.
 	 */
 	WorkScheduler(uint64_t sleepNanoseconds)
 	: sleepNanoseconds(sleepNanoseconds)
 	, lastTimeTakenToFindKey(0UL)
 	, lastTotalTimeTaken(0UL)
+	, lastInterrupted(false)
+	, stopRequested(false)
+	, taskMemoryBudgetBytes(0)
+	, taskSearchMethod(ANFForestSearchMethod)
 	{
 	}
 
@@ -105,27 +137,204 @@ public:
 	 * re-throw the exception once all PEUs have stopped
 	 */
 	void runSearch(PEUPool<VecCount, VecLenBits, WeightType, SubkeyType> & peuPool, EffortAllocation<VecCount, VecLenBits, WeightType> & tasks) {
-		// Enqueue all tasks
-		uint32_t const taskCount = tasks.tasksRemaining();
-		WeightType const maxWeight = tasks.getWeightTable().maximumWeight();
-		ActiveNodeFinder<VecCount, VecLenBits, WeightType> const activeNodeFinder(tasks.getWeightTable(), maxWeight);
-		enqueueAllTasks(peuPool, tasks, activeNodeFinder);
-		// Startup all the PEUs
-		uint32_t tasksCompleted = 0;
+		search(peuPool, tasks, std::numeric_limits<uint32_t>::max(), 0, "", std::chrono::nanoseconds(0));
+	}
+
+	/**
+	 *
+	 * Run a parallel key search, generating tasks from the stream as the search progresses.  If the stream was constructed with an
+	 * AdaptiveTaskSizer, the time taken by each completed task is recorded in it.  At most twice as many tasks as there are PEUs are
+	 * outstanding at any time.
+	 *
+	 * @param peuPool
+	 * @param tasks
+	 * @throws std::exception if any PEU encounters an exception, the WorkScheduler will catch the exception, signal the PEUs to stop, and then
+	 * re-throw the exception once all PEUs have stopped
+	 */
+	void runSearch(PEUPool<VecCount, VecLenBits, WeightType, SubkeyType> & peuPool, SearchTaskStream<VecCount, VecLenBits, WeightType> & tasks) {
+		runSearch(peuPool, tasks, 2 * peuPool.peuCount());
+	}
+
+	/**
+	 *
+	 * Run a parallel key search, generating tasks from the stream as the search progresses.
+	 *
+	 * @param peuPool
+	 * @param tasks
+	 * @param lookAhead the maximum number of tasks that have been generated but not yet completed.  A new task is generated each time one
+	 * completes.
+	 * @throws std::invalid_argument if lookAhead is zero
+	 * @throws std::exception if any PEU encounters an exception, the WorkScheduler will catch the exception, signal the PEUs to stop, and then
+	 * re-throw the exception once all PEUs have stopped
+	 */
+	void runSearch(PEUPool<VecCount, VecLenBits, WeightType, SubkeyType> & peuPool, SearchTaskStream<VecCount, VecLenBits, WeightType> & tasks, uint32_t lookAhead) {
+		if(lookAhead == 0) {
+			throw std::invalid_argument("The task look-ahead must be at least one");
+		}
+		search(peuPool, tasks, lookAhead, 0, "", std::chrono::nanoseconds(0));
+	}
+
+	/**
+	 *
+	 * Run a parallel key search over the unfinished tasks in a checkpoint, recording each completed task in the checkpoint.
+	 *
+	 * The checkpoint is written to checkpointPath every checkpointInterval, when the search ends, and when SIGINT or SIGTERM is
+	 * received.  On receipt of a signal, in-flight tasks are cancelled (and not recorded as completed), the checkpoint is written, and
+	 * this function returns with wasLastSearchInterrupted() set; the search can later be resumed by loading the checkpoint and calling
+	 * this function again.
+	 *
+	 * @param peuPool
+	 * @param checkpoint the search plan and the set of tasks already completed
+	 * @param checkpointPath the file the checkpoint will be written to
+	 * @param checkpointInterval the time between periodic checkpoint writes
+	 * @throws std::exception if any PEU encounters an exception, the WorkScheduler will catch the exception, signal the PEUs to stop, write the
+	 * checkpoint, and then re-throw the exception once all PEUs have stopped.  If the checkpoint cannot be written, the PEU's exception is still
+	 * the one re-thrown.
+	 */
+	void runSearch(PEUPool<VecCount, VecLenBits, WeightType, SubkeyType> & peuPool, SearchCheckpoint<VecCount, VecLenBits, WeightType> & checkpoint,
+			std::string const & checkpointPath, std::chrono::nanoseconds checkpointInterval) {
+		auto const remainingTasks = checkpoint.remainingTasks();
+		if(remainingTasks.empty()) {
+			lastInterrupted = false;
+			checkpoint.save(checkpointPath);
+			return;
+		}
+		EffortAllocation<VecCount, VecLenBits, WeightType> tasks(remainingTasks);
+		InterruptMonitor::install();
+		try {
+			search(peuPool, tasks, std::numeric_limits<uint32_t>::max(), &checkpoint, checkpointPath, checkpointInterval);
+		} catch(...) {
+			InterruptMonitor::uninstall();
+			throw;
+		}
+		InterruptMonitor::uninstall();
+	}
+
+	/**
+	 *
+	 * @return the time taken to find the correct key (or zero if the key was not found or no parallel search has been executed yet)
+	 */
+	std::chrono::duration<uint64_t, std::nano> getLastTimeTakenToFindKey() const {
+		return lastTimeTakenToFindKey;
+	}
+
+	/**
+	 *
+	 * @return the total time spent searching (or zero if no parallel search has been executed yet)
+	 */
+	std::chrono::duration<uint64_t, std::nano> getLastTotalTimeTaken() const {
+		return lastTotalTimeTaken;
+	}
+
+	/**
+	 *
+	 * @return true if the last search was stopped by requestStop(), or (for a checkpointed search) by SIGINT or SIGTERM, before all of its
+	 * tasks were completed
+	 */
+	bool wasLastSearchInterrupted() const {
+		return lastInterrupted;
+	}
+
+	/**
+	 *
+	 * Ask a running search to stop, from any thread.  In-flight tasks are cancelled and the search returns with wasLastSearchInterrupted() set.
+	 * The request is sticky: any later search on this scheduler also stops as soon as it starts.
+	 */
+	void requestStop() {
+		stopRequested.store(true);
+	}
+
+	/**
+	 *
+	 * Limit the memory each ANF/Forest task may use to store candidate keys.  Tasks estimated or found to exceed the budget are searched in
+	 * weight sub-bands, or with the Sorted algorithm if a single weight does not fit.  The peak memory used by each PEU is logged when the
+	 * search ends.
+	 *
+	 * @param taskMemoryBudgetBytes the budget in bytes, or 0 (the default) for no limit
+	 */
+	void setTaskMemoryBudget(uint64_t taskMemoryBudgetBytes) {
+		this->taskMemoryBudgetBytes = taskMemoryBudgetBytes;
+	}
+
+	/**
+	 *
+	 * @return the memory budget of each ANF/Forest task, or 0 for no limit
+	 */
+	uint64_t getTaskMemoryBudget() const {
+		return taskMemoryBudgetBytes;
+	}
+
+	/**
+	 *
+	 * @param taskSearchMethod the method used to search every task after the initial one.  The default is ANFForestSearchMethod.
+	 */
+	void setTaskSearchMethod(TaskSearchMethod taskSearchMethod) {
+		this->taskSearchMethod = taskSearchMethod;
+	}
+
+	/**
+	 *
+	 * @return the method used to search every task after the initial one
+	 */
+	TaskSearchMethod getTaskSearchMethod() const {
+		return taskSearchMethod;
+	}
+private:
+	uint64_t const sleepNanoseconds;
+	std::chrono::duration<uint64_t, std::nano> lastTimeTakenToFindKey;
+	std::chrono::duration<uint64_t, std::nano> lastTotalTimeTaken;
+	bool lastInterrupted;
+	std::atomic<bool> stopRequested;
+	uint64_t taskMemoryBudgetBytes;
+	TaskSearchMethod taskSearchMethod;
+
+	struct TaskProgress {
+		// The number of first subkey values covered by completed runners
+		uint64_t subkeysCompleted;
+		// True if any runner for the task was cancelled before verifying all of its keys
+		bool isCancelled;
+	};
+
+	// Progress of each task in the current search, keyed by weight range
+	std::map<std::pair<WeightType, WeightType>, TaskProgress> taskProgress;
+
+	/**
+	 *
+	 * The main scheduling loop.  Tasks are taken from the source (an EffortAllocation or a SearchTaskStream) so that at most lookAhead of them
+	 * are outstanding.  If checkpoint is null, no checkpointing or signal handling takes place.
+	 */
+	template<typename TaskSource>
+	void search(PEUPool<VecCount, VecLenBits, WeightType, SubkeyType> & peuPool, TaskSource & tasks, uint32_t lookAhead,
+			SearchCheckpoint<VecCount, VecLenBits, WeightType> * checkpoint, std::string const & checkpointPath, std::chrono::nanoseconds checkpointInterval) {
+		// No task visits a weight at or beyond its maximum key weight, so the active nodes are only found up to the largest of these.  Ordered
+		// tasks do not use them at all.
+		WeightType const activeWeightBound = (taskSearchMethod == OrderedSearchMethod) ? 0 : tasks.maximumTaskWeight();
+		ActiveNodeFinder<VecCount, VecLenBits, WeightType> const activeNodeFinder(tasks.getWeightTable(), activeWeightBound, peuPool.peuCount());
+		std::shared_ptr<SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const> sortedWeightTable;
+		uint32_t tasksOutstanding = 0;
 		bool isKeyFound = false;
+		lastInterrupted = false;
+		taskProgress.clear();
 		auto const start = std::chrono::high_resolution_clock::now();
+		auto lastCheckpointTime = start;
+		// Startup all the PEUs, then hand out the first tasks
 		peuPool.processAllPEUsAsynchronously();
+		tasksOutstanding += enqueueTasks(peuPool, tasks, lookAhead - tasksOutstanding, activeNodeFinder, sortedWeightTable);
 		// Loop until all necessary search tasks are completed
-		while(tasksCompleted < taskCount && isKeyFound == false) {
+		while(tasksOutstanding > 0 && isKeyFound == false) {
 			// If a task has been completed, check whether a key was found, and break out of execution if so
-			auto completedBatch = peuPool.getWriteQueue().nonBlockingTake();
+			auto completedBatch = peuPool.getWriteQueue().blockingTake(std::chrono::nanoseconds(sleepNanoseconds));
 			if(completedBatch != 0) {
-				tasksCompleted++;
 				EnvironmentManager::getInstance().logTaskCompletion<KeyLenBits>(
 					completedBatch->size(),
 					completedBatch->getDuration(),
 					completedBatch->methodName()
 				);
+				recordTaskCost(*completedBatch, taskSizerOf(tasks));
+				if(recordCompletion(*completedBatch, checkpoint)) {
+					tasksOutstanding--;
+					tasksOutstanding += enqueueTasks(peuPool, tasks, lookAhead - tasksOutstanding, activeNodeFinder, sortedWeightTable);
+				}
 				isKeyFound = completedBatch->isKeyFound();
 				if(isKeyFound) {
 					auto const end = std::chrono::high_resolution_clock::now();
@@ -137,59 +346,139 @@ public:
 			// Check for exceptions -- will throw if found
 			try {
 				peuPool.checkForThrownExceptions();
-			} catch(std::exception const & ex) {
+			} catch(...) {
 				peuPool.stopAllPEUs(); // Stop the PEUs from processing
-				throw ex;
+				try {
+					finishCheckpoint(peuPool, checkpoint, checkpointPath);
+				} catch(...) {
+					// The PEU's exception is the one the caller needs to see, not a failure to save the checkpoint
+				}
+				throw;
+			}
+			if(stopRequested.load()) {
+				lastInterrupted = true;
+				break;
+			}
+			if(checkpoint != 0) {
+				if(InterruptMonitor::isInterrupted()) {
+					lastInterrupted = true;
+					break;
+				}
+				auto const now = std::chrono::high_resolution_clock::now();
+				if(now - lastCheckpointTime >= checkpointInterval) {
+					checkpoint->save(checkpointPath);
+					lastCheckpointTime = now;
+				}
 			}
-			// Now sleep until next tick
-			std::this_thread::sleep_for(std::chrono::nanoseconds(sleepNanoseconds));
 		}
 		// Stop all PEUs
 		peuPool.stopAllPEUs();
+		finishCheckpoint(peuPool, checkpoint, checkpointPath);
+		EnvironmentManager::getInstance().logMemoryUsage(peuPool.peakMemoryBytes());
 		auto const end = std::chrono::high_resolution_clock::now();
 		lastTotalTimeTaken = std::chrono::duration<uint64_t, std::nano>(end - start);
 	}
 
 	/**
 	 *
-	 * @return the time taken to find the correct key (or zero if the key was not found or no parallel search has been executed yet)
+	 * Record a completed runner against the progress of its task.  Only tasks that ran to completion are recorded in the checkpoint; a
+	 * cancelled task may not have verified all of its keys.
+	 *
+	 * @return true if the runner completed the last outstanding part of its task
 	 */
-	std::chrono::duration<uint64_t, std::nano> getLastTimeTakenToFindKey() const {
-		return lastTimeTakenToFindKey;
+	bool recordCompletion(SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType> const & completedBatch, SearchCheckpoint<VecCount, VecLenBits, WeightType> * checkpoint) {
+		auto const & task = completedBatch.getTask();
+		auto const key = std::make_pair(task.getMinKeyWeight(), task.getMaxKeyWeight());
+		auto iter = taskProgress.find(key);
+		if(iter == taskProgress.end()) {
+			TaskProgress const initial = {0, false};
+			iter = taskProgress.insert(std::make_pair(key, initial)).first;
+		}
+		TaskProgress & progress = iter->second;
+		progress.subkeysCompleted += task.getFirstSubkeyEnd() - task.getFirstSubkeyBegin();
+		progress.isCancelled |= completedBatch.isCancelled();
+		if(progress.subkeysCompleted < SearchTask<VecCount, VecLenBits, WeightType>::VectorSize) {
+			return false;
+		}
+		if(checkpoint != 0 && !progress.isCancelled) {
+			checkpoint->markCompleted(task);
+		}
+		return true;
 	}
 
 	/**
 	 *
-	 * @return the total time spent searching (or zero if no parallel search has been executed yet)
+	 * Feed the measured cost of a completed runner back into the task sizer, if there is one.  The initial task uses the Sorted enumeration
+	 * method, and cancelled runners did not verify all of their keys, so neither is representative of the cost of later tasks.
 	 */
-	std::chrono::duration<uint64_t, std::nano> getLastTotalTimeTaken() const {
-		return lastTotalTimeTaken;
+	void recordTaskCost(SearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType> const & completedBatch, AdaptiveTaskSizer<KeyLenBits> * taskSizer) {
+		if(taskSizer != 0 && !completedBatch.getTask().isInitialTask() && !completedBatch.isCancelled()) {
+			taskSizer->recordTask(completedBatch.size(), completedBatch.getDuration());
+		}
+	}
+
+	static AdaptiveTaskSizer<KeyLenBits> * taskSizerOf(EffortAllocation<VecCount, VecLenBits, WeightType> const &) {
+		return 0;
+	}
+
+	static AdaptiveTaskSizer<KeyLenBits> * taskSizerOf(SearchTaskStream<VecCount, VecLenBits, WeightType> const & tasks) {
+		return tasks.getTaskSizer();
+	}
+
+	/**
+	 *
+	 * Once the PEUs have stopped, record any tasks that completed after the scheduler stopped listening, and write the checkpoint
+	 */
+	void finishCheckpoint(PEUPool<VecCount, VecLenBits, WeightType, SubkeyType> & peuPool, SearchCheckpoint<VecCount, VecLenBits, WeightType> * checkpoint,
+			std::string const & checkpointPath) {
+		if(checkpoint != 0) {
+			auto completedBatch = peuPool.getWriteQueue().nonBlockingTake();
+			while(completedBatch != 0) {
+				recordCompletion(*completedBatch, checkpoint);
+				completedBatch = peuPool.getWriteQueue().nonBlockingTake();
+			}
+			checkpoint->save(checkpointPath);
+		}
 	}
-private:
-	uint64_t const sleepNanoseconds;
-	std::chrono::duration<uint64_t, std::nano> lastTimeTakenToFindKey;
-	std::chrono::duration<uint64_t, std::nano> lastTotalTimeTaken;
 
 	/**
 	 *
-	 * The simplest way to allocate work is to take the set of SearchTasks described by the EffortAllocation and push them all onto a queue
-	 * prior to execution
+	 * Take up to maxTasks SearchTasks from the source and push them onto the PEU queues.  The initial task (containing the most likely key) is
+	 * searched with the Sorted enumeration method, and all others with the task search method: ANF/Forest within the task memory budget, or
+	 * Ordered.
+	 *
+	 * All Sorted and Ordered tasks share a single sorted snapshot of the weight table, built the first time one is needed.
+	 *
+	 * @return the number of tasks enqueued
 	 */
-	void enqueueAllTasks(PEUPool<VecCount, VecLenBits, WeightType, SubkeyType> & peuPool, EffortAllocation<VecCount, VecLenBits, WeightType> & tasks, ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder) {
-		while(tasks.tasksRemaining() > 0) {
+	template<typename TaskSource>
+	uint32_t enqueueTasks(PEUPool<VecCount, VecLenBits, WeightType, SubkeyType> & peuPool, TaskSource & tasks, uint32_t maxTasks,
+			ActiveNodeFinder<VecCount, VecLenBits, WeightType> const & activeNodeFinder,
+			std::shared_ptr<SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const> & sortedWeightTable) {
+		uint32_t enqueued = 0;
+		while(enqueued < maxTasks && tasks.isTasksAvailable()) {
 			auto const nextTaskDef = tasks.removeNextTask();
+			bool const isSorted = nextTaskDef.second.isInitialTask() || taskSearchMethod == OrderedSearchMethod;
+			if(isSorted && !sortedWeightTable) {
+				sortedWeightTable = std::make_shared<SortedWeightTable<VecCount, VecLenBits, WeightType, SubkeyType> const>(tasks.getWeightTable());
+			}
 			if(nextTaskDef.second.isInitialTask()) {
-				// If its the initial task (starts searching the most likely key), then we use the sorted enumeration method
-				auto * runner = new SortedSearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>(nextTaskDef.second, nextTaskDef.first);
+				auto * runner = new SortedSearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>(nextTaskDef.second, nextTaskDef.first, sortedWeightTable);
 				std::unique_ptr<SortedSearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> runnerPtr(runner);
 				peuPool.addTasking(std::move(runnerPtr));
+			} else if(taskSearchMethod == OrderedSearchMethod) {
+				auto * runner = new OrderedSearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>(nextTaskDef.second, nextTaskDef.first, sortedWeightTable);
+				std::unique_ptr<OrderedSearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> runnerPtr(runner);
+				peuPool.addTasking(std::move(runnerPtr));
 			} else {
-				// If its not the initial task, then we use the ANF/Forest enumeration method
-				auto * runner = new ANFForestSearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>(nextTaskDef.second, nextTaskDef.first, activeNodeFinder);
+				auto * runner = new ANFForestSearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>(nextTaskDef.second, nextTaskDef.first, activeNodeFinder,
+						LinkedForestLayout, taskMemoryBudgetBytes);
 				std::unique_ptr<ANFForestSearchTaskRunner<VecCount, VecLenBits, WeightType, SubkeyType>> runnerPtr(runner);
 				peuPool.addTasking(std::move(runnerPtr));
 			}
+			enqueued++;
 		}
+		return enqueued;
 	}
 };
 
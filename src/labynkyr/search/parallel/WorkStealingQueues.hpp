@@ -0,0 +1,363 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * WorkStealingQueues.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_WORKSTEALINGQUEUES_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_WORKSTEALINGQUEUES_HPP_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * A set of double-ended queues, one per worker, for work-stealing scheduling.
+ *
+ * Each worker takes work from the front of its own deque, and pushes work it creates (by splitting a task) onto the front of its own deque.
+ * When its deque is empty, a worker steals from the back of the other workers' deques, which is where the oldest -- and, for search tasks
+ * queued most-likely-first, the earliest -- work sits.  Each deque has its own lock, so workers only contend when stealing.
+ *
+ * Workers with nothing to do can block in take until work is added, rather than polling.
+ *
+ * A worker may also publish a splitter for the item it is running.  When every deque is empty, take calls the other workers' splitters, so
+ * that an idle worker can take over part of an item that was already running when it became idle.
+ *
+ * The set also counts the workers that are currently idle (looking for work), so that busy workers can decide whether splitting their task
+ * is worthwhile.
+ *
+ * @tparam T
+ */
+template<typename T>
+class WorkStealingQueues {
+public:
+	/**
+	 *
+	 * @param workerCount the number of deques
+	 * @throws std::invalid_argument if workerCount is zero
+	 */
+	WorkStealingQueues(uint32_t workerCount)
+	: deques(workerCount)
+	, splitters(workerCount)
+	, nextDequeIndex(0)
+	, idleWorkers(0)
+	, version(0)
+	, wakeVersion(0)
+	{
+		if(workerCount == 0) {
+			std::stringstream error;
+			error << "Work stealing requires at least one worker";
+			throw std::invalid_argument(error.str().c_str());
+		}
+		for(auto & deque : deques) {
+			deque.reset(new LockedDeque());
+		}
+		for(auto & splitter : splitters) {
+			splitter.reset(new LockedSplitter());
+		}
+	}
+
+	~WorkStealingQueues() {}
+
+	/**
+	 *
+	 * Add an item to the back of the deques in round-robin order, so that initially queued work is spread evenly across the workers
+	 *
+	 * @param obj
+	 */
+	void put(std::unique_ptr<T> obj) {
+		uint32_t const dequeIndex = nextDequeIndex.fetch_add(1) % deques.size();
+		{
+			LockedDeque & deque = *deques[dequeIndex];
+			std::unique_lock<std::mutex> lock(deque.mutex);
+			deque.items.push_back(std::move(obj));
+		}
+		signal(false);
+	}
+
+	/**
+	 *
+	 * Add an item to the front of a worker's own deque.  It will be the next item the worker takes, and the last to be stolen.
+	 *
+	 * @param workerIndex
+	 * @param obj
+	 */
+	void putLocal(uint32_t workerIndex, std::unique_ptr<T> obj) {
+		{
+			LockedDeque & deque = *deques[workerIndex];
+			std::unique_lock<std::mutex> lock(deque.mutex);
+			deque.items.push_front(std::move(obj));
+		}
+		signal(false);
+	}
+
+	/**
+	 *
+	 * Take the next item from the front of a worker's own deque, or if it is empty, steal from the back of another worker's deque.  If all
+	 * deques are empty, split part off an item another worker is running.
+	 *
+	 * @param workerIndex
+	 * @return the item, or a null pointer if all deques are empty and no running item could be split
+	 */
+	std::unique_ptr<T> take(uint32_t workerIndex) {
+		{
+			LockedDeque & deque = *deques[workerIndex];
+			std::unique_lock<std::mutex> lock(deque.mutex);
+			if(!deque.items.empty()) {
+				std::unique_ptr<T> item = std::move(deque.items.front());
+				deque.items.pop_front();
+				return item;
+			}
+		}
+		for(uint32_t offset = 1 ; offset < deques.size() ; offset++) {
+			LockedDeque & victim = *deques[(workerIndex + offset) % deques.size()];
+			std::unique_lock<std::mutex> lock(victim.mutex);
+			if(!victim.items.empty()) {
+				std::unique_ptr<T> item = std::move(victim.items.back());
+				victim.items.pop_back();
+				return item;
+			}
+		}
+		for(uint32_t offset = 1 ; offset < splitters.size() ; offset++) {
+			LockedSplitter & victim = *splitters[(workerIndex + offset) % splitters.size()];
+			std::unique_lock<std::mutex> lock(victim.mutex);
+			if(victim.split) {
+				std::unique_ptr<T> item = victim.split();
+				if(item.get() != 0) {
+					return item;
+				}
+			}
+		}
+		return std::unique_ptr<T>();
+	}
+
+	/**
+	 *
+	 * Publish a splitter for the item a worker is running, which idle workers will call when all deques are empty.  Waiting workers are
+	 * woken so that they can try it.
+	 *
+	 * @param workerIndex
+	 * @param split returns part of the running item, or a null pointer if it cannot be split further
+	 */
+	void setRunning(uint32_t workerIndex, std::function<std::unique_ptr<T>()> split) {
+		{
+			LockedSplitter & splitter = *splitters[workerIndex];
+			std::unique_lock<std::mutex> lock(splitter.mutex);
+			splitter.split = std::move(split);
+		}
+		signal(false);
+	}
+
+	/**
+	 *
+	 * Withdraw a worker's splitter, waiting for any split in progress to finish, so that the running item is not split once this returns
+	 *
+	 * @param workerIndex
+	 */
+	void clearRunning(uint32_t workerIndex) {
+		LockedSplitter & splitter = *splitters[workerIndex];
+		std::unique_lock<std::mutex> lock(splitter.mutex);
+		splitter.split = std::function<std::unique_ptr<T>()>();
+	}
+
+	/**
+	 *
+	 * As above, but if all deques are empty, wait until work is added, the timeout expires, or wakeAll() is called
+	 *
+	 * @param workerIndex
+	 * @param timeout
+	 * @return the item, or a null pointer if no work became available
+	 */
+	std::unique_ptr<T> take(uint32_t workerIndex, std::chrono::nanoseconds timeout) {
+		auto const deadline = std::chrono::steady_clock::now() + timeout;
+		while(true) {
+			std::unique_lock<std::mutex> lock(signalMutex);
+			uint64_t const seenVersion = version;
+			lock.unlock();
+			std::unique_ptr<T> item = take(workerIndex);
+			if(item.get() != 0) {
+				return item;
+			}
+			lock.lock();
+			if(!workAdded.wait_until(lock, deadline, [&]() { return version != seenVersion; })) {
+				return std::unique_ptr<T>();
+			}
+			if(isWakeRequested(seenVersion)) {
+				return std::unique_ptr<T>();
+			}
+		}
+	}
+
+	/**
+	 *
+	 * Wake every worker currently waiting in take, e.g. so that it can notice a request to stop.  Woken workers return a null pointer.
+	 */
+	void wakeAll() {
+		signal(true);
+	}
+
+	/**
+	 *
+	 * Record that a worker has started or stopped looking for work
+	 *
+	 * @param isIdle
+	 */
+	void setIdle(bool isIdle) {
+		if(isIdle) {
+			idleWorkers.fetch_add(1);
+		} else {
+			idleWorkers.fetch_sub(1);
+		}
+	}
+
+	/**
+	 *
+	 * @return the number of workers currently looking for work
+	 */
+	uint32_t idleCount() const {
+		return idleWorkers.load();
+	}
+
+	/**
+	 *
+	 * @param workerIndex
+	 * @return the number of items in a worker's deque
+	 */
+	uint64_t size(uint32_t workerIndex) const {
+		LockedDeque const & deque = *deques[workerIndex];
+		std::unique_lock<std::mutex> lock(deque.mutex);
+		return deque.items.size();
+	}
+
+	/**
+	 *
+	 * @return true if every deque is empty
+	 */
+	bool isEmpty() const {
+		for(uint32_t workerIndex = 0 ; workerIndex < deques.size() ; workerIndex++) {
+			if(size(workerIndex) > 0) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 *
+	 * @return the number of deques
+	 */
+	uint32_t workerCount() const {
+		return deques.size();
+	}
+private:
+	struct LockedDeque {
+		std::deque<std::unique_ptr<T>> items;
+		mutable std::mutex mutex;
+	};
+
+	struct LockedSplitter {
+		// Empty unless the worker is running an item that may be split
+		std::function<std::unique_ptr<T>()> split;
+		std::mutex mutex;
+	};
+
+	std::vector<std::unique_ptr<LockedDeque>> deques;
+	std::vector<std::unique_ptr<LockedSplitter>> splitters;
+	std::atomic<uint32_t> nextDequeIndex;
+	std::atomic<uint32_t> idleWorkers;
+
+	// Incremented whenever work is added or the waiting workers are woken
+	uint64_t version;
+	// The version at which wakeAll() was last called
+	uint64_t wakeVersion;
+	std::mutex signalMutex;
+	std::condition_variable workAdded;
+
+	void signal(bool isWake) {
+		std::unique_lock<std::mutex> lock(signalMutex);
+		version++;
+		if(isWake) {
+			wakeVersion = version;
+			workAdded.notify_all();
+		} else {
+			workAdded.notify_one();
+		}
+	}
+
+	/**
+	 *
+	 * Must be called holding signalMutex
+	 */
+	bool isWakeRequested(uint64_t seenVersion) const {
+		return wakeVersion > seenVersion;
+	}
+
+	/**
+	 * Overriden copy constructor
+	 */
+	WorkStealingQueues(WorkStealingQueues const &);
+
+	/**
+	 * Overriden assignment operator
+	 */
+	WorkStealingQueues & operator=(WorkStealingQueues const &);
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_PARALLEL_WORKSTEALINGQUEUES_HPP_ */
@@ -0,0 +1,593 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * AES128Kernels.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AES128KERNELS_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AES128KERNELS_HPP_
+
+#include <stdint.h>
+
+#include <immintrin.h>
+#include <wmmintrin.h>
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * The AES-128 encryption kernels available to AES128KeyVerifier, in order of increasing width
+ */
+enum AES128Kernel {
+	// AES-NI, 4 keys interleaved (as AES128NIEncryptUnrolledKeyVerifier)
+	AESNI4Kernel,
+	// AES-NI, 8 keys interleaved, to hide the latency of aesenc on cores that can issue more than one per cycle
+	AESNI8Kernel,
+	// VAES on 256-bit registers, 8 keys with 2 blocks per instruction
+	VAES256Kernel,
+	// VAES on 512-bit registers, 16 keys with 4 blocks per instruction
+	VAES512Kernel
+};
+
+/**
+ *
+ * AES-128 encryption of a single plaintext under a group of candidate keys, with the key schedule computed on the fly.
+ *
+ * Every kernel uses the same key schedule: the keys are transposed in groups of 4 so that one register holds the same word of each
+ * key, and SubWord is applied to 4 keys at once with aesenclast (a shuffle then undoes ShiftRows and applies RotWord).  The wider
+ * kernels apply this within each 128-bit lane.  The VAES kernels are compiled for their instruction sets with target attributes, so
+ * they are always available in the binary; isSupported must be checked before calling one.
+ *
+ * A wider kernel is not always faster: some cores split 512-bit instructions into two, or lower their clock while running them.
+ * fastestSupported therefore times the supported kernels, once per process, rather than assuming the widest is best.
+ */
+class AES128Kernels {
+public:
+	enum {
+		// Number of keys each kernel encrypts in each calibration run, and the number of runs (the fastest run is kept)
+		CalibrationKeys = 1 << 14,
+		CalibrationRuns = 3
+	};
+
+	/**
+	 *
+	 * @param kernel
+	 * @return the number of keys encrypted by each call to the kernel
+	 */
+	static uint32_t keysPerCall(AES128Kernel kernel) {
+		switch(kernel) {
+		case AESNI4Kernel:
+			return 4;
+		case AESNI8Kernel:
+		case VAES256Kernel:
+			return 8;
+		default:
+			return 16;
+		}
+	}
+
+	/**
+	 *
+	 * @param kernel
+	 * @return true if the CPU the program is running on supports the instructions the kernel uses
+	 */
+	static bool isSupported(AES128Kernel kernel) {
+		__builtin_cpu_init();
+		bool const aesni = __builtin_cpu_supports("aes") && __builtin_cpu_supports("ssse3");
+		switch(kernel) {
+		case AESNI4Kernel:
+		case AESNI8Kernel:
+			return aesni;
+		case VAES256Kernel:
+			return aesni && __builtin_cpu_supports("vaes") && __builtin_cpu_supports("avx2");
+		default:
+			return aesni && __builtin_cpu_supports("vaes") && __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+		}
+	}
+
+	/**
+	 *
+	 * @return the widest kernel supported by the CPU
+	 * @throws std::runtime_error if the CPU does not support AES-NI
+	 */
+	static AES128Kernel widestSupported() {
+		AES128Kernel const kernels[] = {VAES512Kernel, VAES256Kernel, AESNI8Kernel, AESNI4Kernel};
+		for(AES128Kernel const kernel : kernels) {
+			if(isSupported(kernel)) {
+				return kernel;
+			}
+		}
+		throw std::runtime_error("The CPU does not support AES-NI");
+	}
+
+	/**
+	 *
+	 * The kernels are timed on the first call, which takes around a millisecond, and the result is reused for the rest of the process.
+	 *
+	 * @return the supported kernel that encrypted keys fastest on this CPU
+	 * @throws std::runtime_error if the CPU does not support AES-NI
+	 */
+	static AES128Kernel fastestSupported() {
+		static AES128Kernel const fastest = fastestOf(supported());
+		return fastest;
+	}
+
+	/**
+	 *
+	 * Time each kernel, and return the one with the highest throughput.  Of kernels that are equally fast, the widest is returned.
+	 *
+	 * @param kernels supported kernels, in order of increasing width (as returned by supported())
+	 * @return the fastest of the kernels
+	 * @throws std::runtime_error if kernels is empty
+	 */
+	static AES128Kernel fastestOf(std::vector<AES128Kernel> const & kernels) {
+		if(kernels.empty()) {
+			throw std::runtime_error("The CPU does not support AES-NI");
+		}
+		AES128Kernel fastest = kernels.front();
+		uint64_t fastestNanoseconds = 0;
+		for(auto kernel = kernels.rbegin() ; kernel != kernels.rend() ; ++kernel) {
+			uint64_t const nanoseconds = timeKernel(*kernel);
+			if(kernel == kernels.rbegin() || nanoseconds < fastestNanoseconds) {
+				fastest = *kernel;
+				fastestNanoseconds = nanoseconds;
+			}
+		}
+		return fastest;
+	}
+
+	/**
+	 *
+	 * @return every kernel supported by the CPU
+	 */
+	static std::vector<AES128Kernel> supported() {
+		std::vector<AES128Kernel> kernels;
+		AES128Kernel const allKernels[] = {AESNI4Kernel, AESNI8Kernel, VAES256Kernel, VAES512Kernel};
+		for(AES128Kernel const kernel : allKernels) {
+			if(isSupported(kernel)) {
+				kernels.push_back(kernel);
+			}
+		}
+		return kernels;
+	}
+
+	/**
+	 *
+	 * @param kernel
+	 * @return a short name for the kernel
+	 */
+	static std::string name(AES128Kernel kernel) {
+		switch(kernel) {
+		case AESNI4Kernel:
+			return "AES-NI x4";
+		case AESNI8Kernel:
+			return "AES-NI x8";
+		case VAES256Kernel:
+			return "VAES-256";
+		default:
+			return "VAES-512";
+		}
+	}
+
+	/**
+	 *
+	 * Encrypt a plaintext under keysPerCall(kernel) keys
+	 *
+	 * @param kernel
+	 * @param keys the keys, stored back to back.  No alignment is required.
+	 * @param plaintext 16 bytes
+	 * @param ciphertexts receives one 16 byte ciphertext per key, stored back to back
+	 */
+	static void encrypt(AES128Kernel kernel, uint8_t const * keys, uint8_t const * plaintext, uint8_t * ciphertexts) {
+		switch(kernel) {
+		case AESNI4Kernel:
+			encryptAESNI4(keys, plaintext, ciphertexts);
+			break;
+		case AESNI8Kernel:
+			encryptAESNI8(keys, plaintext, ciphertexts);
+			break;
+		case VAES256Kernel:
+			encryptVAES256(keys, plaintext, ciphertexts);
+			break;
+		default:
+			encryptVAES512(keys, plaintext, ciphertexts);
+			break;
+		}
+	}
+
+	/**
+	 *
+	 * Run the key schedule backwards to recover 4 cipher keys from their round 10 keys.  The words of the keys are transposed as in the
+	 * encryption kernels, so SubWord is applied to all 4 keys with a single aesenclast per round.
+	 *
+	 * @param lastRoundKeys 4 round 10 keys, stored back to back.  No alignment is required.
+	 * @param keys receives the 4 cipher keys, stored back to back
+	 */
+	static void invertKeySchedule4(uint8_t const * lastRoundKeys, uint8_t * keys) {
+		__m128i const mask = _mm_set_epi8(0x0C, 0x03, 0x06, 0x09, 0x08, 0x0F, 0x02, 0x05, 0x04, 0x0B, 0x0E, 0x01, 0x00, 0x07, 0x0A, 0x0D);
+		__m128i const zero = _mm_setzero_si128();
+
+		__m128i key0 = _mm_loadu_si128((__m128i const *) &(lastRoundKeys[ 0]));
+		__m128i key1 = _mm_loadu_si128((__m128i const *) &(lastRoundKeys[16]));
+		__m128i key2 = _mm_loadu_si128((__m128i const *) &(lastRoundKeys[32]));
+		__m128i key3 = _mm_loadu_si128((__m128i const *) &(lastRoundKeys[48]));
+
+		__m128i rki = _mm_unpacklo_epi32(key0, key1);
+		__m128i rkj = _mm_unpacklo_epi32(key2, key3);
+		__m128i rk0 = _mm_unpacklo_epi64(rki, rkj);
+		__m128i rk1 = _mm_unpackhi_epi64(rki, rkj);
+		rki = _mm_unpackhi_epi32(key0, key1);
+		rkj = _mm_unpackhi_epi32(key2, key3);
+		__m128i rk2 = _mm_unpacklo_epi64(rki, rkj);
+		__m128i rk3 = _mm_unpackhi_epi64(rki, rkj);
+
+		for(uint32_t round = 10 ; round >= 1 ; round--) {
+			rk3 = _mm_xor_si128(rk3, rk2);
+			rk2 = _mm_xor_si128(rk2, rk1);
+			rk1 = _mm_xor_si128(rk1, rk0);
+			__m128i tmp = _mm_shuffle_epi8(_mm_aesenclast_si128(rk3, zero), mask);
+			tmp = _mm_xor_si128(tmp, _mm_set1_epi32(rcon(round)));
+			rk0 = _mm_xor_si128(rk0, tmp);
+		}
+
+		rki = _mm_unpacklo_epi32(rk0, rk1);
+		rkj = _mm_unpacklo_epi32(rk2, rk3);
+		_mm_storeu_si128((__m128i *) &(keys[ 0]), _mm_unpacklo_epi64(rki, rkj));
+		_mm_storeu_si128((__m128i *) &(keys[16]), _mm_unpackhi_epi64(rki, rkj));
+		rki = _mm_unpackhi_epi32(rk0, rk1);
+		rkj = _mm_unpackhi_epi32(rk2, rk3);
+		_mm_storeu_si128((__m128i *) &(keys[32]), _mm_unpacklo_epi64(rki, rkj));
+		_mm_storeu_si128((__m128i *) &(keys[48]), _mm_unpackhi_epi64(rki, rkj));
+	}
+
+	static void encryptAESNI4(uint8_t const * keys, uint8_t const * plaintext, uint8_t * ciphertexts) {
+		__m128i const mask = _mm_set_epi8(0x0C, 0x03, 0x06, 0x09, 0x08, 0x0F, 0x02, 0x05, 0x04, 0x0B, 0x0E, 0x01, 0x00, 0x07, 0x0A, 0x0D);
+		__m128i const zero = _mm_setzero_si128();
+		__m128i const data = _mm_loadu_si128((__m128i const *) plaintext);
+
+		__m128i key0 = _mm_loadu_si128((__m128i const *) &(keys[ 0]));
+		__m128i key1 = _mm_loadu_si128((__m128i const *) &(keys[16]));
+		__m128i key2 = _mm_loadu_si128((__m128i const *) &(keys[32]));
+		__m128i key3 = _mm_loadu_si128((__m128i const *) &(keys[48]));
+
+		__m128i data0 = _mm_xor_si128(data, key0);
+		__m128i data1 = _mm_xor_si128(data, key1);
+		__m128i data2 = _mm_xor_si128(data, key2);
+		__m128i data3 = _mm_xor_si128(data, key3);
+
+		__m128i rki = _mm_unpacklo_epi32(key0, key1);
+		__m128i rkj = _mm_unpacklo_epi32(key2, key3);
+		__m128i rk0 = _mm_unpacklo_epi64(rki, rkj);
+		__m128i rk1 = _mm_unpackhi_epi64(rki, rkj);
+		rki = _mm_unpackhi_epi32(key0, key1);
+		rkj = _mm_unpackhi_epi32(key2, key3);
+		__m128i rk2 = _mm_unpacklo_epi64(rki, rkj);
+		__m128i rk3 = _mm_unpackhi_epi64(rki, rkj);
+
+		for(uint32_t round = 1 ; round <= 10 ; round++) {
+			__m128i tmp = _mm_shuffle_epi8(_mm_aesenclast_si128(rk3, zero), mask);
+			tmp = _mm_xor_si128(tmp, _mm_set1_epi32(rcon(round)));
+			rk0 = _mm_xor_si128(rk0, tmp);
+			rk1 = _mm_xor_si128(rk1, rk0);
+			rk2 = _mm_xor_si128(rk2, rk1);
+			rk3 = _mm_xor_si128(rk3, rk2);
+
+			rki = _mm_unpacklo_epi32(rk0, rk1);
+			rkj = _mm_unpacklo_epi32(rk2, rk3);
+			key0 = _mm_unpacklo_epi64(rki, rkj);
+			key1 = _mm_unpackhi_epi64(rki, rkj);
+			rki = _mm_unpackhi_epi32(rk0, rk1);
+			rkj = _mm_unpackhi_epi32(rk2, rk3);
+			key2 = _mm_unpacklo_epi64(rki, rkj);
+			key3 = _mm_unpackhi_epi64(rki, rkj);
+
+			if(round < 10) {
+				data0 = _mm_aesenc_si128(data0, key0);
+				data1 = _mm_aesenc_si128(data1, key1);
+				data2 = _mm_aesenc_si128(data2, key2);
+				data3 = _mm_aesenc_si128(data3, key3);
+			} else {
+				data0 = _mm_aesenclast_si128(data0, key0);
+				data1 = _mm_aesenclast_si128(data1, key1);
+				data2 = _mm_aesenclast_si128(data2, key2);
+				data3 = _mm_aesenclast_si128(data3, key3);
+			}
+		}
+
+		_mm_storeu_si128((__m128i *) &(ciphertexts[ 0]), data0);
+		_mm_storeu_si128((__m128i *) &(ciphertexts[16]), data1);
+		_mm_storeu_si128((__m128i *) &(ciphertexts[32]), data2);
+		_mm_storeu_si128((__m128i *) &(ciphertexts[48]), data3);
+	}
+
+	/**
+	 *
+	 * Two independent groups of 4 keys, with their rounds interleaved so that 8 aesenc instructions are in flight
+	 */
+	static void encryptAESNI8(uint8_t const * keys, uint8_t const * plaintext, uint8_t * ciphertexts) {
+		__m128i const mask = _mm_set_epi8(0x0C, 0x03, 0x06, 0x09, 0x08, 0x0F, 0x02, 0x05, 0x04, 0x0B, 0x0E, 0x01, 0x00, 0x07, 0x0A, 0x0D);
+		__m128i const zero = _mm_setzero_si128();
+		__m128i const data = _mm_loadu_si128((__m128i const *) plaintext);
+
+		__m128i key[8];
+		__m128i state[8];
+		for(uint32_t index = 0 ; index < 8 ; index++) {
+			key[index] = _mm_loadu_si128((__m128i const *) &(keys[index * 16]));
+			state[index] = _mm_xor_si128(data, key[index]);
+		}
+
+		__m128i rk[8];
+		for(uint32_t group = 0 ; group < 8 ; group += 4) {
+			__m128i const rki = _mm_unpacklo_epi32(key[group], key[group + 1]);
+			__m128i const rkj = _mm_unpacklo_epi32(key[group + 2], key[group + 3]);
+			rk[group] = _mm_unpacklo_epi64(rki, rkj);
+			rk[group + 1] = _mm_unpackhi_epi64(rki, rkj);
+			__m128i const rkk = _mm_unpackhi_epi32(key[group], key[group + 1]);
+			__m128i const rkl = _mm_unpackhi_epi32(key[group + 2], key[group + 3]);
+			rk[group + 2] = _mm_unpacklo_epi64(rkk, rkl);
+			rk[group + 3] = _mm_unpackhi_epi64(rkk, rkl);
+		}
+
+		for(uint32_t round = 1 ; round <= 10 ; round++) {
+			__m128i const roundConstant = _mm_set1_epi32(rcon(round));
+			for(uint32_t group = 0 ; group < 8 ; group += 4) {
+				__m128i tmp = _mm_shuffle_epi8(_mm_aesenclast_si128(rk[group + 3], zero), mask);
+				tmp = _mm_xor_si128(tmp, roundConstant);
+				rk[group] = _mm_xor_si128(rk[group], tmp);
+				rk[group + 1] = _mm_xor_si128(rk[group + 1], rk[group]);
+				rk[group + 2] = _mm_xor_si128(rk[group + 2], rk[group + 1]);
+				rk[group + 3] = _mm_xor_si128(rk[group + 3], rk[group + 2]);
+
+				__m128i const rki = _mm_unpacklo_epi32(rk[group], rk[group + 1]);
+				__m128i const rkj = _mm_unpacklo_epi32(rk[group + 2], rk[group + 3]);
+				key[group] = _mm_unpacklo_epi64(rki, rkj);
+				key[group + 1] = _mm_unpackhi_epi64(rki, rkj);
+				__m128i const rkk = _mm_unpackhi_epi32(rk[group], rk[group + 1]);
+				__m128i const rkl = _mm_unpackhi_epi32(rk[group + 2], rk[group + 3]);
+				key[group + 2] = _mm_unpacklo_epi64(rkk, rkl);
+				key[group + 3] = _mm_unpackhi_epi64(rkk, rkl);
+			}
+			if(round < 10) {
+				for(uint32_t index = 0 ; index < 8 ; index++) {
+					state[index] = _mm_aesenc_si128(state[index], key[index]);
+				}
+			} else {
+				for(uint32_t index = 0 ; index < 8 ; index++) {
+					state[index] = _mm_aesenclast_si128(state[index], key[index]);
+				}
+			}
+		}
+
+		for(uint32_t index = 0 ; index < 8 ; index++) {
+			_mm_storeu_si128((__m128i *) &(ciphertexts[index * 16]), state[index]);
+		}
+	}
+
+	/**
+	 *
+	 * Register j holds keys 2j and 2j + 1, and the keys are transposed within each 128-bit lane
+	 */
+	__attribute__((target("aes,vaes,avx2")))
+	static void encryptVAES256(uint8_t const * keys, uint8_t const * plaintext, uint8_t * ciphertexts) {
+		__m256i const mask = _mm256_broadcastsi128_si256(
+				_mm_set_epi8(0x0C, 0x03, 0x06, 0x09, 0x08, 0x0F, 0x02, 0x05, 0x04, 0x0B, 0x0E, 0x01, 0x00, 0x07, 0x0A, 0x0D));
+		__m256i const zero = _mm256_setzero_si256();
+		__m256i const data = _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i const *) plaintext));
+
+		__m256i key0 = _mm256_loadu_si256((__m256i const *) &(keys[ 0]));
+		__m256i key1 = _mm256_loadu_si256((__m256i const *) &(keys[32]));
+		__m256i key2 = _mm256_loadu_si256((__m256i const *) &(keys[64]));
+		__m256i key3 = _mm256_loadu_si256((__m256i const *) &(keys[96]));
+
+		__m256i data0 = _mm256_xor_si256(data, key0);
+		__m256i data1 = _mm256_xor_si256(data, key1);
+		__m256i data2 = _mm256_xor_si256(data, key2);
+		__m256i data3 = _mm256_xor_si256(data, key3);
+
+		__m256i rki = _mm256_unpacklo_epi32(key0, key1);
+		__m256i rkj = _mm256_unpacklo_epi32(key2, key3);
+		__m256i rk0 = _mm256_unpacklo_epi64(rki, rkj);
+		__m256i rk1 = _mm256_unpackhi_epi64(rki, rkj);
+		rki = _mm256_unpackhi_epi32(key0, key1);
+		rkj = _mm256_unpackhi_epi32(key2, key3);
+		__m256i rk2 = _mm256_unpacklo_epi64(rki, rkj);
+		__m256i rk3 = _mm256_unpackhi_epi64(rki, rkj);
+
+		for(uint32_t round = 1 ; round <= 10 ; round++) {
+			__m256i tmp = _mm256_shuffle_epi8(_mm256_aesenclast_epi128(rk3, zero), mask);
+			tmp = _mm256_xor_si256(tmp, _mm256_set1_epi32(rcon(round)));
+			rk0 = _mm256_xor_si256(rk0, tmp);
+			rk1 = _mm256_xor_si256(rk1, rk0);
+			rk2 = _mm256_xor_si256(rk2, rk1);
+			rk3 = _mm256_xor_si256(rk3, rk2);
+
+			rki = _mm256_unpacklo_epi32(rk0, rk1);
+			rkj = _mm256_unpacklo_epi32(rk2, rk3);
+			key0 = _mm256_unpacklo_epi64(rki, rkj);
+			key1 = _mm256_unpackhi_epi64(rki, rkj);
+			rki = _mm256_unpackhi_epi32(rk0, rk1);
+			rkj = _mm256_unpackhi_epi32(rk2, rk3);
+			key2 = _mm256_unpacklo_epi64(rki, rkj);
+			key3 = _mm256_unpackhi_epi64(rki, rkj);
+
+			if(round < 10) {
+				data0 = _mm256_aesenc_epi128(data0, key0);
+				data1 = _mm256_aesenc_epi128(data1, key1);
+				data2 = _mm256_aesenc_epi128(data2, key2);
+				data3 = _mm256_aesenc_epi128(data3, key3);
+			} else {
+				data0 = _mm256_aesenclast_epi128(data0, key0);
+				data1 = _mm256_aesenclast_epi128(data1, key1);
+				data2 = _mm256_aesenclast_epi128(data2, key2);
+				data3 = _mm256_aesenclast_epi128(data3, key3);
+			}
+		}
+
+		_mm256_storeu_si256((__m256i *) &(ciphertexts[ 0]), data0);
+		_mm256_storeu_si256((__m256i *) &(ciphertexts[32]), data1);
+		_mm256_storeu_si256((__m256i *) &(ciphertexts[64]), data2);
+		_mm256_storeu_si256((__m256i *) &(ciphertexts[96]), data3);
+	}
+
+	// GCC reports the deliberately undefined pass-through operand of the unmasked AVX-512 intrinsics as maybe-uninitialized
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+	/**
+	 *
+	 * Register j holds keys 4j to 4j + 3, and the keys are transposed within each 128-bit lane
+	 */
+	__attribute__((target("aes,vaes,avx512f,avx512bw")))
+	static void encryptVAES512(uint8_t const * keys, uint8_t const * plaintext, uint8_t * ciphertexts) {
+		__m512i const mask = _mm512_broadcast_i32x4(
+				_mm_set_epi8(0x0C, 0x03, 0x06, 0x09, 0x08, 0x0F, 0x02, 0x05, 0x04, 0x0B, 0x0E, 0x01, 0x00, 0x07, 0x0A, 0x0D));
+		__m512i const zero = _mm512_setzero_si512();
+		__m512i const data = _mm512_broadcast_i32x4(_mm_loadu_si128((__m128i const *) plaintext));
+
+		__m512i key0 = _mm512_loadu_si512((void const *) &(keys[  0]));
+		__m512i key1 = _mm512_loadu_si512((void const *) &(keys[ 64]));
+		__m512i key2 = _mm512_loadu_si512((void const *) &(keys[128]));
+		__m512i key3 = _mm512_loadu_si512((void const *) &(keys[192]));
+
+		__m512i data0 = _mm512_xor_si512(data, key0);
+		__m512i data1 = _mm512_xor_si512(data, key1);
+		__m512i data2 = _mm512_xor_si512(data, key2);
+		__m512i data3 = _mm512_xor_si512(data, key3);
+
+		__m512i rki = _mm512_unpacklo_epi32(key0, key1);
+		__m512i rkj = _mm512_unpacklo_epi32(key2, key3);
+		__m512i rk0 = _mm512_unpacklo_epi64(rki, rkj);
+		__m512i rk1 = _mm512_unpackhi_epi64(rki, rkj);
+		rki = _mm512_unpackhi_epi32(key0, key1);
+		rkj = _mm512_unpackhi_epi32(key2, key3);
+		__m512i rk2 = _mm512_unpacklo_epi64(rki, rkj);
+		__m512i rk3 = _mm512_unpackhi_epi64(rki, rkj);
+
+		for(uint32_t round = 1 ; round <= 10 ; round++) {
+			__m512i tmp = _mm512_shuffle_epi8(_mm512_aesenclast_epi128(rk3, zero), mask);
+			tmp = _mm512_xor_si512(tmp, _mm512_set1_epi32(rcon(round)));
+			rk0 = _mm512_xor_si512(rk0, tmp);
+			rk1 = _mm512_xor_si512(rk1, rk0);
+			rk2 = _mm512_xor_si512(rk2, rk1);
+			rk3 = _mm512_xor_si512(rk3, rk2);
+
+			rki = _mm512_unpacklo_epi32(rk0, rk1);
+			rkj = _mm512_unpacklo_epi32(rk2, rk3);
+			key0 = _mm512_unpacklo_epi64(rki, rkj);
+			key1 = _mm512_unpackhi_epi64(rki, rkj);
+			rki = _mm512_unpackhi_epi32(rk0, rk1);
+			rkj = _mm512_unpackhi_epi32(rk2, rk3);
+			key2 = _mm512_unpacklo_epi64(rki, rkj);
+			key3 = _mm512_unpackhi_epi64(rki, rkj);
+
+			if(round < 10) {
+				data0 = _mm512_aesenc_epi128(data0, key0);
+				data1 = _mm512_aesenc_epi128(data1, key1);
+				data2 = _mm512_aesenc_epi128(data2, key2);
+				data3 = _mm512_aesenc_epi128(data3, key3);
+			} else {
+				data0 = _mm512_aesenclast_epi128(data0, key0);
+				data1 = _mm512_aesenclast_epi128(data1, key1);
+				data2 = _mm512_aesenclast_epi128(data2, key2);
+				data3 = _mm512_aesenclast_epi128(data3, key3);
+			}
+		}
+
+		_mm512_storeu_si512((void *) &(ciphertexts[  0]), data0);
+		_mm512_storeu_si512((void *) &(ciphertexts[ 64]), data1);
+		_mm512_storeu_si512((void *) &(ciphertexts[128]), data2);
+		_mm512_storeu_si512((void *) &(ciphertexts[192]), data3);
+	}
+	#pragma GCC diagnostic pop
+private:
+	/**
+	 *
+	 * @param round 1 to 10
+	 * @return the key schedule round constant
+	 */
+	/**
+	 *
+	 * @return the shortest time, over CalibrationRuns runs, that the kernel took to encrypt CalibrationKeys keys
+	 */
+	static uint64_t timeKernel(AES128Kernel kernel) {
+		uint8_t keys[16 * 16];
+		uint8_t plaintext[16];
+		uint8_t ciphertexts[16 * 16];
+		for(uint32_t index = 0 ; index < sizeof(keys) ; index++) {
+			keys[index] = static_cast<uint8_t>(index * 151 + 1);
+		}
+		std::fill(plaintext, plaintext + 16, 0);
+		uint64_t fastestNanoseconds = 0;
+		for(uint32_t run = 0 ; run < CalibrationRuns ; run++) {
+			auto const begin = std::chrono::steady_clock::now();
+			for(uint32_t encrypted = 0 ; encrypted < CalibrationKeys ; encrypted += keysPerCall(kernel)) {
+				encrypt(kernel, keys, plaintext, ciphertexts);
+				// Feed the output back in, so that the calls cannot be optimised away
+				keys[0] ^= ciphertexts[0];
+			}
+			uint64_t const nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count();
+			if(run == 0 || nanoseconds < fastestNanoseconds) {
+				fastestNanoseconds = nanoseconds;
+			}
+		}
+		return fastestNanoseconds;
+	}
+
+	static uint32_t rcon(uint32_t round) {
+		static uint32_t const roundConstants[11] = {0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36};
+		return roundConstants[round];
+	}
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AES128KERNELS_HPP_ */
@@ -0,0 +1,234 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * AES128LastRoundKeyVerifier.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AES128LASTROUNDKEYVERIFIER_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AES128LASTROUNDKEYVERIFIER_HPP_
+
+#include "labynkyr/search/verify/AES128Kernels.hpp"
+#include "labynkyr/search/verify/GroupedKeyVerifier.hpp"
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Implementation of the KeyVerifier interface for attacks on the final AES-128 round, where the enumerated key is the round 10 key rather
+ * than the cipher key.  Candidate round 10 keys are converted to cipher keys by running the key schedule backwards
+ * (AES128Kernels::invertKeySchedule4), and then checked against a known plaintext and ciphertext pair using one of the AES128Kernels.  By
+ * default the kernel found fastest on the CPU at runtime is used (see AES128Kernels::fastestSupported).
+ *
+ * Decrypting the ciphertext directly under the round 10 key would avoid the conversion, but the AES-NI equivalent inverse cipher needs
+ * InvMixColumns applied to every round key, which triples the number of AES instructions per key.  The transposed inverse key schedule
+ * costs one aesenclast per 4 keys per round.
+ *
+ * The correct key is reported as the round 10 key, i.e as it was enumerated.  Use masterKey to convert it to the cipher key.
+ */
+class AES128LastRoundKeyVerifier : public GroupedKeyVerifier<128> {
+public:
+	enum {
+		// The largest number of keys encrypted by any kernel
+		MaxKeysPerCall = 16
+	};
+
+	/**
+	 *
+	 * Uses AES128Kernels::fastestSupported()
+	 *
+	 * @param plaintext
+	 * @param ciphertext
+	 * @throws std::runtime_error if the CPU does not support AES-NI
+	 */
+	AES128LastRoundKeyVerifier(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext)
+	: AES128LastRoundKeyVerifier(plaintext, ciphertext, AES128Kernels::fastestSupported())
+	{
+	}
+
+	/**
+	 *
+	 * @param plaintext
+	 * @param ciphertext
+	 * @param kernel
+	 * @throws std::invalid_argument if the CPU does not support the kernel
+	 */
+	AES128LastRoundKeyVerifier(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext, AES128Kernel kernel)
+	: GroupedKeyVerifier<128>(AES128Kernels::keysPerCall(kernel))
+	, kernel(kernel)
+	{
+		if(!AES128Kernels::isSupported(kernel)) {
+			std::stringstream error;
+			error << "The CPU does not support the " << AES128Kernels::name(kernel) << " AES-128 kernel";
+			throw std::invalid_argument(error.str().c_str());
+		}
+		std::copy(plaintext.begin(), plaintext.end(), this->plaintext);
+		std::copy(ciphertext.begin(), ciphertext.end(), expectedCiphertext);
+	}
+
+	~AES128LastRoundKeyVerifier() {}
+
+	/**
+	 *
+	 * @return the kernel used to encrypt candidate keys
+	 */
+	AES128Kernel getKernel() const {
+		return kernel;
+	}
+
+	/**
+	 *
+	 * Run the AES-128 key schedule backwards from a round 10 key to the cipher key.
+	 *
+	 * @param lastRoundKey the 16 byte round 10 key
+	 * @return the 16 byte cipher key
+	 * @throws std::invalid_argument if lastRoundKey is not 16 bytes long
+	 */
+	static std::vector<uint8_t> masterKey(std::vector<uint8_t> const & lastRoundKey) {
+		if(lastRoundKey.size() != 16) {
+			std::stringstream error;
+			error << "An AES-128 round key is 16 bytes long, not " << lastRoundKey.size();
+			throw std::invalid_argument(error.str().c_str());
+		}
+		uint8_t lastRoundKeys[64] = {0};
+		uint8_t keys[64];
+		std::copy(lastRoundKey.begin(), lastRoundKey.end(), lastRoundKeys);
+		AES128Kernels::invertKeySchedule4(lastRoundKeys, keys);
+		return std::vector<uint8_t>(keys, keys + 16);
+	}
+private:
+	AES128Kernel const kernel;
+	uint8_t plaintext[16];
+	uint8_t expectedCiphertext[16];
+
+	/**
+	 *
+	 * Convert the group of round 10 keys to cipher keys, encrypt, and compare the first keyCount ciphertexts against the expected one
+	 */
+	void checkGroup(uint8_t const * lastRoundKeys, uint64_t keyCount) override {
+		uint8_t keys[16 * MaxKeysPerCall];
+		uint8_t ciphertexts[16 * MaxKeysPerCall];
+		for(uint32_t offset = 0 ; offset < keysPerCall ; offset += 4) {
+			AES128Kernels::invertKeySchedule4(lastRoundKeys + offset * 16, keys + offset * 16);
+		}
+		AES128Kernels::encrypt(kernel, keys, plaintext, ciphertexts);
+		for(uint64_t keyIndex = 0 ; keyIndex < keyCount ; keyIndex++) {
+			if(0 == memcmp(expectedCiphertext, ciphertexts + keyIndex * 16, 16)) {
+				setFound(lastRoundKeys + keyIndex * 16);
+			}
+		}
+	}
+};
+
+/**
+ *
+ * Builds AES128LastRoundKeyVerifiers.  Unless a kernel is given, every verifier uses AES128Kernels::fastestSupported().
+ */
+class AES128LastRoundKeyVerifierFactory : public KeyVerifierFactory<128> {
+public:
+	/**
+	 *
+	 * @param plaintext
+	 * @param ciphertext
+	 * @throws std::runtime_error if the CPU does not support AES-NI
+	 */
+	AES128LastRoundKeyVerifierFactory(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext)
+	: AES128LastRoundKeyVerifierFactory(plaintext, ciphertext, AES128Kernels::fastestSupported())
+	{
+	}
+
+	/**
+	 *
+	 * @param plaintext
+	 * @param ciphertext
+	 * @param kernel
+	 * @throws std::invalid_argument if the CPU does not support the kernel
+	 */
+	AES128LastRoundKeyVerifierFactory(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext, AES128Kernel kernel)
+	: KeyVerifierFactory<128>()
+	, plaintext(plaintext)
+	, ciphertext(ciphertext)
+	, kernel(kernel)
+	{
+		if(!AES128Kernels::isSupported(kernel)) {
+			std::stringstream error;
+			error << "The CPU does not support the " << AES128Kernels::name(kernel) << " AES-128 kernel";
+			throw std::invalid_argument(error.str().c_str());
+		}
+	}
+
+	~AES128LastRoundKeyVerifierFactory() {}
+
+	std::unique_ptr<KeyVerifier<128>> newVerifier() const override {
+		auto * verifier = new AES128LastRoundKeyVerifier(plaintext, ciphertext, kernel);
+		return std::unique_ptr<AES128LastRoundKeyVerifier>(verifier);
+	}
+
+	/**
+	 *
+	 * @return the kernel used by the verifiers
+	 */
+	AES128Kernel getKernel() const {
+		return kernel;
+	}
+private:
+	std::vector<uint8_t> const plaintext;
+	std::vector<uint8_t> const ciphertext;
+	AES128Kernel const kernel;
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AES128LASTROUNDKEYVERIFIER_HPP_ */
@@ -48,6 +48,7 @@
 #ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AES128NIENCRYPTUNROLLEDKEYVERIFIER_HPP_
 #define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AES128NIENCRYPTUNROLLEDKEYVERIFIER_HPP_
 
+#include "labynkyr/search/verify/GroupedKeyVerifier.hpp"
 #include "labynkyr/search/verify/KeyVerifier.hpp"
 
 #include <stdio.h>
@@ -67,118 +68,55 @@ namespace search {
 /**
  *
  * Implementation of the KeyVerifier interface for verifying AES-128 keys given a known plaintext and a ciphertext pair.  The
- * implementation uses the AES-NI instruction set and buffers 4 candidate keys at a time to maximise pipeline occupancy.
+ * implementation uses the AES-NI instruction set and encrypts 4 candidate keys at a time to maximise pipeline occupancy (see
+ * GroupedKeyVerifier).
  */
-class AES128NIEncryptUnrolledKeyVerifier : public KeyVerifier<128> {
+class AES128NIEncryptUnrolledKeyVerifier : public GroupedKeyVerifier<128> {
 public:
 	AES128NIEncryptUnrolledKeyVerifier(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext)
-	: KeyVerifier<128>()
-	, count(0)
-	, currentBatchSize(0)
-	, found(false)
-	, foundKeyBytes(16)
-	, output(16)
+	: GroupedKeyVerifier<128>(4)
 	{
-		#ifdef __APPLE__
-		posix_memalign((void**)&keysBuffer, 16, 16 * 4);
-		#else
-		keysBuffer = (uint8_t*) aligned_alloc(16, 16 * 4);
-		#endif
-
 		std::copy(plaintext.begin(), plaintext.end(), this->plaintext);
 		std::copy(ciphertext.begin(), ciphertext.end(), expectedCiphertext);
 	}
 
-	~AES128NIEncryptUnrolledKeyVerifier() {
-		free(keysBuffer);
-	}
-
-	void checkKey(std::vector<uint8_t> const & candidateKeyBytes) override {
-		// Copy the incoming key in
-		std::copy(candidateKeyBytes.begin(), candidateKeyBytes.end(), keysBuffer + currentBatchSize * 16);
-		count++;
-		currentBatchSize++;
-		if(currentBatchSize == 4) {
-			unrolledKeys(keysBuffer, plaintext, ciphertextsBuffer);
-			runCheck();
-		}
-	}
-
-	uint64_t keysChecked() const override {
-		return count;
-	}
-
-	bool success() const override {
-		return found;
-	}
-
-	Key<128> correctKey() override {
-		if(found) {
-			Key<128> const key(foundKeyBytes);
-			return key;
-		}
-		throw std::logic_error("Key has not been found");
-	}
-
-	void flush() override {
-		unrolledKeys(keysBuffer, plaintext, ciphertextsBuffer);
-		runCheck();
-	}
+	~AES128NIEncryptUnrolledKeyVerifier() {}
 private:
-	uint64_t count;
-	uint64_t currentBatchSize;
-	bool found;
-	std::vector<uint8_t> foundKeyBytes;
-	std::vector<uint8_t> output;
-
 	uint8_t plaintext[16] 								__attribute__((aligned(16)));
 	uint8_t expectedCiphertext[16] 						__attribute__((aligned(16)));
-	//uint8_t keysBuffer[64] 								__attribute__((aligned(64)));
-	uint8_t * keysBuffer;
-	uint8_t ciphertextsBuffer[64] 						__attribute__((aligned(64)));
 
 	uint32_t const rcon[16] = {0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36, 0x6c, 0xd8, 0xab, 0x4d, 0x9a };
 
 	/**
 	 *
-	 * Compare all four ciphertexts against the expected one.
+	 * Encrypt the group and compare the first keyCount ciphertexts against the expected one
 	 */
-	void runCheck() {
-		if(!found) {
-			if(0 == memcmp(&(expectedCiphertext[00]), &(ciphertextsBuffer[00]), 16)) {
-				found = true;
-				std::copy(keysBuffer, keysBuffer + 16, foundKeyBytes.begin());
-			}
-			if(0 == memcmp(&(expectedCiphertext[00]), &(ciphertextsBuffer[16]), 16)) {
-				found = true;
-				std::copy(keysBuffer + 16, keysBuffer + 32, foundKeyBytes.begin());
-			}
-			if(0 == memcmp(&(expectedCiphertext[00]), &(ciphertextsBuffer[32]), 16)) {
-				found = true;
-				std::copy(keysBuffer + 32, keysBuffer + 48, foundKeyBytes.begin());
-			}
-			if(0 == memcmp(&(expectedCiphertext[00]), &(ciphertextsBuffer[48]), 16)) {
-				found = true;
-				std::copy(keysBuffer + 48, keysBuffer + 64, foundKeyBytes.begin());
+	void checkGroup(uint8_t const * keys, uint64_t keyCount) override {
+		// The ciphertexts are kept on the stack: heap allocated verifiers are not guaranteed to honour over-aligned members
+		uint8_t ciphertexts[64] __attribute__((aligned(16)));
+		unrolledKeys(keys, plaintext, ciphertexts);
+		for(uint64_t keyIndex = 0 ; keyIndex < keyCount ; keyIndex++) {
+			if(0 == memcmp(&(expectedCiphertext[00]), &(ciphertexts[keyIndex * 16]), 16)) {
+				setFound(keys + keyIndex * 16);
 			}
-			currentBatchSize = 0;
 		}
 	}
 
-	void unrolledKeys(uint8_t * keys, uint8_t * plaintext, uint8_t *ciphertexts) {
+	void unrolledKeys(uint8_t const * keys, uint8_t const * plaintext, uint8_t * ciphertexts) {
 
 	  __m128i const mask = _mm_set_epi8(0x0C, 0x03, 0x06, 0x09, 0x08, 0x0F, 0x02, 0x05,
 	                              0x04, 0x0B, 0x0E, 0x01, 0x00, 0x07, 0x0A, 0x0D);
 
 	  __m128i tmp0;
-	  __m128i zero = _mm_xor_si128(tmp0, tmp0);
+	  __m128i zero = _mm_setzero_si128();
 
-	  __m128i key0  = _mm_load_si128((__m128i*)&(keys[ 0]));
-	  __m128i key1  = _mm_load_si128((__m128i*)&(keys[16]));
-	  __m128i key2  = _mm_load_si128((__m128i*)&(keys[32]));
-	  __m128i key3  = _mm_load_si128((__m128i*)&(keys[48]));
+	  // Keys may come straight from a caller's block, so do not assume alignment
+	  __m128i key0  = _mm_loadu_si128((__m128i const*)&(keys[ 0]));
+	  __m128i key1  = _mm_loadu_si128((__m128i const*)&(keys[16]));
+	  __m128i key2  = _mm_loadu_si128((__m128i const*)&(keys[32]));
+	  __m128i key3  = _mm_loadu_si128((__m128i const*)&(keys[48]));
 
-	  __m128i data0  = _mm_load_si128((__m128i*) plaintext);
+	  __m128i data0  = _mm_load_si128((__m128i const*) plaintext);
 	  __m128i data1  = data0;
 	  __m128i data2  = data0;
 	  __m128i data3  = data0;
@@ -0,0 +1,272 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * AESLongKeyKernels.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AESLONGKEYKERNELS_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AESLONGKEYKERNELS_HPP_
+
+#include "labynkyr/search/verify/AES128Kernels.hpp"
+
+#include <stdint.h>
+
+#include <immintrin.h>
+#include <wmmintrin.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * The AES-192 and AES-256 encryption kernels available to AESLongKeyVerifier
+ */
+enum AESLongKeyKernel {
+	// AES-NI, 4 keys interleaved
+	AESNI4LongKeyKernel,
+	// AES-NI, 8 keys interleaved, to hide the latency of aesenc on cores that can issue more than one per cycle
+	AESNI8LongKeyKernel
+};
+
+/**
+ *
+ * AES-192 and AES-256 encryption of a single plaintext under a group of candidate keys, with the key schedule computed on the fly.
+ *
+ * The key schedule is the one used by AES128Kernels: the keys are transposed in groups of 4 so that one register holds the same word of
+ * each key, and SubWord is applied to 4 keys at once with aesenclast followed by a shuffle.  With the words transposed, the round keys of
+ * AES-192, which straddle the 6-word blocks of the schedule, are simply every 4 consecutive registers.  The schedule is interleaved with
+ * the rounds, each round running as soon as the schedule has generated its key.
+ *
+ * @tparam KeyLenBits 192 or 256
+ */
+template<uint32_t KeyLenBits>
+class AESLongKeyKernels {
+public:
+	static_assert(KeyLenBits == 192 || KeyLenBits == 256, "AESLongKeyKernels supports AES-192 and AES-256");
+
+	enum {
+		KeyLenBytes = KeyLenBits / 8,
+		KeyWords = KeyLenBits / 32,
+		Rounds = KeyWords + 6,
+		ScheduleWords = 4 * (Rounds + 1)
+	};
+
+	/**
+	 *
+	 * @param kernel
+	 * @return the number of keys encrypted by each call to the kernel
+	 */
+	static uint32_t keysPerCall(AESLongKeyKernel kernel) {
+		return (kernel == AESNI4LongKeyKernel) ? 4 : 8;
+	}
+
+	/**
+	 *
+	 * @return true if the CPU the program is running on supports AES-NI
+	 */
+	static bool isSupported() {
+		return AES128Kernels::isSupported(AESNI4Kernel);
+	}
+
+	/**
+	 *
+	 * @param kernel
+	 * @return a short name for the kernel
+	 */
+	static std::string name(AESLongKeyKernel kernel) {
+		std::stringstream kernelName;
+		kernelName << "AES-" << KeyLenBits << " AES-NI x" << keysPerCall(kernel);
+		return kernelName.str();
+	}
+
+	/**
+	 *
+	 * Encrypt a plaintext under keysPerCall(kernel) keys
+	 *
+	 * @param kernel
+	 * @param keys the keys, stored back to back.  No alignment is required.
+	 * @param plaintext 16 bytes
+	 * @param ciphertexts receives one 16 byte ciphertext per key, stored back to back
+	 */
+	static void encrypt(AESLongKeyKernel kernel, uint8_t const * keys, uint8_t const * plaintext, uint8_t * ciphertexts) {
+		if(kernel == AESNI4LongKeyKernel) {
+			encryptGroups<1>(keys, plaintext, ciphertexts);
+		} else {
+			encryptGroups<2>(keys, plaintext, ciphertexts);
+		}
+	}
+
+	/**
+	 *
+	 * Encrypt a plaintext under a single key
+	 *
+	 * @param key
+	 * @param plaintext 16 bytes
+	 * @param ciphertext receives the 16 byte ciphertext
+	 */
+	static void encryptOne(uint8_t const * key, uint8_t const * plaintext, uint8_t * ciphertext) {
+		uint8_t keys[4 * KeyLenBytes];
+		uint8_t ciphertexts[4 * 16];
+		for(uint32_t index = 0 ; index < 4 ; index++) {
+			std::copy(key, key + KeyLenBytes, keys + index * KeyLenBytes);
+		}
+		encryptGroups<1>(keys, plaintext, ciphertexts);
+		std::copy(ciphertexts, ciphertexts + 16, ciphertext);
+	}
+
+	/**
+	 *
+	 * Groups of 4 keys, each with its own transposed key schedule, with their rounds interleaved
+	 *
+	 * @tparam Groups the number of groups of 4 keys
+	 */
+	template<uint32_t Groups>
+	static void encryptGroups(uint8_t const * keys, uint8_t const * plaintext, uint8_t * ciphertexts) {
+		// Undo ShiftRows, then rotate each word (RotWord)
+		__m128i const rotWordMask = _mm_set_epi8(0x0C, 0x03, 0x06, 0x09, 0x08, 0x0F, 0x02, 0x05, 0x04, 0x0B, 0x0E, 0x01, 0x00, 0x07, 0x0A, 0x0D);
+		// Undo ShiftRows only, for the extra SubWord step of the AES-256 schedule
+		__m128i const subWordMask = _mm_set_epi8(0x03, 0x06, 0x09, 0x0C, 0x0F, 0x02, 0x05, 0x08, 0x0B, 0x0E, 0x01, 0x04, 0x07, 0x0A, 0x0D, 0x00);
+		__m128i const zero = _mm_setzero_si128();
+		__m128i const data = _mm_loadu_si128((__m128i const *) plaintext);
+
+		__m128i words[Groups][ScheduleWords];
+		__m128i state[Groups * 4];
+		for(uint32_t group = 0 ; group < Groups ; group++) {
+			uint8_t const * groupKeys = keys + group * 4 * KeyLenBytes;
+			// Words 0 to 3, which are also the round 0 keys
+			__m128i roundKeys[4];
+			for(uint32_t index = 0 ; index < 4 ; index++) {
+				roundKeys[index] = _mm_loadu_si128((__m128i const *) &(groupKeys[index * KeyLenBytes]));
+				state[group * 4 + index] = _mm_xor_si128(data, roundKeys[index]);
+			}
+			transpose(roundKeys, &(words[group][0]));
+			// Words 4 to KeyWords - 1; AES-192 has only 2, so 8 byte loads keep within the last key
+			for(uint32_t index = 0 ; index < 4 ; index++) {
+				uint8_t const * tail = &(groupKeys[index * KeyLenBytes + 16]);
+				roundKeys[index] = (KeyWords == 8) ? _mm_loadu_si128((__m128i const *) tail) : _mm_loadl_epi64((__m128i const *) tail);
+			}
+			transpose(roundKeys, &(words[group][4]));
+		}
+
+		// AES-256 loads the round 1 key along with the cipher key
+		if(KeyWords == 8) {
+			encryptRound<Groups>(words, state, 1);
+		}
+		// Fully unrolled, so that every branch below is resolved at compile time and the schedule words stay in registers
+		#pragma GCC unroll 64
+		for(uint32_t index = KeyWords ; index < ScheduleWords ; index++) {
+			for(uint32_t group = 0 ; group < Groups ; group++) {
+				__m128i tmp = words[group][index - 1];
+				if(index % KeyWords == 0) {
+					tmp = _mm_shuffle_epi8(_mm_aesenclast_si128(tmp, zero), rotWordMask);
+					tmp = _mm_xor_si128(tmp, _mm_set1_epi32(rcon(index / KeyWords)));
+				} else if(KeyWords == 8 && index % KeyWords == 4) {
+					tmp = _mm_shuffle_epi8(_mm_aesenclast_si128(tmp, zero), subWordMask);
+				}
+				words[group][index] = _mm_xor_si128(words[group][index - KeyWords], tmp);
+			}
+			if(index % 4 == 3) {
+				encryptRound<Groups>(words, state, index / 4);
+			}
+		}
+
+		for(uint32_t index = 0 ; index < Groups * 4 ; index++) {
+			_mm_storeu_si128((__m128i *) &(ciphertexts[index * 16]), state[index]);
+		}
+	}
+private:
+	/**
+	 *
+	 * Apply a round to every state, once the schedule words 4 * round to 4 * round + 3 have been generated
+	 */
+	template<uint32_t Groups>
+	static void encryptRound(__m128i const (&words)[Groups][ScheduleWords], __m128i (&state)[Groups * 4], uint32_t round) {
+		for(uint32_t group = 0 ; group < Groups ; group++) {
+			__m128i roundKeys[4];
+			transpose(&(words[group][4 * round]), roundKeys);
+			for(uint32_t index = 0 ; index < 4 ; index++) {
+				if(round < Rounds) {
+					state[group * 4 + index] = _mm_aesenc_si128(state[group * 4 + index], roundKeys[index]);
+				} else {
+					state[group * 4 + index] = _mm_aesenclast_si128(state[group * 4 + index], roundKeys[index]);
+				}
+			}
+		}
+	}
+
+	/**
+	 *
+	 * 4x4 transpose of 32-bit words, which converts between 4 keys (or round keys) and 4 schedule words
+	 */
+	static void transpose(__m128i const * input, __m128i * output) {
+		__m128i const rki = _mm_unpacklo_epi32(input[0], input[1]);
+		__m128i const rkj = _mm_unpacklo_epi32(input[2], input[3]);
+		__m128i const rkk = _mm_unpackhi_epi32(input[0], input[1]);
+		__m128i const rkl = _mm_unpackhi_epi32(input[2], input[3]);
+		output[0] = _mm_unpacklo_epi64(rki, rkj);
+		output[1] = _mm_unpackhi_epi64(rki, rkj);
+		output[2] = _mm_unpacklo_epi64(rkk, rkl);
+		output[3] = _mm_unpackhi_epi64(rkk, rkl);
+	}
+
+	/**
+	 *
+	 * @param index 1 to 8
+	 * @return the key schedule round constant
+	 */
+	static uint32_t rcon(uint32_t index) {
+		static uint32_t const roundConstants[9] = {0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+		return roundConstants[index];
+	}
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AESLONGKEYKERNELS_HPP_ */
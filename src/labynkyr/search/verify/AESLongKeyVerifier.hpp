@@ -0,0 +1,303 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * AESLongKeyVerifier.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AESLONGKEYVERIFIER_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AESLONGKEYVERIFIER_HPP_
+
+#include "labynkyr/search/verify/AESLongKeyKernels.hpp"
+#include "labynkyr/search/verify/GroupedKeyVerifier.hpp"
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Implementation of the KeyVerifier interface for verifying AES-192 or AES-256 keys, using one of the AESLongKeyKernels.
+ *
+ * A single 128-bit block cannot single out a 192- or 256-bit key: around 2^64 or 2^128 keys map a given plaintext to a given
+ * ciphertext.  The verifier therefore takes a second known plaintext and ciphertext pair to confirm candidates.  Every candidate key is
+ * encrypted on the first block, and the ciphertexts are screened by comparing their first 8 bytes; only keys passing the full comparison
+ * are encrypted on the second block.  Without a second pair, any key matching the first block is reported.
+ *
+ * Keys are encrypted in groups of the kernel's keysPerCall (see GroupedKeyVerifier).
+ *
+ * @tparam KeyLenBits 192 or 256
+ */
+template<uint32_t KeyLenBits>
+class AESLongKeyVerifier : public GroupedKeyVerifier<KeyLenBits> {
+public:
+	enum {
+		KeyLenBytes = KeyLenBits / 8,
+		// The largest number of keys encrypted by any kernel
+		MaxKeysPerCall = 8
+	};
+
+	/**
+	 *
+	 * Checks keys against a single block, using the AESNI8LongKeyKernel
+	 *
+	 * @param plaintext 16 bytes
+	 * @param ciphertext 16 bytes
+	 * @throws std::invalid_argument
+	 * @throws std::runtime_error if the CPU does not support AES-NI
+	 */
+	AESLongKeyVerifier(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext)
+	: AESLongKeyVerifier(plaintext, ciphertext, std::vector<uint8_t>(), std::vector<uint8_t>(), AESNI8LongKeyKernel)
+	{
+	}
+
+	/**
+	 *
+	 * Uses the AESNI8LongKeyKernel
+	 *
+	 * @param plaintext 16 bytes
+	 * @param ciphertext 16 bytes
+	 * @param confirmPlaintext 16 bytes, or empty to skip confirmation
+	 * @param confirmCiphertext 16 bytes, or empty to skip confirmation
+	 * @throws std::invalid_argument
+	 * @throws std::runtime_error if the CPU does not support AES-NI
+	 */
+	AESLongKeyVerifier(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext,
+			std::vector<uint8_t> const & confirmPlaintext, std::vector<uint8_t> const & confirmCiphertext)
+	: AESLongKeyVerifier(plaintext, ciphertext, confirmPlaintext, confirmCiphertext, AESNI8LongKeyKernel)
+	{
+	}
+
+	/**
+	 *
+	 * @param plaintext 16 bytes
+	 * @param ciphertext 16 bytes
+	 * @param confirmPlaintext 16 bytes, or empty to skip confirmation
+	 * @param confirmCiphertext 16 bytes, or empty to skip confirmation
+	 * @param kernel
+	 * @throws std::invalid_argument
+	 * @throws std::runtime_error if the CPU does not support AES-NI
+	 */
+	AESLongKeyVerifier(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext,
+			std::vector<uint8_t> const & confirmPlaintext, std::vector<uint8_t> const & confirmCiphertext, AESLongKeyKernel kernel)
+	: GroupedKeyVerifier<KeyLenBits>(AESLongKeyKernels<KeyLenBits>::keysPerCall(kernel))
+	, kernel(kernel)
+	, confirm(!confirmPlaintext.empty())
+	, confirmations(0)
+	{
+		checkArguments(plaintext, ciphertext, confirmPlaintext, confirmCiphertext);
+		std::copy(plaintext.begin(), plaintext.end(), this->plaintext);
+		std::copy(ciphertext.begin(), ciphertext.end(), expectedCiphertext);
+		std::copy(confirmPlaintext.begin(), confirmPlaintext.end(), this->confirmPlaintext);
+		std::copy(confirmCiphertext.begin(), confirmCiphertext.end(), expectedConfirmCiphertext);
+		memcpy(&expectedPrefix, expectedCiphertext, 8);
+	}
+
+	~AESLongKeyVerifier() {}
+
+	/**
+	 *
+	 * @return the kernel used to encrypt candidate keys
+	 */
+	AESLongKeyKernel getKernel() const {
+		return kernel;
+	}
+
+	/**
+	 *
+	 * @return the number of candidates that matched the first block and were encrypted on the second
+	 */
+	uint64_t confirmationsRun() const {
+		return confirmations;
+	}
+
+	/**
+	 *
+	 * Shared with AESLongKeyVerifierFactory, so that bad arguments are reported when the factory is built
+	 *
+	 * @throws std::invalid_argument
+	 */
+	static void checkArguments(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext,
+			std::vector<uint8_t> const & confirmPlaintext, std::vector<uint8_t> const & confirmCiphertext) {
+		if(plaintext.size() != 16 || ciphertext.size() != 16) {
+			throw std::invalid_argument("An AES plaintext and ciphertext are 16 bytes long");
+		}
+		if(confirmPlaintext.size() != confirmCiphertext.size() || (!confirmPlaintext.empty() && confirmPlaintext.size() != 16)) {
+			throw std::invalid_argument("The confirmation plaintext and ciphertext must both be 16 bytes long, or both be empty");
+		}
+		if(!AESLongKeyKernels<KeyLenBits>::isSupported()) {
+			throw std::runtime_error("The CPU does not support AES-NI");
+		}
+	}
+private:
+	AESLongKeyKernel const kernel;
+	bool const confirm;
+	uint64_t confirmations;
+	uint64_t expectedPrefix;
+	uint8_t plaintext[16];
+	uint8_t expectedCiphertext[16];
+	uint8_t confirmPlaintext[16];
+	uint8_t expectedConfirmCiphertext[16];
+
+	/**
+	 *
+	 * Encrypt the group, screen the first keyCount ciphertexts on their first 8 bytes, then confirm any that match in full
+	 */
+	void checkGroup(uint8_t const * keys, uint64_t keyCount) override {
+		uint8_t ciphertexts[16 * MaxKeysPerCall];
+		AESLongKeyKernels<KeyLenBits>::encrypt(kernel, keys, plaintext, ciphertexts);
+		for(uint64_t keyIndex = 0 ; keyIndex < keyCount ; keyIndex++) {
+			uint64_t prefix;
+			memcpy(&prefix, ciphertexts + keyIndex * 16, 8);
+			if(prefix == expectedPrefix && 0 == memcmp(expectedCiphertext + 8, ciphertexts + keyIndex * 16 + 8, 8)) {
+				uint8_t const * candidateKey = keys + keyIndex * KeyLenBytes;
+				if(confirmKey(candidateKey)) {
+					this->setFound(candidateKey);
+				}
+			}
+		}
+	}
+
+	/**
+	 *
+	 * @return true if the key also encrypts the second plaintext to the second ciphertext, or if there is no second pair
+	 */
+	bool confirmKey(uint8_t const * candidateKey) {
+		if(!confirm) {
+			return true;
+		}
+		confirmations++;
+		uint8_t ciphertext[16];
+		AESLongKeyKernels<KeyLenBits>::encryptOne(candidateKey, confirmPlaintext, ciphertext);
+		return 0 == memcmp(expectedConfirmCiphertext, ciphertext, 16);
+	}
+};
+
+typedef AESLongKeyVerifier<192> AES192KeyVerifier;
+typedef AESLongKeyVerifier<256> AES256KeyVerifier;
+
+/**
+ *
+ * Builds AESLongKeyVerifiers, e.g to search AES-256 keys with a PEUPool through KeyVerifierFactory<256>
+ *
+ * @tparam KeyLenBits 192 or 256
+ */
+template<uint32_t KeyLenBits>
+class AESLongKeyVerifierFactory : public KeyVerifierFactory<KeyLenBits> {
+public:
+	/**
+	 *
+	 * Uses the AESNI8LongKeyKernel
+	 *
+	 * @param plaintext 16 bytes
+	 * @param ciphertext 16 bytes
+	 * @param confirmPlaintext 16 bytes, or empty to skip confirmation
+	 * @param confirmCiphertext 16 bytes, or empty to skip confirmation
+	 * @throws std::invalid_argument
+	 * @throws std::runtime_error if the CPU does not support AES-NI
+	 */
+	AESLongKeyVerifierFactory(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext,
+			std::vector<uint8_t> const & confirmPlaintext, std::vector<uint8_t> const & confirmCiphertext)
+	: AESLongKeyVerifierFactory(plaintext, ciphertext, confirmPlaintext, confirmCiphertext, AESNI8LongKeyKernel)
+	{
+	}
+
+	/**
+	 *
+	 * @param plaintext 16 bytes
+	 * @param ciphertext 16 bytes
+	 * @param confirmPlaintext 16 bytes, or empty to skip confirmation
+	 * @param confirmCiphertext 16 bytes, or empty to skip confirmation
+	 * @param kernel
+	 * @throws std::invalid_argument
+	 * @throws std::runtime_error if the CPU does not support AES-NI
+	 */
+	AESLongKeyVerifierFactory(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext,
+			std::vector<uint8_t> const & confirmPlaintext, std::vector<uint8_t> const & confirmCiphertext, AESLongKeyKernel kernel)
+	: KeyVerifierFactory<KeyLenBits>()
+	, plaintext(plaintext)
+	, ciphertext(ciphertext)
+	, confirmPlaintext(confirmPlaintext)
+	, confirmCiphertext(confirmCiphertext)
+	, kernel(kernel)
+	{
+		AESLongKeyVerifier<KeyLenBits>::checkArguments(plaintext, ciphertext, confirmPlaintext, confirmCiphertext);
+	}
+
+	~AESLongKeyVerifierFactory() {}
+
+	std::unique_ptr<KeyVerifier<KeyLenBits>> newVerifier() const override {
+		auto * verifier = new AESLongKeyVerifier<KeyLenBits>(plaintext, ciphertext, confirmPlaintext, confirmCiphertext, kernel);
+		return std::unique_ptr<AESLongKeyVerifier<KeyLenBits>>(verifier);
+	}
+
+	/**
+	 *
+	 * @return the kernel used by the verifiers
+	 */
+	AESLongKeyKernel getKernel() const {
+		return kernel;
+	}
+private:
+	std::vector<uint8_t> const plaintext;
+	std::vector<uint8_t> const ciphertext;
+	std::vector<uint8_t> const confirmPlaintext;
+	std::vector<uint8_t> const confirmCiphertext;
+	AESLongKeyKernel const kernel;
+};
+
+typedef AESLongKeyVerifierFactory<192> AES192KeyVerifierFactory;
+typedef AESLongKeyVerifierFactory<256> AES256KeyVerifierFactory;
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_AESLONGKEYVERIFIER_HPP_ */
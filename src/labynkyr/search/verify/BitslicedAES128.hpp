@@ -0,0 +1,509 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * BitslicedAES128.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_BITSLICEDAES128_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_BITSLICEDAES128_HPP_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * The number of keys a BitslicedAES128 call encrypts, i.e the width of the words each bit of the state is held in
+ */
+enum BitslicedAES128Width {
+	Bitsliced64Width,
+	Bitsliced128Width,
+	Bitsliced256Width
+};
+
+/**
+ *
+ * A software AES-128 implementation that does not need AES-NI, for checking many candidate keys against a single known plaintext and
+ * ciphertext pair.  The cipher is bitsliced across keys: each of the 128 state bits (and round key bits) is held in one word, whose
+ * lane j belongs to key j.  A word is a uint64_t, or a 128 or 256-bit GCC vector that the compiler maps onto SSE2 or AVX2 registers, so
+ * 64, 128 or 256 keys are encrypted at a time.  The S-box is the 113 gate circuit of Boyar and Peralta; ShiftRows is free.
+ *
+ * The final round first computes only two bytes of each ciphertext.  When no key matches them, the remaining 14 S-boxes (and 3 of the key
+ * schedule) are skipped.
+ */
+class BitslicedAES128 {
+public:
+	typedef uint64_t Word64;
+	typedef uint64_t Word128 __attribute__((vector_size(16)));
+	typedef uint64_t Word256 __attribute__((vector_size(32)));
+
+	/**
+	 *
+	 * @param width
+	 * @return the number of keys encrypted per call
+	 */
+	static uint32_t keysPerCall(BitslicedAES128Width width) {
+		switch(width) {
+		case Bitsliced64Width:
+			return 64;
+		case Bitsliced128Width:
+			return 128;
+		default:
+			return 256;
+		}
+	}
+
+	/**
+	 *
+	 * @return 256 if the CPU supports AVX2, 128 otherwise
+	 */
+	static BitslicedAES128Width fastestSupported() {
+		return __builtin_cpu_supports("avx2") ? Bitsliced256Width : Bitsliced128Width;
+	}
+
+	/**
+	 *
+	 * @param width
+	 * @return a short description of the width
+	 */
+	static std::string name(BitslicedAES128Width width) {
+		switch(width) {
+		case Bitsliced64Width:
+			return "Bitsliced x64";
+		case Bitsliced128Width:
+			return "Bitsliced x128";
+		default:
+			return "Bitsliced x256";
+		}
+	}
+
+	/**
+	 *
+	 * Encrypt a plaintext under keysPerCall(width) keys, and find the keys that produce the expected ciphertext
+	 *
+	 * @param width
+	 * @param keys the keys, stored back to back
+	 * @param plaintext 16 bytes
+	 * @param ciphertext the expected 16 byte ciphertext
+	 * @param matches receives keysPerCall(width) / 8 bytes: bit j % 8 of byte j / 8 is set if key j is a match
+	 * @return true if any key is a match
+	 */
+	static bool findMatches(BitslicedAES128Width width, uint8_t const * keys, uint8_t const * plaintext, uint8_t const * ciphertext,
+			uint8_t * matches) {
+		switch(width) {
+		case Bitsliced64Width:
+			return findMatches<Word64>(keys, plaintext, ciphertext, matches);
+		case Bitsliced128Width:
+			return findMatches<Word128>(keys, plaintext, ciphertext, matches);
+		default:
+			return findMatches<Word256>(keys, plaintext, ciphertext, matches);
+		}
+	}
+
+	/**
+	 *
+	 * As above, for a single width
+	 *
+	 * @tparam Word Word64, Word128 or Word256
+	 */
+	template<typename Word>
+	static bool findMatches(uint8_t const * keys, uint8_t const * plaintext, uint8_t const * ciphertext, uint8_t * matches) {
+		Word const ones = ~Word();
+		Word state[128];
+		Word roundKey[128];
+		transpose(keys, roundKey);
+		for(uint32_t bit = 0 ; bit < 128 ; bit++) {
+			state[bit] = isSet(plaintext, bit) ? ~roundKey[bit] : roundKey[bit];
+		}
+		for(uint32_t round = 1 ; round < 10 ; round++) {
+			for(uint32_t byte = 0 ; byte < 16 ; byte++) {
+				sbox(state + byte * 8, state + byte * 8);
+			}
+			shiftRowsMixColumns(state);
+			expandKey(roundKey, round);
+			for(uint32_t bit = 0 ; bit < 128 ; bit++) {
+				state[bit] ^= roundKey[bit];
+			}
+		}
+
+		// Ciphertext bytes 0 and 1 come from state bytes 0 and 5, and round key bytes 0 and 1 from SubWord of round 9 key bytes 13 and 14
+		Word sboxOutput[8];
+		Word mismatch = Word();
+		for(uint32_t byte = 0 ; byte < 2 ; byte++) {
+			Word keyBits[8];
+			sbox(roundKey + (13 + byte) * 8, keyBits);
+			sbox(state + (byte * 5) * 8, sboxOutput);
+			for(uint32_t bit = 0 ; bit < 8 ; bit++) {
+				Word const keyBit = roundKey[byte * 8 + bit] ^ keyBits[bit] ^ ((byte == 0 && ((rcon(10) >> bit) & 1)) ? ones : Word());
+				Word const expected = isSet(ciphertext, byte * 8 + bit) ? ones : Word();
+				mismatch |= sboxOutput[bit] ^ keyBit ^ expected;
+			}
+		}
+		if(isAllOnes(mismatch)) {
+			memset(matches, 0, sizeof(Word));
+			return false;
+		}
+
+		for(uint32_t byte = 0 ; byte < 16 ; byte++) {
+			sbox(state + byte * 8, state + byte * 8);
+		}
+		shiftRows(state);
+		expandKey(roundKey, 10);
+		for(uint32_t bit = 0 ; bit < 128 ; bit++) {
+			Word const expected = isSet(ciphertext, bit) ? ones : Word();
+			mismatch |= state[bit] ^ roundKey[bit] ^ expected;
+		}
+		Word const matched = ~mismatch;
+		memcpy(matches, &matched, sizeof(Word));
+		return !isAllOnes(mismatch);
+	}
+private:
+	/**
+	 *
+	 * @param round 1 to 10
+	 * @return the key schedule round constant
+	 */
+	static uint32_t rcon(uint32_t round) {
+		static uint32_t const roundConstants[11] = {0x8d, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36};
+		return roundConstants[round];
+	}
+
+	/**
+	 *
+	 * @return bit (bit % 8) of byte (bit / 8)
+	 */
+	static bool isSet(uint8_t const * bytes, uint32_t bit) {
+		return (bytes[bit / 8] >> (bit % 8)) & 1;
+	}
+
+	template<typename Word>
+	static bool isAllOnes(Word const & word) {
+		uint64_t elements[sizeof(Word) / 8];
+		memcpy(elements, &word, sizeof(Word));
+		uint64_t combined = ~0ULL;
+		for(uint32_t index = 0 ; index < sizeof(Word) / 8 ; index++) {
+			combined &= elements[index];
+		}
+		return combined == ~0ULL;
+	}
+
+	/**
+	 *
+	 * Transpose 8 keys at a time with the 8x8 bit matrix transpose from Hacker's Delight: byte t of the input word holds byte b of key t,
+	 * and byte k of the output holds bit k of byte b of the 8 keys.
+	 *
+	 * @param keys sizeof(Word) * 8 keys stored back to back
+	 * @param planes receives word (b * 8 + k) = bit k of byte b of every key
+	 */
+	template<typename Word>
+	static void transpose(uint8_t const * keys, Word * planes) {
+		uint32_t const groups = sizeof(Word);
+		uint8_t planeBytes[128][sizeof(Word)];
+		for(uint32_t group = 0 ; group < groups ; group++) {
+			uint8_t const * groupKeys = keys + group * 8 * 16;
+			for(uint32_t byte = 0 ; byte < 16 ; byte++) {
+				uint64_t x = 0;
+				for(uint32_t key = 0 ; key < 8 ; key++) {
+					x |= static_cast<uint64_t>(groupKeys[key * 16 + byte]) << (key * 8);
+				}
+				uint64_t t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+				x = x ^ t ^ (t << 7);
+				t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+				x = x ^ t ^ (t << 14);
+				t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+				x = x ^ t ^ (t << 28);
+				for(uint32_t bit = 0 ; bit < 8 ; bit++) {
+					planeBytes[byte * 8 + bit][group] = static_cast<uint8_t>(x >> (bit * 8));
+				}
+			}
+		}
+		memcpy(planes, planeBytes, sizeof(planeBytes));
+	}
+
+	/**
+	 *
+	 * The AES S-box on one bitsliced byte (Boyar and Peralta, "A depth-16 circuit for the AES S-box").  in and out may alias.
+	 *
+	 * @param in 8 words, least significant bit first
+	 * @param out 8 words, least significant bit first
+	 */
+	template<typename Word>
+	static inline void sbox(Word const * in, Word * out) {
+		Word const u0 = in[7];
+		Word const u1 = in[6];
+		Word const u2 = in[5];
+		Word const u3 = in[4];
+		Word const u4 = in[3];
+		Word const u5 = in[2];
+		Word const u6 = in[1];
+		Word const u7 = in[0];
+		Word const t1 = u0 ^ u3;
+		Word const t2 = u0 ^ u5;
+		Word const t3 = u0 ^ u6;
+		Word const t4 = u3 ^ u5;
+		Word const t5 = u4 ^ u6;
+		Word const t6 = t1 ^ t5;
+		Word const t7 = u1 ^ u2;
+		Word const t8 = u7 ^ t6;
+		Word const t9 = u7 ^ t7;
+		Word const t10 = t6 ^ t7;
+		Word const t11 = u1 ^ u5;
+		Word const t12 = u2 ^ u5;
+		Word const t13 = t3 ^ t4;
+		Word const t14 = t6 ^ t11;
+		Word const t15 = t5 ^ t11;
+		Word const t16 = t5 ^ t12;
+		Word const t17 = t9 ^ t16;
+		Word const t18 = u3 ^ u7;
+		Word const t19 = t7 ^ t18;
+		Word const t20 = t1 ^ t19;
+		Word const t21 = u6 ^ u7;
+		Word const t22 = t7 ^ t21;
+		Word const t23 = t2 ^ t22;
+		Word const t24 = t2 ^ t10;
+		Word const t25 = t20 ^ t17;
+		Word const t26 = t3 ^ t16;
+		Word const t27 = t1 ^ t12;
+		Word const m1 = t13 & t6;
+		Word const m2 = t23 & t8;
+		Word const m3 = t14 ^ m1;
+		Word const m4 = t19 & u7;
+		Word const m5 = m4 ^ m1;
+		Word const m6 = t3 & t16;
+		Word const m7 = t22 & t9;
+		Word const m8 = t26 ^ m6;
+		Word const m9 = t20 & t17;
+		Word const m10 = m9 ^ m6;
+		Word const m11 = t1 & t15;
+		Word const m12 = t4 & t27;
+		Word const m13 = m12 ^ m11;
+		Word const m14 = t2 & t10;
+		Word const m15 = m14 ^ m11;
+		Word const m16 = m3 ^ m2;
+		Word const m17 = m5 ^ t24;
+		Word const m18 = m8 ^ m7;
+		Word const m19 = m10 ^ m15;
+		Word const m20 = m16 ^ m13;
+		Word const m21 = m17 ^ m15;
+		Word const m22 = m18 ^ m13;
+		Word const m23 = m19 ^ t25;
+		Word const m24 = m22 ^ m23;
+		Word const m25 = m22 & m20;
+		Word const m26 = m21 ^ m25;
+		Word const m27 = m20 ^ m21;
+		Word const m28 = m23 ^ m25;
+		Word const m29 = m28 & m27;
+		Word const m30 = m26 & m24;
+		Word const m31 = m20 & m23;
+		Word const m32 = m27 & m31;
+		Word const m33 = m27 ^ m25;
+		Word const m34 = m21 & m22;
+		Word const m35 = m24 & m34;
+		Word const m36 = m24 ^ m25;
+		Word const m37 = m21 ^ m29;
+		Word const m38 = m32 ^ m33;
+		Word const m39 = m23 ^ m30;
+		Word const m40 = m35 ^ m36;
+		Word const m41 = m38 ^ m40;
+		Word const m42 = m37 ^ m39;
+		Word const m43 = m37 ^ m38;
+		Word const m44 = m39 ^ m40;
+		Word const m45 = m42 ^ m41;
+		Word const m46 = m44 & t6;
+		Word const m47 = m40 & t8;
+		Word const m48 = m39 & u7;
+		Word const m49 = m43 & t16;
+		Word const m50 = m38 & t9;
+		Word const m51 = m37 & t17;
+		Word const m52 = m42 & t15;
+		Word const m53 = m45 & t27;
+		Word const m54 = m41 & t10;
+		Word const m55 = m44 & t13;
+		Word const m56 = m40 & t23;
+		Word const m57 = m39 & t19;
+		Word const m58 = m43 & t3;
+		Word const m59 = m38 & t22;
+		Word const m60 = m37 & t20;
+		Word const m61 = m42 & t1;
+		Word const m62 = m45 & t4;
+		Word const m63 = m41 & t2;
+		Word const l0 = m61 ^ m62;
+		Word const l1 = m50 ^ m56;
+		Word const l2 = m46 ^ m48;
+		Word const l3 = m47 ^ m55;
+		Word const l4 = m54 ^ m58;
+		Word const l5 = m49 ^ m61;
+		Word const l6 = m62 ^ l5;
+		Word const l7 = m46 ^ l3;
+		Word const l8 = m51 ^ m59;
+		Word const l9 = m52 ^ m53;
+		Word const l10 = m53 ^ l4;
+		Word const l11 = m60 ^ l2;
+		Word const l12 = m48 ^ m51;
+		Word const l13 = m50 ^ l0;
+		Word const l14 = m52 ^ m61;
+		Word const l15 = m55 ^ l1;
+		Word const l16 = m56 ^ l0;
+		Word const l17 = m57 ^ l1;
+		Word const l18 = m58 ^ l8;
+		Word const l19 = m63 ^ l4;
+		Word const l20 = l0 ^ l1;
+		Word const l21 = l1 ^ l7;
+		Word const l22 = l3 ^ l12;
+		Word const l23 = l18 ^ l2;
+		Word const l24 = l15 ^ l9;
+		Word const l25 = l6 ^ l10;
+		Word const l26 = l7 ^ l9;
+		Word const l27 = l8 ^ l10;
+		Word const l28 = l11 ^ l14;
+		Word const l29 = l11 ^ l17;
+		out[7] = l6 ^ l24;
+		out[6] = ~(l16 ^ l26);
+		out[5] = ~(l19 ^ l28);
+		out[4] = l6 ^ l21;
+		out[3] = l20 ^ l22;
+		out[2] = l25 ^ l29;
+		out[1] = ~(l13 ^ l27);
+		out[0] = ~(l6 ^ l23);
+	}
+
+	/**
+	 *
+	 * Multiply a bitsliced byte by x in GF(2^8)
+	 */
+	template<typename Word>
+	static inline void xtime(Word const * in, Word * out) {
+		out[0] = in[7];
+		out[1] = in[0] ^ in[7];
+		out[2] = in[1];
+		out[3] = in[2] ^ in[7];
+		out[4] = in[3] ^ in[7];
+		out[5] = in[4];
+		out[6] = in[5];
+		out[7] = in[6];
+	}
+
+	/**
+	 *
+	 * Row r of the state is rotated left by r bytes.  Byte r + 4c of the state is in row r and column c.
+	 */
+	template<typename Word>
+	static void shiftRows(Word * state) {
+		Word shifted[128];
+		for(uint32_t row = 0 ; row < 4 ; row++) {
+			for(uint32_t column = 0 ; column < 4 ; column++) {
+				Word const * source = state + (row + 4 * ((column + row) % 4)) * 8;
+				std::copy(source, source + 8, shifted + (row + 4 * column) * 8);
+			}
+		}
+		std::copy(shifted, shifted + 128, state);
+	}
+
+	/**
+	 *
+	 * ShiftRows followed by MixColumns, reading the ShiftRows output straight from the state.  Each output byte of a column is
+	 * b_r = 2(a_r + a_{r+1}) + a_{r+1} + a_{r+2} + a_{r+3}.
+	 */
+	template<typename Word>
+	static void shiftRowsMixColumns(Word * state) {
+		Word mixed[128];
+		for(uint32_t column = 0 ; column < 4 ; column++) {
+			Word const * a[4];
+			for(uint32_t row = 0 ; row < 4 ; row++) {
+				a[row] = state + (row + 4 * ((column + row) % 4)) * 8;
+			}
+			for(uint32_t row = 0 ; row < 4 ; row++) {
+				Word const * a0 = a[row];
+				Word const * a1 = a[(row + 1) % 4];
+				Word const * a2 = a[(row + 2) % 4];
+				Word const * a3 = a[(row + 3) % 4];
+				Word sum[8];
+				Word doubled[8];
+				for(uint32_t bit = 0 ; bit < 8 ; bit++) {
+					sum[bit] = a0[bit] ^ a1[bit];
+				}
+				xtime(sum, doubled);
+				Word * out = mixed + (row + 4 * column) * 8;
+				for(uint32_t bit = 0 ; bit < 8 ; bit++) {
+					out[bit] = doubled[bit] ^ a1[bit] ^ a2[bit] ^ a3[bit];
+				}
+			}
+		}
+		std::copy(mixed, mixed + 128, state);
+	}
+
+	/**
+	 *
+	 * Replace the round key for round - 1 with the key for round
+	 */
+	template<typename Word>
+	static void expandKey(Word * roundKey, uint32_t round) {
+		// SubWord(RotWord(w3)): byte i of the result is S(byte (i + 1) % 4 of w3), held in key bytes 12 to 15
+		Word substituted[32];
+		for(uint32_t byte = 0 ; byte < 4 ; byte++) {
+			sbox(roundKey + (12 + (byte + 1) % 4) * 8, substituted + byte * 8);
+		}
+		for(uint32_t bit = 0 ; bit < 8 ; bit++) {
+			if((rcon(round) >> bit) & 1) {
+				substituted[bit] = ~substituted[bit];
+			}
+		}
+		for(uint32_t bit = 0 ; bit < 32 ; bit++) {
+			roundKey[bit] ^= substituted[bit];
+		}
+		for(uint32_t bit = 32 ; bit < 128 ; bit++) {
+			roundKey[bit] ^= roundKey[bit - 32];
+		}
+	}
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_BITSLICEDAES128_HPP_ */
@@ -0,0 +1,180 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * BitslicedAES128KeyVerifier.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_BITSLICEDAES128KEYVERIFIER_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_BITSLICEDAES128KEYVERIFIER_HPP_
+
+#include "labynkyr/search/verify/BitslicedAES128.hpp"
+#include "labynkyr/search/verify/GroupedKeyVerifier.hpp"
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Implementation of the KeyVerifier interface for verifying AES-128 keys given a known plaintext and a ciphertext pair, on hosts without
+ * AES-NI (or with it masked off).  Keys are encrypted 64, 128 or 256 at a time with BitslicedAES128; by default 256 if the CPU supports
+ * AVX2 and 128 otherwise.
+ *
+ * Keys are encrypted in groups of the width (see GroupedKeyVerifier), so the verifier is best used behind a KeyBatch or a PEU, which pass
+ * keys in blocks.
+ */
+class BitslicedAES128KeyVerifier : public GroupedKeyVerifier<128> {
+public:
+	enum {
+		// The largest number of keys encrypted per call
+		MaxKeysPerCall = 256
+	};
+
+	/**
+	 *
+	 * Uses BitslicedAES128::fastestSupported()
+	 *
+	 * @param plaintext
+	 * @param ciphertext
+	 */
+	BitslicedAES128KeyVerifier(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext)
+	: BitslicedAES128KeyVerifier(plaintext, ciphertext, BitslicedAES128::fastestSupported())
+	{
+	}
+
+	/**
+	 *
+	 * @param plaintext
+	 * @param ciphertext
+	 * @param width
+	 */
+	BitslicedAES128KeyVerifier(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext, BitslicedAES128Width width)
+	: GroupedKeyVerifier<128>(BitslicedAES128::keysPerCall(width))
+	, width(width)
+	{
+		std::copy(plaintext.begin(), plaintext.end(), this->plaintext);
+		std::copy(ciphertext.begin(), ciphertext.end(), expectedCiphertext);
+	}
+
+	~BitslicedAES128KeyVerifier() {}
+
+	/**
+	 *
+	 * @return the width, i.e number of keys encrypted per call
+	 */
+	BitslicedAES128Width getWidth() const {
+		return width;
+	}
+private:
+	BitslicedAES128Width const width;
+	uint8_t plaintext[16];
+	uint8_t expectedCiphertext[16];
+
+	/**
+	 *
+	 * Encrypt the group, and record the first of the first keyCount keys that matches
+	 */
+	void checkGroup(uint8_t const * keys, uint64_t keyCount) override {
+		uint8_t matches[MaxKeysPerCall / 8];
+		if(BitslicedAES128::findMatches(width, keys, plaintext, expectedCiphertext, matches)) {
+			for(uint64_t keyIndex = 0 ; keyIndex < keyCount ; keyIndex++) {
+				if((matches[keyIndex / 8] >> (keyIndex % 8)) & 1) {
+					setFound(keys + keyIndex * 16);
+					break;
+				}
+			}
+		}
+	}
+};
+
+/**
+ *
+ * Builds BitslicedAES128KeyVerifiers.  Unless a width is given, every verifier uses BitslicedAES128::fastestSupported().
+ */
+class BitslicedAES128KeyVerifierFactory : public KeyVerifierFactory<128> {
+public:
+	BitslicedAES128KeyVerifierFactory(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext)
+	: BitslicedAES128KeyVerifierFactory(plaintext, ciphertext, BitslicedAES128::fastestSupported())
+	{
+	}
+
+	BitslicedAES128KeyVerifierFactory(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext, BitslicedAES128Width width)
+	: KeyVerifierFactory<128>()
+	, plaintext(plaintext)
+	, ciphertext(ciphertext)
+	, width(width)
+	{
+	}
+
+	~BitslicedAES128KeyVerifierFactory() {}
+
+	std::unique_ptr<KeyVerifier<128>> newVerifier() const override {
+		auto * verifier = new BitslicedAES128KeyVerifier(plaintext, ciphertext, width);
+		return std::unique_ptr<BitslicedAES128KeyVerifier>(verifier);
+	}
+
+	/**
+	 *
+	 * @return the number of keys each verifier encrypts per call
+	 */
+	BitslicedAES128Width getWidth() const {
+		return width;
+	}
+private:
+	std::vector<uint8_t> const plaintext;
+	std::vector<uint8_t> const ciphertext;
+	BitslicedAES128Width const width;
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_BITSLICEDAES128KEYVERIFIER_HPP_ */
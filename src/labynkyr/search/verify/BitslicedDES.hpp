@@ -0,0 +1,487 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * BitslicedDES.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_BITSLICEDDES_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_BITSLICEDDES_HPP_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * The number of DES keys a BitslicedDES call encrypts, i.e the width of the words each bit of the state is held in
+ */
+enum BitslicedDESWidth {
+	BitslicedDES64Width,
+	BitslicedDES256Width
+};
+
+/**
+ *
+ * A bitsliced DES implementation for recovering a DES key from a single round key, given a known plaintext and ciphertext pair.
+ *
+ * A side-channel attack on the first or last round of DES recovers the 6-bit subkeys entering each of the 8 S-boxes: a 48-bit round key.
+ * The key schedule only permutes and rotates key bits, so a round key fixes 48 of the 56 bits of the DES key, and the remaining 8 are
+ * found by brute force.  Each bit of the cipher state is held in one word whose lane j belongs to the key completing the round key with
+ * the 8 missing bits set to j.  With 256-bit words one pass tries all 256 completions; with 64-bit words four passes are needed.
+ *
+ * Round keys use the byte layout of FullKeyBuilder<8, 6, ...>: subkey i is the 6-bit input to S-box i + 1 (first bit most significant),
+ * and is stored in bits [6i, 6i + 6) of the key, least significant bit first.  DES keys are 8 bytes in the usual order, with odd parity.
+ *
+ * Each S-box is evaluated as a multiplexer tree over its truth table.  All 16 functions of the two lowest input bits are computed once, and
+ * the remaining four inputs select between them.
+ *
+ * After 15 rounds half of the expected pre-output is already known.  When no key matches it the final round is skipped.
+ */
+class BitslicedDES {
+public:
+	typedef uint64_t Word64;
+	typedef uint64_t Word256 __attribute__((vector_size(32)));
+
+	/**
+	 *
+	 * @param width
+	 * @return the number of DES keys encrypted per pass
+	 */
+	static uint32_t keysPerPass(BitslicedDESWidth width) {
+		return (width == BitslicedDES64Width) ? 64 : 256;
+	}
+
+	/**
+	 *
+	 * @return 256 if the CPU supports AVX2, 64 otherwise
+	 */
+	static BitslicedDESWidth fastestSupported() {
+		return __builtin_cpu_supports("avx2") ? BitslicedDES256Width : BitslicedDES64Width;
+	}
+
+	/**
+	 *
+	 * @param width
+	 * @return a short description of the width
+	 */
+	static std::string name(BitslicedDESWidth width) {
+		return (width == BitslicedDES64Width) ? "Bitsliced DES x64" : "Bitsliced DES x256";
+	}
+
+	/**
+	 *
+	 * Compute a round key with the DES key schedule
+	 *
+	 * @param key the 8 byte DES key.  Parity bits are ignored.
+	 * @param round 1 to 16
+	 * @return the 6 byte round key, in FullKeyBuilder<8, 6, ...> layout
+	 * @throws std::invalid_argument
+	 */
+	static std::vector<uint8_t> roundKey(std::vector<uint8_t> const & key, uint32_t round) {
+		checkRound(round);
+		if(key.size() != 8) {
+			std::stringstream error;
+			error << "A DES key is 8 bytes long, not " << key.size();
+			throw std::invalid_argument(error.str().c_str());
+		}
+		Tables const & table = tables();
+		std::vector<uint8_t> roundKeyBytes(6, 0);
+		for(uint32_t bit = 0 ; bit < 48 ; bit++) {
+			uint32_t const keyBit = table.pc1[table.roundKeyIndex[round - 1][bit]];
+			if(isSetMSBFirst(key.data(), keyBit)) {
+				uint32_t const layoutBit = roundKeyLayoutBit(bit);
+				roundKeyBytes[layoutBit / 8] |= static_cast<uint8_t>(1 << (layoutBit % 8));
+			}
+		}
+		return roundKeyBytes;
+	}
+
+	/**
+	 *
+	 * Try all 256 DES keys with the given round key.
+	 *
+	 * @param width
+	 * @param roundKey the 6 byte round key, in FullKeyBuilder<8, 6, ...> layout
+	 * @param round the round the key belongs to, 1 to 16
+	 * @param plaintext 8 bytes
+	 * @param ciphertext the expected 8 byte ciphertext
+	 * @param key receives the 8 byte DES key with odd parity, if one is found
+	 * @return true if a DES key encrypts the plaintext to the ciphertext
+	 */
+	static bool findKey(BitslicedDESWidth width, uint8_t const * roundKey, uint32_t round, uint8_t const * plaintext, uint8_t const * ciphertext,
+			uint8_t * key) {
+		if(width == BitslicedDES64Width) {
+			return findKey<Word64>(roundKey, round, plaintext, ciphertext, key);
+		} else {
+			return findKey<Word256>(roundKey, round, plaintext, ciphertext, key);
+		}
+	}
+
+	/**
+	 *
+	 * As above, for a single width
+	 *
+	 * @tparam Word Word64 or Word256
+	 */
+	template<typename Word>
+	static bool findKey(uint8_t const * roundKey, uint32_t round, uint8_t const * plaintext, uint8_t const * ciphertext, uint8_t * key) {
+		uint32_t const elements = sizeof(Word) / 8;
+		Tables const & table = tables();
+		Word const ones = ~Word();
+
+		// C0D0 (the key after PC1): 48 bits fixed by the round key, 8 taken from the lane index
+		Word cd[56];
+		bool fixed[56] = {false};
+		for(uint32_t bit = 0 ; bit < 48 ; bit++) {
+			uint32_t const index = table.roundKeyIndex[round - 1][bit];
+			cd[index] = isSetLSBFirst(roundKey, roundKeyLayoutBit(bit)) ? ones : Word();
+			fixed[index] = true;
+		}
+		uint32_t missing[8];
+		uint32_t missingCount = 0;
+		for(uint32_t index = 0 ; index < 56 ; index++) {
+			if(!fixed[index]) {
+				missing[missingCount++] = index;
+			}
+		}
+
+		// IP(plaintext) = L0 R0, IP(ciphertext) = R16 L16
+		uint8_t input[64];
+		uint8_t expected[64];
+		for(uint32_t bit = 0 ; bit < 64 ; bit++) {
+			input[bit] = isSetMSBFirst(plaintext, table.ip[bit]);
+			expected[bit] = isSetMSBFirst(ciphertext, table.ip[bit]);
+		}
+
+		for(uint32_t pass = 0 ; pass < 256 / (elements * 64) ; pass++) {
+			for(uint32_t missingIndex = 0 ; missingIndex < 8 ; missingIndex++) {
+				cd[missing[missingIndex]] = lanePattern<Word>(pass, missingIndex);
+			}
+			Word state[64];
+			for(uint32_t bit = 0 ; bit < 64 ; bit++) {
+				state[bit] = input[bit] ? ones : Word();
+			}
+			Word * left = state;
+			Word * right = state + 32;
+			for(uint32_t r = 0 ; r < 15 ; r++) {
+				feistel(table, r, cd, right, left);
+				std::swap(left, right);
+			}
+			// right holds R15 = L16
+			Word mismatch = Word();
+			for(uint32_t bit = 0 ; bit < 32 ; bit++) {
+				mismatch |= right[bit] ^ (expected[32 + bit] ? ones : Word());
+			}
+			if(isAllOnes(mismatch)) {
+				continue;
+			}
+			feistel(table, 15, cd, right, left);
+			// left holds R16
+			for(uint32_t bit = 0 ; bit < 32 ; bit++) {
+				mismatch |= left[bit] ^ (expected[bit] ? ones : Word());
+			}
+			if(isAllOnes(mismatch)) {
+				continue;
+			}
+
+			uint64_t lanes[elements];
+			memcpy(lanes, &mismatch, sizeof(Word));
+			for(uint32_t element = 0 ; element < elements ; element++) {
+				if(lanes[element] != ~0ULL) {
+					uint32_t const lane = (pass * elements + element) * 64 + __builtin_ctzll(~lanes[element]);
+					buildKey(table, cd, missing, lane, key);
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+private:
+	struct Tables {
+		// For each bit of C0D0, the DES key bit it is taken from (0 = most significant bit of byte 0)
+		uint8_t pc1[56];
+		// For each round and each round key bit (0 = first input bit of S-box 1), the C0D0 bit it is taken from
+		uint8_t roundKeyIndex[16][48];
+		// For each bit of IP(x), the bit of x it is taken from
+		uint8_t ip[64];
+		uint8_t expansion[48];
+		// For each output bit of the round function, the S-box output bit it is taken from
+		uint8_t permutation[32];
+		// For each S-box, output bit and value of the 4 highest inputs, the index of a function of the 2 lowest inputs (see sbox)
+		uint8_t functionIndex[8][4][16];
+	};
+
+	static void checkRound(uint32_t round) {
+		if(round < 1 || round > 16) {
+			std::stringstream error;
+			error << "DES has rounds 1 to 16, not " << round;
+			throw std::invalid_argument(error.str().c_str());
+		}
+	}
+
+	/**
+	 *
+	 * @param bit a round key bit, 0 = first input bit of S-box 1
+	 * @return the position of the bit in the FullKeyBuilder<8, 6, ...> layout
+	 */
+	static uint32_t roundKeyLayoutBit(uint32_t bit) {
+		return (bit / 6) * 6 + (5 - bit % 6);
+	}
+
+	static bool isSetMSBFirst(uint8_t const * bytes, uint32_t bit) {
+		return (bytes[bit / 8] >> (7 - bit % 8)) & 1;
+	}
+
+	static bool isSetLSBFirst(uint8_t const * bytes, uint32_t bit) {
+		return (bytes[bit / 8] >> (bit % 8)) & 1;
+	}
+
+	template<typename Word>
+	static bool isAllOnes(Word const & word) {
+		uint64_t elements[sizeof(Word) / 8];
+		memcpy(elements, &word, sizeof(Word));
+		uint64_t combined = ~0ULL;
+		for(uint32_t index = 0 ; index < sizeof(Word) / 8 ; index++) {
+			combined &= elements[index];
+		}
+		return combined == ~0ULL;
+	}
+
+	/**
+	 *
+	 * @return a word whose lane j holds bit missingIndex of the completion (pass * lanes + j)
+	 */
+	template<typename Word>
+	static Word lanePattern(uint32_t pass, uint32_t missingIndex) {
+		static uint64_t const patterns[6] = {0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL, 0xFF00FF00FF00FF00ULL,
+				0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL};
+		uint32_t const elements = sizeof(Word) / 8;
+		uint64_t lanes[elements];
+		for(uint32_t element = 0 ; element < elements ; element++) {
+			uint32_t const high = pass * elements + element;
+			if(missingIndex < 6) {
+				lanes[element] = patterns[missingIndex];
+			} else {
+				lanes[element] = ((high >> (missingIndex - 6)) & 1) ? ~0ULL : 0;
+			}
+		}
+		Word word;
+		memcpy(&word, lanes, sizeof(Word));
+		return word;
+	}
+
+	/**
+	 *
+	 * Write the DES key for one lane, with odd parity
+	 */
+	template<typename Word>
+	static void buildKey(Tables const & table, Word const * cd, uint32_t const * missing, uint32_t lane, uint8_t * key) {
+		memset(key, 0, 8);
+		for(uint32_t index = 0 ; index < 56 ; index++) {
+			uint64_t elements[sizeof(Word) / 8];
+			memcpy(elements, &cd[index], sizeof(Word));
+			bool bitValue = (elements[0] & 1) != 0;
+			for(uint32_t missingIndex = 0 ; missingIndex < 8 ; missingIndex++) {
+				if(missing[missingIndex] == index) {
+					bitValue = (lane >> missingIndex) & 1;
+				}
+			}
+			if(bitValue) {
+				key[table.pc1[index] / 8] |= static_cast<uint8_t>(0x80 >> (table.pc1[index] % 8));
+			}
+		}
+		for(uint32_t byte = 0 ; byte < 8 ; byte++) {
+			if(__builtin_parity(key[byte]) == 0) {
+				key[byte] ^= 1;
+			}
+		}
+	}
+
+	/**
+	 *
+	 * left ^= f(right, K_{round + 1})
+	 */
+	template<typename Word>
+	static void feistel(Tables const & table, uint32_t round, Word const * cd, Word const * right, Word * left) {
+		Word output[32];
+		for(uint32_t box = 0 ; box < 8 ; box++) {
+			Word input[6];
+			for(uint32_t bit = 0 ; bit < 6 ; bit++) {
+				uint32_t const index = box * 6 + bit;
+				input[bit] = right[table.expansion[index]] ^ cd[table.roundKeyIndex[round][index]];
+			}
+			sbox(table.functionIndex[box], input, output + box * 4);
+		}
+		for(uint32_t bit = 0 ; bit < 32 ; bit++) {
+			left[bit] ^= output[table.permutation[bit]];
+		}
+	}
+
+	/**
+	 *
+	 * Evaluate one S-box.  The 16 functions of the lowest inputs s0 = in[5] and s1 = in[4] are built from their minterms, and each output
+	 * bit is then a multiplexer tree selecting between them on in[3], in[2], in[1] and in[0].
+	 *
+	 * @param functionIndex for each output bit and value of the highest 4 inputs, the function of (s0, s1) it reduces to
+	 * @param in 6 words, first (most significant) input bit first
+	 * @param out 4 words, most significant output bit first
+	 */
+	template<typename Word>
+	static inline void sbox(uint8_t const (&functionIndex)[4][16], Word const * in, Word * out) {
+		Word const s0 = in[5];
+		Word const s1 = in[4];
+		Word const minterms[4] = {~(s0 | s1), s0 & ~s1, s1 & ~s0, s0 & s1};
+		Word functions[16];
+		functions[0] = Word();
+		for(uint32_t index = 1 ; index < 16 ; index++) {
+			functions[index] = functions[index & (index - 1)] ^ minterms[__builtin_ctz(index)];
+		}
+		for(uint32_t bit = 0 ; bit < 4 ; bit++) {
+			Word level[16];
+			for(uint32_t group = 0 ; group < 16 ; group++) {
+				level[group] = functions[functionIndex[bit][group]];
+			}
+			uint32_t select = 3;
+			for(uint32_t width = 8 ; width > 0 ; width /= 2) {
+				for(uint32_t index = 0 ; index < width ; index++) {
+					level[index] = level[2 * index] ^ ((level[2 * index] ^ level[2 * index + 1]) & in[select]);
+				}
+				select--;
+			}
+			out[bit] = level[0];
+		}
+	}
+
+	static Tables const & tables() {
+		static Tables const table = buildTables();
+		return table;
+	}
+
+	static Tables buildTables() {
+		static uint8_t const pc1[56] = {57, 49, 41, 33, 25, 17, 9, 1, 58, 50, 42, 34, 26, 18, 10, 2, 59, 51, 43, 35, 27, 19, 11, 3, 60, 52, 44, 36,
+				63, 55, 47, 39, 31, 23, 15, 7, 62, 54, 46, 38, 30, 22, 14, 6, 61, 53, 45, 37, 29, 21, 13, 5, 28, 20, 12, 4};
+		static uint8_t const pc2[48] = {14, 17, 11, 24, 1, 5, 3, 28, 15, 6, 21, 10, 23, 19, 12, 4, 26, 8, 16, 7, 27, 20, 13, 2,
+				41, 52, 31, 37, 47, 55, 30, 40, 51, 45, 33, 48, 44, 49, 39, 56, 34, 53, 46, 42, 50, 36, 29, 32};
+		static uint8_t const shifts[16] = {1, 1, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 1};
+		static uint8_t const ip[64] = {58, 50, 42, 34, 26, 18, 10, 2, 60, 52, 44, 36, 28, 20, 12, 4, 62, 54, 46, 38, 30, 22, 14, 6,
+				64, 56, 48, 40, 32, 24, 16, 8, 57, 49, 41, 33, 25, 17, 9, 1, 59, 51, 43, 35, 27, 19, 11, 3, 61, 53, 45, 37, 29, 21, 13, 5,
+				63, 55, 47, 39, 31, 23, 15, 7};
+		static uint8_t const expansion[48] = {32, 1, 2, 3, 4, 5, 4, 5, 6, 7, 8, 9, 8, 9, 10, 11, 12, 13, 12, 13, 14, 15, 16, 17,
+				16, 17, 18, 19, 20, 21, 20, 21, 22, 23, 24, 25, 24, 25, 26, 27, 28, 29, 28, 29, 30, 31, 32, 1};
+		static uint8_t const permutation[32] = {16, 7, 20, 21, 29, 12, 28, 17, 1, 15, 23, 26, 5, 18, 31, 10, 2, 8, 24, 14, 32, 27, 3, 9,
+				19, 13, 30, 6, 22, 11, 4, 25};
+		// Row-major, row = first and last input bits, column = middle 4 input bits
+		static uint8_t const sboxes[8][64] = {
+			{14, 4, 13, 1, 2, 15, 11, 8, 3, 10, 6, 12, 5, 9, 0, 7, 0, 15, 7, 4, 14, 2, 13, 1, 10, 6, 12, 11, 9, 5, 3, 8,
+			 4, 1, 14, 8, 13, 6, 2, 11, 15, 12, 9, 7, 3, 10, 5, 0, 15, 12, 8, 2, 4, 9, 1, 7, 5, 11, 3, 14, 10, 0, 6, 13},
+			{15, 1, 8, 14, 6, 11, 3, 4, 9, 7, 2, 13, 12, 0, 5, 10, 3, 13, 4, 7, 15, 2, 8, 14, 12, 0, 1, 10, 6, 9, 11, 5,
+			 0, 14, 7, 11, 10, 4, 13, 1, 5, 8, 12, 6, 9, 3, 2, 15, 13, 8, 10, 1, 3, 15, 4, 2, 11, 6, 7, 12, 0, 5, 14, 9},
+			{10, 0, 9, 14, 6, 3, 15, 5, 1, 13, 12, 7, 11, 4, 2, 8, 13, 7, 0, 9, 3, 4, 6, 10, 2, 8, 5, 14, 12, 11, 15, 1,
+			 13, 6, 4, 9, 8, 15, 3, 0, 11, 1, 2, 12, 5, 10, 14, 7, 1, 10, 13, 0, 6, 9, 8, 7, 4, 15, 14, 3, 11, 5, 2, 12},
+			{7, 13, 14, 3, 0, 6, 9, 10, 1, 2, 8, 5, 11, 12, 4, 15, 13, 8, 11, 5, 6, 15, 0, 3, 4, 7, 2, 12, 1, 10, 14, 9,
+			 10, 6, 9, 0, 12, 11, 7, 13, 15, 1, 3, 14, 5, 2, 8, 4, 3, 15, 0, 6, 10, 1, 13, 8, 9, 4, 5, 11, 12, 7, 2, 14},
+			{2, 12, 4, 1, 7, 10, 11, 6, 8, 5, 3, 15, 13, 0, 14, 9, 14, 11, 2, 12, 4, 7, 13, 1, 5, 0, 15, 10, 3, 9, 8, 6,
+			 4, 2, 1, 11, 10, 13, 7, 8, 15, 9, 12, 5, 6, 3, 0, 14, 11, 8, 12, 7, 1, 14, 2, 13, 6, 15, 0, 9, 10, 4, 5, 3},
+			{12, 1, 10, 15, 9, 2, 6, 8, 0, 13, 3, 4, 14, 7, 5, 11, 10, 15, 4, 2, 7, 12, 9, 5, 6, 1, 13, 14, 0, 11, 3, 8,
+			 9, 14, 15, 5, 2, 8, 12, 3, 7, 0, 4, 10, 1, 13, 11, 6, 4, 3, 2, 12, 9, 5, 15, 10, 11, 14, 1, 7, 6, 0, 8, 13},
+			{4, 11, 2, 14, 15, 0, 8, 13, 3, 12, 9, 7, 5, 10, 6, 1, 13, 0, 11, 7, 4, 9, 1, 10, 14, 3, 5, 12, 2, 15, 8, 6,
+			 1, 4, 11, 13, 12, 3, 7, 14, 10, 15, 6, 8, 0, 5, 9, 2, 6, 11, 13, 8, 1, 4, 10, 7, 9, 5, 0, 15, 14, 2, 3, 12},
+			{13, 2, 8, 4, 6, 15, 11, 1, 10, 9, 3, 14, 5, 0, 12, 7, 1, 15, 13, 8, 10, 3, 7, 4, 12, 5, 6, 11, 0, 14, 9, 2,
+			 7, 11, 4, 1, 9, 12, 14, 2, 0, 6, 10, 13, 15, 3, 5, 8, 2, 1, 14, 7, 4, 10, 8, 13, 15, 12, 9, 0, 3, 5, 6, 11}
+		};
+
+		Tables table;
+		for(uint32_t bit = 0 ; bit < 56 ; bit++) {
+			table.pc1[bit] = pc1[bit] - 1;
+		}
+		uint32_t rotation = 0;
+		for(uint32_t round = 0 ; round < 16 ; round++) {
+			rotation += shifts[round];
+			for(uint32_t bit = 0 ; bit < 48 ; bit++) {
+				// C and D are each rotated left, so bit i of Cr is bit (i + rotation) mod 28 of C0
+				uint32_t const position = pc2[bit] - 1;
+				uint32_t const half = (position / 28) * 28;
+				table.roundKeyIndex[round][bit] = static_cast<uint8_t>(half + (position - half + rotation) % 28);
+			}
+		}
+		for(uint32_t bit = 0 ; bit < 64 ; bit++) {
+			table.ip[bit] = ip[bit] - 1;
+		}
+		for(uint32_t bit = 0 ; bit < 48 ; bit++) {
+			table.expansion[bit] = expansion[bit] - 1;
+		}
+		for(uint32_t bit = 0 ; bit < 32 ; bit++) {
+			table.permutation[bit] = permutation[bit] - 1;
+		}
+		for(uint32_t box = 0 ; box < 8 ; box++) {
+			for(uint32_t bit = 0 ; bit < 4 ; bit++) {
+				for(uint32_t group = 0 ; group < 16 ; group++) {
+					uint32_t function = 0;
+					for(uint32_t low = 0 ; low < 4 ; low++) {
+						uint32_t const value = group * 4 + low;
+						uint32_t const row = ((value >> 4) & 2) | (value & 1);
+						uint32_t const column = (value >> 1) & 0xF;
+						uint32_t const output = sboxes[box][row * 16 + column];
+						function |= ((output >> (3 - bit)) & 1) << low;
+					}
+					table.functionIndex[box][bit][group] = static_cast<uint8_t>(function);
+				}
+			}
+		}
+		return table;
+	}
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_BITSLICEDDES_HPP_ */
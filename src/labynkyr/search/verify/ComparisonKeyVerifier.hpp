@@ -90,6 +90,15 @@ public:
 		keyFound |= match;
 	}
 
+	void checkKeys(uint8_t const * candidateKeys, uint64_t keyCount) override {
+		uint32_t const keyLenBytes = KeyVerifier<KeyLenBits>::KeyLenBytes;
+		auto const & keyBytes = key.asBytes();
+		for(uint64_t keyIndex = 0 ; keyIndex < keyCount ; keyIndex++) {
+			keyFound |= std::equal(keyBytes.begin(), keyBytes.end(), candidateKeys + keyIndex * keyLenBytes);
+		}
+		count += keyCount;
+	}
+
 	uint64_t keysChecked() const override {
 		return count;
 	}
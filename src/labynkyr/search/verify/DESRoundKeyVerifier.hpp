@@ -0,0 +1,235 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * DESRoundKeyVerifier.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_DESROUNDKEYVERIFIER_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_DESROUNDKEYVERIFIER_HPP_
+
+#include "labynkyr/search/verify/BitslicedDES.hpp"
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+
+#include "labynkyr/Key.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Implementation of the KeyVerifier interface for attacks on the first or last round of DES, where the enumerated key is a 48-bit round
+ * key made of 8 6-bit subkeys (i.e a search with VecCount = 8 and VecLenBits = 6).  Each candidate round key is checked against a known
+ * plaintext and ciphertext pair by trying all 256 DES keys it is consistent with, using BitslicedDES.
+ *
+ * The correct key is reported as the round key, i.e as it was enumerated; getDESKey returns the DES key it was completed to.
+ */
+class DESRoundKeyVerifier : public KeyVerifier<48> {
+public:
+	/**
+	 *
+	 * Uses BitslicedDES::fastestSupported()
+	 *
+	 * @param plaintext 8 bytes
+	 * @param ciphertext 8 bytes
+	 * @param round the round the enumerated keys belong to: 1 for first round attacks, 16 for last round attacks
+	 * @throws std::invalid_argument
+	 */
+	DESRoundKeyVerifier(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext, uint32_t round)
+	: DESRoundKeyVerifier(plaintext, ciphertext, round, BitslicedDES::fastestSupported())
+	{
+	}
+
+	/**
+	 *
+	 * @param plaintext 8 bytes
+	 * @param ciphertext 8 bytes
+	 * @param round the round the enumerated keys belong to: 1 for first round attacks, 16 for last round attacks
+	 * @param width
+	 * @throws std::invalid_argument
+	 */
+	DESRoundKeyVerifier(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext, uint32_t round, BitslicedDESWidth width)
+	: KeyVerifier<48>()
+	, round(round)
+	, width(width)
+	, count(0)
+	, found(false)
+	, foundKeyBytes(6)
+	, desKey(8)
+	{
+		if(round < 1 || round > 16) {
+			std::stringstream error;
+			error << "DES has rounds 1 to 16, not " << round;
+			throw std::invalid_argument(error.str().c_str());
+		}
+		if(plaintext.size() != 8 || ciphertext.size() != 8) {
+			throw std::invalid_argument("A DES plaintext and ciphertext are 8 bytes long");
+		}
+		std::copy(plaintext.begin(), plaintext.end(), this->plaintext);
+		std::copy(ciphertext.begin(), ciphertext.end(), expectedCiphertext);
+	}
+
+	~DESRoundKeyVerifier() {}
+
+	void checkKey(std::vector<uint8_t> const & candidateKeyBytes) override {
+		checkKeys(candidateKeyBytes.data(), 1);
+	}
+
+	void checkKeys(uint8_t const * candidateKeys, uint64_t keyCount) override {
+		for(uint64_t keyIndex = 0 ; keyIndex < keyCount && !found ; keyIndex++) {
+			uint8_t const * candidateKey = candidateKeys + keyIndex * 6;
+			if(BitslicedDES::findKey(width, candidateKey, round, plaintext, expectedCiphertext, desKey.data())) {
+				found = true;
+				std::copy(candidateKey, candidateKey + 6, foundKeyBytes.begin());
+			}
+		}
+		count += keyCount;
+	}
+
+	uint64_t keysChecked() const override {
+		return count;
+	}
+
+	bool success() const override {
+		return found;
+	}
+
+	Key<48> correctKey() override {
+		if(found) {
+			Key<48> const key(foundKeyBytes);
+			return key;
+		}
+		throw std::logic_error("Key has not been found");
+	}
+
+	void flush() override {}
+
+	/**
+	 *
+	 * @return the 8 byte DES key, with odd parity
+	 * @throws std::logic_error if the key has not been found
+	 */
+	std::vector<uint8_t> getDESKey() const {
+		if(found) {
+			return desKey;
+		}
+		throw std::logic_error("Key has not been found");
+	}
+
+	/**
+	 *
+	 * @return the width, i.e number of DES keys encrypted per pass
+	 */
+	BitslicedDESWidth getWidth() const {
+		return width;
+	}
+private:
+	uint32_t const round;
+	BitslicedDESWidth const width;
+	uint64_t count;
+	bool found;
+	std::vector<uint8_t> foundKeyBytes;
+	std::vector<uint8_t> desKey;
+	uint8_t plaintext[8];
+	uint8_t expectedCiphertext[8];
+};
+
+/**
+ *
+ * Builds DESRoundKeyVerifiers.  Unless a width is given, every verifier uses BitslicedDES::fastestSupported().
+ */
+class DESRoundKeyVerifierFactory : public KeyVerifierFactory<48> {
+public:
+	/**
+	 *
+	 * @param plaintext 8 bytes
+	 * @param ciphertext 8 bytes
+	 * @param round the round the enumerated keys belong to: 1 for first round attacks, 16 for last round attacks
+	 */
+	DESRoundKeyVerifierFactory(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext, uint32_t round)
+	: DESRoundKeyVerifierFactory(plaintext, ciphertext, round, BitslicedDES::fastestSupported())
+	{
+	}
+
+	/**
+	 *
+	 * @param plaintext 8 bytes
+	 * @param ciphertext 8 bytes
+	 * @param round the round the enumerated keys belong to: 1 for first round attacks, 16 for last round attacks
+	 * @param width
+	 */
+	DESRoundKeyVerifierFactory(std::vector<uint8_t> const & plaintext, std::vector<uint8_t> const & ciphertext, uint32_t round,
+			BitslicedDESWidth width)
+	: KeyVerifierFactory<48>()
+	, plaintext(plaintext)
+	, ciphertext(ciphertext)
+	, round(round)
+	, width(width)
+	{
+	}
+
+	~DESRoundKeyVerifierFactory() {}
+
+	std::unique_ptr<KeyVerifier<48>> newVerifier() const override {
+		auto * verifier = new DESRoundKeyVerifier(plaintext, ciphertext, round, width);
+		return std::unique_ptr<DESRoundKeyVerifier>(verifier);
+	}
+private:
+	std::vector<uint8_t> const plaintext;
+	std::vector<uint8_t> const ciphertext;
+	uint32_t const round;
+	BitslicedDESWidth const width;
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_DESROUNDKEYVERIFIER_HPP_ */
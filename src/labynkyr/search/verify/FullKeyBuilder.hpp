@@ -50,6 +50,7 @@
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <vector>
 
 namespace labynkyr {
@@ -67,42 +68,127 @@ template<uint32_t VecCount, uint32_t VecLenBits, typename SubkeyType>
 class FullKeyBuilder {
 public:
 
+	enum {
+		KeyLenBits = VecCount * VecLenBits,
+		KeyLenBytes = (KeyLenBits + 7) / 8,
+		// Subkeys are packed through a 64-bit accumulator, which holds at most 7 pending bits plus one subkey
+		MaxPackedSubkeyBits = 56
+	};
+
 	/**
 	 *
 	 * @param input a vector of length VecCount
 	 * @param output a vector of length VecCount * VecLenBits / 8; the number of bytes in the key.  Output will be modified to
-	 * contain the byte representation of the key specified by the sub-key representation stored in input.
+	 * contain the byte representation of the key specified by the sub-key representation stored in input.  Bits of output beyond the
+	 * end of the key are left untouched.
 	 */
 	static void fullKey(std::vector<SubkeyType> const & input, std::vector<uint8_t> & output) {
-		uint32_t offset = 0;
-		for(auto value : input) {
-			uint32_t const bitEnd =  offset + VecLenBits - 1;
+		for(uint32_t vectorIndex = 0 ; vectorIndex < VecCount ; vectorIndex++) {
+			setSubkey(vectorIndex, input[vectorIndex], output.data());
+		}
+	}
 
-			for(uint32_t byteIndex = 0 ; byteIndex < output.size() ; byteIndex++) {
-				uint32_t byteValue = 0;
-				for(uint32_t bitIndex = 0 ; bitIndex < 8 ; bitIndex++) {
-					bool bitValue = 0;
-					if(bitIndex + (byteIndex * 8) < offset || bitIndex + (byteIndex * 8) > bitEnd) {
-						bitValue = output[byteIndex] & (1 << bitIndex);
-					} else {
-						bitValue = value & (1 << (bitIndex + (byteIndex * 8) - offset));
-					}
-					byteValue |= (bitValue << bitIndex);
-				}
-				output[byteIndex] = static_cast<uint8_t>(byteValue);
+	/**
+	 *
+	 * @param input a vector of length VecCount
+	 * @param output a buffer of VecCount * VecLenBits / 8 bytes (rounded up); the number of bytes in the key.  Output will be overwritten
+	 * with the byte representation of the key specified by the sub-key representation stored in input.  Unused high bits are cleared.
+	 */
+	static void fullKey(std::vector<SubkeyType> const & input, uint8_t * output) {
+		if(VecLenBits > MaxPackedSubkeyBits) {
+			std::fill(output, output + KeyLenBytes, 0);
+			for(uint32_t vectorIndex = 0 ; vectorIndex < VecCount ; vectorIndex++) {
+				setSubkey(vectorIndex, input[vectorIndex], output);
 			}
-			offset += VecLenBits;
+			return;
+		}
+		// VecCount and VecLenBits are known at compile time, so the loop unrolls into a fixed sequence of shifts and masks
+		uint64_t pending = 0;
+		uint32_t pendingBits = 0;
+		uint8_t * outputByte = output;
+		for(uint32_t vectorIndex = 0 ; vectorIndex < VecCount ; vectorIndex++) {
+			pending |= (static_cast<uint64_t>(input[vectorIndex]) & subkeyMask()) << pendingBits;
+			pendingBits += VecLenBits;
+			while(pendingBits >= 8) {
+				*outputByte++ = static_cast<uint8_t>(pending);
+				pending >>= 8;
+				pendingBits -= 8;
+			}
+		}
+		if(pendingBits > 0) {
+			*outputByte = static_cast<uint8_t>(pending);
 		}
 	}
+
+	/**
+	 *
+	 * Overwrite a single subkey within an existing byte representation of a key, leaving the bits of all other subkeys untouched.
+	 * Only the bytes overlapping the subkey are rewritten.  This is the incremental counterpart to fullKey: enumeration algorithms that
+	 * change one subkey between consecutive candidates should keep the key in byte form and call this for the subkey that changed.
+	 *
+	 * @param vectorIndex the index of the subkey to replace
+	 * @param value the new subkey value
+	 * @param output a buffer of VecCount * VecLenBits / 8 bytes (rounded up) containing the byte representation of a key
+	 */
+	static void setSubkey(uint32_t vectorIndex, SubkeyType value, uint8_t * output) {
+		uint64_t const subkeyValue = static_cast<uint64_t>(value);
+		uint32_t const bitOffset = vectorIndex * VecLenBits;
+		if(VecLenBits % 8 == 0) {
+			for(uint32_t byteIndex = 0 ; byteIndex < VecLenBits / 8 ; byteIndex++) {
+				output[bitOffset / 8 + byteIndex] = static_cast<uint8_t>(subkeyValue >> (byteIndex * 8));
+			}
+			return;
+		}
+		if(VecLenBits <= MaxPackedSubkeyBits) {
+			// The subkey and its mask are shifted into place once, then written over the bytes they span
+			uint32_t const shift = bitOffset % 8;
+			uint64_t const bits = (subkeyValue & subkeyMask()) << shift;
+			uint64_t const mask = subkeyMask() << shift;
+			uint8_t * const first = output + bitOffset / 8;
+			uint32_t const byteCount = (shift + VecLenBits + 7) / 8;
+			for(uint32_t byteIndex = 0 ; byteIndex < byteCount ; byteIndex++) {
+				uint8_t const byteMask = static_cast<uint8_t>(mask >> (byteIndex * 8));
+				first[byteIndex] = static_cast<uint8_t>((first[byteIndex] & ~byteMask) | static_cast<uint8_t>(bits >> (byteIndex * 8)));
+			}
+			return;
+		}
+		uint32_t bitIndex = 0;
+		while(bitIndex < VecLenBits) {
+			uint32_t const keyBit = bitOffset + bitIndex;
+			uint32_t const shift = keyBit % 8;
+			uint32_t const bitCount = std::min<uint32_t>(8 - shift, VecLenBits - bitIndex);
+			uint32_t const mask = ((1U << bitCount) - 1) << shift;
+			uint32_t const bits = static_cast<uint32_t>((subkeyValue >> bitIndex) << shift) & mask;
+			output[keyBit / 8] = static_cast<uint8_t>((output[keyBit / 8] & ~mask) | bits);
+			bitIndex += bitCount;
+		}
+	}
+private:
+	static constexpr uint64_t subkeyMask() {
+		return (VecLenBits >= 64) ? ~static_cast<uint64_t>(0) : (static_cast<uint64_t>(1) << (VecLenBits % 64)) - 1;
+	}
 };
 
 // Specialisation for 8-bit attacks
 template<uint32_t VecCount>
 class FullKeyBuilder<VecCount, 8U, uint8_t> {
 public:
+	enum {
+		KeyLenBits = VecCount * 8,
+		KeyLenBytes = VecCount
+	};
+
 	static void fullKey(std::vector<uint8_t> const & input, std::vector<uint8_t> & output) {
 		std::copy(input.begin(), input.end(), output.begin());
 	}
+
+	static void fullKey(std::vector<uint8_t> const & input, uint8_t * output) {
+		std::copy(input.begin(), input.end(), output);
+	}
+
+	static void setSubkey(uint32_t vectorIndex, uint8_t value, uint8_t * output) {
+		output[vectorIndex] = value;
+	}
 };
 
 } /*namespace search */
@@ -0,0 +1,195 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * GroupedKeyVerifier.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_GROUPEDKEYVERIFIER_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_GROUPEDKEYVERIFIER_HPP_
+
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+
+#include "labynkyr/Key.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Base class for KeyVerifiers that check a fixed number of keys at a time, e.g with a cipher kernel that encrypts keysPerCall keys
+ * per call.  Implementing classes only provide checkGroup.
+ *
+ * Keys passed in blocks to checkKeys are checked in place, keysPerCall at a time; the remainder, and keys passed individually, are
+ * buffered until a full group is available or the verifier is flushed.  Keys are checked in the order they arrive.  Once the key is found,
+ * later keys are counted but not checked.
+ *
+ * @tparam KeyLenBits the length of the key in bits
+ */
+template<uint32_t KeyLenBits>
+class GroupedKeyVerifier : public KeyVerifier<KeyLenBits> {
+public:
+	enum {
+		KeyLenBytes = KeyVerifier<KeyLenBits>::KeyLenBytes
+	};
+
+	/**
+	 *
+	 * @param keysPerCall the number of keys passed to each call of checkGroup
+	 */
+	GroupedKeyVerifier(uint32_t keysPerCall)
+	: KeyVerifier<KeyLenBits>()
+	, keysPerCall(keysPerCall)
+	, count(0)
+	, currentBatchSize(0)
+	, found(false)
+	, foundKeyBytes(KeyLenBytes)
+	, keysBuffer(KeyLenBytes * keysPerCall, 0)
+	{
+	}
+
+	virtual ~GroupedKeyVerifier() {}
+
+	void checkKey(std::vector<uint8_t> const & candidateKeyBytes) override {
+		bufferKey(candidateKeyBytes.data());
+	}
+
+	void checkKeys(uint8_t const * candidateKeys, uint64_t keyCount) override {
+		uint64_t keyIndex = 0;
+		// Complete any partially filled buffer first, so that keys are checked in the order they arrive
+		for( ; currentBatchSize != 0 && keyIndex < keyCount ; keyIndex++) {
+			bufferKey(candidateKeys + keyIndex * KeyLenBytes);
+		}
+		// Check directly from the caller's block
+		for( ; keyIndex + keysPerCall <= keyCount ; keyIndex += keysPerCall) {
+			if(!found) {
+				checkGroup(candidateKeys + keyIndex * KeyLenBytes, keysPerCall);
+			}
+			count += keysPerCall;
+		}
+		for( ; keyIndex < keyCount ; keyIndex++) {
+			bufferKey(candidateKeys + keyIndex * KeyLenBytes);
+		}
+	}
+
+	uint64_t keysChecked() const override {
+		return count;
+	}
+
+	bool success() const override {
+		return found;
+	}
+
+	Key<KeyLenBits> correctKey() override {
+		if(found) {
+			Key<KeyLenBits> const key(foundKeyBytes);
+			return key;
+		}
+		throw std::logic_error("Key has not been found");
+	}
+
+	void flush() override {
+		if(currentBatchSize > 0) {
+			if(!found) {
+				checkGroup(keysBuffer.data(), currentBatchSize);
+			}
+			currentBatchSize = 0;
+		}
+	}
+protected:
+	uint32_t const keysPerCall;
+
+	/**
+	 *
+	 * Check a group of keys, calling setFound for the correct key if it is among them
+	 *
+	 * @param keys keysPerCall keys stored back to back.  Only the first keyCount are to be checked: when keyCount < keysPerCall the
+	 * remaining keys are stale keys that have already been checked (or zeros), so that kernels can always process a full group.
+	 * @param keyCount
+	 */
+	virtual void checkGroup(uint8_t const * keys, uint64_t keyCount) = 0;
+
+	/**
+	 *
+	 * Record the correct key
+	 *
+	 * @param key KeyLenBytes bytes
+	 */
+	void setFound(uint8_t const * key) {
+		found = true;
+		std::copy(key, key + KeyLenBytes, foundKeyBytes.begin());
+	}
+private:
+	uint64_t count;
+	uint64_t currentBatchSize;
+	bool found;
+	std::vector<uint8_t> foundKeyBytes;
+	std::vector<uint8_t> keysBuffer;
+
+	/**
+	 *
+	 * Copy a key into the buffer, checking the buffer once it holds keysPerCall keys
+	 */
+	void bufferKey(uint8_t const * candidateKey) {
+		std::copy(candidateKey, candidateKey + KeyLenBytes, keysBuffer.begin() + currentBatchSize * KeyLenBytes);
+		count++;
+		currentBatchSize++;
+		if(currentBatchSize == keysPerCall) {
+			if(!found) {
+				checkGroup(keysBuffer.data(), keysPerCall);
+			}
+			currentBatchSize = 0;
+		}
+	}
+};
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_GROUPEDKEYVERIFIER_HPP_ */
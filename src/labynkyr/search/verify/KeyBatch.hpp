@@ -0,0 +1,237 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * KeyBatch.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_KEYBATCH_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_KEYBATCH_HPP_
+
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+#include "labynkyr/search/CancellationToken.hpp"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+#include <sstream>
+#include <stdexcept>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * An aligned block of candidate keys, filled in place by an enumeration algorithm and handed to a KeyVerifier in a single call to
+ * KeyVerifier#checkKeys once full.  Each enumeration instance owns its own batch, and so the block is only ever touched by the thread
+ * running that enumeration.
+ *
+ * Keys are only seen by the verifier when the batch is full or flushed, so KeyVerifier#success may lag the enumeration by up to one
+ * batch.  Enumeration algorithms must call flush() before they return.
+ *
+ * A batch may optionally be given a CancellationToken shared with other threads.  The batch raises the token when its verifier finds the
+ * key, and isStopped() reports the token having been raised by any other thread.
+ *
+ * @tparam KeyLenBits the length of the key in bits
+ */
+template<uint32_t KeyLenBits>
+class KeyBatch {
+public:
+	enum {
+		KeyLenBytes = KeyVerifier<KeyLenBits>::KeyLenBytes,
+		DefaultBatchSize = 64,
+		Alignment = 64
+	};
+
+	/**
+	 *
+	 * @param keyVerifier the verifier that will receive the batches
+	 */
+	KeyBatch(KeyVerifier<KeyLenBits> & keyVerifier)
+	: KeyBatch(keyVerifier, DefaultBatchSize)
+	{
+	}
+
+	/**
+	 *
+	 * @param keyVerifier the verifier that will receive the batches
+	 * @param batchSize the number of keys handed to the verifier in each call
+	 * @throws std::invalid_argument if batchSize is zero
+	 * @throws std::bad_alloc
+	 */
+	KeyBatch(KeyVerifier<KeyLenBits> & keyVerifier, uint64_t batchSize)
+	: KeyBatch(keyVerifier, batchSize, 0)
+	{
+	}
+
+	/**
+	 *
+	 * @param keyVerifier the verifier that will receive the batches
+	 * @param batchSize the number of keys handed to the verifier in each call
+	 * @param cancellationToken raised when the verifier finds the key, and polled by isStopped().  May be null.
+	 * @throws std::invalid_argument if batchSize is zero
+	 * @throws std::bad_alloc
+	 */
+	KeyBatch(KeyVerifier<KeyLenBits> & keyVerifier, uint64_t batchSize, CancellationToken * cancellationToken)
+	: keyVerifier(keyVerifier)
+	, batchSize(batchSize)
+	, keyCount(0)
+	, block(0)
+	, cancellationToken(cancellationToken)
+	{
+		if(batchSize == 0) {
+			std::stringstream error;
+			error << "Key batch size must be at least 1";
+			throw std::invalid_argument(error.str().c_str());
+		}
+		// aligned_alloc requires the size to be a multiple of the alignment
+		uint64_t const blockBytes = ((batchSize * KeyLenBytes + Alignment - 1) / Alignment) * Alignment;
+		#ifdef __APPLE__
+		if(posix_memalign((void**)&block, Alignment, blockBytes) != 0) {
+			block = 0;
+		}
+		#else
+		block = (uint8_t*) aligned_alloc(Alignment, blockBytes);
+		#endif
+		if(block == 0) {
+			throw std::bad_alloc();
+		}
+		memset(block, 0, blockBytes);
+	}
+
+	~KeyBatch() {
+		free(block);
+	}
+
+	/**
+	 *
+	 * @return the KeyLenBytes bytes in which the next key should be written.  The key is added to the batch by calling commit().
+	 */
+	uint8_t * nextKey() {
+		return block + keyCount * KeyLenBytes;
+	}
+
+	/**
+	 *
+	 * Add the key written to nextKey() to the batch, handing the batch to the verifier if it is now full
+	 *
+	 * @return true if the batch was handed to the verifier, and so KeyVerifier#success may have changed
+	 */
+	bool commit() {
+		keyCount++;
+		if(keyCount == batchSize) {
+			flush();
+			return true;
+		}
+		return false;
+	}
+
+	/**
+	 *
+	 * Hand any keys in the batch to the verifier
+	 */
+	void flush() {
+		if(keyCount > 0) {
+			keyVerifier.checkKeys(block, keyCount);
+			keyCount = 0;
+			if(cancellationToken != 0 && keyVerifier.success()) {
+				cancellationToken->cancel();
+			}
+		}
+	}
+
+	/**
+	 *
+	 * @return true if enumeration should stop, because either the verifier has found the key or the cancellation token has been raised
+	 */
+	bool isStopped() const {
+		return keyVerifier.success() || (cancellationToken != 0 && cancellationToken->isCancelled());
+	}
+
+	/**
+	 *
+	 * @return the verifier receiving the batches
+	 */
+	KeyVerifier<KeyLenBits> & getVerifier() const {
+		return keyVerifier;
+	}
+
+	/**
+	 *
+	 * @return the number of keys handed to the verifier in each call
+	 */
+	uint64_t getBatchSize() const {
+		return batchSize;
+	}
+
+	/**
+	 *
+	 * @return the number of keys waiting in the batch
+	 */
+	uint64_t pending() const {
+		return keyCount;
+	}
+private:
+	KeyVerifier<KeyLenBits> & keyVerifier;
+	uint64_t const batchSize;
+	uint64_t keyCount;
+	uint8_t * block;
+	CancellationToken * cancellationToken;
+
+	/**
+	 * Overriden copy constructor
+	 */
+	KeyBatch(KeyBatch const &);
+
+	/**
+	 * Overriden assignment operator
+	 */
+	KeyBatch & operator=(KeyBatch const &);
+};
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_KEYBATCH_HPP_ */
@@ -48,10 +48,13 @@
 #ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_KEYVERIFIER_HPP_
 #define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_KEYVERIFIER_HPP_
 
+#include "labynkyr/search/CancellationToken.hpp"
+
 #include "labynkyr/Key.hpp"
 
 #include <stdint.h>
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -67,6 +70,10 @@ namespace search {
 template<uint32_t KeyLenBits>
 class KeyVerifier {
 public:
+	enum {
+		// Number of bytes occupied by each key passed to checkKeys
+		KeyLenBytes = (KeyLenBits % 8 != 0) ? (KeyLenBits / 8) + 1 : KeyLenBits / 8
+	};
 
 	virtual ~KeyVerifier() {}
 
@@ -77,6 +84,23 @@ public:
 	 */
 	virtual void checkKey(std::vector<uint8_t> const & candidateKeyBytes) = 0;
 
+	/**
+	 *
+	 * Check a contiguous block of candidate keys in one call.  The default implementation passes each key to checkKey in turn;
+	 * implementations should override this to avoid the per-key virtual call and copy.
+	 *
+	 * @param candidateKeys keyCount keys stored back to back, each occupying KeyLenBytes bytes
+	 * @param keyCount
+	 */
+	virtual void checkKeys(uint8_t const * candidateKeys, uint64_t keyCount) {
+		std::vector<uint8_t> candidateKeyBytes(KeyLenBytes);
+		for(uint64_t keyIndex = 0 ; keyIndex < keyCount ; keyIndex++) {
+			uint8_t const * const candidateKey = candidateKeys + keyIndex * KeyLenBytes;
+			std::copy(candidateKey, candidateKey + KeyLenBytes, candidateKeyBytes.begin());
+			checkKey(candidateKeyBytes);
+		}
+	}
+
 	/**
 	 *
 	 * @return the number of keys this verifier has checked
@@ -103,6 +127,15 @@ public:
 	 * keys when a call to this function is made.
 	 */
 	virtual void flush() = 0;
+
+	/**
+	 *
+	 * Give the verifier the token shared by the threads taking part in a search.  Verifiers that may block (e.g waiting for another
+	 * process) should poll the token, and stop waiting once it is raised.  The default implementation ignores the token.
+	 *
+	 * @param cancellationToken
+	 */
+	virtual void setCancellationToken(CancellationToken & cancellationToken) {}
 };
 
 /**
@@ -76,11 +76,19 @@ public:
 	~ListKeyVerifier() {}
 
 	void checkKey(std::vector<uint8_t> const & candidateKeyBytes) override {
-		std::vector<uint8_t> copyKeyBytes(candidateKeyBytes);
-		keysRecorded.push_back(copyKeyBytes);
+		keysRecorded.push_back(candidateKeyBytes);
 		count++;
 	}
 
+	void checkKeys(uint8_t const * candidateKeys, uint64_t keyCount) override {
+		uint32_t const keyLenBytes = KeyVerifier<KeyLenBits>::KeyLenBytes;
+		for(uint64_t keyIndex = 0 ; keyIndex < keyCount ; keyIndex++) {
+			uint8_t const * const candidateKey = candidateKeys + keyIndex * keyLenBytes;
+			keysRecorded.emplace_back(candidateKey, candidateKey + keyLenBytes);
+		}
+		count += keyCount;
+	}
+
 	uint64_t keysChecked() const override {
 		return count;
 	}
@@ -0,0 +1,166 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SharedMemoryKeyConsumer.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_SHAREDMEMORYKEYCONSUMER_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_SHAREDMEMORYKEYCONSUMER_HPP_
+
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+#include "labynkyr/search/verify/SharedMemoryRing.hpp"
+
+#include "labynkyr/Key.hpp"
+
+#include <stdint.h>
+
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+#ifdef __linux__
+
+/**
+ *
+ * The consumer side of a SharedMemoryKeyVerifier.  Each block of candidate keys is passed to a local KeyVerifier straight from shared
+ * memory, and the correct key is reported back to the producer as soon as the local verifier finds it.
+ *
+ * This is the reference for an external verification process: such a process only needs to open the ring, and loop over nextBlock(),
+ * reportFound() and releaseBlock() as run() does.
+ *
+ * Only available on Linux.
+ *
+ * @tparam KeyLenBits
+ */
+template<uint32_t KeyLenBits>
+class SharedMemoryKeyConsumer {
+public:
+	/**
+	 *
+	 * @param name the name of a ring created by a SharedMemoryKeyVerifier
+	 * @param verifier the verifier the candidate keys are checked with
+	 * @param timeout how long to wait for the producer to create the ring
+	 * @throws std::runtime_error if the ring does not exist within the timeout, or holds keys of a different length
+	 */
+	SharedMemoryKeyConsumer(std::string const & name, KeyVerifier<KeyLenBits> & verifier,
+			std::chrono::milliseconds timeout = std::chrono::milliseconds(0))
+	: ring(openRing(name, timeout))
+	, verifier(verifier)
+	{
+		if(ring->getKeyLenBytes() != KeyVerifier<KeyLenBits>::KeyLenBytes) {
+			std::stringstream error;
+			error << "Shared memory " << name << " holds " << ring->getKeyLenBytes() << "-byte keys, expected " << KeyVerifier<KeyLenBits>::KeyLenBytes;
+			throw std::runtime_error(error.str().c_str());
+		}
+	}
+
+	~SharedMemoryKeyConsumer() {}
+
+	/**
+	 *
+	 * Verify blocks until the producer closes the ring and it has been drained.  Once the key has been found, the remaining blocks are
+	 * released without being verified.
+	 */
+	void run() {
+		uint64_t keyCount = 0;
+		uint8_t const * block = 0;
+		while((block = ring->nextBlock(keyCount)) != 0) {
+			if(ring->isFound()) {
+				ring->releaseBlock(0);
+				continue;
+			}
+			verifier.checkKeys(block, keyCount);
+			// The producer relies on every released key having been verified
+			verifier.flush();
+			if(verifier.success()) {
+				Key<KeyLenBits> const key = verifier.correctKey();
+				ring->reportFound(key.asBytes().data());
+			}
+			ring->releaseBlock(keyCount);
+		}
+	}
+private:
+	std::unique_ptr<SharedMemoryRing> ring;
+	KeyVerifier<KeyLenBits> & verifier;
+
+	/**
+	 *
+	 * Overriden copy constructor
+	 */
+	SharedMemoryKeyConsumer(SharedMemoryKeyConsumer<KeyLenBits> const & other);
+
+	/**
+	 *
+	 * Overriden assignment operator
+	 */
+	SharedMemoryKeyConsumer<KeyLenBits> & operator=(SharedMemoryKeyConsumer<KeyLenBits> const & other);
+
+	static std::unique_ptr<SharedMemoryRing> openRing(std::string const & name, std::chrono::milliseconds timeout) {
+		auto const deadline = std::chrono::steady_clock::now() + timeout;
+		while(true) {
+			try {
+				return SharedMemoryRing::open(name);
+			} catch(std::runtime_error const &) {
+				if(std::chrono::steady_clock::now() >= deadline) {
+					throw;
+				}
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+	}
+};
+
+#endif
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_SHAREDMEMORYKEYCONSUMER_HPP_ */
@@ -0,0 +1,275 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SharedMemoryKeyVerifier.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_SHAREDMEMORYKEYVERIFIER_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_SHAREDMEMORYKEYVERIFIER_HPP_
+
+#include "labynkyr/search/verify/KeyVerifier.hpp"
+#include "labynkyr/search/verify/SharedMemoryRing.hpp"
+
+#include "labynkyr/Key.hpp"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+#ifdef __linux__
+
+/**
+ *
+ * Implementation of KeyVerifier that passes candidate keys to a verifier running in another process, through a SharedMemoryRing.  This
+ * allows the search to drive verification oracles that cannot be linked into it (e.g a separate binary implementing a proprietary
+ * cipher, or a wrapper around a hardware test harness).
+ *
+ * Keys are copied once, straight into the shared block being filled, and a block is published to the consumer when it is full or on
+ * flush().  flush() waits until the consumer has verified every published key, so success() is accurate after a flush.  A consumer must
+ * be attached for the producer to make progress: see SharedMemoryKeyConsumer for a reference implementation.  checkKeys() and flush()
+ * throw std::runtime_error if the consumer goes away, and stop waiting for it once the search's CancellationToken is raised.
+ *
+ * Only available on Linux.
+ *
+ * @tparam KeyLenBits
+ */
+template<uint32_t KeyLenBits>
+class SharedMemoryKeyVerifier : public KeyVerifier<KeyLenBits> {
+public:
+	enum {
+		DefaultSlotCount = 16,
+		DefaultBlockKeys = 4096
+	};
+
+	/**
+	 *
+	 * @param name the name of the shared memory object to create, which must begin with '/'
+	 * @param slotCount the number of blocks in the ring
+	 * @param blockKeys the maximum number of keys in each block
+	 * @throws std::invalid_argument
+	 * @throws std::runtime_error
+	 */
+	SharedMemoryKeyVerifier(std::string const & name, uint32_t slotCount = DefaultSlotCount, uint64_t blockKeys = DefaultBlockKeys)
+	: KeyVerifier<KeyLenBits>()
+	, ring(SharedMemoryRing::create(name, KeyVerifier<KeyLenBits>::KeyLenBytes, slotCount, blockKeys))
+	, block(0)
+	, blockKeyCount(0)
+	, count(0)
+	{
+	}
+
+	/**
+	 *
+	 * Publishes any partially filled block and closes the ring, so that the consumer finishes once it has drained it.  The shared memory
+	 * object is removed; a consumer that is still attached keeps its mapping until it exits.
+	 */
+	~SharedMemoryKeyVerifier() {
+		publish();
+		ring->close();
+	}
+
+	void checkKey(std::vector<uint8_t> const & candidateKeyBytes) override {
+		checkKeys(candidateKeyBytes.data(), 1);
+	}
+
+	void checkKeys(uint8_t const * candidateKeys, uint64_t keyCount) override {
+		uint32_t const keyLenBytes = KeyVerifier<KeyLenBits>::KeyLenBytes;
+		count += keyCount;
+		while(keyCount > 0) {
+			if(block == 0) {
+				block = ring->reserveBlock();
+				if(block == 0) {
+					// The key has been found, or the search cancelled: there is no need to send the rest
+					return;
+				}
+			}
+			uint64_t const keysToCopy = std::min(keyCount, ring->getBlockKeys() - blockKeyCount);
+			std::copy(candidateKeys, candidateKeys + keysToCopy * keyLenBytes, block + blockKeyCount * keyLenBytes);
+			blockKeyCount += keysToCopy;
+			candidateKeys += keysToCopy * keyLenBytes;
+			keyCount -= keysToCopy;
+			if(blockKeyCount == ring->getBlockKeys()) {
+				publish();
+			}
+		}
+	}
+
+	uint64_t keysChecked() const override {
+		return count;
+	}
+
+	bool success() const override {
+		return ring->isFound();
+	}
+
+	Key<KeyLenBits> correctKey() override {
+		if(ring->isFound()) {
+			uint8_t const * const key = ring->foundKey();
+			std::vector<uint8_t> const keyBytes(key, key + KeyVerifier<KeyLenBits>::KeyLenBytes);
+			return Key<KeyLenBits>(keyBytes);
+		}
+		throw std::logic_error("Key has not been found");
+	}
+
+	/**
+	 *
+	 * Publish any partially filled block, and wait until the consumer has verified every key sent so far
+	 */
+	void flush() override {
+		publish();
+		ring->waitUntilDrained();
+	}
+
+	void setCancellationToken(CancellationToken & cancellationToken) override {
+		ring->setCancellationToken(cancellationToken);
+	}
+
+	/**
+	 *
+	 * @return the number of keys the consumer has verified
+	 */
+	uint64_t keysVerified() const {
+		return ring->keysVerified();
+	}
+
+	/**
+	 *
+	 * @return the name of the shared memory object
+	 */
+	std::string const & getName() const {
+		return ring->getName();
+	}
+private:
+	std::unique_ptr<SharedMemoryRing> ring;
+	uint8_t * block;
+	uint64_t blockKeyCount;
+	uint64_t count;
+
+	/**
+	 *
+	 * Overriden copy constructor
+	 */
+	SharedMemoryKeyVerifier(SharedMemoryKeyVerifier<KeyLenBits> const & other);
+
+	/**
+	 *
+	 * Overriden assignment operator
+	 */
+	SharedMemoryKeyVerifier<KeyLenBits> & operator=(SharedMemoryKeyVerifier<KeyLenBits> const & other);
+
+	void publish() {
+		if(block != 0 && blockKeyCount > 0) {
+			ring->publishBlock(blockKeyCount);
+			block = 0;
+			blockKeyCount = 0;
+		}
+	}
+};
+
+/**
+ *
+ * Creates one SharedMemoryKeyVerifier, and so one ring, per call.  The rings are named namePrefix-0, namePrefix-1, ... in order of
+ * creation, so that the consumer process (or processes) can open the ring belonging to each PEU.
+ *
+ * @tparam KeyLenBits
+ */
+template<uint32_t KeyLenBits>
+class SharedMemoryKeyVerifierFactory : public KeyVerifierFactory<KeyLenBits> {
+public:
+	/**
+	 *
+	 * @param namePrefix must begin with '/'
+	 * @param slotCount the number of blocks in each ring
+	 * @param blockKeys the maximum number of keys in each block
+	 */
+	SharedMemoryKeyVerifierFactory(std::string const & namePrefix,
+			uint32_t slotCount = SharedMemoryKeyVerifier<KeyLenBits>::DefaultSlotCount,
+			uint64_t blockKeys = SharedMemoryKeyVerifier<KeyLenBits>::DefaultBlockKeys)
+	: KeyVerifierFactory<KeyLenBits>()
+	, namePrefix(namePrefix)
+	, slotCount(slotCount)
+	, blockKeys(blockKeys)
+	, verifierCount(0)
+	{
+	}
+
+	~SharedMemoryKeyVerifierFactory() {}
+
+	std::unique_ptr<KeyVerifier<KeyLenBits>> newVerifier() const override {
+		auto * verifier = new SharedMemoryKeyVerifier<KeyLenBits>(ringName(verifierCount++), slotCount, blockKeys);
+		return std::unique_ptr<SharedMemoryKeyVerifier<KeyLenBits>>(verifier);
+	}
+
+	/**
+	 *
+	 * @param index
+	 * @return the name of the ring created by the index-th call to newVerifier
+	 */
+	std::string ringName(uint32_t index) const {
+		std::stringstream name;
+		name << namePrefix << "-" << index;
+		return name.str();
+	}
+private:
+	std::string const namePrefix;
+	uint32_t const slotCount;
+	uint64_t const blockKeys;
+	mutable std::atomic<uint32_t> verifierCount;
+};
+
+#endif
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_SHAREDMEMORYKEYVERIFIER_HPP_ */
@@ -0,0 +1,509 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SharedMemoryRing.hpp
+ *
+ */
+
+#ifndef LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_SHAREDMEMORYRING_HPP_
+#define LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_SHAREDMEMORYRING_HPP_
+
+#include "labynkyr/search/CancellationToken.hpp"
+
+#ifdef __linux__
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <signal.h>
+	#include <string.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace labynkyr {
+namespace search {
+
+#ifdef __linux__
+
+/**
+ *
+ * A single-producer/single-consumer ring of candidate key blocks held in POSIX shared memory, so that candidate keys can be handed to a
+ * verifier running in another process without being copied through a pipe or socket.
+ *
+ * The region holds a header, a slot for the key found by the consumer, and slotCount blocks of up to blockKeys keys each.  The producer
+ * fills the block at the write index and publishes it; the consumer verifies the block at the read index in place and releases it.  Both
+ * indices only ever increase, and the block for index i is held in slot i % slotCount.  A consumer that finds the key writes it to the
+ * found slot before releasing the block it was in, so once the read index has caught up with the write index the producer can rely on
+ * isFound().
+ *
+ * The consumer records its pid in the header when it opens the ring, and marks itself detached when it closes it.  A producer waiting for
+ * the consumer gives up with an exception if the consumer has detached or its process has exited, and returns early if its
+ * CancellationToken is raised, so that it is never left waiting on a consumer that will not come back.
+ *
+ * The producer creates (and on destruction removes) the region; the consumer opens an existing one.  Only available on Linux.
+ */
+class SharedMemoryRing {
+public:
+	~SharedMemoryRing() {
+		if(consumer) {
+			header()->consumerState.store(ConsumerDetached, std::memory_order_release);
+		}
+		::munmap(region, regionBytes);
+		if(owner) {
+			::shm_unlink(name.c_str());
+		}
+	}
+
+	/**
+	 *
+	 * Create a new ring, replacing any existing region with the same name.
+	 *
+	 * @param name the POSIX shared memory object name, which must begin with '/'
+	 * @param keyLenBytes the number of bytes occupied by each key
+	 * @param slotCount the number of blocks in the ring
+	 * @param blockKeys the maximum number of keys in each block
+	 * @return the ring, with this process as its producer
+	 * @throws std::invalid_argument
+	 * @throws std::runtime_error
+	 */
+	static std::unique_ptr<SharedMemoryRing> create(std::string const & name, uint32_t keyLenBytes, uint32_t slotCount, uint64_t blockKeys) {
+		if(name.empty() || name[0] != '/') {
+			throw std::invalid_argument("Shared memory ring names must begin with '/'");
+		}
+		if(keyLenBytes == 0 || slotCount == 0 || blockKeys == 0) {
+			throw std::invalid_argument("Shared memory rings must hold at least one key of at least one byte");
+		}
+		::shm_unlink(name.c_str());
+		int const descriptor = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+		if(descriptor < 0) {
+			throwError("Unable to create shared memory " + name);
+		}
+		uint64_t const bytes = layoutBytes(keyLenBytes, slotCount, blockKeys);
+		if(::ftruncate(descriptor, bytes) != 0) {
+			::close(descriptor);
+			::shm_unlink(name.c_str());
+			throwError("Unable to size shared memory " + name);
+		}
+		std::unique_ptr<SharedMemoryRing> ring(new SharedMemoryRing(name, descriptor, bytes, true));
+		Header * const header = new (ring->region) Header();
+		header->keyLenBytes = keyLenBytes;
+		header->slotCount = slotCount;
+		header->blockKeys = blockKeys;
+		header->writeIndex.store(0);
+		header->readIndex.store(0);
+		header->found.store(0);
+		header->closed.store(0);
+		header->keysVerified.store(0);
+		header->consumerPid.store(0);
+		header->consumerState.store(ConsumerNone);
+		if(!header->writeIndex.is_lock_free()) {
+			throw std::runtime_error("Shared memory rings require lock-free 64-bit atomics");
+		}
+		header->magic.store(Magic, std::memory_order_release);
+		ring->attach();
+		return ring;
+	}
+
+	/**
+	 *
+	 * Open a ring created by another process.  Each ring has a single consumer.
+	 *
+	 * @param name
+	 * @return the ring, with this process as its consumer
+	 * @throws std::runtime_error if no initialised ring of that name exists
+	 */
+	static std::unique_ptr<SharedMemoryRing> open(std::string const & name) {
+		int const descriptor = ::shm_open(name.c_str(), O_RDWR, 0);
+		if(descriptor < 0) {
+			throwError("Unable to open shared memory " + name);
+		}
+		struct stat status;
+		if(::fstat(descriptor, &status) != 0 || static_cast<uint64_t>(status.st_size) < sizeof(Header)) {
+			::close(descriptor);
+			throw std::runtime_error("Shared memory " + name + " is not a key ring");
+		}
+		std::unique_ptr<SharedMemoryRing> ring(new SharedMemoryRing(name, descriptor, status.st_size, false));
+		Header * const header = ring->header();
+		if(header->magic.load(std::memory_order_acquire) != Magic
+				|| layoutBytes(header->keyLenBytes, header->slotCount, header->blockKeys) != ring->regionBytes) {
+			throw std::runtime_error("Shared memory " + name + " is not a key ring");
+		}
+		ring->attach();
+		header->consumerPid.store(::getpid(), std::memory_order_relaxed);
+		header->consumerState.store(ConsumerAttached, std::memory_order_release);
+		ring->consumer = true;
+		return ring;
+	}
+
+	/**
+	 *
+	 * Producer: wait for a free block.
+	 *
+	 * @return the block to write keys into, or 0 if the key has been found or the cancellation token raised (in which case further keys
+	 * need not be sent)
+	 * @throws std::runtime_error if the consumer has gone
+	 */
+	uint8_t * reserveBlock() {
+		Header * const h = header();
+		uint64_t const writeIndex = h->writeIndex.load(std::memory_order_relaxed);
+		while(writeIndex - cachedReadIndex >= slotCount) {
+			if(isFound() || isCancelled()) {
+				return 0;
+			}
+			// Checked first, so that blocks released by the consumer before it detached are seen below
+			bool const consumerLost = isConsumerLost();
+			cachedReadIndex = h->readIndex.load(std::memory_order_acquire);
+			if(writeIndex - cachedReadIndex >= slotCount) {
+				if(consumerLost) {
+					throwConsumerLost();
+				}
+				std::this_thread::yield();
+			}
+		}
+		return slotKeys(writeIndex % slotCount);
+	}
+
+	/**
+	 *
+	 * Producer: publish the block returned by the last call to reserveBlock
+	 *
+	 * @param keyCount the number of keys written to the block
+	 */
+	void publishBlock(uint64_t keyCount) {
+		Header * const h = header();
+		uint64_t const writeIndex = h->writeIndex.load(std::memory_order_relaxed);
+		*slotKeyCount(writeIndex % slotCount) = keyCount;
+		h->writeIndex.store(writeIndex + 1, std::memory_order_release);
+	}
+
+	/**
+	 *
+	 * Producer: wait until the consumer has released every published block, the key has been found, or the cancellation token is raised
+	 *
+	 * @throws std::runtime_error if the consumer has gone
+	 */
+	void waitUntilDrained() {
+		Header const * const h = header();
+		uint64_t const writeIndex = h->writeIndex.load(std::memory_order_relaxed);
+		while(true) {
+			bool const consumerLost = isConsumerLost();
+			if(h->readIndex.load(std::memory_order_acquire) == writeIndex || isFound() || isCancelled()) {
+				return;
+			}
+			if(consumerLost) {
+				throwConsumerLost();
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	/**
+	 *
+	 * Producer: stop waiting for the consumer once the token is raised
+	 *
+	 * @param cancellationToken
+	 */
+	void setCancellationToken(CancellationToken & cancellationToken) {
+		this->cancellationToken = &cancellationToken;
+	}
+
+	/**
+	 *
+	 * Producer: tell the consumer that no more blocks will be published
+	 */
+	void close() {
+		header()->closed.store(1, std::memory_order_release);
+	}
+
+	/**
+	 *
+	 * Consumer: wait for the next published block.
+	 *
+	 * @param keyCount set to the number of keys in the block
+	 * @return the keys, or 0 if the producer has closed the ring and every block has been consumed
+	 */
+	uint8_t const * nextBlock(uint64_t & keyCount) {
+		Header const * const h = header();
+		uint64_t const readIndex = h->readIndex.load(std::memory_order_relaxed);
+		while(readIndex == cachedWriteIndex) {
+			cachedWriteIndex = h->writeIndex.load(std::memory_order_acquire);
+			if(readIndex == cachedWriteIndex) {
+				if(h->closed.load(std::memory_order_acquire) != 0) {
+					// The producer may have published a final block before closing
+					cachedWriteIndex = h->writeIndex.load(std::memory_order_acquire);
+					if(readIndex == cachedWriteIndex) {
+						return 0;
+					}
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		}
+		keyCount = *slotKeyCount(readIndex % slotCount);
+		return slotKeys(readIndex % slotCount);
+	}
+
+	/**
+	 *
+	 * Consumer: release the block returned by the last call to nextBlock, once its keys have been verified
+	 *
+	 * @param keyCount the number of keys verified
+	 */
+	void releaseBlock(uint64_t keyCount) {
+		Header * const h = header();
+		h->keysVerified.fetch_add(keyCount, std::memory_order_relaxed);
+		h->readIndex.store(h->readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	/**
+	 *
+	 * Consumer: report the correct key.  Must be called before the block containing the key is released.
+	 *
+	 * @param key keyLenBytes bytes
+	 */
+	void reportFound(uint8_t const * key) {
+		Header * const h = header();
+		std::copy(key, key + keyLenBytes, foundKeySlot());
+		h->found.store(1, std::memory_order_release);
+	}
+
+	/**
+	 *
+	 * @return true if the consumer has reported the correct key
+	 */
+	bool isFound() const {
+		return header()->found.load(std::memory_order_acquire) != 0;
+	}
+
+	/**
+	 *
+	 * @return the key reported by the consumer, keyLenBytes bytes.  Only valid once isFound() returns true.
+	 */
+	uint8_t const * foundKey() const {
+		return foundKeySlot();
+	}
+
+	/**
+	 *
+	 * @return the number of keys the consumer has verified and released
+	 */
+	uint64_t keysVerified() const {
+		return header()->keysVerified.load(std::memory_order_relaxed);
+	}
+
+	uint32_t getKeyLenBytes() const {
+		return keyLenBytes;
+	}
+
+	uint32_t getSlotCount() const {
+		return slotCount;
+	}
+
+	uint64_t getBlockKeys() const {
+		return blockKeys;
+	}
+
+	std::string const & getName() const {
+		return name;
+	}
+private:
+	enum : uint64_t {
+		Magic = 0x4C4142594E4B5952ULL,
+		CacheLineBytes = 64
+	};
+
+	enum : uint32_t {
+		ConsumerNone = 0,
+		ConsumerAttached = 1,
+		ConsumerDetached = 2
+	};
+
+	struct Header {
+		std::atomic<uint64_t> magic;
+		uint32_t keyLenBytes;
+		uint32_t slotCount;
+		uint64_t blockKeys;
+		// Each index is written by one side only, so they are kept on separate cache lines
+		alignas(64) std::atomic<uint64_t> writeIndex;
+		alignas(64) std::atomic<uint64_t> readIndex;
+		std::atomic<uint64_t> keysVerified;
+		std::atomic<int32_t> consumerPid;
+		std::atomic<uint32_t> consumerState;
+		alignas(64) std::atomic<uint32_t> found;
+		std::atomic<uint32_t> closed;
+	};
+
+	std::string const name;
+	uint64_t const regionBytes;
+	bool const owner;
+	bool consumer;
+	uint8_t * region;
+	uint32_t keyLenBytes;
+	uint32_t slotCount;
+	uint64_t blockKeys;
+	uint64_t slotBytes;
+	uint64_t cachedReadIndex;
+	uint64_t cachedWriteIndex;
+	// Null unless set by setCancellationToken
+	CancellationToken * cancellationToken;
+
+	SharedMemoryRing(std::string const & name, int descriptor, uint64_t regionBytes, bool owner)
+	: name(name)
+	, regionBytes(regionBytes)
+	, owner(owner)
+	, consumer(false)
+	, region(0)
+	, keyLenBytes(0)
+	, slotCount(0)
+	, blockKeys(0)
+	, slotBytes(0)
+	, cachedReadIndex(0)
+	, cachedWriteIndex(0)
+	, cancellationToken(0)
+	{
+		void * const mapping = ::mmap(0, regionBytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+		::close(descriptor);
+		if(mapping == MAP_FAILED) {
+			if(owner) {
+				::shm_unlink(name.c_str());
+			}
+			throwError("Unable to map shared memory " + name);
+		}
+		region = static_cast<uint8_t *>(mapping);
+	}
+
+	/**
+	 *
+	 * Overriden copy constructor
+	 */
+	SharedMemoryRing(SharedMemoryRing const & other);
+
+	/**
+	 *
+	 * Overriden assignment operator
+	 */
+	SharedMemoryRing & operator=(SharedMemoryRing const & other);
+
+	void attach() {
+		Header const * const h = header();
+		keyLenBytes = h->keyLenBytes;
+		slotCount = h->slotCount;
+		blockKeys = h->blockKeys;
+		slotBytes = roundUp(sizeof(uint64_t) + blockKeys * keyLenBytes);
+		cachedReadIndex = h->readIndex.load(std::memory_order_acquire);
+		cachedWriteIndex = h->writeIndex.load(std::memory_order_acquire);
+	}
+
+	Header * header() {
+		return reinterpret_cast<Header *>(region);
+	}
+
+	Header const * header() const {
+		return reinterpret_cast<Header const *>(region);
+	}
+
+	uint8_t * foundKeySlot() const {
+		return region + roundUp(sizeof(Header));
+	}
+
+	uint64_t * slotKeyCount(uint64_t slot) {
+		return reinterpret_cast<uint64_t *>(region + roundUp(sizeof(Header)) + roundUp(keyLenBytes) + slot * slotBytes);
+	}
+
+	uint8_t * slotKeys(uint64_t slot) {
+		return reinterpret_cast<uint8_t *>(slotKeyCount(slot) + 1);
+	}
+
+	bool isCancelled() const {
+		return cancellationToken != 0 && cancellationToken->isCancelled();
+	}
+
+	/**
+	 *
+	 * @return true if the consumer has closed the ring, or its process has exited
+	 */
+	bool isConsumerLost() const {
+		Header const * const h = header();
+		uint32_t const state = h->consumerState.load(std::memory_order_acquire);
+		if(state == ConsumerDetached) {
+			return true;
+		}
+		return state == ConsumerAttached && ::kill(h->consumerPid.load(std::memory_order_relaxed), 0) != 0 && errno == ESRCH;
+	}
+
+	void throwConsumerLost() const {
+		throw std::runtime_error("The consumer of shared memory " + name + " has gone without releasing every block");
+	}
+
+	static uint64_t roundUp(uint64_t bytes) {
+		return (bytes + CacheLineBytes - 1) / CacheLineBytes * CacheLineBytes;
+	}
+
+	static uint64_t layoutBytes(uint32_t keyLenBytes, uint32_t slotCount, uint64_t blockKeys) {
+		return roundUp(sizeof(Header)) + roundUp(keyLenBytes) + slotCount * roundUp(sizeof(uint64_t) + blockKeys * keyLenBytes);
+	}
+
+	static void throwError(std::string const & message) {
+		std::stringstream error;
+		error << message << ": " << ::strerror(errno);
+		throw std::runtime_error(error.str().c_str());
+	}
+};
+
+#endif
+
+} /* namespace search */
+} /* namespace labynkyr */
+
+#endif /* LABYNKYR_SRC_LABYNKYR_SEARCH_VERIFY_SHAREDMEMORYRING_HPP_ */
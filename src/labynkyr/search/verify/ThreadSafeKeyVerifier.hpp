@@ -77,6 +77,11 @@ public:
 		internal->checkKey(candidateKeyBytes);
 	}
 
+	void checkKeys(uint8_t const * candidateKeys, uint64_t keyCount) override {
+		std::unique_lock<std::mutex> lock(mutex);
+		internal->checkKeys(candidateKeys, keyCount);
+	}
+
 	uint64_t keysChecked() const override {
 		return internal->keysChecked();
 	}
@@ -93,6 +98,10 @@ public:
 		std::unique_lock<std::mutex> lock(mutex);
 		internal->flush();
 	}
+
+	void setCancellationToken(CancellationToken & cancellationToken) override {
+		internal->setCancellationToken(cancellationToken);
+	}
 private:
 	std::unique_ptr<KeyVerifier<KeyLenBits>> internal;
 	mutable std::mutex mutex;
@@ -0,0 +1,119 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * AdaptiveTaskSizerTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/AdaptiveTaskSizer.hpp"
+
+#include "src/labynkyr/BigInt.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace labynkyr {
+namespace search {
+
+TEST(AdaptiveTaskSizer_initialSize) {
+	AdaptiveTaskSizer<32> sizer(std::chrono::milliseconds(10), 12.0, 4.0, 20.0);
+	CHECK_CLOSE(12.0, sizer.preferredJobSizeBits(), 1e-9);
+	CHECK_EQUAL(0, sizer.sampleCount());
+	CHECK_CLOSE(0.0, sizer.estimatedKeysPerSecond(), 1e-9);
+
+	AdaptiveTaskSizer<32> clamped(std::chrono::milliseconds(10), 30.0, 4.0, 20.0);
+	CHECK_CLOSE(20.0, clamped.preferredJobSizeBits(), 1e-9);
+}
+
+TEST(AdaptiveTaskSizer_invalidArguments) {
+	CHECK_THROW((AdaptiveTaskSizer<32>(std::chrono::milliseconds(0), 12.0, 4.0, 20.0)), std::invalid_argument);
+	CHECK_THROW((AdaptiveTaskSizer<32>(std::chrono::milliseconds(10), 12.0, 20.0, 4.0)), std::invalid_argument);
+	CHECK_THROW((AdaptiveTaskSizer<32>(std::chrono::milliseconds(10), 12.0, 4.0, 33.0)), std::invalid_argument);
+}
+
+TEST(AdaptiveTaskSizer_separatesSetupCost) {
+	// Each task costs 1ms of setup and 1us per key
+	AdaptiveTaskSizer<32> sizer(std::chrono::milliseconds(10), 10.0, 0.0, 32.0);
+	sizer.recordTask(BigInt<32>(1024), std::chrono::microseconds(1000 + 1024));
+	sizer.recordTask(BigInt<32>(4096), std::chrono::microseconds(1000 + 4096));
+	CHECK_EQUAL(2, sizer.sampleCount());
+	CHECK_CLOSE(1e6, sizer.estimatedKeysPerSecond(), 1e3);
+	CHECK_CLOSE(1000000, sizer.estimatedSetupCost().count(), 1000);
+	// 9ms of the 10ms target are left for verification
+	CHECK_CLOSE(std::log2(9000.0), sizer.preferredJobSizeBits(), 1e-3);
+}
+
+TEST(AdaptiveTaskSizer_sameSizedTasks) {
+	// The setup cost cannot be separated, so all of the time is attributed to the keys
+	AdaptiveTaskSizer<32> sizer(std::chrono::milliseconds(8), 10.0, 0.0, 32.0);
+	sizer.recordTask(BigInt<32>(1024), std::chrono::milliseconds(2));
+	CHECK_CLOSE(0, sizer.estimatedSetupCost().count(), 1);
+	CHECK_CLOSE(12.0, sizer.preferredJobSizeBits(), 1e-6);
+}
+
+TEST(AdaptiveTaskSizer_setupDominates) {
+	// Each task costs 20ms of setup and 1us per key, against a target of 10ms
+	AdaptiveTaskSizer<32> sizer(std::chrono::milliseconds(10), 10.0, 0.0, 32.0);
+	sizer.recordTask(BigInt<32>(1024), std::chrono::microseconds(20000 + 1024));
+	sizer.recordTask(BigInt<32>(4096), std::chrono::microseconds(20000 + 4096));
+	// Verification is given as long as the setup
+	CHECK_CLOSE(std::log2(20000.0), sizer.preferredJobSizeBits(), 1e-3);
+}
+
+TEST(AdaptiveTaskSizer_clampedToBounds) {
+	AdaptiveTaskSizer<32> sizer(std::chrono::seconds(10), 10.0, 4.0, 16.0);
+	sizer.recordTask(BigInt<32>(1024), std::chrono::microseconds(1024));
+	CHECK_CLOSE(16.0, sizer.preferredJobSizeBits(), 1e-9);
+
+	AdaptiveTaskSizer<32> small(std::chrono::nanoseconds(1), 10.0, 4.0, 16.0);
+	small.recordTask(BigInt<32>(1024), std::chrono::microseconds(1024));
+	CHECK_CLOSE(4.0, small.preferredJobSizeBits(), 1e-9);
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -235,6 +235,20 @@ TEST(EffortAllocation_preAllocatedConstructor) {
 	CHECK_ARRAY_EQUAL(expectedMaxWeights, maxWeights, expectedMaxWeights.size());
 }
 
+TEST(EffortAllocation_maximumTaskWeight) {
+	SearchSpec<4> const searchSpec(0, 8);
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+
+	EffortAllocation<2, 2, uint32_t> allocation(searchSpec, weightTable, 0);
+	// The first 8 keys have weight below 3
+	CHECK_EQUAL(3, allocation.maximumTaskWeight());
+	while(allocation.isTasksAvailable()) {
+		allocation.removeNextTask();
+	}
+	CHECK_EQUAL(0, allocation.maximumTaskWeight());
+}
+
 } /* namespace search */
 } /* namespace labynkyr */
 
@@ -0,0 +1,109 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * FirstSubkeyRangeTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/FirstSubkeyRange.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+
+namespace labynkyr {
+namespace search {
+
+TEST(FirstSubkeyRange_empty) {
+	CHECK_THROW(FirstSubkeyRange range(3, 3), std::invalid_argument);
+}
+
+TEST(FirstSubkeyRange_claim_ascending) {
+	FirstSubkeyRange range(2, 5);
+	uint64_t subkey = 0;
+	for(uint64_t expected = 2 ; expected < 5 ; expected++) {
+		CHECK(range.claim(subkey));
+		CHECK_EQUAL(expected, subkey);
+	}
+	CHECK(!range.claim(subkey));
+	CHECK_EQUAL(5, range.getEnd());
+}
+
+TEST(FirstSubkeyRange_split_upperHalfOfUnclaimed) {
+	FirstSubkeyRange range(0, 8);
+	uint64_t subkey = 0;
+	CHECK(range.claim(subkey));
+	CHECK(range.claim(subkey));
+	// Subkeys 2-7 remain, so 5-7 are split off
+	uint64_t splitBegin = 0;
+	uint64_t splitEnd = 0;
+	CHECK(range.split(splitBegin, splitEnd));
+	CHECK_EQUAL(5, splitBegin);
+	CHECK_EQUAL(8, splitEnd);
+	CHECK_EQUAL(5, range.getEnd());
+	for(uint64_t expected = 2 ; expected < 5 ; expected++) {
+		CHECK(range.claim(subkey));
+		CHECK_EQUAL(expected, subkey);
+	}
+	CHECK(!range.claim(subkey));
+}
+
+TEST(FirstSubkeyRange_split_keepsOneForClaimer) {
+	FirstSubkeyRange range(0, 2);
+	uint64_t subkey = 0;
+	uint64_t splitBegin = 0;
+	uint64_t splitEnd = 0;
+	CHECK(range.split(splitBegin, splitEnd));
+	CHECK_EQUAL(1, splitBegin);
+	CHECK_EQUAL(2, splitEnd);
+	CHECK(!range.split(splitBegin, splitEnd));
+	CHECK(range.claim(subkey));
+	CHECK_EQUAL(0, subkey);
+	CHECK(!range.split(splitBegin, splitEnd));
+	CHECK(!range.claim(subkey));
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -48,8 +48,10 @@
 #include "src/labynkyr/search/PathCountSearch.hpp"
 
 #include "src/labynkyr/search/enumerate/ActiveNodeFinder.hpp"
+#include "src/labynkyr/search/enumerate/SortedWeightTable.hpp"
 #include "src/labynkyr/search/verify/ComparisonKeyVerifier.hpp"
 #include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+#include "src/labynkyr/search/CancellationToken.hpp"
 #include "src/labynkyr/search/SearchTask.hpp"
 
 #include "src/labynkyr/BigInt.hpp"
@@ -59,6 +61,7 @@
 
 #include <stdint.h>
 
+#include <stdexcept>
 #include <vector>
 
 namespace labynkyr {
@@ -229,5 +232,80 @@ TEST(PathCountSearch_searchWithSorted_twoVectors_size4) {
 	CHECK_EQUAL(4, verifier.keysChecked());
 }
 
+TEST(PathCountSearch_searchWithANFForest_cancelled) {
+	ListKeyVerifier<6> verifier;
+	CancellationToken token;
+	token.cancel();
+	PathCountSearch<3, 2, uint32_t, uint32_t> search(verifier, 4, &token);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+
+	uint32_t const minKeyWeight = 0;
+	uint32_t const maxKeyWeight = 5;
+	SearchTask<3, 2, uint32_t> const task(minKeyWeight, maxKeyWeight, weightTable);
+	ActiveNodeFinder<3, 2, uint32_t> activeNodeFinder(weightTable, weightTable.maximumWeight());
+
+	// Cancelled before the graph is built, so no keys are enumerated
+	search.searchWithANFForest(task, activeNodeFinder);
+	CHECK_EQUAL(0, verifier.keysChecked());
+	search.searchWithANFFlatForest(task, activeNodeFinder);
+	CHECK_EQUAL(0, verifier.keysChecked());
+}
+
+TEST(PathCountSearch_searchWithANFForest_raisesToken) {
+	std::vector<uint8_t> const targetKey = {0x06};
+	ComparisonKeyVerifier<4> verifier(targetKey);
+	CancellationToken token;
+	PathCountSearch<2, 2, uint32_t, uint32_t> search(verifier, 4, &token);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+
+	uint32_t const minKeyWeight = 0;
+	uint32_t const maxKeyWeight = 6;
+	SearchTask<2, 2, uint32_t> const task(minKeyWeight, maxKeyWeight, weightTable);
+	ActiveNodeFinder<2, 2, uint32_t> activeNodeFinder(weightTable, weightTable.maximumWeight());
+
+	search.searchWithANFForest(task, activeNodeFinder);
+	CHECK(verifier.success());
+	CHECK(token.isCancelled());
+}
+
+TEST(PathCountSearch_searchWithANFForest_memoryLimitExceeded) {
+	ListKeyVerifier<6> verifier;
+	PathCountSearch<3, 2, uint32_t, uint32_t> search(verifier);
+	search.setMemoryLimit(1);
+	CHECK_EQUAL(1, search.getMemoryLimit());
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SearchTask<3, 2, uint32_t> const task(0, 5, weightTable);
+	ActiveNodeFinder<3, 2, uint32_t> activeNodeFinder(weightTable, weightTable.maximumWeight());
+
+	// The limit is hit while building, before any key is verified
+	CHECK_THROW(search.searchWithANFForest(task, activeNodeFinder), std::length_error);
+	CHECK_THROW(search.searchWithANFFlatForest(task, activeNodeFinder), std::length_error);
+	CHECK_EQUAL(0, verifier.keysChecked());
+
+	search.setMemoryLimit(0);
+	search.searchWithANFForest(task, activeNodeFinder);
+	CHECK_EQUAL(53, verifier.keysChecked());
+}
+
+TEST(PathCountSearch_searchWithSorted_task) {
+	ListKeyVerifier<6> verifier;
+	PathCountSearch<3, 2, uint32_t, uint32_t> search(verifier);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SortedWeightTable<3, 2, uint32_t, uint32_t> const sortedWeightTable(weightTable);
+
+	// 53 keys below weight 5, of which 4 have weight 0
+	SearchTask<3, 2, uint32_t> const task(1, 5, weightTable);
+	search.searchWithSorted(task, sortedWeightTable);
+	CHECK_EQUAL(49, verifier.keysChecked());
+}
+
 } /* namespace search */
 } /* namespace labynkyr */
@@ -0,0 +1,224 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SearchCheckpointTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/SearchCheckpoint.hpp"
+
+#include "src/labynkyr/search/EffortAllocation.hpp"
+#include "src/labynkyr/search/SearchSpec.hpp"
+
+#include "src/labynkyr/BigInt.hpp"
+#include "src/labynkyr/WeightTable.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(SearchCheckpoint_remainingTasks) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> allocation(SearchSpec<4>(0, 15), weightTable, 0);
+
+	SearchCheckpoint<2, 2, uint32_t> checkpoint(weightTable, allocation.getAllocatedTasks());
+	CHECK_EQUAL(6, checkpoint.taskCount());
+	CHECK_EQUAL(0, checkpoint.completedCount());
+	CHECK_EQUAL(6, checkpoint.maximumPlannedWeight());
+
+	checkpoint.markCompleted(SearchTask<2, 2, uint32_t>(0, 1, weightTable));
+	checkpoint.markCompleted(SearchTask<2, 2, uint32_t>(3, 4, weightTable));
+	CHECK_EQUAL(2, checkpoint.completedCount());
+	CHECK(checkpoint.isCompleted(0));
+	CHECK(checkpoint.isCompleted(3));
+	CHECK(!checkpoint.isCompleted(1));
+
+	auto const remaining = checkpoint.remainingTasks();
+	std::vector<BigInt<4>> const expectedBatchSizes = {2, 2, 1, 1};
+	std::vector<uint32_t> const expectedMinWeights = {1, 2, 4, 5};
+	std::vector<BigInt<4>> batchSizes;
+	std::vector<uint32_t> minWeights;
+	for(auto const & task : remaining) {
+		batchSizes.push_back(task.first);
+		minWeights.push_back(task.second.getMinKeyWeight());
+	}
+	CHECK_EQUAL(expectedBatchSizes.size(), remaining.size());
+	CHECK_ARRAY_EQUAL(expectedBatchSizes, batchSizes, expectedBatchSizes.size());
+	CHECK_ARRAY_EQUAL(expectedMinWeights, minWeights, expectedMinWeights.size());
+}
+
+TEST(SearchCheckpoint_markCompleted_unknownTask) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> allocation(SearchSpec<4>(0, 15), weightTable, 0);
+
+	SearchCheckpoint<2, 2, uint32_t> checkpoint(weightTable, allocation.getAllocatedTasks());
+	CHECK_THROW(checkpoint.markCompleted(SearchTask<2, 2, uint32_t>(0, 2, weightTable)), std::invalid_argument);
+}
+
+TEST(SearchCheckpoint_saveAndLoad) {
+	std::string const path = "SearchCheckpoint_saveAndLoad.checkpoint";
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> allocation(SearchSpec<4>(0, 15), weightTable, 0);
+
+	SearchCheckpoint<2, 2, uint32_t> checkpoint(weightTable, allocation.getAllocatedTasks());
+	checkpoint.markCompleted(SearchTask<2, 2, uint32_t>(1, 2, weightTable));
+	checkpoint.markCompleted(SearchTask<2, 2, uint32_t>(5, 6, weightTable));
+	checkpoint.save(path);
+	// Saving again replaces the file
+	checkpoint.save(path);
+
+	SearchCheckpoint<2, 2, uint32_t> const loaded(weightTable, path);
+	CHECK_EQUAL(6, loaded.taskCount());
+	CHECK_EQUAL(2, loaded.completedCount());
+	CHECK(loaded.isCompleted(1));
+	CHECK(loaded.isCompleted(5));
+	CHECK_EQUAL(checkpoint.getWeightTableHash(), loaded.getWeightTableHash());
+	auto const remaining = loaded.remainingTasks();
+	CHECK_EQUAL(4, remaining.size());
+	CHECK_EQUAL(4, remaining.front().first);
+	CHECK_EQUAL(4, remaining.back().second.getMinKeyWeight());
+	remove(path.c_str());
+}
+
+TEST(SearchCheckpoint_load_differentWeightTable) {
+	std::string const path = "SearchCheckpoint_load_differentWeightTable.checkpoint";
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> allocation(SearchSpec<4>(0, 15), weightTable, 0);
+	SearchCheckpoint<2, 2, uint32_t> const checkpoint(weightTable, allocation.getAllocatedTasks());
+	checkpoint.save(path);
+
+	std::vector<uint32_t> const otherWeights = {0, 1, 3, 0, 0, 2, 3, 1};
+	WeightTable<2, 2, uint32_t> const otherWeightTable(otherWeights);
+	CHECK((checkpoint.getWeightTableHash() != SearchCheckpoint<2, 2, uint32_t>::hashWeightTable(otherWeightTable)));
+	CHECK_THROW((SearchCheckpoint<2, 2, uint32_t>(otherWeightTable, path)), std::invalid_argument);
+	remove(path.c_str());
+}
+
+TEST(SearchCheckpoint_load_malformed) {
+	std::string const path = "SearchCheckpoint_load_malformed.checkpoint";
+	{
+		std::ofstream output(path.c_str());
+		output << "labynkyr-checkpoint 1\ntasks 3\n";
+	}
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	CHECK_THROW((SearchCheckpoint<2, 2, uint32_t>(weightTable, path)), std::runtime_error);
+	remove(path.c_str());
+	CHECK_THROW((SearchCheckpoint<2, 2, uint32_t>(weightTable, path)), std::runtime_error);
+}
+
+TEST(SearchCheckpoint_extendBudget) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> allocation(SearchSpec<4>(0, 8), weightTable, 0);
+
+	SearchCheckpoint<2, 2, uint32_t> checkpoint(weightTable, allocation.getAllocatedTasks());
+	CHECK_EQUAL(3, checkpoint.taskCount());
+	checkpoint.markCompleted(SearchTask<2, 2, uint32_t>(0, 1, weightTable));
+	checkpoint.markCompleted(SearchTask<2, 2, uint32_t>(1, 2, weightTable));
+	checkpoint.markCompleted(SearchTask<2, 2, uint32_t>(2, 3, weightTable));
+
+	CHECK_EQUAL(3, checkpoint.extendBudget(SearchSpec<4>(0, 15), 0));
+	CHECK_EQUAL(6, checkpoint.taskCount());
+	CHECK_EQUAL(3, checkpoint.completedCount());
+	auto const remaining = checkpoint.remainingTasks();
+	std::vector<BigInt<4>> const expectedBatchSizes = {5, 1, 1};
+	std::vector<uint32_t> const expectedMinWeights = {3, 4, 5};
+	std::vector<BigInt<4>> batchSizes;
+	std::vector<uint32_t> minWeights;
+	for(auto const & task : remaining) {
+		batchSizes.push_back(task.first);
+		minWeights.push_back(task.second.getMinKeyWeight());
+	}
+	CHECK_EQUAL(expectedBatchSizes.size(), remaining.size());
+	CHECK_ARRAY_EQUAL(expectedBatchSizes, batchSizes, expectedBatchSizes.size());
+	CHECK_ARRAY_EQUAL(expectedMinWeights, minWeights, expectedMinWeights.size());
+
+	// Extending to a budget already covered adds nothing
+	CHECK_EQUAL(0, checkpoint.extendBudget(SearchSpec<4>(0, 8), 0));
+}
+
+TEST(SearchCheckpoint_extendBudget_trimsStraddlingTask) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> allocation(SearchSpec<4>(0, 4), weightTable, 0);
+
+	SearchCheckpoint<2, 2, uint32_t> checkpoint(weightTable, allocation.getAllocatedTasks());
+	CHECK_EQUAL(1, checkpoint.taskCount());
+	CHECK_EQUAL(1, checkpoint.maximumPlannedWeight());
+
+	// The first generated task covers weights [0, 3), and is trimmed to [1, 3)
+	CHECK_EQUAL(2, checkpoint.extendBudget(SearchSpec<4>(0, 15), 3));
+	auto const remaining = checkpoint.remainingTasks();
+	std::vector<BigInt<4>> const expectedBatchSizes = {4, 4, 7};
+	std::vector<uint32_t> const expectedMinWeights = {0, 1, 3};
+	std::vector<uint32_t> const expectedMaxWeights = {1, 3, 6};
+	std::vector<BigInt<4>> batchSizes;
+	std::vector<uint32_t> minWeights;
+	std::vector<uint32_t> maxWeights;
+	for(auto const & task : remaining) {
+		batchSizes.push_back(task.first);
+		minWeights.push_back(task.second.getMinKeyWeight());
+		maxWeights.push_back(task.second.getMaxKeyWeight());
+	}
+	CHECK_EQUAL(expectedBatchSizes.size(), remaining.size());
+	CHECK_ARRAY_EQUAL(expectedBatchSizes, batchSizes, expectedBatchSizes.size());
+	CHECK_ARRAY_EQUAL(expectedMinWeights, minWeights, expectedMinWeights.size());
+	CHECK_ARRAY_EQUAL(expectedMaxWeights, maxWeights, expectedMaxWeights.size());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -0,0 +1,148 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SearchTaskStreamTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/SearchTaskStream.hpp"
+
+#include "src/labynkyr/search/AdaptiveTaskSizer.hpp"
+#include "src/labynkyr/search/EffortAllocation.hpp"
+#include "src/labynkyr/search/SearchSpec.hpp"
+#include "src/labynkyr/BigInt.hpp"
+#include "src/labynkyr/WeightTable.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+void checkStreamMatchesAllocation(SearchTaskStream<2, 2, uint32_t> & stream, EffortAllocation<2, 2, uint32_t> & allocation) {
+	while(allocation.isTasksAvailable()) {
+		CHECK(stream.isTasksAvailable());
+		auto const expected = allocation.removeNextTask();
+		auto const actual = stream.removeNextTask();
+		CHECK_EQUAL(expected.first, actual.first);
+		CHECK_EQUAL(expected.second.getMinKeyWeight(), actual.second.getMinKeyWeight());
+		CHECK_EQUAL(expected.second.getMaxKeyWeight(), actual.second.getMaxKeyWeight());
+	}
+	CHECK(!stream.isTasksAvailable());
+	CHECK_THROW(stream.removeNextTask(), std::logic_error);
+}
+
+}
+
+TEST(SearchTaskStream_matchesEffortAllocation) {
+	SearchSpec<4> const searchSpec(0, 15);
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+
+	SearchTaskStream<2, 2, uint32_t> stream(searchSpec, weightTable, 0);
+	EffortAllocation<2, 2, uint32_t> allocation(searchSpec, weightTable, 0);
+	CHECK_EQUAL(6, allocation.tasksRemaining());
+	checkStreamMatchesAllocation(stream, allocation);
+}
+
+TEST(SearchTaskStream_differentFirstJobSize_matchesEffortAllocation) {
+	SearchSpec<4> const searchSpec(0, 15);
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+
+	SearchTaskStream<2, 2, uint32_t> stream(searchSpec, weightTable, 3, 1);
+	EffortAllocation<2, 2, uint32_t> allocation(searchSpec, weightTable, 3, 1);
+	checkStreamMatchesAllocation(stream, allocation);
+}
+
+TEST(SearchTaskStream_offset_matchesEffortAllocation) {
+	SearchSpec<4> const searchSpec(5, 10);
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+
+	SearchTaskStream<2, 2, uint32_t> stream(searchSpec, weightTable, 0);
+	EffortAllocation<2, 2, uint32_t> allocation(searchSpec, weightTable, 0);
+	// The task straddling the offset is retained
+	CHECK_EQUAL(1, allocation.getAllocatedTasks().front().second.getMinKeyWeight());
+	checkStreamMatchesAllocation(stream, allocation);
+}
+
+TEST(SearchTaskStream_adaptiveTaskSize) {
+	SearchSpec<4> const searchSpec(0, 15);
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	AdaptiveTaskSizer<4> sizer(std::chrono::milliseconds(10), 0.0, 0.0, 4.0);
+
+	SearchTaskStream<2, 2, uint32_t> stream(searchSpec, weightTable, 0, sizer);
+	CHECK_EQUAL(&sizer, stream.getTaskSizer());
+	auto const first = stream.removeNextTask();
+	CHECK_EQUAL(4, first.first);
+	// Taking 5ms for 4 keys suggests 8 keys for 10ms
+	sizer.recordTask(first.first, std::chrono::milliseconds(5));
+	CHECK_CLOSE(3.0, sizer.preferredJobSizeBits(), 1e-6);
+	auto const second = stream.removeNextTask();
+	CHECK_EQUAL(1, second.second.getMinKeyWeight());
+	CHECK_EQUAL(4, second.second.getMaxKeyWeight());
+	CHECK_EQUAL(9, second.first);
+}
+
+TEST(SearchTaskStream_maximumTaskWeight_boundsEveryTask) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	SearchTaskStream<2, 2, uint32_t> stream(SearchSpec<4>(0, 5), weightTable, 0);
+	// Only the weights needed for the budget are ranked, rather than every weight up to 6
+	CHECK_EQUAL(2, stream.maximumTaskWeight());
+	while(stream.isTasksAvailable()) {
+		CHECK(stream.removeNextTask().second.getMaxKeyWeight() <= stream.maximumTaskWeight());
+	}
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
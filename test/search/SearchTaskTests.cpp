@@ -0,0 +1,96 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SearchTaskTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/SearchTask.hpp"
+
+#include "src/labynkyr/WeightTable.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(SearchTask_defaultFirstSubkeyRange) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	SearchTask<2, 2, uint32_t> const task(0, 6, weightTable);
+	CHECK_EQUAL(0, task.getFirstSubkeyBegin());
+	CHECK_EQUAL(4, task.getFirstSubkeyEnd());
+	CHECK(task.isSplittable());
+	CHECK(task.isFirstSubkeyIncluded(3));
+}
+
+TEST(SearchTask_invalidFirstSubkeyRange) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	CHECK_THROW((SearchTask<2, 2, uint32_t>(0, 6, weightTable, 2, 2)), std::invalid_argument);
+	CHECK_THROW((SearchTask<2, 2, uint32_t>(0, 6, weightTable, 0, 5)), std::invalid_argument);
+}
+
+TEST(SearchTask_splitByFirstSubkey) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	SearchTask<2, 2, uint32_t> const task(1, 6, weightTable, 1, 4);
+	auto const halves = task.splitByFirstSubkey();
+	CHECK_EQUAL(1, halves.first.getMinKeyWeight());
+	CHECK_EQUAL(6, halves.first.getMaxKeyWeight());
+	CHECK_EQUAL(1, halves.first.getFirstSubkeyBegin());
+	CHECK_EQUAL(2, halves.first.getFirstSubkeyEnd());
+	CHECK_EQUAL(2, halves.second.getFirstSubkeyBegin());
+	CHECK_EQUAL(4, halves.second.getFirstSubkeyEnd());
+	CHECK(!halves.first.isSplittable());
+	CHECK(!halves.first.isFirstSubkeyIncluded(2));
+	CHECK_THROW(halves.first.splitByFirstSubkey(), std::logic_error);
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
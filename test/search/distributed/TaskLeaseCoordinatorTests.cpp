@@ -0,0 +1,234 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * TaskLeaseCoordinatorTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/distributed/TaskLeaseCoordinator.hpp"
+
+#include "src/labynkyr/search/distributed/LocalSocket.hpp"
+#include "src/labynkyr/search/distributed/TaskLeaseMessage.hpp"
+#include "src/labynkyr/search/distributed/TaskLeaseWorker.hpp"
+#include "src/labynkyr/search/parallel/PEUPool.hpp"
+#include "src/labynkyr/search/verify/ComparisonKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+#include "src/labynkyr/search/EffortAllocation.hpp"
+#include "src/labynkyr/search/SearchSpec.hpp"
+#include "src/labynkyr/WeightTable.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#ifdef __linux__
+	#include <sys/types.h>
+	#include <sys/wait.h>
+	#include <unistd.h>
+#endif
+
+#include <stdint.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+#ifdef __linux__
+
+namespace {
+
+std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+
+void runWorker(std::string const & path, KeyVerifierFactory<4> & verifierFactory) {
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	PEUPool<2, 2, uint32_t, uint32_t> pool(1, verifierFactory, 1, 10000000UL);
+	TaskLeaseWorker<2, 2, uint32_t, uint32_t> worker(path, weightTable, pool, 10000000UL, std::chrono::milliseconds(5));
+	worker.run();
+}
+
+/**
+ *
+ * Fork a worker process, which exits with status 0 if it ran successfully
+ */
+pid_t forkWorker(std::string const & path, std::vector<uint8_t> const & targetKey) {
+	pid_t const pid = ::fork();
+	if(pid == 0) {
+		int status = 0;
+		try {
+			if(targetKey.empty()) {
+				ListKeyVerifierFactory<4> verifierFactory;
+				runWorker(path, verifierFactory);
+			} else {
+				ComparisonKeyVerifierFactory<4> verifierFactory(targetKey);
+				runWorker(path, verifierFactory);
+			}
+		} catch(...) {
+			status = 1;
+		}
+		::_exit(status);
+	}
+	return pid;
+}
+
+bool waitForWorker(pid_t pid) {
+	int status = 0;
+	::waitpid(pid, &status, 0);
+	return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+}
+
+TEST(TaskLeaseCoordinator_workerProcesses_verifyEveryKey) {
+	std::string const path = "TaskLeaseCoordinator_verifyEveryKey.socket";
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> effort(SearchSpec<4>(0, 15), weightTable, 0);
+	TaskLeaseCoordinator<2, 2, uint32_t> coordinator(path, effort, std::chrono::seconds(30));
+	CHECK_EQUAL(6, coordinator.getTaskCount());
+
+	std::vector<pid_t> workers;
+	for(uint32_t index = 0 ; index < 3 ; index++) {
+		workers.push_back(forkWorker(path, std::vector<uint8_t>()));
+	}
+	coordinator.run();
+	for(auto const pid : workers) {
+		CHECK(waitForWorker(pid));
+	}
+	CHECK(!coordinator.isKeyFound());
+	CHECK_EQUAL(6, coordinator.getTasksCompleted());
+	CHECK_EQUAL(15, coordinator.keysVerified());
+	CHECK_EQUAL(0, coordinator.getLeasesExpired());
+	CHECK_THROW(coordinator.correctKey(), std::logic_error);
+}
+
+TEST(TaskLeaseCoordinator_workerProcesses_findKey) {
+	std::string const path = "TaskLeaseCoordinator_findKey.socket";
+	std::vector<uint8_t> const targetKey = {0x06};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> effort(SearchSpec<4>(0, 15), weightTable, 0);
+	TaskLeaseCoordinator<2, 2, uint32_t> coordinator(path, effort, std::chrono::seconds(30));
+
+	std::vector<pid_t> workers;
+	for(uint32_t index = 0 ; index < 3 ; index++) {
+		workers.push_back(forkWorker(path, targetKey));
+	}
+	coordinator.run();
+	for(auto const pid : workers) {
+		CHECK(waitForWorker(pid));
+	}
+	CHECK(coordinator.isKeyFound());
+	CHECK_ARRAY_EQUAL(targetKey, coordinator.correctKey().asBytes(), targetKey.size());
+}
+
+TEST(TaskLeaseCoordinator_expiredLease_isLeasedAgain) {
+	std::string const path = "TaskLeaseCoordinator_expiredLease.socket";
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> effort(SearchSpec<4>(0, 15), weightTable, 0);
+	TaskLeaseCoordinator<2, 2, uint32_t> coordinator(path, effort, std::chrono::milliseconds(50));
+	std::thread coordinatorThread(&TaskLeaseCoordinator<2, 2, uint32_t>::run, &coordinator);
+
+	// A worker that takes the first lease and never reports back
+	auto stalled = LocalSocket::connect(path);
+	stalled->sendLine(TaskLeaseMessage<4>::hello(SearchCheckpoint<2, 2, uint32_t>::hashWeightTable(weightTable)).format());
+	stalled->sendLine(TaskLeaseMessage<4>(RequestMessage).format());
+	std::string line;
+	CHECK(stalled->readLine(line));
+	CHECK_EQUAL(LeaseMessage, TaskLeaseMessage<4>::parse(line).type);
+
+	ListKeyVerifierFactory<4> verifierFactory;
+	runWorker(path, verifierFactory);
+	coordinatorThread.join();
+	CHECK_EQUAL(6, coordinator.getTasksCompleted());
+	CHECK(coordinator.getLeasesExpired() >= 1);
+	CHECK_EQUAL(15, coordinator.keysVerified());
+	// The stalled worker is stopped as well
+	CHECK(stalled->readLine(line));
+	CHECK_EQUAL(StopMessage, TaskLeaseMessage<4>::parse(line).type);
+}
+
+TEST(TaskLeaseCoordinator_differentWeightTable_rejected) {
+	std::string const path = "TaskLeaseCoordinator_rejected.socket";
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> effort(SearchSpec<4>(0, 15), weightTable, 0);
+	TaskLeaseCoordinator<2, 2, uint32_t> coordinator(path, effort, std::chrono::seconds(30));
+	std::thread coordinatorThread(&TaskLeaseCoordinator<2, 2, uint32_t>::run, &coordinator);
+
+	std::vector<uint32_t> const otherWeights = {0, 1, 3, 0, 0, 2, 3, 1};
+	WeightTable<2, 2, uint32_t> const otherWeightTable(otherWeights);
+	ListKeyVerifierFactory<4> verifierFactory;
+	PEUPool<2, 2, uint32_t, uint32_t> pool(1, verifierFactory, 1, 10000000UL);
+	TaskLeaseWorker<2, 2, uint32_t, uint32_t> rejected(path, otherWeightTable, pool, 10000000UL, std::chrono::milliseconds(5));
+	CHECK_THROW(rejected.run(), std::invalid_argument);
+	CHECK_EQUAL(0, rejected.getTasksCompleted());
+
+	runWorker(path, verifierFactory);
+	coordinatorThread.join();
+	CHECK_EQUAL(6, coordinator.getTasksCompleted());
+}
+
+TEST(TaskLeaseCoordinator_requestWithoutHello_rejected) {
+	std::string const path = "TaskLeaseCoordinator_noHello.socket";
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> effort(SearchSpec<4>(0, 15), weightTable, 0);
+	TaskLeaseCoordinator<2, 2, uint32_t> coordinator(path, effort, std::chrono::seconds(30));
+	std::thread coordinatorThread(&TaskLeaseCoordinator<2, 2, uint32_t>::run, &coordinator);
+
+	auto unvalidated = LocalSocket::connect(path);
+	unvalidated->sendLine(TaskLeaseMessage<4>(RequestMessage).format());
+	std::string line;
+	CHECK(unvalidated->readLine(line));
+	CHECK_EQUAL(RejectMessage, TaskLeaseMessage<4>::parse(line).type);
+
+	ListKeyVerifierFactory<4> verifierFactory;
+	runWorker(path, verifierFactory);
+	coordinatorThread.join();
+	CHECK_EQUAL(6, coordinator.getTasksCompleted());
+	CHECK_EQUAL(0, coordinator.getLeasesExpired());
+}
+
+#endif
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -0,0 +1,113 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * TaskLeaseMessageTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/distributed/TaskLeaseMessage.hpp"
+
+#include "src/labynkyr/BigInt.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(TaskLeaseMessage_hello_roundTrip) {
+	auto const message = TaskLeaseMessage<128>::hello(14695981039346656037ULL);
+	CHECK_EQUAL("hello 14695981039346656037", message.format());
+	auto const parsed = TaskLeaseMessage<128>::parse(message.format());
+	CHECK_EQUAL(HelloMessage, parsed.type);
+	CHECK_EQUAL(14695981039346656037ULL, parsed.weightTableHash);
+}
+
+TEST(TaskLeaseMessage_lease_roundTrip) {
+	BigInt<128> keyCount(1);
+	keyCount = keyCount << 100;
+	auto const message = TaskLeaseMessage<128>::lease(7, 300, 412, keyCount);
+	auto const parsed = TaskLeaseMessage<128>::parse(message.format());
+	CHECK_EQUAL(LeaseMessage, parsed.type);
+	CHECK_EQUAL(7, parsed.leaseId);
+	CHECK_EQUAL(300, parsed.minKeyWeight);
+	CHECK_EQUAL(412, parsed.maxKeyWeight);
+	CHECK_EQUAL(keyCount, parsed.keyCount);
+}
+
+TEST(TaskLeaseMessage_done_roundTrip) {
+	std::vector<uint8_t> const key = {0x00, 0x0A, 0xFF};
+	auto const message = TaskLeaseMessage<24>::done(3, 1000, true, key);
+	CHECK_EQUAL("done 3 1000 1 000aff", message.format());
+	auto const parsed = TaskLeaseMessage<24>::parse(message.format());
+	CHECK_EQUAL(DoneMessage, parsed.type);
+	CHECK_EQUAL(3, parsed.leaseId);
+	CHECK_EQUAL(1000, parsed.keysChecked);
+	CHECK(parsed.keyFound);
+	CHECK_EQUAL(key.size(), parsed.key.size());
+	CHECK_ARRAY_EQUAL(key, parsed.key, key.size());
+
+	auto const notFound = TaskLeaseMessage<24>::parse(TaskLeaseMessage<24>::done(4, 10, false, std::vector<uint8_t>()).format());
+	CHECK(!notFound.keyFound);
+	CHECK_EQUAL(0, notFound.key.size());
+}
+
+TEST(TaskLeaseMessage_simpleMessages_roundTrip) {
+	CHECK_EQUAL(RequestMessage, TaskLeaseMessage<128>::parse("request").type);
+	CHECK_EQUAL(WaitMessage, TaskLeaseMessage<128>::parse(TaskLeaseMessage<128>(WaitMessage).format()).type);
+	CHECK_EQUAL(StopMessage, TaskLeaseMessage<128>::parse(TaskLeaseMessage<128>(StopMessage).format()).type);
+	CHECK_EQUAL(RejectMessage, TaskLeaseMessage<128>::parse(TaskLeaseMessage<128>(RejectMessage).format()).type);
+}
+
+TEST(TaskLeaseMessage_malformed) {
+	CHECK_THROW(TaskLeaseMessage<128>::parse("unknown"), std::runtime_error);
+	CHECK_THROW(TaskLeaseMessage<128>::parse("lease 1 2"), std::runtime_error);
+	CHECK_THROW(TaskLeaseMessage<128>::parse("hello"), std::runtime_error);
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -0,0 +1,144 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * ANFMemoryEstimatorTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/enumerate/ANFMemoryEstimator.hpp"
+
+#include "src/labynkyr/search/enumerate/ActiveNodeFinder.hpp"
+#include "src/labynkyr/search/enumerate/Arena.hpp"
+#include "src/labynkyr/search/enumerate/CandidateKeyForest.hpp"
+#include "src/labynkyr/search/enumerate/FlatCandidateKeyForest.hpp"
+#include "src/labynkyr/search/enumerate/FlatCandidateKeyStore.hpp"
+#include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+#include "src/labynkyr/search/PathCountSearch.hpp"
+#include "src/labynkyr/search/SearchTask.hpp"
+
+#include "src/labynkyr/WeightTable.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+/**
+ *
+ * Weights spread over several bitset words, with repeated weights within each vector
+ */
+WeightTable<4, 4, uint32_t> spreadWeightTable() {
+	std::vector<uint32_t> weights;
+	for(uint32_t index = 0 ; index < 64 ; index++) {
+		weights.push_back((index * 37 + 11) % 97);
+	}
+	return WeightTable<4, 4, uint32_t>(weights);
+}
+
+std::vector<std::pair<uint32_t, uint32_t>> weightBands() {
+	return {{0, 1}, {0, 60}, {0, 130}, {100, 200}, {150, 151}, {64, 129}, {0, 389}};
+}
+
+}
+
+TEST(ANFMemoryEstimator_treeCount_matchesFlatForest) {
+	WeightTable<4, 4, uint32_t> const weightTable = spreadWeightTable();
+	ActiveNodeFinder<4, 4, uint32_t> const activeNodeFinder(weightTable, 389);
+	for(auto const & band : weightBands()) {
+		SearchTask<4, 4, uint32_t> const task(band.first, band.second, weightTable);
+		ANFMemoryEstimator<4, 4, uint32_t, uint8_t> const estimator(task, activeNodeFinder);
+
+		ListKeyVerifier<16> verifier;
+		PathCountSearch<4, 4, uint32_t, uint8_t> search(verifier);
+		FlatCandidateKeyStore<4, 4, uint8_t> store;
+		search.searchWithANFFlatForest(task, activeNodeFinder, store);
+
+		CHECK_EQUAL(0, estimator.treeCount(0));
+		uint64_t nodes = 0;
+		for(uint32_t vectorIndex = 0 ; vectorIndex < 4 ; vectorIndex++) {
+			CHECK_EQUAL(store.nodeCount(vectorIndex), estimator.treeCount(vectorIndex));
+			nodes += store.nodeCount(vectorIndex);
+		}
+		CHECK_EQUAL(nodes, estimator.treeCount());
+		uint64_t const graphBytes = 2 * band.second * sizeof(FlatCandidateKeyForest<4, 4, uint8_t>);
+		CHECK_EQUAL(store.bytesUsed() + graphBytes, estimator.flatForestBytes());
+	}
+}
+
+TEST(ANFMemoryEstimator_linkedForestBytes_boundsArena) {
+	WeightTable<4, 4, uint32_t> const weightTable = spreadWeightTable();
+	ActiveNodeFinder<4, 4, uint32_t> const activeNodeFinder(weightTable, 389);
+	for(auto const & band : weightBands()) {
+		SearchTask<4, 4, uint32_t> const task(band.first, band.second, weightTable);
+		ANFMemoryEstimator<4, 4, uint32_t, uint8_t> const estimator(task, activeNodeFinder);
+
+		ListKeyVerifier<16> verifier;
+		PathCountSearch<4, 4, uint32_t, uint8_t> search(verifier);
+		Arena arena;
+		search.searchWithANFForest(task, activeNodeFinder, arena);
+
+		uint64_t const graphBytes = 2 * band.second * sizeof(CandidateKeyForest<4, 4, uint8_t>);
+		CHECK(arena.bytesUsed() + graphBytes <= estimator.linkedForestBytes());
+		CHECK(estimator.forestCount() <= estimator.treeCount());
+	}
+}
+
+TEST(ANFMemoryEstimator_emptyTask) {
+	WeightTable<4, 4, uint32_t> const weightTable = spreadWeightTable();
+	ActiveNodeFinder<4, 4, uint32_t> const activeNodeFinder(weightTable, 389);
+	// No key has weight 0
+	SearchTask<4, 4, uint32_t> const task(0, 1, weightTable);
+	ANFMemoryEstimator<4, 4, uint32_t, uint8_t> const estimator(task, activeNodeFinder);
+	CHECK_EQUAL(0, estimator.treeCount());
+	CHECK_EQUAL(0, estimator.forestCount());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
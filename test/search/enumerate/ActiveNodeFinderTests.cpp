@@ -107,5 +107,61 @@ TEST(ActiveNodeFinder_zeroWeightActive_threeCol) {
 	CHECK_EQUAL(1, set3.count(0));
 }
 
+namespace {
+
+/**
+ *
+ * The set of active weights, found by visiting every (weight, subkey) pair
+ */
+template<uint32_t VecCount, uint32_t VecLenBits>
+std::vector<std::set<uint64_t>> referenceActiveWeights(WeightTable<VecCount, VecLenBits, uint32_t> const & weightTable, uint64_t maxWeight) {
+	std::vector<std::set<uint64_t>> levels(1, std::set<uint64_t>({0}));
+	for(uint32_t vectorIndex = 1 ; vectorIndex < VecCount ; vectorIndex++) {
+		std::set<uint64_t> level;
+		for(auto const column : levels.back()) {
+			for(uint32_t subkey = 0 ; subkey < (1U << VecLenBits) ; subkey++) {
+				uint64_t const weight = column + weightTable.weight(vectorIndex - 1, subkey);
+				if(weight < maxWeight) {
+					level.insert(weight);
+				}
+			}
+		}
+		levels.push_back(level);
+	}
+	return levels;
+}
+
+template<uint32_t VecCount, uint32_t VecLenBits>
+void checkMatchesReference(ActiveNodeFinder<VecCount, VecLenBits, uint32_t> const & finder, std::vector<std::set<uint64_t>> const & expected) {
+	for(uint32_t vectorIndex = 0 ; vectorIndex < VecCount ; vectorIndex++) {
+		auto const & actual = finder.nextWeightIndexes(vectorIndex);
+		std::vector<uint64_t> const expectedWeights(expected[vectorIndex].begin(), expected[vectorIndex].end());
+		std::vector<uint64_t> const actualWeights(actual.begin(), actual.end());
+		CHECK_EQUAL(expectedWeights.size(), actualWeights.size());
+		CHECK(expectedWeights == actualWeights);
+	}
+}
+
+}
+
+TEST(ActiveNodeFinder_matchesReference_acrossWordBoundaries) {
+	std::vector<uint32_t> const weights = {0, 1, 63, 64, 0, 65, 127, 200, 2, 3, 130, 0, 5, 64, 128, 300};
+	WeightTable<4, 2, uint32_t> const weightTable(weights);
+	for(uint32_t maxWeight : {0U, 1U, 64U, 65U, 128U, 191U, 500U, 1000U}) {
+		ActiveNodeFinder<4, 2, uint32_t> const finder(weightTable, maxWeight);
+		checkMatchesReference(finder, referenceActiveWeights(weightTable, maxWeight));
+	}
+}
+
+TEST(ActiveNodeFinder_multipleThreads_matchesReference) {
+	// Large enough for each level to be split between threads
+	std::vector<uint32_t> const weights = {0, 70001, 300000, 123457, 0, 64, 250003, 99999, 3, 0, 1, 500000};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	uint32_t const maxWeight = 700000;
+	ActiveNodeFinder<3, 2, uint32_t> const finder(weightTable, maxWeight, 4);
+	checkMatchesReference(finder, referenceActiveWeights(weightTable, maxWeight));
+	CHECK(finder.bytesUsed() > 0);
+}
+
 } /* namespace search */
 } /* namespace labynkyr */
@@ -0,0 +1,132 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * ArenaTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/enumerate/Arena.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+namespace labynkyr {
+namespace search {
+
+TEST(Arena_empty) {
+	Arena const arena;
+	CHECK_EQUAL(0, arena.bytesUsed());
+	CHECK_EQUAL(0, arena.bytesReserved());
+	CHECK_EQUAL(0, arena.blockCount());
+}
+
+TEST(Arena_allocate_alignment) {
+	Arena arena(256, false);
+	arena.allocate(1, 1);
+	void * const ptr = arena.allocate(8, 8);
+	CHECK_EQUAL(0, reinterpret_cast<uintptr_t>(ptr) % 8);
+	CHECK(arena.bytesUsed() >= 9);
+	CHECK_EQUAL(1, arena.blockCount());
+	CHECK_EQUAL(256, arena.bytesReserved());
+}
+
+TEST(Arena_allocate_newBlock) {
+	Arena arena(64, false);
+	arena.allocate(48, 8);
+	arena.allocate(48, 8);
+	CHECK_EQUAL(2, arena.blockCount());
+	// Allocations larger than the block size get a dedicated block
+	arena.allocate(1000, 8);
+	CHECK_EQUAL(3, arena.blockCount());
+	CHECK(arena.bytesReserved() >= 1128);
+}
+
+TEST(Arena_extend) {
+	Arena arena(256, false);
+	uint32_t * const first = arena.allocateArray<uint32_t>(4);
+	CHECK(arena.extend(first, 16, 32));
+	CHECK_EQUAL(32, arena.bytesUsed());
+	uint32_t * const second = arena.allocateArray<uint32_t>(4);
+	CHECK(second == first + 8);
+	// Only the most recent allocation can be extended
+	CHECK(!arena.extend(first, 32, 48));
+	// Cannot extend beyond the end of the block
+	CHECK(!arena.extend(second, 16, 512));
+	CHECK(arena.extend(second, 16, 32));
+}
+
+TEST(Arena_reset) {
+	Arena arena(64, false);
+	void * const first = arena.allocate(48, 8);
+	arena.allocate(48, 8);
+	CHECK_EQUAL(2, arena.blockCount());
+	arena.reset();
+	CHECK_EQUAL(0, arena.bytesUsed());
+	CHECK_EQUAL(1, arena.blockCount());
+	CHECK_EQUAL(64, arena.bytesReserved());
+	// The first block is re-used
+	CHECK(first == arena.allocate(48, 8));
+}
+
+TEST(Arena_release) {
+	Arena arena(64, false);
+	arena.allocate(48, 8);
+	arena.release();
+	CHECK_EQUAL(0, arena.bytesUsed());
+	CHECK_EQUAL(0, arena.bytesReserved());
+	CHECK_EQUAL(0, arena.blockCount());
+}
+
+TEST(Arena_hugePages) {
+	Arena arena(64, true);
+	arena.allocate(48, 8);
+	CHECK_EQUAL(1, arena.blockCount());
+#ifdef __linux__
+	// Blocks are rounded up to a whole number of huge pages
+	CHECK_EQUAL(Arena::HugePageSizeBytes, arena.bytesReserved());
+#endif
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
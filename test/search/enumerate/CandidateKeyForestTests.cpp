@@ -47,6 +47,7 @@
 
 #include "src/labynkyr/search/enumerate/CandidateKeyForest.hpp"
 
+#include "src/labynkyr/search/enumerate/Arena.hpp"
 #include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
 
 #include <unittest++/UnitTest++.h>
@@ -64,7 +65,7 @@ TEST(CandidateKeyForest_empty) {
 
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> const forest(0);
 	CHECK_EQUAL(0, forest.size());
-	CHECK_EQUAL(0, std::distance(forest.getForest()->begin(), forest.getForest()->end()));
+	CHECK_EQUAL(0, std::distance(forest.begin(), forest.end()));
 }
 
 TEST(CandidateKeyForest_sizeOne) {
@@ -73,42 +74,45 @@ TEST(CandidateKeyForest_sizeOne) {
 
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> const forest(1);
 	CHECK_EQUAL(1, forest.size());
-	CHECK_EQUAL(0, std::distance(forest.getForest()->begin(), forest.getForest()->end()));
+	CHECK_EQUAL(0, std::distance(forest.begin(), forest.end()));
 }
 
 TEST(CandidateKeyForest_merge_empty_one) {
 	uint32_t const vectorSizeBits = 8;
 	uint32_t const vectorCount = 3;
+	Arena arena;
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest1(0);
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest2(1);
-	forest1.merge(forest2, 2);
+	forest1.merge(forest2, 2, arena);
 	// Should now have a single key
 	CHECK_EQUAL(1, forest1.size());
-	CHECK_EQUAL(1, std::distance(forest1.getForest()->begin(), forest1.getForest()->end()));
+	CHECK_EQUAL(1, std::distance(forest1.begin(), forest1.end()));
 }
 
 TEST(CandidateKeyForest_merge_one_one) {
 	uint32_t const vectorSizeBits = 8;
 	uint32_t const vectorCount = 3;
+	Arena arena;
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest1(1);
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest2(1);
-	forest1.merge(forest2, 3);
+	forest1.merge(forest2, 3, arena);
 	CHECK_EQUAL(2, forest1.size());
-	CHECK_EQUAL(1, std::distance(forest1.getForest()->begin(), forest1.getForest()->end()));
+	CHECK_EQUAL(1, std::distance(forest1.begin(), forest1.end()));
 }
 
 TEST(CandidateKeyForest_merge_verifyCandidates) {
 	uint32_t const vectorSizeBits = 8;
 	uint32_t const vectorCount = 3;
+	Arena arena;
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest1(1);
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest2(0);
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest3(0);
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest4(0);
 
 	ListKeyVerifier<24> verifier;
-	forest2.merge(forest1, 3);
-	forest3.merge(forest2, 5);
-	forest4.merge(forest3, 4);
+	forest2.merge(forest1, 3, arena);
+	forest3.merge(forest2, 5, arena);
+	forest4.merge(forest3, 4, arena);
 
 	forest4.verifyKeys(verifier);
 
@@ -121,16 +125,17 @@ TEST(CandidateKeyForest_merge_verifyCandidates) {
 TEST(CandidateKeyForest_merge_verifyCandidates_2) {
 	uint32_t const vectorSizeBits = 8;
 	uint32_t const vectorCount = 3;
+	Arena arena;
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest1(1);
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest2(0);
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest3(0);
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest4(0);
 
 	ListKeyVerifier<24> verifier;
-	forest2.merge(forest1, 3);
-	forest3.merge(forest2, 5);
-	forest4.merge(forest3, 4);
-	forest4.merge(forest3, 7);
+	forest2.merge(forest1, 3, arena);
+	forest3.merge(forest2, 5, arena);
+	forest4.merge(forest3, 4, arena);
+	forest4.merge(forest3, 7, arena);
 
 	forest4.verifyKeys(verifier);
 
@@ -145,14 +150,15 @@ TEST(CandidateKeyForest_merge_verifyCandidates_2) {
 TEST(CandidateKeyForest_merge_verifyMergeCandidates) {
 	uint32_t const vectorSizeBits = 8;
 	uint32_t const vectorCount = 3;
+	Arena arena;
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest1(1);
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest2(0);
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest3(0);
 	CandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest4(0);
 
 	ListKeyVerifier<24> verifier;
-	forest2.merge(forest1, 3);
-	forest3.merge(forest2, 5);
+	forest2.merge(forest1, 3, arena);
+	forest3.merge(forest2, 5, arena);
 	forest4.verifyMergeCandidates(verifier, forest3, 4);
 
 	// Only 1 key should be verified
@@ -162,7 +168,7 @@ TEST(CandidateKeyForest_merge_verifyMergeCandidates) {
 
 	// Forest 4 should not be modified
 	CHECK_EQUAL(0, forest4.size());
-	CHECK_EQUAL(0, std::distance(forest4.getForest()->begin(), forest4.getForest()->end()));
+	CHECK_EQUAL(0, std::distance(forest4.begin(), forest4.end()));
 }
 
 } /* namespace search */
@@ -0,0 +1,215 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * FlatCandidateKeyForestTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/enumerate/FlatCandidateKeyForest.hpp"
+
+#include "src/labynkyr/search/enumerate/FlatCandidateKeyStore.hpp"
+#include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(FlatCandidateKeyForest_empty) {
+	uint32_t const vectorSizeBits = 8;
+	uint32_t const vectorCount = 3;
+
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> const forest(0);
+	CHECK_EQUAL(0, forest.size());
+	CHECK_EQUAL(0, forest.getNodeCount());
+}
+
+TEST(FlatCandidateKeyForest_sizeOne) {
+	uint32_t const vectorSizeBits = 8;
+	uint32_t const vectorCount = 3;
+
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> const forest(1);
+	CHECK_EQUAL(1, forest.size());
+	CHECK_EQUAL(0, forest.getNodeCount());
+}
+
+TEST(FlatCandidateKeyForest_merge_empty_one) {
+	uint32_t const vectorSizeBits = 8;
+	uint32_t const vectorCount = 3;
+	FlatCandidateKeyStore<vectorCount, vectorSizeBits, uint8_t> store;
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest1(0);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest2(1);
+	forest1.merge(forest2, 2, 2, store);
+	// Should now have a single key
+	CHECK_EQUAL(1, forest1.size());
+	CHECK_EQUAL(1, forest1.getNodeCount());
+}
+
+TEST(FlatCandidateKeyForest_merge_one_one) {
+	uint32_t const vectorSizeBits = 8;
+	uint32_t const vectorCount = 3;
+	FlatCandidateKeyStore<vectorCount, vectorSizeBits, uint8_t> store;
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest1(1);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest2(1);
+	forest1.merge(forest2, 3, 2, store);
+	CHECK_EQUAL(2, forest1.size());
+	CHECK_EQUAL(1, forest1.getNodeCount());
+}
+
+TEST(FlatCandidateKeyForest_merge_verifyCandidates) {
+	uint32_t const vectorSizeBits = 8;
+	uint32_t const vectorCount = 3;
+	FlatCandidateKeyStore<vectorCount, vectorSizeBits, uint8_t> store;
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest1(1);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest2(0);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest3(0);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest4(0);
+
+	ListKeyVerifier<24> verifier;
+	forest2.merge(forest1, 3, 2, store);
+	forest3.merge(forest2, 5, 1, store);
+	forest4.merge(forest3, 4, 0, store);
+
+	forest4.verifyKeys(verifier, store);
+
+	// Only 1 key should be verified
+	CHECK_EQUAL(1, verifier.keysChecked());
+	std::vector<uint8_t> const expectedKey1Bytes = {0x04, 0x05, 0x03};
+	CHECK_ARRAY_EQUAL(expectedKey1Bytes, verifier.keys().at(0), expectedKey1Bytes.size());
+}
+
+TEST(FlatCandidateKeyForest_merge_verifyCandidates_2) {
+	uint32_t const vectorSizeBits = 8;
+	uint32_t const vectorCount = 3;
+	FlatCandidateKeyStore<vectorCount, vectorSizeBits, uint8_t> store;
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest1(1);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest2(0);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest3(0);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest4(0);
+
+	ListKeyVerifier<24> verifier;
+	forest2.merge(forest1, 3, 2, store);
+	forest3.merge(forest2, 5, 1, store);
+	forest4.merge(forest3, 4, 0, store);
+	forest4.merge(forest3, 7, 0, store);
+
+	forest4.verifyKeys(verifier, store);
+
+	// Only 1 key should be verified
+	CHECK_EQUAL(2, verifier.keysChecked());
+	std::vector<uint8_t> const expectedKey1Bytes = {0x04, 0x05, 0x03};
+	CHECK_ARRAY_EQUAL(expectedKey1Bytes, verifier.keys().at(0), expectedKey1Bytes.size());
+	std::vector<uint8_t> const expectedKey2Bytes = {0x07, 0x05, 0x03};
+	CHECK_ARRAY_EQUAL(expectedKey2Bytes, verifier.keys().at(1), expectedKey2Bytes.size());
+}
+
+TEST(FlatCandidateKeyForest_merge_verifyMergeCandidates) {
+	uint32_t const vectorSizeBits = 8;
+	uint32_t const vectorCount = 3;
+	FlatCandidateKeyStore<vectorCount, vectorSizeBits, uint8_t> store;
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest1(1);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest2(0);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest3(0);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest4(0);
+
+	ListKeyVerifier<24> verifier;
+	forest2.merge(forest1, 3, 2, store);
+	forest3.merge(forest2, 5, 1, store);
+	forest4.verifyMergeCandidates(verifier, forest3, 4, store);
+
+	// Only 1 key should be verified
+	CHECK_EQUAL(1, verifier.keysChecked());
+	std::vector<uint8_t> const expectedKey1Bytes = {0x04, 0x05, 0x03};
+	CHECK_ARRAY_EQUAL(expectedKey1Bytes, verifier.keys().at(0), expectedKey1Bytes.size());
+
+	// Forest 4 should not be modified
+	CHECK_EQUAL(0, forest4.size());
+	CHECK_EQUAL(0, forest4.getNodeCount());
+}
+
+TEST(FlatCandidateKeyForest_merge_notConsecutive) {
+	uint32_t const vectorSizeBits = 8;
+	uint32_t const vectorCount = 3;
+	FlatCandidateKeyStore<vectorCount, vectorSizeBits, uint8_t> store;
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest1(1);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest2(0);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest3(0);
+
+	forest2.merge(forest1, 3, 2, store);
+	forest3.merge(forest1, 4, 2, store);
+	CHECK_THROW(forest2.merge(forest1, 5, 2, store), std::logic_error);
+}
+
+TEST(FlatCandidateKeyStore_nodes) {
+	uint32_t const vectorSizeBits = 8;
+	uint32_t const vectorCount = 3;
+	FlatCandidateKeyStore<vectorCount, vectorSizeBits, uint8_t> store;
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest1(1);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest2(0);
+	FlatCandidateKeyForest<vectorCount, vectorSizeBits, uint8_t> forest3(0);
+
+	forest2.merge(forest1, 3, 2, store);
+	forest2.merge(forest1, 6, 2, store);
+	forest3.merge(forest2, 5, 1, store);
+	CHECK_EQUAL(2, store.nodeCount(2));
+	CHECK_EQUAL(1, store.nodeCount(1));
+	CHECK_EQUAL(0, store.nodeCount(0));
+	CHECK_EQUAL(6, store.node(2, 1).value);
+	CHECK_EQUAL(5, store.node(1, 0).value);
+	CHECK_EQUAL(0, store.node(1, 0).firstChild);
+	CHECK_EQUAL(2, store.node(1, 0).childCount);
+	CHECK_EQUAL(2, store.node(1, 0).subtreeSize);
+	CHECK(store.bytesUsed() > 0);
+
+	store.reset();
+	CHECK_EQUAL(0, store.nodeCount(2));
+	CHECK_EQUAL(0, store.bytesUsed());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -0,0 +1,174 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * KeyIteratorTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/enumerate/KeyIterator.hpp"
+
+#include "src/labynkyr/search/enumerate/SortedEnumeration.hpp"
+#include "src/labynkyr/search/enumerate/SortedWeightTable.hpp"
+#include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+#include "src/labynkyr/search/SearchTask.hpp"
+
+#include "src/labynkyr/WeightTable.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+WeightTable<3, 4, uint32_t> iteratorWeightTable() {
+	std::vector<uint32_t> weights(3 * 16);
+	for(uint32_t index = 0 ; index < weights.size() ; index++) {
+		weights[index] = (index * 11) % 13;
+	}
+	return WeightTable<3, 4, uint32_t>(weights);
+}
+
+/**
+ *
+ * Drain the iterator in blocks of batchSize keys
+ */
+std::vector<std::vector<uint8_t>> drain(KeyIterator<3, 4, uint32_t, uint8_t> & iterator, uint64_t batchSize) {
+	std::vector<std::vector<uint8_t>> keys;
+	std::vector<uint8_t> batch;
+	while(!iterator.isFinished()) {
+		uint64_t const produced = iterator.next(batch, batchSize);
+		CHECK(produced == batchSize || iterator.isFinished());
+		CHECK_EQUAL(produced * 2, batch.size());
+		for(uint64_t keyIndex = 0 ; keyIndex < produced ; keyIndex++) {
+			keys.push_back(std::vector<uint8_t>(batch.begin() + keyIndex * 2, batch.begin() + (keyIndex + 1) * 2));
+		}
+	}
+	return keys;
+}
+
+}
+
+TEST(KeyIterator_next_matchesSortedEnumeration) {
+	WeightTable<3, 4, uint32_t> const weightTable = iteratorWeightTable();
+	SortedWeightTable<3, 4, uint32_t, uint8_t> const sortedTable(weightTable);
+	SearchTask<3, 4, uint32_t> const task(9, 14, weightTable, 2, 11);
+
+	ListKeyVerifier<12> verifier;
+	SortedEnumeration<3, 4, uint32_t, uint8_t> enumeration(verifier, sortedTable);
+	enumeration.enumerate(task.getMinKeyWeight(), task.getMaxKeyWeight(), task.getFirstSubkeyBegin(), task.getFirstSubkeyEnd());
+	CHECK(verifier.keysChecked() > 0);
+
+	// The same keys in the same order, whatever the batch size
+	for(uint64_t batchSize : {1UL, 7UL, 64UL, 100000UL}) {
+		KeyIterator<3, 4, uint32_t, uint8_t> iterator(task, sortedTable);
+		std::vector<std::vector<uint8_t>> const keys = drain(iterator, batchSize);
+		CHECK(verifier.keys() == keys);
+		CHECK_EQUAL(verifier.keysChecked(), iterator.keysEnumerated());
+	}
+}
+
+TEST(KeyIterator_next_interleaved) {
+	WeightTable<3, 4, uint32_t> const weightTable = iteratorWeightTable();
+	SortedWeightTable<3, 4, uint32_t, uint8_t> const sortedTable(weightTable);
+	SearchTask<3, 4, uint32_t> const task(0, 12, weightTable);
+
+	KeyIterator<3, 4, uint32_t, uint8_t> reference(task, sortedTable);
+	std::vector<std::vector<uint8_t>> const expected = drain(reference, 1000);
+
+	// Two iterators over the same table advance independently
+	KeyIterator<3, 4, uint32_t, uint8_t> first(task, sortedTable);
+	KeyIterator<3, 4, uint32_t, uint8_t> second(task, sortedTable);
+	uint8_t firstKeys[3 * 2];
+	uint8_t secondKeys[5 * 2];
+	std::vector<std::vector<uint8_t>> firstSeen;
+	std::vector<std::vector<uint8_t>> secondSeen;
+	while(!first.isFinished() || !second.isFinished()) {
+		uint64_t const firstCount = first.next(firstKeys, 3);
+		for(uint64_t keyIndex = 0 ; keyIndex < firstCount ; keyIndex++) {
+			firstSeen.push_back(std::vector<uint8_t>(firstKeys + keyIndex * 2, firstKeys + (keyIndex + 1) * 2));
+		}
+		uint64_t const secondCount = second.next(secondKeys, 5);
+		for(uint64_t keyIndex = 0 ; keyIndex < secondCount ; keyIndex++) {
+			secondSeen.push_back(std::vector<uint8_t>(secondKeys + keyIndex * 2, secondKeys + (keyIndex + 1) * 2));
+		}
+	}
+	CHECK(expected == firstSeen);
+	CHECK(expected == secondSeen);
+}
+
+TEST(KeyIterator_next_emptyTask) {
+	WeightTable<3, 4, uint32_t> const weightTable = iteratorWeightTable();
+	SortedWeightTable<3, 4, uint32_t, uint8_t> const sortedTable(weightTable);
+	// Beyond the heaviest key
+	SearchTask<3, 4, uint32_t> const task(100, 200, weightTable);
+
+	KeyIterator<3, 4, uint32_t, uint8_t> iterator(task, sortedTable);
+	uint8_t keys[4 * 2];
+	CHECK_EQUAL(0, iterator.next(keys, 4));
+	CHECK(iterator.isFinished());
+	CHECK_EQUAL(0, iterator.next(keys, 4));
+	CHECK_EQUAL(0, iterator.keysEnumerated());
+}
+
+TEST(KeyIterator_next_singleVector) {
+	std::vector<uint32_t> const weights = {3, 0, 2, 1};
+	WeightTable<1, 2, uint32_t> const weightTable(weights);
+	SortedWeightTable<1, 2, uint32_t, uint8_t> const sortedTable(weightTable);
+	SearchTask<1, 2, uint32_t> const task(1, 3, weightTable, 0, 3);
+
+	KeyIterator<1, 2, uint32_t, uint8_t> iterator(task, sortedTable);
+	std::vector<uint8_t> batch;
+	CHECK_EQUAL(1, iterator.next(batch, 1));
+	CHECK_EQUAL(0x02, batch[0]);
+	// Subkey 3 has weight 1 but is outside the first subkey range
+	CHECK_EQUAL(0, iterator.next(batch, 1));
+	CHECK(iterator.isFinished());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
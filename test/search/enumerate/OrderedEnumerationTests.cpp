@@ -0,0 +1,163 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * OrderedEnumerationTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/enumerate/OrderedEnumeration.hpp"
+
+#include "src/labynkyr/search/enumerate/SortedWeightTable.hpp"
+#include "src/labynkyr/search/verify/ComparisonKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/FullKeyBuilder.hpp"
+#include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+#include "src/labynkyr/search/CancellationToken.hpp"
+
+#include "src/labynkyr/WeightTable.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+/**
+ *
+ * @return the weight of a 12-bit key built from three 4-bit subkeys
+ */
+uint32_t keyWeight(WeightTable<3, 4, uint32_t> const & weightTable, std::vector<uint8_t> const & key) {
+	uint32_t const keyValue = key[0] | (static_cast<uint32_t>(key[1]) << 8);
+	return weightTable.weight(0, keyValue & 0xF) + weightTable.weight(1, (keyValue >> 4) & 0xF) + weightTable.weight(2, keyValue >> 8);
+}
+
+}
+
+TEST(OrderedEnumeration_enumerate_ascendingWeight) {
+	std::vector<uint32_t> weights(3 * 16);
+	for(uint32_t index = 0 ; index < weights.size() ; index++) {
+		weights[index] = (index * 37 + 11) % 97;
+	}
+	WeightTable<3, 4, uint32_t> weightTable(weights);
+	SortedWeightTable<3, 4, uint32_t, uint8_t> const sortedTable(weightTable);
+	uint32_t const minKeyWeight = 60;
+	uint32_t const maxKeyWeight = 170;
+
+	ListKeyVerifier<12> verifier;
+	OrderedEnumeration<3, 4, uint32_t, uint8_t> enumeration(verifier, sortedTable, 7);
+	enumeration.enumerate(minKeyWeight, maxKeyWeight, 3, 14);
+
+	// Every key within the band whose first subkey is in [3, 14) is enumerated exactly once
+	std::vector<std::vector<uint8_t>> expectedKeys;
+	for(uint32_t keyValue = 0 ; keyValue < (1U << 12) ; keyValue++) {
+		std::vector<uint8_t> const subkeys = {
+			static_cast<uint8_t>(keyValue & 0xF), static_cast<uint8_t>((keyValue >> 4) & 0xF), static_cast<uint8_t>(keyValue >> 8)
+		};
+		uint32_t const weight = weightTable.weight(0, subkeys[0]) + weightTable.weight(1, subkeys[1]) + weightTable.weight(2, subkeys[2]);
+		if(weight >= minKeyWeight && weight < maxKeyWeight && subkeys[0] >= 3 && subkeys[0] < 14) {
+			std::vector<uint8_t> key(2);
+			FullKeyBuilder<3, 4, uint8_t>::fullKey(subkeys, key.data());
+			expectedKeys.push_back(key);
+		}
+	}
+	std::vector<std::vector<uint8_t>> keys = verifier.keys();
+	for(uint64_t keyIndex = 1 ; keyIndex < keys.size() ; keyIndex++) {
+		CHECK(keyWeight(weightTable, keys[keyIndex - 1]) <= keyWeight(weightTable, keys[keyIndex]));
+	}
+	std::sort(keys.begin(), keys.end());
+	std::sort(expectedKeys.begin(), expectedKeys.end());
+	CHECK_EQUAL(expectedKeys.size(), keys.size());
+	CHECK(expectedKeys == keys);
+}
+
+TEST(OrderedEnumeration_enumerate_emptyBand) {
+	std::vector<uint32_t> weights(3 * 16, 5);
+	WeightTable<3, 4, uint32_t> weightTable(weights);
+	SortedWeightTable<3, 4, uint32_t, uint8_t> const sortedTable(weightTable);
+
+	// Every key has weight 15
+	ListKeyVerifier<12> verifier;
+	OrderedEnumeration<3, 4, uint32_t, uint8_t> enumeration(verifier, sortedTable);
+	enumeration.enumerate(0, 15, 0, 16);
+	CHECK_EQUAL(0, verifier.keysChecked());
+	enumeration.enumerate(15, 16, 0, 16);
+	CHECK_EQUAL(16 * 16 * 16, verifier.keysChecked());
+}
+
+TEST(OrderedEnumeration_enumerate_mostLikelyKeyFirst) {
+	std::vector<uint32_t> weights(2 * 256, 9);
+	weights[0x42] = 0;
+	weights[256 + 0x17] = 1;
+	WeightTable<2, 8, uint32_t> weightTable(weights);
+	SortedWeightTable<2, 8, uint32_t, uint8_t> const sortedTable(weightTable);
+
+	// The only key of weight 1 is found in the first batch, however wide the band
+	std::vector<uint8_t> const targetKey = {0x42, 0x17};
+	ComparisonKeyVerifier<16> verifier(targetKey);
+	OrderedEnumeration<2, 8, uint32_t, uint8_t> enumeration(verifier, sortedTable, 10);
+	enumeration.enumerate(1, 19, 0, 256);
+	CHECK(verifier.success());
+	CHECK_EQUAL(10, verifier.keysChecked());
+}
+
+TEST(OrderedEnumeration_enumerate_cancelled) {
+	std::vector<uint32_t> weights(2 * 256, 1);
+	WeightTable<2, 8, uint32_t> weightTable(weights);
+	SortedWeightTable<2, 8, uint32_t, uint8_t> const sortedTable(weightTable);
+
+	ListKeyVerifier<16> verifier;
+	CancellationToken token;
+	token.cancel();
+	OrderedEnumeration<2, 8, uint32_t, uint8_t> enumeration(verifier, sortedTable, 10, token);
+	enumeration.enumerate(0, 3, 0, 256);
+	// The token is polled once per batch
+	CHECK_EQUAL(10, verifier.keysChecked());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
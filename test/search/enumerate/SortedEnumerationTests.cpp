@@ -0,0 +1,215 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SortedEnumerationTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/enumerate/SortedEnumeration.hpp"
+
+#include "src/labynkyr/search/enumerate/SortedWeightTable.hpp"
+#include "src/labynkyr/search/verify/ComparisonKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/FullKeyBuilder.hpp"
+#include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+#include "src/labynkyr/search/CancellationToken.hpp"
+
+#include "src/labynkyr/WeightTable.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(FullKeyBuilder_setSubkey_unaligned) {
+	// Three 5-bit subkeys: 0x1F, 0x00, 0x15 -> bits 0..4 = 11111, bits 5..9 = 00000, bits 10..14 = 10101
+	std::vector<uint8_t> key(2, 0xFF);
+	FullKeyBuilder<3, 5, uint8_t>::setSubkey(1, 0x00, key.data());
+	CHECK_EQUAL(0x1F, key[0]);
+	CHECK_EQUAL(0xFC, key[1]);
+	FullKeyBuilder<3, 5, uint8_t>::setSubkey(2, 0x15, key.data());
+	CHECK_EQUAL(0x1F, key[0]);
+	CHECK_EQUAL(0xD4, key[1]);
+
+	std::vector<uint8_t> expected(2);
+	std::vector<uint8_t> const subkeys = {0x1F, 0x00, 0x15};
+	FullKeyBuilder<3, 5, uint8_t>::fullKey(subkeys, expected.data());
+	// fullKey clears the unused top bit, setSubkey leaves it alone
+	CHECK_EQUAL(expected[0], key[0]);
+	CHECK_EQUAL(expected[1], key[1] & 0x7F);
+}
+
+TEST(SortedEnumeration_enumerate_unalignedSubkeys) {
+	std::vector<uint32_t> weights(3 * 16);
+	for(uint32_t index = 0 ; index < weights.size() ; index++) {
+		weights[index] = (index * 7) % 5;
+	}
+	WeightTable<3, 4, uint32_t> weightTable(weights);
+	SortedWeightTable<3, 4, uint32_t, uint8_t> const sortedTable(weightTable);
+	uint32_t const maxKeyWeight = 4;
+
+	ListKeyVerifier<12> verifier;
+	SortedEnumeration<3, 4, uint32_t, uint8_t> enumeration(verifier, sortedTable, 5);
+	enumeration.enumerate(maxKeyWeight);
+
+	// Every key below the maximum weight is enumerated exactly once
+	std::vector<std::vector<uint8_t>> expectedKeys;
+	for(uint32_t keyValue = 0 ; keyValue < (1U << 12) ; keyValue++) {
+		std::vector<uint8_t> const subkeys = {
+			static_cast<uint8_t>(keyValue & 0xF), static_cast<uint8_t>((keyValue >> 4) & 0xF), static_cast<uint8_t>(keyValue >> 8)
+		};
+		if(weightTable.weight(0, subkeys[0]) + weightTable.weight(1, subkeys[1]) + weightTable.weight(2, subkeys[2]) < maxKeyWeight) {
+			std::vector<uint8_t> key(2);
+			FullKeyBuilder<3, 4, uint8_t>::fullKey(subkeys, key.data());
+			expectedKeys.push_back(key);
+		}
+	}
+	std::vector<std::vector<uint8_t>> keys = verifier.keys();
+	std::sort(keys.begin(), keys.end());
+	std::sort(expectedKeys.begin(), expectedKeys.end());
+	CHECK_EQUAL(expectedKeys.size(), keys.size());
+	CHECK(expectedKeys == keys);
+}
+
+TEST(SortedEnumeration_enumerate_weightBand) {
+	std::vector<uint32_t> weights(3 * 16);
+	for(uint32_t index = 0 ; index < weights.size() ; index++) {
+		weights[index] = (index * 11) % 13;
+	}
+	WeightTable<3, 4, uint32_t> weightTable(weights);
+	SortedWeightTable<3, 4, uint32_t, uint8_t> const sortedTable(weightTable);
+	uint32_t const minKeyWeight = 9;
+	uint32_t const maxKeyWeight = 14;
+
+	ListKeyVerifier<12> verifier;
+	SortedEnumeration<3, 4, uint32_t, uint8_t> enumeration(verifier, sortedTable, 7);
+	enumeration.enumerate(minKeyWeight, maxKeyWeight, 2, 11);
+
+	// Every key within the band whose first subkey is in [2, 11) is enumerated exactly once
+	std::vector<std::vector<uint8_t>> expectedKeys;
+	for(uint32_t keyValue = 0 ; keyValue < (1U << 12) ; keyValue++) {
+		std::vector<uint8_t> const subkeys = {
+			static_cast<uint8_t>(keyValue & 0xF), static_cast<uint8_t>((keyValue >> 4) & 0xF), static_cast<uint8_t>(keyValue >> 8)
+		};
+		uint32_t const weight = weightTable.weight(0, subkeys[0]) + weightTable.weight(1, subkeys[1]) + weightTable.weight(2, subkeys[2]);
+		if(weight >= minKeyWeight && weight < maxKeyWeight && subkeys[0] >= 2 && subkeys[0] < 11) {
+			std::vector<uint8_t> key(2);
+			FullKeyBuilder<3, 4, uint8_t>::fullKey(subkeys, key.data());
+			expectedKeys.push_back(key);
+		}
+	}
+	std::vector<std::vector<uint8_t>> keys = verifier.keys();
+	std::sort(keys.begin(), keys.end());
+	std::sort(expectedKeys.begin(), expectedKeys.end());
+	CHECK_EQUAL(expectedKeys.size(), keys.size());
+	CHECK(expectedKeys == keys);
+}
+
+TEST(SortedEnumeration_enumerate_fullVector8Bit) {
+	// All 256 values of the last vector fall below the maximum weight; the subkey loop must not wrap
+	std::vector<uint32_t> weights(2 * 256, 1);
+	weights[0] = 0;
+	WeightTable<2, 8, uint32_t> weightTable(weights);
+	SortedWeightTable<2, 8, uint32_t, uint8_t> const sortedTable(weightTable);
+
+	ListKeyVerifier<16> verifier;
+	SortedEnumeration<2, 8, uint32_t, uint8_t> enumeration(verifier, sortedTable);
+	enumeration.enumerate(2);
+	CHECK_EQUAL(256, verifier.keysChecked());
+	for(auto const & key : verifier.keys()) {
+		CHECK_EQUAL(0, key[0]);
+	}
+}
+
+TEST(SortedEnumeration_enumerate_stopsAfterBatch) {
+	std::vector<uint32_t> weights(2 * 256, 1);
+	weights[0] = 0;
+	weights[256] = 0;
+	WeightTable<2, 8, uint32_t> weightTable(weights);
+	SortedWeightTable<2, 8, uint32_t, uint8_t> const sortedTable(weightTable);
+
+	// The key with both subkeys set to 0 is the first candidate enumerated
+	std::vector<uint8_t> const targetKey = {0x00, 0x00};
+	ComparisonKeyVerifier<16> verifier(targetKey);
+	SortedEnumeration<2, 8, uint32_t, uint8_t> enumeration(verifier, sortedTable, 10);
+	enumeration.enumerate(3);
+	CHECK(verifier.success());
+	CHECK_EQUAL(10, verifier.keysChecked());
+}
+
+TEST(SortedEnumeration_enumerate_cancelled) {
+	std::vector<uint32_t> weights(2 * 256, 1);
+	WeightTable<2, 8, uint32_t> weightTable(weights);
+	SortedWeightTable<2, 8, uint32_t, uint8_t> const sortedTable(weightTable);
+
+	ListKeyVerifier<16> verifier;
+	CancellationToken token;
+	token.cancel();
+	SortedEnumeration<2, 8, uint32_t, uint8_t> enumeration(verifier, sortedTable, 10, token);
+	enumeration.enumerate(3);
+	// The token is polled once per batch
+	CHECK_EQUAL(10, verifier.keysChecked());
+}
+
+TEST(SortedEnumeration_enumerate_raisesToken) {
+	std::vector<uint32_t> weights(2 * 256, 1);
+	weights[0] = 0;
+	weights[256] = 0;
+	WeightTable<2, 8, uint32_t> weightTable(weights);
+	SortedWeightTable<2, 8, uint32_t, uint8_t> const sortedTable(weightTable);
+
+	std::vector<uint8_t> const targetKey = {0x00, 0x00};
+	ComparisonKeyVerifier<16> verifier(targetKey);
+	CancellationToken token;
+	SortedEnumeration<2, 8, uint32_t, uint8_t> enumeration(verifier, sortedTable, 10, token);
+	enumeration.enumerate(3);
+	CHECK(verifier.success());
+	CHECK(token.isCancelled());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
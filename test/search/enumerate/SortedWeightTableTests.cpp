@@ -0,0 +1,104 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SortedWeightTableTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/enumerate/SortedWeightTable.hpp"
+
+#include "src/labynkyr/WeightTable.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(SortedWeightTable_sortedWeights) {
+	std::vector<uint32_t> const weights = {0, 3, 4, 1, 	6, 4, 3, 1, 	5, 7, 4, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SortedWeightTable<3, 2, uint32_t, uint8_t> const sortedTable(weightTable);
+
+	std::vector<uint32_t> const expected = {0, 1, 3, 4,    1, 3, 4, 6,   1, 4, 5, 7};
+	CHECK_ARRAY_EQUAL(expected, sortedTable.getSortedTable().allWeights(), expected.size());
+	CHECK_EQUAL(3, sortedTable.weight(1, 1));
+	CHECK_EQUAL(7, sortedTable.weight(2, 3));
+}
+
+TEST(SortedWeightTable_subkeys) {
+	std::vector<uint32_t> const weights = {0, 3, 4, 1, 	6, 4, 3, 1, 	5, 7, 4, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SortedWeightTable<3, 2, uint32_t, uint8_t> const sortedTable(weightTable);
+
+	std::vector<uint8_t> const expectedIndexes = {0, 3, 1, 2,    3, 2, 1, 0,   3, 2, 0, 1};
+	for(uint32_t vectorIndex = 0 ; vectorIndex < 3 ; vectorIndex++) {
+		for(uint32_t sortedIndex = 0 ; sortedIndex < 4 ; sortedIndex++) {
+			CHECK_EQUAL(expectedIndexes[vectorIndex * 4 + sortedIndex], sortedTable.subkey(vectorIndex, sortedIndex));
+		}
+	}
+}
+
+TEST(SortedWeightTable_remainingMinimumWeight) {
+	std::vector<uint32_t> const weights = {0, 3, 4, 1, 	6, 4, 3, 2, 	5, 7, 4, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SortedWeightTable<3, 2, uint32_t, uint8_t> const sortedTable(weightTable);
+
+	CHECK_EQUAL(3, sortedTable.remainingMinimumWeight(0));
+	CHECK_EQUAL(1, sortedTable.remainingMinimumWeight(1));
+	CHECK_EQUAL(0, sortedTable.remainingMinimumWeight(2));
+}
+
+TEST(SortedWeightTable_originalUnmodified) {
+	std::vector<uint32_t> const weights = {0, 3, 4, 1, 	6, 4, 3, 1, 	5, 7, 4, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SortedWeightTable<3, 2, uint32_t, uint8_t> const sortedTable(weightTable);
+
+	CHECK_ARRAY_EQUAL(weights, weightTable.allWeights(), weights.size());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
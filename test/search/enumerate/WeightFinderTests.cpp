@@ -259,6 +259,37 @@ TEST(WeightFinder_listPreConstructed_twoVector_list) {
 	CHECK_ARRAY_EQUAL(rankList, list, rankList.size());
 }
 
+TEST(WeightFinder_depthBounded_listIsSuffixOfFullList) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	WeightFinder<2, 2, uint32_t> weightFinder(weightTable, BigInt<4>(5));
+
+	// Bounds of 1 and then 2 are ranked; the rank of 2 reaches the depth
+	CHECK_EQUAL(2, weightFinder.rankedWeightBound());
+	auto const & list = weightFinder.list();
+	std::vector<BigInt<4>> const expected = {6, 4};
+	CHECK_EQUAL(expected.size(), list.size());
+	CHECK_ARRAY_EQUAL(expected, list, expected.size());
+
+	auto const actual = weightFinder.findBestWeight(BigInt<4>(5));
+	WeightFinder<2, 2, uint32_t> fullWeightFinder(weightTable);
+	auto const expectedWeight = fullWeightFinder.findBestWeight(BigInt<4>(5));
+	CHECK_EQUAL(expectedWeight.first, actual.first);
+	CHECK_EQUAL(expectedWeight.second, actual.second);
+}
+
+TEST(WeightFinder_depthBounded_wholeTable) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	WeightFinder<2, 2, uint32_t> weightFinder(weightTable, BigInt<4>(15));
+
+	CHECK_EQUAL(6, weightFinder.rankedWeightBound());
+	auto const & list = weightFinder.list();
+	std::vector<BigInt<4>> const expected = {15, 14, 13, 8, 6, 4};
+	CHECK_EQUAL(expected.size(), list.size());
+	CHECK_ARRAY_EQUAL(expected, list, expected.size());
+}
+
 } /* namespace search */
 } /* namespace labynkyr */
 
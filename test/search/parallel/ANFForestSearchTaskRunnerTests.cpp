@@ -48,7 +48,10 @@
 #include "src/labynkyr/search/parallel/ANFForestSearchTaskRunner.hpp"
 
 #include "src/labynkyr/search/enumerate/ActiveNodeFinder.hpp"
+#include "src/labynkyr/search/enumerate/ANFMemoryEstimator.hpp"
+#include "src/labynkyr/search/enumerate/Arena.hpp"
 #include "src/labynkyr/search/verify/ComparisonKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/FullKeyBuilder.hpp"
 #include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
 #include "src/labynkyr/search/SearchTask.hpp"
 
@@ -59,6 +62,7 @@
 
 #include <stdint.h>
 
+#include <set>
 #include <vector>
 
 namespace labynkyr {
@@ -96,6 +100,44 @@ TEST(ANFForestSearchTaskRunner_searchWithANFForest_size15_3vectors) {
 	CHECK_EQUAL(53, verifier.keysChecked());
 }
 
+TEST(ANFForestSearchTaskRunner_searchWithANFForest_size15_3vectors_smallArenaBlocks) {
+	ListKeyVerifier<6> verifier;
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+
+	uint32_t const minKeyWeight = 0;
+	uint32_t const maxKeyWeight = 5;
+	SearchTask<3, 2, uint32_t> const task(minKeyWeight, maxKeyWeight, weightTable);
+	ActiveNodeFinder<3, 2, uint32_t> const activeNodeFinder(weightTable, weightTable.maximumWeight());
+
+	// Tiny blocks force forests to be relocated when they cannot grow in place
+	ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t> runner(task, 53, activeNodeFinder, 64, false);
+	CHECK_EQUAL(0, runner.getArenaBytesUsed());
+	runner.processSequentially(verifier);
+	CHECK_EQUAL(53, verifier.keysChecked());
+	CHECK(runner.getArenaBytesUsed() > 0);
+	CHECK(runner.getArenaBytesReserved() >= runner.getArenaBytesUsed());
+}
+
+TEST(ANFForestSearchTaskRunner_searchWithANFForest_size15_3vectors_hugePages) {
+	ListKeyVerifier<6> verifier;
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+
+	uint32_t const minKeyWeight = 0;
+	uint32_t const maxKeyWeight = 5;
+	SearchTask<3, 2, uint32_t> const task(minKeyWeight, maxKeyWeight, weightTable);
+	ActiveNodeFinder<3, 2, uint32_t> const activeNodeFinder(weightTable, weightTable.maximumWeight());
+
+	// Falls back to regular pages if the host has no huge pages available
+	ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t> runner(task, 53, activeNodeFinder, Arena::DefaultBlockSizeBytes, true);
+	runner.processSequentially(verifier);
+	CHECK_EQUAL(53, verifier.keysChecked());
+	CHECK(runner.getArenaBytesUsed() > 0);
+}
+
 TEST(ANFForestSearchTaskRunner_searchWithANFForest_size15_fail) {
 	std::vector<uint8_t> const targetKey = {0x0A}; // Any key other than 0x0A should verify
 	ComparisonKeyVerifier<4> verifier(targetKey);
@@ -178,5 +220,184 @@ TEST(ANFForestSearchTaskRunner_searchWithANFForest_size11) {
 	CHECK_EQUAL(11, verifier.keysChecked());
 }
 
+TEST(ANFForestSearchTaskRunner_searchWithANFFlatForest_size15_3vectors) {
+	ListKeyVerifier<6> linkedVerifier;
+	ListKeyVerifier<6> flatVerifier;
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+
+	uint32_t const minKeyWeight = 0;
+	uint32_t const maxKeyWeight = 5;
+	SearchTask<3, 2, uint32_t> const task(minKeyWeight, maxKeyWeight, weightTable);
+	ActiveNodeFinder<3, 2, uint32_t> const activeNodeFinder(weightTable, weightTable.maximumWeight());
+
+	ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t> linkedRunner(task, 53, activeNodeFinder);
+	linkedRunner.processSequentially(linkedVerifier);
+	ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t> flatRunner(task, 53, activeNodeFinder, FlatForestLayout);
+	CHECK_EQUAL(FlatForestLayout, flatRunner.getForestLayout());
+	flatRunner.processSequentially(flatVerifier);
+	CHECK_EQUAL(53, flatVerifier.keysChecked());
+	CHECK(flatRunner.getArenaBytesUsed() > 0);
+	// Both representations should produce the same keys in the same order
+	for(uint32_t index = 0 ; index < 53 ; index++) {
+		CHECK_ARRAY_EQUAL(linkedVerifier.keys().at(index), flatVerifier.keys().at(index), 1);
+	}
+}
+
+TEST(ANFForestSearchTaskRunner_searchWithANFFlatForest_size15_success) {
+	std::vector<uint8_t> const targetKey = {0x06};
+	ComparisonKeyVerifier<4> verifier(targetKey);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+
+	uint32_t const minKeyWeight = 0;
+	uint32_t const maxKeyWeight = 6;
+	SearchTask<2, 2, uint32_t> const task(minKeyWeight, maxKeyWeight, weightTable);
+	ActiveNodeFinder<2, 2, uint32_t> const activeNodeFinder(weightTable, weightTable.maximumWeight());
+
+	ANFForestSearchTaskRunner<2, 2, uint32_t, uint32_t> runner(task, 15, activeNodeFinder, FlatForestLayout);
+	runner.processSequentially(verifier);
+	CHECK(verifier.success());
+}
+
+TEST(ANFForestSearchTaskRunner_searchWithANFFlatForest_size11) {
+	ListKeyVerifier<4> verifier;
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+
+	uint32_t const minKeyWeight = 1;
+	uint32_t const maxKeyWeight = 6;
+	SearchTask<2, 2, uint32_t> const task(minKeyWeight, maxKeyWeight, weightTable);
+	ActiveNodeFinder<2, 2, uint32_t> const activeNodeFinder(weightTable, weightTable.maximumWeight());
+
+	ANFForestSearchTaskRunner<2, 2, uint32_t, uint32_t> runner(task, 11, activeNodeFinder, FlatForestLayout);
+	runner.processSequentially(verifier);
+	CHECK_EQUAL(11, verifier.keysChecked());
+}
+
+TEST(ANFForestSearchTaskRunner_split_coversTask) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SearchTask<3, 2, uint32_t> const task(1, 5, weightTable);
+	ActiveNodeFinder<3, 2, uint32_t> const activeNodeFinder(weightTable, weightTable.maximumWeight());
+
+	ListKeyVerifier<6> wholeVerifier;
+	ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t> runner(task, 49, activeNodeFinder, FlatForestLayout);
+	runner.processSequentially(wholeVerifier);
+
+	auto halves = runner.split();
+	CHECK(halves.first.get() != 0 && halves.second.get() != 0);
+	CHECK_EQUAL("ANF/FlatForest", halves.first->methodName());
+	auto quarters = halves.second->split();
+	ListKeyVerifier<6> splitVerifier;
+	halves.first->processSequentially(splitVerifier);
+	quarters.first->processSequentially(splitVerifier);
+	quarters.second->processSequentially(splitVerifier);
+	CHECK_EQUAL(wholeVerifier.keysChecked(), splitVerifier.keysChecked());
+}
+
+namespace {
+
+WeightTable<3, 4, uint32_t> budgetWeightTable() {
+	std::vector<uint32_t> weights(3 * 16);
+	for(uint32_t index = 0 ; index < weights.size() ; index++) {
+		weights[index] = (index * 37 + 11) % 97;
+	}
+	return WeightTable<3, 4, uint32_t>(weights);
+}
+
+/**
+ *
+ * Check that every key in the task was verified exactly once
+ */
+void checkVerifiesTaskOnce(SearchTask<3, 4, uint32_t> const & task, ListKeyVerifier<12> const & verifier) {
+	auto const & weightTable = task.getWeightTable();
+	std::set<std::vector<uint8_t>> expectedKeys;
+	for(uint32_t keyValue = 0 ; keyValue < (1U << 12) ; keyValue++) {
+		std::vector<uint8_t> const subkeys = {
+			static_cast<uint8_t>(keyValue & 0xF), static_cast<uint8_t>((keyValue >> 4) & 0xF), static_cast<uint8_t>(keyValue >> 8)
+		};
+		uint32_t const weight = weightTable.weight(0, subkeys[0]) + weightTable.weight(1, subkeys[1]) + weightTable.weight(2, subkeys[2]);
+		if(weight >= task.getMinKeyWeight() && weight < task.getMaxKeyWeight() && task.isFirstSubkeyIncluded(subkeys[0])) {
+			std::vector<uint8_t> key(2);
+			FullKeyBuilder<3, 4, uint8_t>::fullKey(subkeys, key.data());
+			expectedKeys.insert(key);
+		}
+	}
+	std::set<std::vector<uint8_t>> const keys(verifier.keys().begin(), verifier.keys().end());
+	CHECK_EQUAL(expectedKeys.size(), verifier.keysChecked());
+	CHECK(expectedKeys == keys);
+}
+
+}
+
+TEST(ANFForestSearchTaskRunner_memoryBudget_splitsIntoWeightBands) {
+	WeightTable<3, 4, uint32_t> const weightTable = budgetWeightTable();
+	SearchTask<3, 4, uint32_t> const task(40, 200, weightTable);
+	ActiveNodeFinder<3, 4, uint32_t> const activeNodeFinder(weightTable, 200);
+	for(auto const layout : {LinkedForestLayout, FlatForestLayout}) {
+		ANFMemoryEstimator<3, 4, uint32_t, uint8_t> const estimator(task, activeNodeFinder);
+		uint64_t const taskBytes = (layout == FlatForestLayout) ? estimator.flatForestBytes() : estimator.linkedForestBytes();
+
+		ListKeyVerifier<12> verifier;
+		ANFForestSearchTaskRunner<3, 4, uint32_t, uint8_t> runner(task, 0, activeNodeFinder, layout, taskBytes - 1);
+		CHECK_EQUAL(taskBytes - 1, runner.getMemoryBudget());
+		runner.processSequentially(verifier);
+		checkVerifiesTaskOnce(task, verifier);
+		CHECK(runner.getWeightBandCount() > 1);
+		CHECK(runner.peakMemoryBytes() > 0);
+	}
+}
+
+TEST(ANFForestSearchTaskRunner_memoryBudget_fallsBackToSorted) {
+	WeightTable<3, 4, uint32_t> const weightTable = budgetWeightTable();
+	SearchTask<3, 4, uint32_t> const task(40, 200, weightTable, 3, 12);
+	ActiveNodeFinder<3, 4, uint32_t> const activeNodeFinder(weightTable, 200);
+	for(auto const layout : {LinkedForestLayout, FlatForestLayout}) {
+		// Not even a single weight fits
+		ListKeyVerifier<12> verifier;
+		ANFForestSearchTaskRunner<3, 4, uint32_t, uint8_t> runner(task, 0, activeNodeFinder, layout, 1);
+		runner.processSequentially(verifier);
+		checkVerifiesTaskOnce(task, verifier);
+		CHECK_EQUAL(0, runner.getWeightBandCount());
+		CHECK_EQUAL(160, runner.getSortedBandCount());
+		CHECK_EQUAL(0, runner.peakMemoryBytes());
+	}
+}
+
+TEST(ANFForestSearchTaskRunner_memoryBudget_splitKeepsBudget) {
+	WeightTable<3, 4, uint32_t> const weightTable = budgetWeightTable();
+	SearchTask<3, 4, uint32_t> const task(40, 200, weightTable);
+	ActiveNodeFinder<3, 4, uint32_t> const activeNodeFinder(weightTable, 200);
+
+	ANFForestSearchTaskRunner<3, 4, uint32_t, uint8_t> runner(task, 0, activeNodeFinder, LinkedForestLayout, 1);
+	auto halves = runner.split();
+	ListKeyVerifier<12> verifier;
+	halves.first->processSequentially(verifier);
+	halves.second->processSequentially(verifier);
+	checkVerifiesTaskOnce(task, verifier);
+	auto const & lower = static_cast<ANFForestSearchTaskRunner<3, 4, uint32_t, uint8_t> const &>(*halves.first);
+	CHECK_EQUAL(1, lower.getMemoryBudget());
+	CHECK(lower.getSortedBandCount() > 0);
+}
+
+TEST(ANFForestSearchTaskRunner_noMemoryBudget_singleBand) {
+	WeightTable<3, 4, uint32_t> const weightTable = budgetWeightTable();
+	SearchTask<3, 4, uint32_t> const task(40, 200, weightTable);
+	ActiveNodeFinder<3, 4, uint32_t> const activeNodeFinder(weightTable, 200);
+
+	ListKeyVerifier<12> verifier;
+	ANFForestSearchTaskRunner<3, 4, uint32_t, uint8_t> runner(task, 0, activeNodeFinder);
+	CHECK_EQUAL(0, runner.getMemoryBudget());
+	runner.processSequentially(verifier);
+	checkVerifiesTaskOnce(task, verifier);
+	CHECK_EQUAL(1, runner.getWeightBandCount());
+	CHECK_EQUAL(0, runner.getSortedBandCount());
+	CHECK_EQUAL(runner.getArenaBytesReserved(), runner.peakMemoryBytes());
+}
+
 } /* namespace search */
 } /* namespace labynkyr */
@@ -0,0 +1,125 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * CPUTopologyTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/parallel/CPUTopology.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+/**
+ * Two sockets, one NUMA node each, two physical cores per socket, two SMT threads per core.  Siblings are numbered as on a typical Linux
+ * system: CPU n and CPU n + 4 share a core.
+ */
+CPUTopology dualSocketTopology() {
+	std::vector<LogicalCPU> cpus;
+	for(uint32_t id = 0 ; id < 8 ; id++) {
+		uint32_t const package = (id % 4) / 2;
+		LogicalCPU const cpu = {id, package, id % 2, package};
+		cpus.push_back(cpu);
+	}
+	return CPUTopology(cpus);
+}
+
+}
+
+TEST(CPUTopology_parseCPUList) {
+	std::vector<uint32_t> const expected = {0, 1, 2, 3, 8, 10, 11};
+	auto const parsed = CPUTopology::parseCPUList("0-3,8,10-11\n");
+	CHECK_EQUAL(expected.size(), parsed.size());
+	CHECK_ARRAY_EQUAL(expected, parsed, expected.size());
+	CHECK(CPUTopology::parseCPUList("").empty());
+	CHECK_THROW(CPUTopology::parseCPUList("3-1"), std::invalid_argument);
+	CHECK_THROW(CPUTopology::parseCPUList("a"), std::invalid_argument);
+}
+
+TEST(CPUTopology_empty) {
+	CHECK_THROW((CPUTopology(std::vector<LogicalCPU>())), std::invalid_argument);
+}
+
+TEST(CPUTopology_counts) {
+	auto const topology = dualSocketTopology();
+	CHECK_EQUAL(8, topology.logicalCPUCount());
+	CHECK_EQUAL(4, topology.physicalCoreCount());
+	CHECK_EQUAL(2, topology.packageCount());
+	CHECK_EQUAL(2, topology.nodeCount());
+	CHECK_EQUAL(1, topology.nodeOf(6));
+	CHECK_THROW(topology.nodeOf(8), std::invalid_argument);
+}
+
+TEST(CPUTopology_physicalCoresFirst) {
+	auto const topology = dualSocketTopology();
+	// One thread of each core, alternating between the nodes, then the SMT siblings
+	std::vector<uint32_t> const expected = {0, 2, 1, 3, 4, 6, 5, 7};
+	auto const order = topology.physicalCoresFirst();
+	CHECK_EQUAL(expected.size(), order.size());
+	CHECK_ARRAY_EQUAL(expected, order, expected.size());
+}
+
+TEST(CPUTopology_report) {
+	auto const report = dualSocketTopology().report();
+	CHECK(report.find("8 logical CPUs, 4 physical cores, 2 packages, 2 NUMA nodes") != std::string::npos);
+	CHECK(report.find("node 1: CPUs 2 3 6 7") != std::string::npos);
+}
+
+TEST(CPUTopology_detect) {
+	auto const topology = CPUTopology::detect();
+	CHECK(topology.logicalCPUCount() > 0);
+	CHECK(topology.physicalCoreCount() <= topology.logicalCPUCount());
+	CHECK_EQUAL(topology.logicalCPUCount(), topology.physicalCoresFirst().size());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -0,0 +1,124 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * KeyBlockQueueTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/parallel/KeyBlockQueue.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(KeyBlockQueue_reservePublishFrontPop) {
+	KeyBlockQueue<16> queue(2, 3);
+	uint64_t keyCount = 0;
+	CHECK(queue.isEmpty());
+	CHECK(queue.front(keyCount) == 0);
+
+	uint8_t * const first = queue.reserve();
+	CHECK(first != 0);
+	first[0] = 0x11;
+	queue.publish(3);
+	uint8_t * const second = queue.reserve();
+	CHECK(second != 0 && second != first);
+	second[0] = 0x22;
+	queue.publish(1);
+	// Both slots are in use
+	CHECK(queue.reserve() == 0);
+	CHECK(!queue.isEmpty());
+
+	CHECK_EQUAL(0x11, queue.front(keyCount)[0]);
+	CHECK_EQUAL(3, keyCount);
+	queue.pop();
+	CHECK(queue.reserve() == first);
+	CHECK_EQUAL(0x22, queue.front(keyCount)[0]);
+	CHECK_EQUAL(1, keyCount);
+	queue.pop();
+	CHECK(queue.isEmpty());
+}
+
+TEST(KeyBlockQueue_constructor_invalid) {
+	CHECK_THROW(KeyBlockQueue<16>(0, 4), std::invalid_argument);
+	CHECK_THROW(KeyBlockQueue<16>(4, 0), std::invalid_argument);
+}
+
+TEST(KeyBlockQueue_producerConsumerThreads) {
+	KeyBlockQueue<8> queue(4, 2);
+	uint32_t const blockCount = 10000;
+	std::thread producer([&queue]() {
+		for(uint32_t blockIndex = 0 ; blockIndex < blockCount ; blockIndex++) {
+			uint8_t * block = 0;
+			while((block = queue.reserve()) == 0) {
+				std::this_thread::yield();
+			}
+			block[0] = static_cast<uint8_t>(blockIndex);
+			block[1] = static_cast<uint8_t>(blockIndex >> 8);
+			queue.publish(2);
+		}
+	});
+	bool inOrder = true;
+	for(uint32_t blockIndex = 0 ; blockIndex < blockCount ; blockIndex++) {
+		uint64_t keyCount = 0;
+		uint8_t const * block = 0;
+		while((block = queue.front(keyCount)) == 0) {
+			std::this_thread::yield();
+		}
+		inOrder &= (block[0] | (block[1] << 8)) == static_cast<int>(blockIndex & 0xFFFF) && keyCount == 2;
+		queue.pop();
+	}
+	producer.join();
+	CHECK(inOrder);
+	CHECK(queue.isEmpty());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
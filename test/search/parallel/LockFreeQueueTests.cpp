@@ -0,0 +1,168 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * LockFreeQueueTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/parallel/LockFreeQueue.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(LockFreeQueue_invalidCapacity) {
+	CHECK_THROW(LockFreeQueue<uint32_t> queue(0), std::invalid_argument);
+	CHECK_THROW(LockFreeQueue<uint32_t> queue(1), std::invalid_argument);
+	CHECK_THROW(LockFreeQueue<uint32_t> queue(6), std::invalid_argument);
+}
+
+TEST(LockFreeQueue_put_take_wraps) {
+	LockFreeQueue<uint32_t> queue(4);
+	CHECK_EQUAL(4, queue.capacity());
+	CHECK(queue.isEmpty());
+	// Several times around the ring buffer
+	for(uint32_t value = 0 ; value < 10 ; value++) {
+		queue.put(std::unique_ptr<uint32_t>(new uint32_t(value)));
+		queue.put(std::unique_ptr<uint32_t>(new uint32_t(value + 100)));
+		CHECK_EQUAL(false, queue.isEmpty());
+		CHECK_EQUAL(value, *queue.nonBlockingTake());
+		CHECK_EQUAL(value + 100, *queue.nonBlockingTake());
+		CHECK(queue.isEmpty());
+	}
+	CHECK(!queue.nonBlockingTake());
+}
+
+TEST(LockFreeQueue_put_overflowsWhenFull) {
+	LockFreeQueue<uint32_t> queue(2);
+	for(uint32_t value = 0 ; value < 5 ; value++) {
+		queue.put(std::unique_ptr<uint32_t>(new uint32_t(value)));
+	}
+	CHECK_EQUAL(3, queue.overflowSize());
+	CHECK_EQUAL(0, *queue.nonBlockingTake());
+	// Items keep overflowing, behind the earlier ones, until the overflow list has been emptied
+	queue.put(std::unique_ptr<uint32_t>(new uint32_t(5)));
+	CHECK_EQUAL(4, queue.overflowSize());
+	for(uint32_t value = 1 ; value < 6 ; value++) {
+		CHECK_EQUAL(value, *queue.nonBlockingTake());
+	}
+	CHECK(queue.isEmpty());
+	CHECK_EQUAL(0, queue.overflowSize());
+	queue.put(std::unique_ptr<uint32_t>(new uint32_t(6)));
+	CHECK_EQUAL(0, queue.overflowSize());
+	CHECK_EQUAL(6, *queue.nonBlockingTake());
+}
+
+TEST(LockFreeQueue_destructor_releasesItems) {
+	std::shared_ptr<uint32_t> const tracked(new uint32_t(1));
+	{
+		LockFreeQueue<std::shared_ptr<uint32_t>> queue(2);
+		for(uint32_t copy = 0 ; copy < 3 ; copy++) {
+			queue.put(std::unique_ptr<std::shared_ptr<uint32_t>>(new std::shared_ptr<uint32_t>(tracked)));
+		}
+		// One copy is left on the overflow list
+		CHECK_EQUAL(4, tracked.use_count());
+	}
+	CHECK_EQUAL(1, tracked.use_count());
+}
+
+TEST(LockFreeQueue_blockingTake_timeout) {
+	LockFreeQueue<uint32_t> queue;
+	CHECK(!queue.blockingTake(std::chrono::milliseconds(1)));
+}
+
+TEST(LockFreeQueue_blockingTake_wakeWaiters) {
+	LockFreeQueue<uint32_t> queue;
+	auto const start = std::chrono::steady_clock::now();
+	std::thread waker([&queue]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		queue.wakeWaiters();
+	});
+	auto const item = queue.blockingTake(std::chrono::seconds(10));
+	waker.join();
+	CHECK(!item);
+	CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+}
+
+TEST(LockFreeQueue_multipleProducers) {
+	uint32_t const producerCount = 4;
+	uint32_t const itemsPerProducer = 1000;
+	// Smaller than the number of items, so items overflow while the consumer catches up
+	LockFreeQueue<uint32_t> queue(16);
+	std::vector<std::thread> producers;
+	for(uint32_t producer = 0 ; producer < producerCount ; producer++) {
+		producers.push_back(std::thread([&queue, producer, itemsPerProducer]() {
+			for(uint32_t index = 0 ; index < itemsPerProducer ; index++) {
+				queue.put(std::unique_ptr<uint32_t>(new uint32_t(producer * itemsPerProducer + index)));
+			}
+		}));
+	}
+	std::vector<uint32_t> seen(producerCount * itemsPerProducer, 0);
+	uint32_t taken = 0;
+	while(taken < producerCount * itemsPerProducer) {
+		auto const item = queue.blockingTake(std::chrono::seconds(10));
+		if(!item) {
+			break;
+		}
+		seen[*item]++;
+		taken++;
+	}
+	for(auto & producer : producers) {
+		producer.join();
+	}
+	CHECK_EQUAL(producerCount * itemsPerProducer, taken);
+	CHECK_EQUAL(producerCount * itemsPerProducer, static_cast<uint32_t>(std::count(seen.begin(), seen.end(), 1)));
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
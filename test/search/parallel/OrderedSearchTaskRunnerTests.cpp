@@ -0,0 +1,109 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * OrderedSearchTaskRunnerTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/parallel/OrderedSearchTaskRunner.hpp"
+
+#include "src/labynkyr/search/verify/ComparisonKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+#include "src/labynkyr/search/SearchTask.hpp"
+
+#include "src/labynkyr/BigInt.hpp"
+#include "src/labynkyr/WeightTable.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(OrderedSearchTaskRunner_searchWithOrdered_threeVectors_size49) {
+	ListKeyVerifier<6> verifier;
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SearchTask<3, 2, uint32_t> const task(1, 5, weightTable);
+
+	OrderedSearchTaskRunner<3, 2, uint32_t, uint32_t> runner(task, 49);
+	CHECK_EQUAL("Ordered", runner.methodName());
+	runner.processSequentially(verifier);
+	CHECK_EQUAL(49, verifier.keysChecked());
+	CHECK(!runner.isKeyFound());
+}
+
+TEST(OrderedSearchTaskRunner_searchWithOrdered_twoVectors_success) {
+	std::vector<uint8_t> const targetKey = {0x06};
+	ComparisonKeyVerifier<4> verifier(targetKey);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	SearchTask<2, 2, uint32_t> const task(0, 6, weightTable);
+
+	OrderedSearchTaskRunner<2, 2, uint32_t, uint32_t> runner(task, 15);
+	runner.processSequentially(verifier);
+	CHECK(runner.isKeyFound());
+}
+
+TEST(OrderedSearchTaskRunner_split_coversTask) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SearchTask<3, 2, uint32_t> const task(1, 5, weightTable);
+
+	OrderedSearchTaskRunner<3, 2, uint32_t, uint32_t> runner(task, 49);
+	auto halves = runner.split();
+	CHECK(halves.first.get() != 0 && halves.second.get() != 0);
+	CHECK_EQUAL("Ordered", halves.second->methodName());
+	ListKeyVerifier<6> verifier;
+	halves.first->processSequentially(verifier);
+	halves.second->processSequentially(verifier);
+	CHECK_EQUAL(49, verifier.keysChecked());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -0,0 +1,113 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * PEUPlacementTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/parallel/PEUPlacement.hpp"
+
+#include "src/labynkyr/search/parallel/CPUTopology.hpp"
+#include "src/labynkyr/search/parallel/ThreadAffinity.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(PEUPlacement_unpinned) {
+	PEUPlacement const placement;
+	CHECK(!placement.isPinned());
+	CHECK_THROW(placement.cpuFor(0), std::logic_error);
+}
+
+TEST(PEUPlacement_cpuList_wraps) {
+	CHECK_THROW((PEUPlacement(std::vector<uint32_t>())), std::invalid_argument);
+	std::vector<uint32_t> const cpus = {4, 2};
+	PEUPlacement const placement(cpus);
+	CHECK(placement.isPinned());
+	CHECK_EQUAL(4, placement.cpuFor(0));
+	CHECK_EQUAL(2, placement.cpuFor(1));
+	CHECK_EQUAL(4, placement.cpuFor(2));
+}
+
+TEST(PEUPlacement_physicalCoresFirst) {
+	std::vector<LogicalCPU> const cpus = {{0, 0, 0, 0}, {1, 0, 0, 0}, {2, 0, 1, 0}};
+	auto const placement = PEUPlacement::physicalCoresFirst(CPUTopology(cpus));
+	CHECK_EQUAL(0, placement.cpuFor(0));
+	CHECK_EQUAL(2, placement.cpuFor(1));
+	CHECK_EQUAL(1, placement.cpuFor(2));
+}
+
+#ifdef __linux__
+TEST(ThreadAffinity_pinCurrentThread) {
+	bool pinned = false;
+	int32_t cpu = -1;
+	std::thread thread([&pinned, &cpu]() {
+		pinned = ThreadAffinity::pinCurrentThread(0);
+		cpu = ThreadAffinity::currentCPU();
+	});
+	thread.join();
+	CHECK(pinned);
+	CHECK_EQUAL(0, cpu);
+}
+
+TEST(ScopedThreadAffinity_restores) {
+	bool pinned = false;
+	std::thread thread([&pinned]() {
+		ScopedThreadAffinity const affinity(0);
+		pinned = affinity.pinned();
+	});
+	thread.join();
+	CHECK(pinned);
+}
+#endif
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -48,7 +48,9 @@
 #include "src/labynkyr/search/parallel/PEUPool.hpp"
 
 #include "src/labynkyr/search/parallel/ANFForestSearchTaskRunner.hpp"
+#include "src/labynkyr/search/parallel/LockFreeQueue.hpp"
 #include "src/labynkyr/search/parallel/Queue.hpp"
+#include "src/labynkyr/search/verify/ComparisonKeyVerifier.hpp"
 #include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
 #include "test/search/parallel/ExceptionThrowingSearchTaskRunner.hpp"
 
@@ -108,6 +110,20 @@ TEST(PEUPool_processThenStop) {
 	pool.stopAllPEUs();
 }
 
+TEST(PEUPool_stopAllPEUs_cancels) {
+	ListKeyVerifierFactory<6> verifierFactory;
+	PEUPool<3, 2, uint32_t, uint32_t> pool(2, verifierFactory, 2, 200UL);
+
+	pool.processAllPEUsAsynchronously();
+	CHECK(!pool.getCancellationToken().isCancelled());
+	pool.stopAllPEUs();
+	CHECK(pool.getCancellationToken().isCancelled());
+	// Restarting the pool lowers the token again
+	pool.processAllPEUsAsynchronously();
+	CHECK(!pool.getCancellationToken().isCancelled());
+	pool.stopAllPEUs();
+}
+
 TEST(PEUPool_exceptionHandling) {
 	ListKeyVerifierFactory<6> verifierFactory;
 	uint32_t const peuCount = 6;
@@ -135,6 +151,167 @@ TEST(PEUPool_exceptionHandling) {
 	pool.stopAllPEUs();
 }
 
+TEST(PEUPool_lockFreeWriteQueue) {
+	ListKeyVerifierFactory<6> verifierFactory;
+	PEUPool<3, 2, uint32_t, uint32_t> pool(2, verifierFactory, 2, 10000000UL, LockFreeQueueImplementation);
+	CHECK((dynamic_cast<LockFreeQueue<SearchTaskRunner<3, 2, uint32_t, uint32_t>> *>(&pool.getWriteQueue()) != 0));
+}
+
+TEST(PEUPool_lockFreeWriteQueue_fullThenStop) {
+	ListKeyVerifierFactory<6> verifierFactory;
+	PEUPool<3, 2, uint32_t, uint32_t> pool(1, verifierFactory, 1, 200UL, LockFreeQueueImplementation);
+	auto & writeQueue = dynamic_cast<LockFreeQueue<SearchTaskRunner<3, 2, uint32_t, uint32_t>> &>(pool.getWriteQueue());
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SearchTask<3, 2, uint32_t> const task(0, 5, weightTable);
+	ActiveNodeFinder<3, 2, uint32_t> const activeNodeFinder(weightTable, weightTable.maximumWeight());
+	// More completed tasks than the ring buffer holds, and nobody taking them
+	uint64_t const taskCount = writeQueue.capacity() + 10;
+	for(uint64_t taskIndex = 0 ; taskIndex < taskCount ; taskIndex++) {
+		pool.addTasking(std::unique_ptr<ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t>>(new ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t>(task, 53, activeNodeFinder)));
+	}
+	pool.processAllPEUsAsynchronously();
+	auto const start = std::chrono::steady_clock::now();
+	while(writeQueue.overflowSize() < 10 && std::chrono::steady_clock::now() - start < std::chrono::seconds(30)) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	CHECK_EQUAL(10, writeQueue.overflowSize());
+	// The PEU never waits on the full queue, so stopping returns promptly
+	auto const stopStart = std::chrono::steady_clock::now();
+	pool.stopAllPEUs();
+	CHECK(std::chrono::steady_clock::now() - stopStart < std::chrono::seconds(5));
+
+	uint64_t completedCount = 0;
+	while(writeQueue.nonBlockingTake()) {
+		completedCount++;
+	}
+	CHECK_EQUAL(taskCount, completedCount);
+	CHECK(writeQueue.isEmpty());
+}
+
+TEST(PEUPool_pinnedPlacement) {
+	ListKeyVerifierFactory<6> verifierFactory;
+	std::vector<uint32_t> const cpus = {0};
+	PEUPool<3, 2, uint32_t, uint32_t> pool(2, verifierFactory, 1, 10000000UL, LockingQueueImplementation, PEUPlacement(cpus));
+	CHECK_EQUAL(0, pool.getPEUs()[0]->getPinnedCPU());
+	CHECK_EQUAL(0, pool.getPEUs()[1]->getPinnedCPU());
+	PEUPool<3, 2, uint32_t, uint32_t> unpinnedPool(1, verifierFactory, 1, 10000000UL);
+	CHECK_EQUAL(-1, unpinnedPool.getPEUs()[0]->getPinnedCPU());
+}
+
+TEST(PEUPool_verifierCount_notDividing) {
+	ListKeyVerifierFactory<6> verifierFactory;
+	PEUPool<3, 2, uint32_t, uint32_t> pool(5, verifierFactory, 2, 10000000UL);
+	CHECK_EQUAL(2, pool.getVerifiers().size());
+	// Groups of 3 and 2 consecutive PEUs
+	CHECK(&pool.getPEUs()[2]->getKeyVerifier() == pool.getVerifiers()[0].get());
+	CHECK(&pool.getPEUs()[3]->getKeyVerifier() == pool.getVerifiers()[1].get());
+	CHECK_THROW((PEUPool<3, 2, uint32_t, uint32_t>(2, verifierFactory, 3, 10000000UL)), std::invalid_argument);
+	CHECK_THROW((PEUPool<3, 2, uint32_t, uint32_t>(2, verifierFactory, 0, 10000000UL)), std::invalid_argument);
+}
+
+namespace {
+
+/**
+ *
+ * Run a 53 key task on a pipelined pool and wait for it to complete
+ */
+void runPipelinedTask(uint32_t peuCount, uint32_t verifierCount) {
+	ListKeyVerifierFactory<6> verifierFactory;
+	PEUPool<3, 2, uint32_t, uint32_t> pool(peuCount, verifierFactory, verifierCount, 10000000UL, LockingQueueImplementation, PEUPlacement(),
+			VerifierPipeline(2, 4));
+	CHECK_EQUAL(peuCount, pool.getVerifiers().size());
+	pool.processAllPEUsAsynchronously();
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SearchTask<3, 2, uint32_t> const task(0, 5, weightTable);
+	ActiveNodeFinder<3, 2, uint32_t> const activeNodeFinder(weightTable, weightTable.maximumWeight());
+	pool.addTasking(std::unique_ptr<SearchTaskRunner<3, 2, uint32_t, uint32_t>>(new ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t>(task, 53, activeNodeFinder)));
+
+	auto produce = pool.getWriteQueue().blockingTake(std::chrono::seconds(5));
+	CHECK(produce.get() != 0);
+	CHECK_EQUAL(53, pool.keysVerified());
+	CHECK(!pool.isKeyFound());
+	pool.stopAllPEUs();
+}
+
+class FailingKeyVerifier : public KeyVerifier<6> {
+public:
+	void checkKey(std::vector<uint8_t> const & candidateKeyBytes) override {
+		throw std::runtime_error("Verifier failed");
+	}
+
+	uint64_t keysChecked() const override {
+		return 0;
+	}
+
+	bool success() const override {
+		return false;
+	}
+
+	Key<6> correctKey() override {
+		throw std::logic_error("Key has not been found");
+	}
+
+	void flush() override {}
+};
+
+class FailingKeyVerifierFactory : public KeyVerifierFactory<6> {
+public:
+	std::unique_ptr<KeyVerifier<6>> newVerifier() const override {
+		return std::unique_ptr<KeyVerifier<6>>(new FailingKeyVerifier());
+	}
+};
+
+}
+
+TEST(PEUPool_pipelined_verifierThreadFails) {
+	FailingKeyVerifierFactory verifierFactory;
+	PEUPool<3, 2, uint32_t, uint32_t> pool(1, verifierFactory, 1, 10000000UL, LockingQueueImplementation, PEUPlacement(), VerifierPipeline(2, 4));
+	pool.processAllPEUsAsynchronously();
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SearchTask<3, 2, uint32_t> const task(0, 5, weightTable);
+	ActiveNodeFinder<3, 2, uint32_t> const activeNodeFinder(weightTable, weightTable.maximumWeight());
+	pool.addTasking(std::unique_ptr<SearchTaskRunner<3, 2, uint32_t, uint32_t>>(new ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t>(task, 53, activeNodeFinder)));
+
+	// The PEU stops waiting on the failed verifier thread, and wakes the write queue to report it
+	CHECK(!pool.getWriteQueue().blockingTake(std::chrono::seconds(10)));
+	CHECK_THROW(pool.checkForThrownExceptions(), std::runtime_error);
+	pool.stopAllPEUs();
+}
+
+TEST(PEUPool_pipelined_fewerVerifierThreads) {
+	runPipelinedTask(3, 2);
+}
+
+TEST(PEUPool_pipelined_moreVerifierThreads) {
+	runPipelinedTask(2, 5);
+}
+
+TEST(PEUPool_pipelined_keyFound) {
+	std::vector<uint8_t> const targetKey = {0x06};
+	ComparisonKeyVerifierFactory<4> verifierFactory(targetKey);
+	PEUPool<2, 2, uint32_t, uint32_t> pool(2, verifierFactory, 1, 10000000UL, LockingQueueImplementation, PEUPlacement(),
+			VerifierPipeline::pipelined());
+	pool.processAllPEUsAsynchronously();
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	SearchTask<2, 2, uint32_t> const task(0, 6, weightTable);
+	ActiveNodeFinder<2, 2, uint32_t> const activeNodeFinder(weightTable, weightTable.maximumWeight());
+	pool.addTasking(std::unique_ptr<SearchTaskRunner<2, 2, uint32_t, uint32_t>>(new ANFForestSearchTaskRunner<2, 2, uint32_t, uint32_t>(task, 15, activeNodeFinder)));
+
+	auto produce = pool.getWriteQueue().blockingTake(std::chrono::seconds(5));
+	CHECK(produce.get() != 0 && produce->isKeyFound());
+	CHECK(pool.isKeyFound());
+	CHECK(targetKey == pool.correctKey().asBytes());
+	pool.stopAllPEUs();
+}
+
 } /* namespace search */
 } /* namespace labynkyr */
 
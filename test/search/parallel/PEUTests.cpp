@@ -49,20 +49,74 @@
 
 #include "src/labynkyr/search/parallel/ANFForestSearchTaskRunner.hpp"
 #include "src/labynkyr/search/parallel/Queue.hpp"
+#include "src/labynkyr/search/parallel/SortedSearchTaskRunner.hpp"
+#include "src/labynkyr/search/parallel/WorkStealingQueues.hpp"
 #include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+#include "src/labynkyr/search/CancellationToken.hpp"
 #include "test/search/parallel/ExceptionThrowingSearchTaskRunner.hpp"
 
 #include <unittest++/UnitTest++.h>
 
 #include <stdint.h>
 
+#include <future>
 #include <memory>
+#include <set>
 #include <stdexcept>
 #include <thread>
 
 namespace labynkyr {
 namespace search {
 
+namespace {
+
+/**
+ *
+ * Records keys like ListKeyVerifier, but the first call to checkKeys blocks until the verifier is released
+ */
+template<uint32_t KeyLenBits>
+class GatedKeyVerifier : public ListKeyVerifier<KeyLenBits> {
+public:
+	GatedKeyVerifier()
+	: ListKeyVerifier<KeyLenBits>()
+	, isGated(true)
+	, entered()
+	, released()
+	, enteredFuture(entered.get_future())
+	, releasedFuture(released.get_future())
+	{
+	}
+
+	void checkKeys(uint8_t const * candidateKeys, uint64_t keyCount) override {
+		if(isGated) {
+			isGated = false;
+			entered.set_value();
+			releasedFuture.wait();
+		}
+		ListKeyVerifier<KeyLenBits>::checkKeys(candidateKeys, keyCount);
+	}
+
+	/**
+	 *
+	 * @return true if a thread entered checkKeys before the timeout
+	 */
+	bool waitUntilEntered(std::chrono::nanoseconds timeout) {
+		return enteredFuture.wait_for(timeout) == std::future_status::ready;
+	}
+
+	void release() {
+		released.set_value();
+	}
+private:
+	bool isGated;
+	std::promise<void> entered;
+	std::promise<void> released;
+	std::future<void> enteredFuture;
+	std::future<void> releasedFuture;
+};
+
+} /* namespace */
+
 TEST(PEU_startAndStop_runIndefinitely) {
 	Queue<SearchTaskRunner<2, 2, uint32_t, uint32_t>> readQueue;
 	Queue<SearchTaskRunner<2, 2, uint32_t, uint32_t>> writeQueue;
@@ -141,5 +195,166 @@ TEST(PEU_exceptionHandling) {
 	peu.stop();
 }
 
+TEST(PEU_cancelled_doesNotTakeTasks) {
+	Queue<SearchTaskRunner<3, 2, uint32_t, uint32_t>> readQueue;
+	Queue<SearchTaskRunner<3, 2, uint32_t, uint32_t>> writeQueue;
+
+	ListKeyVerifier<6> verifier;
+	CancellationToken token;
+	token.cancel();
+	PEU<3, 2, uint32_t, uint32_t> peu(0, verifier, readQueue, writeQueue, 200, token);
+	peu.processAsynchronously();
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SearchTask<3, 2, uint32_t> const task(0, 5, weightTable);
+	ActiveNodeFinder<3, 2, uint32_t> const activeNodeFinder(weightTable, weightTable.maximumWeight());
+
+	auto * runnerPtr = new ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t>(task, 53, activeNodeFinder);
+	std::unique_ptr<ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t>> runner(runnerPtr);
+	readQueue.put(std::move(runner));
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	peu.stop();
+	CHECK_EQUAL(0, verifier.keysChecked());
+	CHECK(readQueue.nonBlockingTake() != 0);
+}
+
+TEST(PEU_stop_wakesBlockedPEU) {
+	// With a one minute safety net, the PEUs only return promptly if stop() notifies them
+	Queue<SearchTaskRunner<3, 2, uint32_t, uint32_t>> readQueue;
+	Queue<SearchTaskRunner<3, 2, uint32_t, uint32_t>> writeQueue;
+	ListKeyVerifier<6> verifier;
+	CancellationToken token;
+	uint64_t const minute = 60000000000ULL;
+	PEU<3, 2, uint32_t, uint32_t> idlePEU(0, verifier, readQueue, writeQueue, minute, token);
+	idlePEU.processAsynchronously();
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	auto const begin = std::chrono::steady_clock::now();
+	idlePEU.stop();
+
+	token.cancel();
+	PEU<3, 2, uint32_t, uint32_t> cancelledPEU(1, verifier, readQueue, writeQueue, minute, token);
+	cancelledPEU.processAsynchronously();
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	cancelledPEU.stop();
+	CHECK(std::chrono::steady_clock::now() - begin < std::chrono::seconds(5));
+}
+
+TEST(PEU_workStealing_splitsForIdlePEU) {
+	WorkStealingQueues<SearchTaskRunner<3, 2, uint32_t, uint32_t>> readQueues(2);
+	Queue<SearchTaskRunner<3, 2, uint32_t, uint32_t>> writeQueue;
+
+	ListKeyVerifier<6> verifier;
+	CancellationToken token;
+	PEU<3, 2, uint32_t, uint32_t> peu(0, verifier, readQueues, writeQueue, 200, token);
+	CHECK_THROW((PEU<3, 2, uint32_t, uint32_t>(2, verifier, readQueues, writeQueue, 200, token)), std::invalid_argument);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SearchTask<3, 2, uint32_t> const task(0, 5, weightTable);
+	ActiveNodeFinder<3, 2, uint32_t> const activeNodeFinder(weightTable, weightTable.maximumWeight());
+
+	auto * runnerPtr = new ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t>(task, 53, activeNodeFinder);
+	std::unique_ptr<ANFForestSearchTaskRunner<3, 2, uint32_t, uint32_t>> runner(runnerPtr);
+	readQueues.putLocal(0, std::move(runner));
+	// Pretend the second PEU is waiting for work, so that the first PEU shares its task
+	readQueues.setIdle(true);
+	peu.processAsynchronously();
+
+	std::unique_ptr<SearchTaskRunner<3, 2, uint32_t, uint32_t>> produce;
+	uint32_t attempts = 0;
+	while(true) {
+		produce = writeQueue.nonBlockingTake();
+		attempts++;
+		if(produce != 0 || attempts == 5) {
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	peu.stop();
+	CHECK(attempts != 5);
+	if(attempts < 5) {
+		CHECK_EQUAL(2, produce->getTask().getFirstSubkeyEnd());
+		// The PEU keeps stealing and splitting its own work while the other PEU is idle, so verify the remainder here
+		ListKeyVerifier<6> otherVerifier;
+		auto remaining = writeQueue.nonBlockingTake();
+		while(remaining != 0) {
+			remaining = writeQueue.nonBlockingTake();
+		}
+		remaining = readQueues.take(1);
+		while(remaining != 0) {
+			remaining->processSequentially(otherVerifier);
+			remaining = readQueues.take(1);
+		}
+		CHECK_EQUAL(53, verifier.keysChecked() + otherVerifier.keysChecked());
+	}
+}
+
+TEST(PEU_workStealing_splitsRunningTask) {
+	WorkStealingQueues<SearchTaskRunner<2, 8, uint32_t, uint32_t>> readQueues(2);
+	Queue<SearchTaskRunner<2, 8, uint32_t, uint32_t>> writeQueue;
+
+	GatedKeyVerifier<16> gatedVerifier;
+	ListKeyVerifier<16> verifier;
+	CancellationToken token;
+	PEU<2, 8, uint32_t, uint32_t> busyPEU(0, gatedVerifier, readQueues, writeQueue, 200, token);
+	PEU<2, 8, uint32_t, uint32_t> latePEU(1, verifier, readQueues, writeQueue, 200, token);
+
+	// Every key has weight 2, so a single task covers all 65536 keys
+	std::vector<uint32_t> const weights(2 * 256, 1);
+	WeightTable<2, 8, uint32_t> const weightTable(weights);
+	SearchTask<2, 8, uint32_t> const task(0, 3, weightTable);
+	readQueues.putLocal(0, std::unique_ptr<SortedSearchTaskRunner<2, 8, uint32_t, uint32_t>>(new SortedSearchTaskRunner<2, 8, uint32_t, uint32_t>(task, 65536)));
+	busyPEU.processAsynchronously();
+
+	// Only once the first PEU is stuck verifying its first batch does the second PEU start, with nothing left on the deques to steal
+	CHECK(gatedVerifier.waitUntilEntered(std::chrono::seconds(10)));
+	latePEU.processAsynchronously();
+	uint64_t subkeysCompleted = 0;
+	auto completed = writeQueue.blockingTake(std::chrono::seconds(10));
+	CHECK(completed.get() != 0);
+	gatedVerifier.release();
+	while(completed.get() != 0) {
+		subkeysCompleted += completed->getTask().getFirstSubkeyEnd() - completed->getTask().getFirstSubkeyBegin();
+		if(subkeysCompleted == 256) {
+			break;
+		}
+		completed = writeQueue.blockingTake(std::chrono::seconds(10));
+	}
+	busyPEU.stop();
+	latePEU.stop();
+
+	CHECK_EQUAL(256, subkeysCompleted);
+	CHECK(verifier.keysChecked() > 0);
+	CHECK(gatedVerifier.keysChecked() > 0);
+	CHECK_EQUAL(65536, verifier.keysChecked() + gatedVerifier.keysChecked());
+	std::set<std::vector<uint8_t>> keys(verifier.keys().begin(), verifier.keys().end());
+	keys.insert(gatedVerifier.keys().begin(), gatedVerifier.keys().end());
+	CHECK_EQUAL(65536, keys.size());
+}
+
+TEST(PEU_exceptionHandling_wakesWriteQueue) {
+	Queue<SearchTaskRunner<3, 2, uint32_t, uint32_t>> readQueue;
+	Queue<SearchTaskRunner<3, 2, uint32_t, uint32_t>> writeQueue;
+
+	ListKeyVerifier<6> verifier;
+	PEU<3, 2, uint32_t, uint32_t> peu(0, verifier, readQueue, writeQueue, 10000000UL);
+	peu.processAsynchronously();
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> const weightTable(weights);
+	SearchTask<3, 2, uint32_t> const task(0, 5, weightTable);
+	std::unique_ptr<ExceptionThrowingSearchTaskRunner<3, 2, uint32_t, uint32_t>> runner(new ExceptionThrowingSearchTaskRunner<3, 2, uint32_t, uint32_t>(task));
+	auto const start = std::chrono::steady_clock::now();
+	readQueue.put(std::move(runner));
+
+	// No task will complete, but the PEU wakes anyone waiting on the write queue so that the exception is seen promptly
+	CHECK(!writeQueue.blockingTake(std::chrono::seconds(10)));
+	CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+	CHECK(peu.isExceptionThrown());
+	peu.stop();
+}
+
 } /* namespace search */
 } /* namespace labynkyr */
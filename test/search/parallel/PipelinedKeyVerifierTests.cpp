@@ -0,0 +1,196 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * PipelinedKeyVerifierTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/parallel/PipelinedKeyVerifier.hpp"
+
+#include "src/labynkyr/search/parallel/VerifierThread.hpp"
+#include "src/labynkyr/search/verify/ComparisonKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+#include "src/labynkyr/search/CancellationToken.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+class FailingKeyVerifier : public KeyVerifier<16> {
+public:
+	void checkKey(std::vector<uint8_t> const & candidateKeyBytes) override {
+		throw std::runtime_error("Verifier failed");
+	}
+
+	uint64_t keysChecked() const override {
+		return 0;
+	}
+
+	bool success() const override {
+		return false;
+	}
+
+	Key<16> correctKey() override {
+		throw std::logic_error("Key has not been found");
+	}
+
+	void flush() override {}
+};
+
+}
+
+TEST(PipelinedKeyVerifier_flush_verifiesEveryKey) {
+	VerifierThread<16> threadA(std::unique_ptr<KeyVerifier<16>>(new ListKeyVerifier<16>()));
+	VerifierThread<16> threadB(std::unique_ptr<KeyVerifier<16>>(new ListKeyVerifier<16>()));
+	std::vector<VerifierThread<16> *> const threads = {&threadA, &threadB};
+	PipelinedKeyVerifier<16> verifier(threads, 2, 3);
+	threadA.start();
+	threadB.start();
+
+	std::vector<uint8_t> keys(2 * 100);
+	for(uint32_t index = 0 ; index < keys.size() ; index++) {
+		keys[index] = static_cast<uint8_t>(index);
+	}
+	verifier.checkKeys(keys.data(), 99);
+	verifier.checkKey(std::vector<uint8_t>(keys.end() - 2, keys.end()));
+	verifier.flush();
+	CHECK_EQUAL(100, verifier.keysChecked());
+	// Both threads received blocks, and together they verified every key
+	CHECK(threadA.keysChecked() > 0 && threadB.keysChecked() > 0);
+	CHECK_EQUAL(100, threadA.keysChecked() + threadB.keysChecked());
+	CHECK(!verifier.success());
+	CHECK_THROW(verifier.correctKey(), std::logic_error);
+	threadA.stop();
+	threadB.stop();
+}
+
+TEST(PipelinedKeyVerifier_success) {
+	std::vector<uint8_t> const targetKey = {0x08, 0x09};
+	VerifierThread<16> thread(std::unique_ptr<KeyVerifier<16>>(new ComparisonKeyVerifier<16>(targetKey)));
+	std::vector<VerifierThread<16> *> const threads = {&thread};
+	PipelinedKeyVerifier<16> verifier(threads, 4, 4);
+	thread.start();
+
+	std::vector<uint8_t> keys(2 * 10);
+	for(uint32_t index = 0 ; index < keys.size() ; index++) {
+		keys[index] = static_cast<uint8_t>(index);
+	}
+	verifier.checkKeys(keys.data(), 10);
+	verifier.flush();
+	CHECK(verifier.success());
+	CHECK(targetKey == verifier.correctKey().asBytes());
+	// Keys sent once the key is found are not verified
+	verifier.checkKeys(keys.data(), 10);
+	verifier.flush();
+	CHECK_EQUAL(20, verifier.keysChecked());
+	CHECK_EQUAL(8, thread.keysChecked());
+	thread.stop();
+}
+
+TEST(PipelinedKeyVerifier_verifierThreadFails) {
+	VerifierThread<16> thread(std::unique_ptr<KeyVerifier<16>>(new FailingKeyVerifier()));
+	std::vector<VerifierThread<16> *> const threads = {&thread};
+	PipelinedKeyVerifier<16> verifier(threads, 1, 2);
+	thread.start();
+
+	std::vector<uint8_t> const keys(2 * 4, 0);
+	verifier.checkKeys(keys.data(), 2);
+	// The failed thread never drains its queue, so both waiting for a free block and flushing rethrow its exception
+	CHECK_THROW(verifier.checkKeys(keys.data(), 4), std::runtime_error);
+	CHECK_THROW(verifier.flush(), std::runtime_error);
+	CHECK(thread.isExceptionThrown());
+	CHECK_EQUAL(0, thread.keysChecked());
+	thread.stop();
+}
+
+TEST(PipelinedKeyVerifier_cancelled_stopsWaiting) {
+	// The thread is never started, so nothing drains the queue
+	VerifierThread<16> thread(std::unique_ptr<KeyVerifier<16>>(new ListKeyVerifier<16>()));
+	std::vector<VerifierThread<16> *> const threads = {&thread};
+	PipelinedKeyVerifier<16> verifier(threads, 1, 2);
+	CancellationToken token;
+	verifier.setCancellationToken(token);
+
+	std::vector<uint8_t> const keys(2 * 4, 0);
+	auto const start = std::chrono::steady_clock::now();
+	std::thread canceller([&token]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		token.cancel();
+	});
+	// Fills the only block, then waits for another until the token is raised
+	verifier.checkKeys(keys.data(), 4);
+	canceller.join();
+	verifier.flush();
+	CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+	CHECK_EQUAL(4, verifier.keysChecked());
+	CHECK(!verifier.success());
+}
+
+TEST(PipelinedKeyVerifier_constructor_invalid) {
+	std::vector<VerifierThread<16> *> const threads;
+	CHECK_THROW(PipelinedKeyVerifier<16>(threads, 4, 4), std::invalid_argument);
+}
+
+TEST(VerifierThread_addQueue_running) {
+	VerifierThread<16> thread(std::unique_ptr<KeyVerifier<16>>(new ListKeyVerifier<16>()));
+	KeyBlockQueue<16> queue(2, 2);
+	thread.start();
+	CHECK_THROW(thread.addQueue(queue), std::logic_error);
+	thread.stop();
+	thread.addQueue(queue);
+	CHECK_THROW(thread.correctKey(), std::logic_error);
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
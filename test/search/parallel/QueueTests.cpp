@@ -51,7 +51,9 @@
 
 #include <stdint.h>
 
+#include <chrono>
 #include <memory>
+#include <thread>
 
 namespace labynkyr {
 namespace search {
@@ -81,6 +83,38 @@ TEST(Queue_uint32_t_emptyTake) {
 	CHECK(!queue.nonBlockingTake());
 }
 
+TEST(Queue_uint32_t_blockingTake_timeout) {
+	Queue<uint32_t> queue;
+	CHECK(!queue.blockingTake(std::chrono::milliseconds(1)));
+}
+
+TEST(Queue_uint32_t_blockingTake_wokenByPut) {
+	Queue<uint32_t> queue;
+	std::thread producer([&queue]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		queue.put(std::unique_ptr<uint32_t>(new uint32_t(7)));
+	});
+	auto const item = queue.blockingTake(std::chrono::seconds(10));
+	producer.join();
+	CHECK(item.get() != 0);
+	if(item.get() != 0) {
+		CHECK_EQUAL(7, *item);
+	}
+}
+
+TEST(Queue_uint32_t_blockingTake_wakeWaiters) {
+	Queue<uint32_t> queue;
+	auto const start = std::chrono::steady_clock::now();
+	std::thread waker([&queue]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		queue.wakeWaiters();
+	});
+	auto const item = queue.blockingTake(std::chrono::seconds(10));
+	waker.join();
+	CHECK(!item);
+	CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+}
+
 } /* namespace search */
 } /* namespace labynkyr */
 
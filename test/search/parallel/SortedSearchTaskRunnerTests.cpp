@@ -47,6 +47,7 @@
 
 #include "src/labynkyr/search/parallel/SortedSearchTaskRunner.hpp"
 
+#include "src/labynkyr/search/enumerate/SortedWeightTable.hpp"
 #include "src/labynkyr/search/verify/ComparisonKeyVerifier.hpp"
 #include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
 #include "src/labynkyr/search/SearchTask.hpp"
@@ -58,6 +59,8 @@
 
 #include <stdint.h>
 
+#include <memory>
+#include <set>
 #include <vector>
 
 namespace labynkyr {
@@ -122,5 +125,51 @@ TEST(SortedSearchTaskRunner_searchWithSorted_twoVectors_size4) {
 	CHECK_EQUAL(4, verifier.keysChecked());
 }
 
+TEST(SortedSearchTaskRunner_searchWithSorted_sharedSortedWeightTable) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> weightTable(weights);
+	auto const sortedWeightTable = std::make_shared<SortedWeightTable<3, 2, uint32_t, uint32_t> const>(weightTable);
+
+	SearchTask<3, 2, uint32_t> const task1(0, 5, weightTable);
+	SortedSearchTaskRunner<3, 2, uint32_t, uint32_t> runner1(task1, 53, sortedWeightTable);
+	SearchTask<3, 2, uint32_t> const task2(0, 1, weightTable);
+	SortedSearchTaskRunner<3, 2, uint32_t, uint32_t> runner2(task2, 4, sortedWeightTable);
+
+	ListKeyVerifier<6> verifier1;
+	runner1.processSequentially(verifier1);
+	CHECK_EQUAL(53, verifier1.keysChecked());
+	ListKeyVerifier<6> verifier2;
+	runner2.processSequentially(verifier2);
+	CHECK_EQUAL(4, verifier2.keysChecked());
+}
+
+TEST(SortedSearchTaskRunner_split_coversTask) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0, 1, 1, 0, 1};
+	WeightTable<3, 2, uint32_t> weightTable(weights);
+
+	SearchTask<3, 2, uint32_t> const task(0, 5, weightTable);
+	SortedSearchTaskRunner<3, 2, uint32_t, uint32_t> runner(task, 53);
+	auto halves = runner.split();
+	CHECK(halves.first.get() != 0 && halves.second.get() != 0);
+	CHECK(BigInt<6>(53) == halves.first->size() + halves.second->size());
+
+	ListKeyVerifier<6> verifier;
+	halves.first->processSequentially(verifier);
+	halves.second->processSequentially(verifier);
+	CHECK_EQUAL(53, verifier.keysChecked());
+	// Every key should be verified exactly once
+	std::set<std::vector<uint8_t>> const uniqueKeys(verifier.keys().begin(), verifier.keys().end());
+	CHECK_EQUAL(53, uniqueKeys.size());
+}
+
+TEST(SortedSearchTaskRunner_split_singleSubkey) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> weightTable(weights);
+
+	SearchTask<2, 2, uint32_t> const task(0, 6, weightTable, 2, 3);
+	SortedSearchTaskRunner<2, 2, uint32_t, uint32_t> runner(task, 4);
+	CHECK(runner.split().first.get() == 0);
+}
+
 } /* namespace search */
 } /* namespace labynkyr */
@@ -47,24 +47,70 @@
 
 #include "src/labynkyr/search/parallel/WorkScheduler.hpp"
 
+#include "src/labynkyr/search/parallel/InterruptMonitor.hpp"
 #include "src/labynkyr/search/parallel/PEUPool.hpp"
 #include "src/labynkyr/search/verify/ComparisonKeyVerifier.hpp"
 #include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+#include "src/labynkyr/search/AdaptiveTaskSizer.hpp"
 #include "src/labynkyr/search/EffortAllocation.hpp"
+#include "src/labynkyr/search/SearchCheckpoint.hpp"
 #include "src/labynkyr/search/SearchSpec.hpp"
+#include "src/labynkyr/search/SearchTaskStream.hpp"
 #include "src/labynkyr/BigInt.hpp"
 #include "src/labynkyr/WeightTable.hpp"
 
 #include <unittest++/UnitTest++.h>
 
+#include <signal.h>
 #include <stdint.h>
+#include <stdio.h>
 
+#include <chrono>
+#include <csignal>
+#include <memory>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 namespace labynkyr {
 namespace search {
 
+namespace {
+
+/**
+ *
+ * A verifier that fails on every key, so that the PEUs using it throw
+ */
+class FailingKeyVerifier : public KeyVerifier<4> {
+public:
+	void checkKey(std::vector<uint8_t> const & candidateKeyBytes) override {
+		throw std::logic_error("Verifier failed");
+	}
+
+	uint64_t keysChecked() const override {
+		return 0;
+	}
+
+	bool success() const override {
+		return false;
+	}
+
+	Key<4> correctKey() override {
+		throw std::logic_error("Key has not been found");
+	}
+
+	void flush() override {}
+};
+
+class FailingKeyVerifierFactory : public KeyVerifierFactory<4> {
+public:
+	std::unique_ptr<KeyVerifier<4>> newVerifier() const override {
+		return std::unique_ptr<KeyVerifier<4>>(new FailingKeyVerifier());
+	}
+};
+
+}
+
 TEST(WorkScheduler_size15_fail) {
 	std::vector<uint8_t> const targetKey = {0x0A}; // Any key other than 0x0A should verify
 	ComparisonKeyVerifierFactory<4> verifierFactory(targetKey);
@@ -110,6 +156,243 @@ TEST(WorkScheduler_size15_success) {
 	CHECK_ARRAY_EQUAL(targetKey, foundKey.asBytes(), targetKey.size());
 }
 
+TEST(WorkScheduler_checkpoint_runAndResume) {
+	std::string const path = "WorkScheduler_checkpoint_runAndResume.checkpoint";
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> effort(SearchSpec<4>(0, 15), weightTable, 0);
+
+	SearchCheckpoint<2, 2, uint32_t> checkpoint(weightTable, effort.getAllocatedTasks());
+	// Pretend the first two tasks were completed by an earlier run
+	checkpoint.markCompleted(SearchTask<2, 2, uint32_t>(0, 1, weightTable));
+	checkpoint.markCompleted(SearchTask<2, 2, uint32_t>(1, 2, weightTable));
+	checkpoint.save(path);
+
+	ListKeyVerifierFactory<4> verifierFactory;
+	PEUPool<2, 2, uint32_t, uint32_t> pool(2, verifierFactory, 2, 200UL);
+	SearchCheckpoint<2, 2, uint32_t> resumed(weightTable, path);
+	WorkScheduler<2, 2, uint32_t, uint32_t> scheduler(100UL);
+	scheduler.runSearch(pool, resumed, path, std::chrono::milliseconds(1));
+	CHECK(!scheduler.wasLastSearchInterrupted());
+	// Only the keys in the unfinished tasks are verified
+	CHECK_EQUAL(9, pool.keysVerified());
+	CHECK_EQUAL(6, resumed.completedCount());
+
+	SearchCheckpoint<2, 2, uint32_t> finished(weightTable, path);
+	CHECK_EQUAL(6, finished.completedCount());
+	CHECK_EQUAL(0, finished.remainingTasks().size());
+
+	// Resuming a finished search does no work
+	PEUPool<2, 2, uint32_t, uint32_t> secondPool(2, verifierFactory, 2, 200UL);
+	scheduler.runSearch(secondPool, finished, path, std::chrono::milliseconds(1));
+	CHECK_EQUAL(0, secondPool.keysVerified());
+
+	remove(path.c_str());
+	remove((path + ".tmp").c_str());
+}
+
+TEST(WorkScheduler_checkpoint_peuExceptionSurvivesFailedSave) {
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> effort(SearchSpec<4>(0, 15), weightTable, 0);
+	SearchCheckpoint<2, 2, uint32_t> checkpoint(weightTable, effort.getAllocatedTasks());
+
+	FailingKeyVerifierFactory verifierFactory;
+	PEUPool<2, 2, uint32_t, uint32_t> pool(2, verifierFactory, 2, 200UL);
+	WorkScheduler<2, 2, uint32_t, uint32_t> scheduler(100UL);
+	// The checkpoint cannot be written, and no periodic save is due before the PEUs fail
+	CHECK_THROW(scheduler.runSearch(pool, checkpoint, "no-such-directory/search.checkpoint", std::chrono::hours(1)), std::logic_error);
+}
+
+TEST(InterruptMonitor_signal) {
+	InterruptMonitor::install();
+	CHECK(!InterruptMonitor::isInterrupted());
+	std::raise(SIGTERM);
+	CHECK(InterruptMonitor::isInterrupted());
+	InterruptMonitor::install();
+	CHECK(!InterruptMonitor::isInterrupted());
+	InterruptMonitor::uninstall();
+}
+
+namespace {
+
+void hostHandler(int) {}
+
+bool hostHandlerInstalled() {
+	struct sigaction current;
+	sigaction(SIGTERM, 0, &current);
+	return current.sa_handler == hostHandler;
+}
+
+}
+
+TEST(InterruptMonitor_uninstall_restoresPreviousHandler) {
+	std::signal(SIGTERM, hostHandler);
+	InterruptMonitor::install();
+	CHECK(!hostHandlerInstalled());
+	// Installing twice must not save the monitor's own handler over the host's
+	InterruptMonitor::install();
+	InterruptMonitor::uninstall();
+	CHECK(hostHandlerInstalled());
+	std::signal(SIGTERM, SIG_DFL);
+}
+
+TEST(WorkScheduler_morePEUsThanTasks_verifiesEveryKey) {
+	std::vector<uint8_t> const targetKey = {0x0A}; // Outside the 15 most likely keys
+	ComparisonKeyVerifierFactory<4> verifierFactory(targetKey);
+	PEUPool<2, 2, uint32_t, uint32_t> pool(4, verifierFactory, 4, 200UL);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> effort(SearchSpec<4>(0, 15), weightTable, 4); // A single task
+
+	WorkScheduler<2, 2, uint32_t, uint32_t> scheduler(100UL);
+	scheduler.runSearch(pool, effort);
+	CHECK(!pool.isKeyFound());
+	CHECK_EQUAL(15, pool.keysVerified());
+}
+
+TEST(WorkScheduler_lockFreeWriteQueue_success) {
+	std::vector<uint8_t> const targetKey = {0x06};
+	ComparisonKeyVerifierFactory<4> verifierFactory(targetKey);
+	PEUPool<2, 2, uint32_t, uint32_t> pool(3, verifierFactory, 3, 10000000UL, LockFreeQueueImplementation);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> effort(SearchSpec<4>(0, 15), weightTable, 0);
+
+	// A long timeout: the scheduler must be woken by completed tasks, not by polling
+	WorkScheduler<2, 2, uint32_t, uint32_t> scheduler(10000000000UL);
+	scheduler.runSearch(pool, effort);
+	CHECK(pool.isKeyFound());
+	CHECK(scheduler.getLastTotalTimeTaken() < std::chrono::seconds(5));
+}
+
+TEST(WorkScheduler_stream_verifiesEveryKey) {
+	ListKeyVerifierFactory<4> verifierFactory;
+	PEUPool<2, 2, uint32_t, uint32_t> pool(2, verifierFactory, 2, 10000000UL);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	SearchTaskStream<2, 2, uint32_t> stream(SearchSpec<4>(0, 15), weightTable, 0);
+
+	// A single task outstanding at a time
+	WorkScheduler<2, 2, uint32_t, uint32_t> scheduler(10000000UL);
+	scheduler.runSearch(pool, stream, 1);
+	CHECK(!stream.isTasksAvailable());
+	CHECK_EQUAL(15, pool.keysVerified());
+}
+
+TEST(WorkScheduler_stream_success) {
+	std::vector<uint8_t> const targetKey = {0x06};
+	ComparisonKeyVerifierFactory<4> verifierFactory(targetKey);
+	PEUPool<2, 2, uint32_t, uint32_t> pool(3, verifierFactory, 3, 10000000UL);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	SearchTaskStream<2, 2, uint32_t> stream(SearchSpec<4>(0, 15), weightTable, 0);
+
+	WorkScheduler<2, 2, uint32_t, uint32_t> scheduler(10000000UL);
+	scheduler.runSearch(pool, stream);
+	CHECK(pool.isKeyFound());
+	auto const foundKey = pool.correctKey();
+	CHECK_ARRAY_EQUAL(targetKey, foundKey.asBytes(), targetKey.size());
+}
+
+TEST(WorkScheduler_stream_zeroLookAhead) {
+	ListKeyVerifierFactory<4> verifierFactory;
+	PEUPool<2, 2, uint32_t, uint32_t> pool(1, verifierFactory, 1, 10000000UL);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	SearchTaskStream<2, 2, uint32_t> stream(SearchSpec<4>(0, 15), weightTable, 0);
+
+	WorkScheduler<2, 2, uint32_t, uint32_t> scheduler(10000000UL);
+	CHECK_THROW(scheduler.runSearch(pool, stream, 0), std::invalid_argument);
+}
+
+TEST(WorkScheduler_adaptiveStream_verifiesEveryKey) {
+	ListKeyVerifierFactory<4> verifierFactory;
+	PEUPool<2, 2, uint32_t, uint32_t> pool(2, verifierFactory, 2, 10000000UL);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	AdaptiveTaskSizer<4> sizer(std::chrono::milliseconds(1), 0.0, 0.0, 2.0);
+	SearchTaskStream<2, 2, uint32_t> stream(SearchSpec<4>(0, 15), weightTable, 0, sizer);
+
+	WorkScheduler<2, 2, uint32_t, uint32_t> scheduler(10000000UL);
+	scheduler.runSearch(pool, stream, 1);
+	CHECK_EQUAL(15, pool.keysVerified());
+	// Every task but the first (Sorted) task is measured
+	CHECK(sizer.sampleCount() > 0);
+}
+
+TEST(WorkScheduler_taskMemoryBudget_verifiesEveryKey) {
+	ListKeyVerifierFactory<4> verifierFactory;
+	PEUPool<2, 2, uint32_t, uint32_t> pool(2, verifierFactory, 2, 10000000UL);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> effort(SearchSpec<4>(0, 15), weightTable, 0);
+
+	// Too small for any candidate keys to be stored, so every ANF/Forest task falls back to Sorted
+	WorkScheduler<2, 2, uint32_t, uint32_t> scheduler(10000000UL);
+	scheduler.setTaskMemoryBudget(1);
+	CHECK_EQUAL(1, scheduler.getTaskMemoryBudget());
+	scheduler.runSearch(pool, effort);
+	CHECK_EQUAL(15, pool.keysVerified());
+	std::vector<uint64_t> const peakBytes = pool.peakMemoryBytes();
+	CHECK_EQUAL(2, peakBytes.size());
+	CHECK_EQUAL(0, peakBytes[0] + peakBytes[1]);
+}
+
+TEST(WorkScheduler_peakMemoryPerPEU) {
+	ListKeyVerifierFactory<4> verifierFactory;
+	PEUPool<2, 2, uint32_t, uint32_t> pool(2, verifierFactory, 2, 10000000UL);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> effort(SearchSpec<4>(0, 15), weightTable, 0);
+
+	WorkScheduler<2, 2, uint32_t, uint32_t> scheduler(10000000UL);
+	scheduler.runSearch(pool, effort);
+	CHECK_EQUAL(15, pool.keysVerified());
+	std::vector<uint64_t> const peakBytes = pool.peakMemoryBytes();
+	CHECK_EQUAL(2, peakBytes.size());
+	// At least one ANF/Forest task stored candidate keys
+	CHECK(peakBytes[0] + peakBytes[1] > 0);
+}
+
+TEST(WorkScheduler_orderedMethod_verifiesEveryKey) {
+	ListKeyVerifierFactory<4> verifierFactory;
+	PEUPool<2, 2, uint32_t, uint32_t> pool(2, verifierFactory, 2, 10000000UL);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	EffortAllocation<2, 2, uint32_t> effort(SearchSpec<4>(0, 15), weightTable, 0);
+
+	WorkScheduler<2, 2, uint32_t, uint32_t> scheduler(10000000UL);
+	CHECK_EQUAL(ANFForestSearchMethod, scheduler.getTaskSearchMethod());
+	scheduler.setTaskSearchMethod(OrderedSearchMethod);
+	scheduler.runSearch(pool, effort);
+	CHECK_EQUAL(15, pool.keysVerified());
+}
+
+TEST(WorkScheduler_orderedMethod_success) {
+	std::vector<uint8_t> const targetKey = {0x06};
+	ComparisonKeyVerifierFactory<4> verifierFactory(targetKey);
+	PEUPool<2, 2, uint32_t, uint32_t> pool(2, verifierFactory, 2, 10000000UL);
+
+	std::vector<uint32_t> const weights = {0, 1, 3, 0, 0, 2, 3, 0};
+	WeightTable<2, 2, uint32_t> const weightTable(weights);
+	SearchTaskStream<2, 2, uint32_t> stream(SearchSpec<4>(0, 15), weightTable, 0);
+
+	WorkScheduler<2, 2, uint32_t, uint32_t> scheduler(10000000UL);
+	scheduler.setTaskSearchMethod(OrderedSearchMethod);
+	scheduler.runSearch(pool, stream);
+	CHECK(pool.isKeyFound());
+}
+
 } /* namespace search */
 } /* namespace labynkyr */
 
@@ -0,0 +1,178 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * WorkStealingQueuesTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/parallel/WorkStealingQueues.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace labynkyr {
+namespace search {
+
+TEST(WorkStealingQueues_noWorkers) {
+	CHECK_THROW(WorkStealingQueues<uint32_t> queues(0), std::invalid_argument);
+}
+
+TEST(WorkStealingQueues_put_roundRobin) {
+	WorkStealingQueues<uint32_t> queues(2);
+	CHECK(queues.isEmpty());
+	for(uint32_t value = 0 ; value < 3 ; value++) {
+		queues.put(std::unique_ptr<uint32_t>(new uint32_t(value)));
+	}
+	CHECK_EQUAL(2, queues.size(0));
+	CHECK_EQUAL(1, queues.size(1));
+	CHECK_EQUAL(0, *queues.take(0));
+	CHECK_EQUAL(1, *queues.take(1));
+	CHECK_EQUAL(2, *queues.take(0));
+	CHECK(queues.isEmpty());
+	CHECK(queues.take(0).get() == 0);
+}
+
+TEST(WorkStealingQueues_putLocal_takenFirst) {
+	WorkStealingQueues<uint32_t> queues(1);
+	queues.put(std::unique_ptr<uint32_t>(new uint32_t(1)));
+	queues.putLocal(0, std::unique_ptr<uint32_t>(new uint32_t(2)));
+	CHECK_EQUAL(2, *queues.take(0));
+	CHECK_EQUAL(1, *queues.take(0));
+}
+
+TEST(WorkStealingQueues_take_stealsFromBack) {
+	WorkStealingQueues<uint32_t> queues(3);
+	queues.putLocal(1, std::unique_ptr<uint32_t>(new uint32_t(1)));
+	queues.putLocal(1, std::unique_ptr<uint32_t>(new uint32_t(2)));
+	// Worker 0 has no work of its own, so steals the oldest item from worker 1
+	CHECK_EQUAL(1, *queues.take(0));
+	CHECK_EQUAL(0, queues.size(0));
+	CHECK_EQUAL(1, queues.size(1));
+	CHECK_EQUAL(2, *queues.take(2));
+	CHECK(queues.isEmpty());
+}
+
+TEST(WorkStealingQueues_idleCount) {
+	WorkStealingQueues<uint32_t> queues(2);
+	CHECK_EQUAL(0, queues.idleCount());
+	queues.setIdle(true);
+	queues.setIdle(true);
+	CHECK_EQUAL(2, queues.idleCount());
+	queues.setIdle(false);
+	CHECK_EQUAL(1, queues.idleCount());
+}
+
+TEST(WorkStealingQueues_take_timeout) {
+	WorkStealingQueues<uint32_t> queues(2);
+	CHECK(queues.take(0, std::chrono::milliseconds(1)).get() == 0);
+}
+
+TEST(WorkStealingQueues_take_wokenByPut) {
+	WorkStealingQueues<uint32_t> queues(2);
+	std::thread producer([&queues]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		queues.putLocal(1, std::unique_ptr<uint32_t>(new uint32_t(3)));
+	});
+	auto const item = queues.take(0, std::chrono::seconds(10));
+	producer.join();
+	CHECK(item.get() != 0);
+	if(item.get() != 0) {
+		CHECK_EQUAL(3, *item);
+	}
+}
+
+TEST(WorkStealingQueues_take_wakeAll) {
+	WorkStealingQueues<uint32_t> queues(2);
+	auto const start = std::chrono::steady_clock::now();
+	std::thread waker([&queues]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		queues.wakeAll();
+	});
+	auto const item = queues.take(0, std::chrono::seconds(10));
+	waker.join();
+	CHECK(item.get() == 0);
+	CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+}
+
+TEST(WorkStealingQueues_take_splitsRunningItem) {
+	WorkStealingQueues<uint32_t> queues(2);
+	uint32_t remaining = 2;
+	queues.setRunning(1, [&remaining]() {
+		return (remaining > 0) ? std::unique_ptr<uint32_t>(new uint32_t(remaining--)) : std::unique_ptr<uint32_t>();
+	});
+	// Queued items are still taken first
+	queues.put(std::unique_ptr<uint32_t>(new uint32_t(7)));
+	CHECK_EQUAL(7, *queues.take(0));
+	CHECK_EQUAL(2, *queues.take(0));
+	// A worker never splits its own running item
+	CHECK(queues.take(1).get() == 0);
+	CHECK_EQUAL(1, *queues.take(0));
+	CHECK(queues.take(0).get() == 0);
+	remaining = 1;
+	queues.clearRunning(1);
+	CHECK(queues.take(0).get() == 0);
+	CHECK_EQUAL(1, remaining);
+}
+
+TEST(WorkStealingQueues_take_wokenBySetRunning) {
+	WorkStealingQueues<uint32_t> queues(2);
+	std::thread runner([&queues]() {
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		queues.setRunning(1, []() { return std::unique_ptr<uint32_t>(new uint32_t(4)); });
+	});
+	auto const item = queues.take(0, std::chrono::seconds(10));
+	runner.join();
+	CHECK(item.get() != 0);
+	if(item.get() != 0) {
+		CHECK_EQUAL(4, *item);
+	}
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -0,0 +1,129 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * AES128KernelsTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/verify/AES128Kernels.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(AES128Kernels_encrypt_fips197) {
+	std::vector<uint8_t> const key = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+	std::vector<uint8_t> const plaintext = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+	std::vector<uint8_t> const ciphertext = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+
+	for(AES128Kernel const kernel : AES128Kernels::supported()) {
+		uint32_t const keyCount = AES128Kernels::keysPerCall(kernel);
+		// The known key in every position
+		for(uint32_t position = 0 ; position < keyCount ; position++) {
+			std::vector<uint8_t> keys(keyCount * 16, 0xA5);
+			std::copy(key.begin(), key.end(), keys.begin() + position * 16);
+			std::vector<uint8_t> ciphertexts(keyCount * 16);
+			AES128Kernels::encrypt(kernel, keys.data(), plaintext.data(), ciphertexts.data());
+			CHECK(std::equal(ciphertext.begin(), ciphertext.end(), ciphertexts.begin() + position * 16));
+		}
+	}
+}
+
+TEST(AES128Kernels_encrypt_matchAESNI4) {
+	std::vector<uint8_t> const plaintext = {0x32, 0x43, 0xf6, 0xa8, 0x88, 0x5a, 0x30, 0x8d, 0x31, 0x31, 0x98, 0xa2, 0xe0, 0x37, 0x07, 0x34};
+	std::vector<uint8_t> keys(16 * 16);
+	for(uint32_t index = 0 ; index < keys.size() ; index++) {
+		keys[index] = static_cast<uint8_t>(index * 73 + 19);
+	}
+	std::vector<uint8_t> expected(16 * 16);
+	for(uint32_t keyIndex = 0 ; keyIndex < 16 ; keyIndex += 4) {
+		AES128Kernels::encryptAESNI4(keys.data() + keyIndex * 16, plaintext.data(), expected.data() + keyIndex * 16);
+	}
+	for(AES128Kernel const kernel : AES128Kernels::supported()) {
+		uint32_t const keyCount = AES128Kernels::keysPerCall(kernel);
+		std::vector<uint8_t> ciphertexts(16 * 16);
+		for(uint32_t keyIndex = 0 ; keyIndex < 16 ; keyIndex += keyCount) {
+			AES128Kernels::encrypt(kernel, keys.data() + keyIndex * 16, plaintext.data(), ciphertexts.data() + keyIndex * 16);
+		}
+		CHECK(expected == ciphertexts);
+	}
+}
+
+TEST(AES128Kernels_invertKeySchedule4_fips197) {
+	// FIPS-197 Appendix A.1 and C.1: cipher keys and their round 10 keys, in positions 1 and 3
+	std::vector<uint8_t> const keyA = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c};
+	std::vector<uint8_t> const lastRoundKeyA = {0xd0, 0x14, 0xf9, 0xa8, 0xc9, 0xee, 0x25, 0x89, 0xe1, 0x3f, 0x0c, 0xc8, 0xb6, 0x63, 0x0c, 0xa6};
+	std::vector<uint8_t> const keyC = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+	std::vector<uint8_t> const lastRoundKeyC = {0x13, 0x11, 0x1d, 0x7f, 0xe3, 0x94, 0x4a, 0x17, 0xf3, 0x07, 0xa7, 0x8b, 0x4d, 0x2b, 0x30, 0xc5};
+	std::vector<uint8_t> lastRoundKeys(64, 0x5A);
+	std::copy(lastRoundKeyA.begin(), lastRoundKeyA.end(), lastRoundKeys.begin() + 16);
+	std::copy(lastRoundKeyC.begin(), lastRoundKeyC.end(), lastRoundKeys.begin() + 48);
+	std::vector<uint8_t> keys(64);
+	AES128Kernels::invertKeySchedule4(lastRoundKeys.data(), keys.data());
+	CHECK(std::equal(keyA.begin(), keyA.end(), keys.begin() + 16));
+	CHECK(std::equal(keyC.begin(), keyC.end(), keys.begin() + 48));
+}
+
+TEST(AES128Kernels_fastestSupported) {
+	std::vector<AES128Kernel> const kernels = AES128Kernels::supported();
+	CHECK(!kernels.empty());
+	CHECK_EQUAL(kernels.back(), AES128Kernels::widestSupported());
+	// Calibrated once, so every call agrees
+	AES128Kernel const fastest = AES128Kernels::fastestSupported();
+	CHECK(std::find(kernels.begin(), kernels.end(), fastest) != kernels.end());
+	CHECK_EQUAL(fastest, AES128Kernels::fastestSupported());
+	CHECK_EQUAL(AESNI4Kernel, AES128Kernels::fastestOf(std::vector<AES128Kernel>(1, AESNI4Kernel)));
+	CHECK_THROW(AES128Kernels::fastestOf(std::vector<AES128Kernel>()), std::runtime_error);
+	CHECK_EQUAL(16, AES128Kernels::keysPerCall(VAES512Kernel));
+	CHECK_EQUAL("AES-NI x8", AES128Kernels::name(AESNI8Kernel));
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -0,0 +1,101 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * AES128LastRoundKeyVerifierTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/verify/AES128LastRoundKeyVerifier.hpp"
+#include "test/search/verify/VerifierTestKeys.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(AES128LastRoundKeyVerifier_masterKey) {
+	std::vector<uint8_t> const key = AES128LastRoundKeyVerifier::masterKey(fipsLastRoundKey);
+	CHECK_ARRAY_EQUAL(fipsKey, key, fipsKey.size());
+	CHECK_THROW(AES128LastRoundKeyVerifier::masterKey(std::vector<uint8_t>(15)), std::invalid_argument);
+}
+
+TEST(AES128LastRoundKeyVerifier_eachKernel_matchInEverySlot) {
+	// The key schedule is inverted four keys at a time: every lane must be inverted, and the round 10 key reported rather than the cipher key
+	for(AES128Kernel const kernel : AES128Kernels::supported()) {
+		uint32_t const keysPerCall = AES128Kernels::keysPerCall(kernel);
+		for(uint32_t position = 0 ; position < keysPerCall ; position++) {
+			std::vector<uint8_t> const block = keyBlock(fipsLastRoundKey, keysPerCall, position);
+			AES128LastRoundKeyVerifier verifier(fipsPlaintext, fipsCiphertext, kernel);
+			verifier.checkKeys(block.data() + 1, keysPerCall);
+			CHECK(verifier.success());
+			CHECK_ARRAY_EQUAL(fipsLastRoundKey, verifier.correctKey().asBytes(), fipsLastRoundKey.size());
+		}
+	}
+}
+
+TEST(AES128LastRoundKeyVerifier_cipherKeyRejected) {
+	for(AES128Kernel const kernel : AES128Kernels::supported()) {
+		AES128LastRoundKeyVerifier verifier(fipsPlaintext, fipsCiphertext, kernel);
+		verifier.checkKey(fipsKey);
+		verifier.flush();
+		CHECK(!verifier.success());
+		CHECK_THROW(verifier.correctKey(), std::logic_error);
+	}
+}
+
+TEST(AES128LastRoundKeyVerifierFactory_newVerifier) {
+	AES128LastRoundKeyVerifierFactory verifierFactory(fipsPlaintext, fipsCiphertext);
+	CHECK_EQUAL(AES128Kernels::fastestSupported(), verifierFactory.getKernel());
+	auto verifier = verifierFactory.newVerifier();
+	verifier->checkKey(fipsLastRoundKey);
+	verifier->flush();
+	CHECK(verifier->success());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
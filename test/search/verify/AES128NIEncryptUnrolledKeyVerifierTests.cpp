@@ -169,6 +169,56 @@ TEST(AES128NIEncryptUnrolledKeyVerifier_twoBatch_flush) {
 	CHECK_ARRAY_EQUAL(key, verifier.correctKey().asBytes(), key.size());
 }
 
+TEST(AES128NIEncryptUnrolledKeyVerifier_checkKeys) {
+	std::vector<uint8_t> const key = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+	std::vector<uint8_t> const plaintext = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+	std::vector<uint8_t> const ciphertext = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+
+	std::vector<uint8_t> const k1 = {0x01, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+
+	// Six wrong keys followed by the correct key, offset by one byte so that the block is not aligned
+	std::vector<uint8_t> block(1);
+	for(uint32_t index = 0 ; index < 6 ; index++) {
+		block.insert(block.end(), k1.begin(), k1.end());
+	}
+	block.insert(block.end(), key.begin(), key.end());
+
+	AES128NIEncryptUnrolledKeyVerifier verifier(plaintext, ciphertext);
+	verifier.checkKeys(block.data() + 1, 4);
+	CHECK(!verifier.success());
+	CHECK_EQUAL(4, verifier.keysChecked());
+	verifier.checkKeys(block.data() + 1 + 4 * 16, 3);
+	CHECK_EQUAL(7, verifier.keysChecked());
+	// The final three keys are buffered until a flush
+	CHECK(!verifier.success());
+	verifier.flush();
+	CHECK(verifier.success());
+	CHECK_ARRAY_EQUAL(key, verifier.correctKey().asBytes(), key.size());
+}
+
+TEST(AES128NIEncryptUnrolledKeyVerifier_checkKeys_afterCheckKey) {
+	std::vector<uint8_t> const key = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+	std::vector<uint8_t> const plaintext = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+	std::vector<uint8_t> const ciphertext = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+
+	std::vector<uint8_t> const k1 = {0x01, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+
+	std::vector<uint8_t> block;
+	for(uint32_t index = 0 ; index < 7 ; index++) {
+		block.insert(block.end(), k1.begin(), k1.end());
+	}
+	block.insert(block.end(), key.begin(), key.end());
+
+	AES128NIEncryptUnrolledKeyVerifier verifier(plaintext, ciphertext);
+	verifier.checkKey(k1);
+	verifier.checkKey(k1);
+	// Tops up the partially filled buffer, then encrypts the final four keys in place
+	verifier.checkKeys(block.data() + 2 * 16, 6);
+	CHECK(verifier.success());
+	CHECK_EQUAL(8, verifier.keysChecked());
+	CHECK_ARRAY_EQUAL(key, verifier.correctKey().asBytes(), key.size());
+}
+
 TEST(AES128NIEncryptUnrolledKeyVerifier_vector1_factory) {
 	std::vector<uint8_t> const key = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
 	std::vector<uint8_t> const plaintext = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
@@ -0,0 +1,110 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * AESLongKeyKernelsTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/verify/AESLongKeyKernels.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+std::vector<uint8_t> const fipsPlaintext = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+// FIPS-197 appendix C.2
+std::vector<uint8_t> const fips192Ciphertext = {0xdd, 0xa9, 0x7c, 0xa4, 0x86, 0x4c, 0xdf, 0xe0, 0x6e, 0xaf, 0x70, 0xa0, 0xec, 0x0d, 0x71, 0x91};
+// FIPS-197 appendix C.3
+std::vector<uint8_t> const fips256Ciphertext = {0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf, 0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89};
+
+/**
+ *
+ * Every kernel encrypts a block of 8 keys holding the FIPS-197 key 00 01 02 ... at position 5.  The other keys differ from it in one bit
+ * of their last byte, so that an error in the last words of the key schedule is caught.
+ */
+template<uint32_t KeyLenBits>
+void checkKernels(std::vector<uint8_t> const & expectedCiphertext) {
+	uint32_t const keyLenBytes = KeyLenBits / 8;
+	std::vector<uint8_t> keys(1 + 8 * keyLenBytes);
+	for(uint32_t keyIndex = 0 ; keyIndex < 8 ; keyIndex++) {
+		for(uint32_t byteIndex = 0 ; byteIndex < keyLenBytes ; byteIndex++) {
+			keys[1 + keyIndex * keyLenBytes + byteIndex] = static_cast<uint8_t>(byteIndex);
+		}
+		if(keyIndex != 5) {
+			keys[(keyIndex + 1) * keyLenBytes] ^= 0x80;
+		}
+	}
+	for(AESLongKeyKernel const kernel : {AESNI4LongKeyKernel, AESNI8LongKeyKernel}) {
+		uint32_t const keyCount = AESLongKeyKernels<KeyLenBits>::keysPerCall(kernel);
+		std::vector<uint8_t> ciphertexts(keyCount * 16);
+		AESLongKeyKernels<KeyLenBits>::encrypt(kernel, keys.data() + 1, fipsPlaintext.data(), ciphertexts.data());
+		for(uint32_t keyIndex = 0 ; keyIndex < keyCount ; keyIndex++) {
+			bool const matches = std::equal(expectedCiphertext.begin(), expectedCiphertext.end(), ciphertexts.begin() + keyIndex * 16);
+			CHECK_EQUAL(keyIndex == 5, matches);
+		}
+	}
+	std::vector<uint8_t> ciphertext(16);
+	AESLongKeyKernels<KeyLenBits>::encryptOne(keys.data() + 1 + 5 * keyLenBytes, fipsPlaintext.data(), ciphertext.data());
+	CHECK_ARRAY_EQUAL(expectedCiphertext, ciphertext, 16);
+}
+
+}
+
+TEST(AESLongKeyKernels_encrypt_fips197AES192) {
+	checkKernels<192>(fips192Ciphertext);
+}
+
+TEST(AESLongKeyKernels_encrypt_fips197AES256) {
+	checkKernels<256>(fips256Ciphertext);
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -0,0 +1,152 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * AESLongKeyVerifierTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/verify/AESLongKeyVerifier.hpp"
+#include "test/search/verify/VerifierTestKeys.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+// NIST SP 800-38A F.1.3 and F.1.5: the first two blocks of ECB-AES192.Encrypt and ECB-AES256.Encrypt
+std::vector<uint8_t> const aes192Key = {0x8e, 0x73, 0xb0, 0xf7, 0xda, 0x0e, 0x64, 0x52, 0xc8, 0x10, 0xf3, 0x2b, 0x80, 0x90, 0x79, 0xe5,
+		0x62, 0xf8, 0xea, 0xd2, 0x52, 0x2c, 0x6b, 0x7b};
+std::vector<uint8_t> const aes256Key = {0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81,
+		0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4};
+std::vector<uint8_t> const plaintext1 = {0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a};
+std::vector<uint8_t> const plaintext2 = {0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51};
+std::vector<uint8_t> const aes192Ciphertext1 = {0xbd, 0x33, 0x4f, 0x1d, 0x6e, 0x45, 0xf2, 0x5f, 0xf7, 0x12, 0xa2, 0x14, 0x57, 0x1f, 0xa5, 0xcc};
+std::vector<uint8_t> const aes192Ciphertext2 = {0x97, 0x41, 0x04, 0x84, 0x6d, 0x0a, 0xd3, 0xad, 0x77, 0x34, 0xec, 0xb3, 0xec, 0xee, 0x4e, 0xef};
+std::vector<uint8_t> const aes256Ciphertext1 = {0xf3, 0xee, 0xd1, 0xbd, 0xb5, 0xd2, 0xa0, 0x3c, 0x06, 0x4b, 0x5a, 0x7e, 0x3d, 0xb1, 0x81, 0xf8};
+std::vector<uint8_t> const aes256Ciphertext2 = {0x59, 0x1c, 0xcb, 0x10, 0xd4, 0x10, 0xed, 0x26, 0xdc, 0x5b, 0xa7, 0x4a, 0x31, 0x36, 0x28, 0x70};
+
+/**
+ *
+ * Check that each kernel finds the key in every slot of a group, confirming it on the second block exactly once
+ */
+template<uint32_t KeyLenBits>
+void checkEverySlot(std::vector<uint8_t> const & key, std::vector<uint8_t> const & ciphertext1, std::vector<uint8_t> const & ciphertext2) {
+	for(AESLongKeyKernel const kernel : {AESNI4LongKeyKernel, AESNI8LongKeyKernel}) {
+		uint32_t const keysPerCall = AESLongKeyKernels<KeyLenBits>::keysPerCall(kernel);
+		for(uint32_t position = 0 ; position < keysPerCall ; position++) {
+			std::vector<uint8_t> const block = keyBlock(key, keysPerCall, position);
+			AESLongKeyVerifier<KeyLenBits> verifier(plaintext1, ciphertext1, plaintext2, ciphertext2, kernel);
+			verifier.checkKeys(block.data() + 1, keysPerCall);
+			CHECK(verifier.success());
+			CHECK_EQUAL(1, verifier.confirmationsRun());
+			CHECK_ARRAY_EQUAL(key, verifier.correctKey().asBytes(), key.size());
+		}
+	}
+}
+
+}
+
+TEST(AESLongKeyVerifier_matchInEverySlot_AES192) {
+	checkEverySlot<192>(aes192Key, aes192Ciphertext1, aes192Ciphertext2);
+}
+
+TEST(AESLongKeyVerifier_matchInEverySlot_AES256) {
+	checkEverySlot<256>(aes256Key, aes256Ciphertext1, aes256Ciphertext2);
+}
+
+TEST(AESLongKeyVerifier_singleBlock_noConfirmation) {
+	std::vector<uint8_t> const block = keyBlock(aes256Key, 8, 3);
+	AES256KeyVerifier verifier(plaintext1, aes256Ciphertext1);
+	verifier.checkKeys(block.data() + 1, 8);
+	CHECK(verifier.success());
+	CHECK_EQUAL(0, verifier.confirmationsRun());
+}
+
+TEST(AESLongKeyVerifier_wrongKeys_noConfirmation) {
+	// Wrong keys must be rejected on the first block alone
+	std::vector<uint8_t> block = keyBlock(aes192Key, 64, 0);
+	block[1] ^= 0x01;
+	AES192KeyVerifier verifier(plaintext1, aes192Ciphertext1, plaintext2, aes192Ciphertext2);
+	verifier.checkKeys(block.data() + 1, 64);
+	verifier.flush();
+	CHECK(!verifier.success());
+	CHECK_EQUAL(0, verifier.confirmationsRun());
+}
+
+TEST(AESLongKeyVerifier_checkKeys_rejectedBySecondBlock) {
+	// The first block matches, but the second does not: the key must not be reported
+	std::vector<uint8_t> const block = keyBlock(aes256Key, 16, 7);
+	AES256KeyVerifier verifier(plaintext1, aes256Ciphertext1, plaintext2, aes192Ciphertext2);
+	verifier.checkKeys(block.data() + 1, 16);
+	verifier.flush();
+	CHECK(!verifier.success());
+	CHECK_EQUAL(1, verifier.confirmationsRun());
+	CHECK_THROW(verifier.correctKey(), std::logic_error);
+}
+
+TEST(AESLongKeyVerifier_constructor_invalidBlocks) {
+	std::vector<uint8_t> const shortBlock(8);
+	CHECK_THROW(AES256KeyVerifier(shortBlock, aes256Ciphertext1), std::invalid_argument);
+	CHECK_THROW(AES256KeyVerifier(plaintext1, aes256Ciphertext1, plaintext2, std::vector<uint8_t>()), std::invalid_argument);
+	CHECK_THROW(AES192KeyVerifierFactory(plaintext1, aes192Ciphertext1, shortBlock, shortBlock), std::invalid_argument);
+}
+
+TEST(AESLongKeyVerifierFactory_newVerifier) {
+	AES256KeyVerifierFactory verifierFactory(plaintext1, aes256Ciphertext1, plaintext2, aes256Ciphertext2);
+	CHECK_EQUAL(AESNI8LongKeyKernel, verifierFactory.getKernel());
+	std::unique_ptr<KeyVerifier<256>> verifier = verifierFactory.newVerifier();
+	verifier->checkKey(aes256Key);
+	verifier->flush();
+	CHECK(verifier->success());
+	CHECK_ARRAY_EQUAL(aes256Key, verifier->correctKey().asBytes(), aes256Key.size());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
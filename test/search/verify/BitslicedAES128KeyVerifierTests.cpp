@@ -0,0 +1,104 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * BitslicedAES128KeyVerifierTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/verify/BitslicedAES128KeyVerifier.hpp"
+#include "test/search/verify/VerifierTestKeys.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+TEST(BitslicedAES128KeyVerifier_eachWidth_matchInEverySlot) {
+	// The keys are transposed into bit planes and the matches read back as a bitmask: every slot must map back to its own key
+	for(BitslicedAES128Width const width : {Bitsliced64Width, Bitsliced128Width, Bitsliced256Width}) {
+		uint32_t const keysPerCall = BitslicedAES128::keysPerCall(width);
+		for(uint32_t position = 0 ; position < keysPerCall ; position++) {
+			std::vector<uint8_t> const block = keyBlock(fipsKey, keysPerCall, position);
+			BitslicedAES128KeyVerifier verifier(fipsPlaintext, fipsCiphertext, width);
+			verifier.checkKeys(block.data() + 1, keysPerCall);
+			CHECK(verifier.success());
+			CHECK_ARRAY_EQUAL(fipsKey, verifier.correctKey().asBytes(), fipsKey.size());
+		}
+	}
+}
+
+TEST(BitslicedAES128KeyVerifier_flush_ignoresUnusedSlots) {
+	// The all-zero key is correct, and fills the unused slots of the buffer
+	std::vector<uint8_t> const plaintext(16, 0x00);
+	std::vector<uint8_t> const ciphertext = {0x66, 0xe9, 0x4b, 0xd4, 0xef, 0x8a, 0x2c, 0x3b, 0x88, 0x4c, 0xfa, 0x59, 0xca, 0x34, 0x2b, 0x2e};
+	std::vector<uint8_t> const zeroKey(16, 0x00);
+	for(BitslicedAES128Width const width : {Bitsliced64Width, Bitsliced128Width, Bitsliced256Width}) {
+		std::vector<uint8_t> const block = keyBlock(fipsKey, 3, 0);
+		BitslicedAES128KeyVerifier verifier(plaintext, ciphertext, width);
+		verifier.checkKeys(block.data() + 1, 3);
+		verifier.flush();
+		CHECK(!verifier.success());
+		CHECK_THROW(verifier.correctKey(), std::logic_error);
+
+		verifier.checkKey(zeroKey);
+		verifier.flush();
+		CHECK(verifier.success());
+	}
+}
+
+TEST(BitslicedAES128KeyVerifierFactory_newVerifier) {
+	BitslicedAES128KeyVerifierFactory verifierFactory(fipsPlaintext, fipsCiphertext);
+	CHECK_EQUAL(BitslicedAES128::fastestSupported(), verifierFactory.getWidth());
+	auto verifier = verifierFactory.newVerifier();
+	verifier->checkKey(fipsKey);
+	verifier->flush();
+	CHECK(verifier->success());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -0,0 +1,138 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * BitslicedAES128Tests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/verify/AES128Kernels.hpp"
+#include "src/labynkyr/search/verify/BitslicedAES128.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+std::vector<BitslicedAES128Width> const widths = {Bitsliced64Width, Bitsliced128Width, Bitsliced256Width};
+
+/**
+ *
+ * @return the indices of the set bits in the match mask
+ */
+std::vector<uint32_t> matchedKeys(std::vector<uint8_t> const & matches) {
+	std::vector<uint32_t> indices;
+	for(uint32_t keyIndex = 0 ; keyIndex < matches.size() * 8 ; keyIndex++) {
+		if((matches[keyIndex / 8] >> (keyIndex % 8)) & 1) {
+			indices.push_back(keyIndex);
+		}
+	}
+	return indices;
+}
+
+}
+
+TEST(BitslicedAES128_findMatches_fips197) {
+	std::vector<uint8_t> const key = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+	std::vector<uint8_t> const plaintext = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+	std::vector<uint8_t> const ciphertext = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+	for(BitslicedAES128Width const width : widths) {
+		uint32_t const keyCount = BitslicedAES128::keysPerCall(width);
+		for(uint32_t position : {0U, 1U, 7U, 8U, 63U, keyCount - 1}) {
+			std::vector<uint8_t> keys(keyCount * 16);
+			for(uint32_t index = 0 ; index < keys.size() ; index++) {
+				keys[index] = static_cast<uint8_t>(index * 29 + 3);
+			}
+			std::copy(key.begin(), key.end(), keys.begin() + position * 16);
+			std::vector<uint8_t> matches(keyCount / 8);
+			CHECK(BitslicedAES128::findMatches(width, keys.data(), plaintext.data(), ciphertext.data(), matches.data()));
+			std::vector<uint32_t> const indices = matchedKeys(matches);
+			CHECK_EQUAL(1, indices.size());
+			CHECK_EQUAL(position, indices.front());
+		}
+	}
+}
+
+TEST(BitslicedAES128_findMatches_agreesWithAESNI) {
+	if(!AES128Kernels::isSupported(AESNI4Kernel)) {
+		return;
+	}
+	std::vector<uint8_t> const plaintext = {0x32, 0x43, 0xf6, 0xa8, 0x88, 0x5a, 0x30, 0x8d, 0x31, 0x31, 0x98, 0xa2, 0xe0, 0x37, 0x07, 0x34};
+	std::vector<uint8_t> keys(256 * 16);
+	for(uint32_t index = 0 ; index < keys.size() ; index++) {
+		keys[index] = static_cast<uint8_t>((index * 73 + 19) ^ (index >> 5));
+	}
+	std::vector<uint8_t> ciphertexts(256 * 16);
+	for(uint32_t keyIndex = 0 ; keyIndex < 256 ; keyIndex += 4) {
+		AES128Kernels::encryptAESNI4(keys.data() + keyIndex * 16, plaintext.data(), ciphertexts.data() + keyIndex * 16);
+	}
+	for(BitslicedAES128Width const width : widths) {
+		uint32_t const keyCount = BitslicedAES128::keysPerCall(width);
+		for(uint32_t target = 0 ; target < keyCount ; target += 13) {
+			std::vector<uint8_t> matches(keyCount / 8);
+			CHECK(BitslicedAES128::findMatches(width, keys.data(), plaintext.data(), ciphertexts.data() + target * 16, matches.data()));
+			std::vector<uint32_t> const indices = matchedKeys(matches);
+			CHECK_EQUAL(1, indices.size());
+			CHECK_EQUAL(target, indices.front());
+		}
+	}
+}
+
+TEST(BitslicedAES128_findMatches_noMatch) {
+	std::vector<uint8_t> const plaintext(16, 0x00);
+	std::vector<uint8_t> const ciphertext(16, 0x00);
+	std::vector<uint8_t> const keys(256 * 16, 0x00);
+	for(BitslicedAES128Width const width : widths) {
+		std::vector<uint8_t> matches(BitslicedAES128::keysPerCall(width) / 8, 0xFF);
+		CHECK(!BitslicedAES128::findMatches(width, keys.data(), plaintext.data(), ciphertext.data(), matches.data()));
+		CHECK(matchedKeys(matches).empty());
+	}
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -0,0 +1,113 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * BitslicedDESTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/verify/BitslicedDES.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+std::vector<uint8_t> const key = {0x13, 0x34, 0x57, 0x79, 0x9B, 0xBC, 0xDF, 0xF1};
+std::vector<uint8_t> const plaintext = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+std::vector<uint8_t> const ciphertext = {0x85, 0xE8, 0x13, 0x54, 0x0F, 0x0A, 0xB4, 0x05};
+
+}
+
+TEST(BitslicedDES_roundKey) {
+	// K1 = 000110 110000 001011 101111 111111 000111 000001 110010, one 6-bit subkey per S-box
+	std::vector<uint8_t> const firstRoundKey = {0x06, 0xbc, 0xbc, 0xff, 0x11, 0xc8};
+	std::vector<uint8_t> const lastRoundKey = {0xf2, 0x6c, 0x2f, 0x43, 0xf8, 0xd5};
+	CHECK(firstRoundKey == BitslicedDES::roundKey(key, 1));
+	CHECK(lastRoundKey == BitslicedDES::roundKey(key, 16));
+	CHECK_THROW(BitslicedDES::roundKey(key, 0), std::invalid_argument);
+	CHECK_THROW(BitslicedDES::roundKey(key, 17), std::invalid_argument);
+	CHECK_THROW(BitslicedDES::roundKey(std::vector<uint8_t>(7), 1), std::invalid_argument);
+}
+
+TEST(BitslicedDES_findKey_eachRoundAndWidth) {
+	for(BitslicedDESWidth const width : {BitslicedDES64Width, BitslicedDES256Width}) {
+		for(uint32_t round : {1U, 5U, 16U}) {
+			std::vector<uint8_t> const roundKey = BitslicedDES::roundKey(key, round);
+			std::vector<uint8_t> found(8);
+			CHECK(BitslicedDES::findKey(width, roundKey.data(), round, plaintext.data(), ciphertext.data(), found.data()));
+			CHECK(key == found);
+		}
+	}
+}
+
+TEST(BitslicedDES_findKey_zeroCiphertext) {
+	std::vector<uint8_t> const otherKey = {0x0E, 0x32, 0x92, 0x32, 0xEA, 0x6D, 0x0D, 0x73};
+	std::vector<uint8_t> const otherPlaintext(8, 0x87);
+	std::vector<uint8_t> const otherCiphertext(8, 0x00);
+	for(BitslicedDESWidth const width : {BitslicedDES64Width, BitslicedDES256Width}) {
+		std::vector<uint8_t> const roundKey = BitslicedDES::roundKey(otherKey, 16);
+		std::vector<uint8_t> found(8);
+		CHECK(BitslicedDES::findKey(width, roundKey.data(), 16, otherPlaintext.data(), otherCiphertext.data(), found.data()));
+		CHECK(otherKey == found);
+	}
+}
+
+TEST(BitslicedDES_findKey_wrongRoundKey) {
+	std::vector<uint8_t> roundKey = BitslicedDES::roundKey(key, 1);
+	roundKey[2] ^= 0x10;
+	std::vector<uint8_t> found(8);
+	CHECK(!BitslicedDES::findKey(BitslicedDES256Width, roundKey.data(), 1, plaintext.data(), ciphertext.data(), found.data()));
+	// The right round key for the wrong round
+	std::vector<uint8_t> const lastRoundKey = BitslicedDES::roundKey(key, 16);
+	CHECK(!BitslicedDES::findKey(BitslicedDES64Width, lastRoundKey.data(), 1, plaintext.data(), ciphertext.data(), found.data()));
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
@@ -99,5 +99,17 @@ TEST(ComparisonKeyVerifier_correctKey_fail) {
 	CHECK_THROW(verifier.correctKey(), std::logic_error);
 }
 
+TEST(ComparisonKeyVerifier_checkKeys) {
+	std::vector<uint8_t> const expected = {0x01, 0x02, 0x03};
+	ComparisonKeyVerifier<24> verifier(expected);
+	std::vector<uint8_t> const block = {0x02, 0x02, 0x03, 0x01, 0x02, 0x04, 0x01, 0x02, 0x03};
+	verifier.checkKeys(block.data(), 2);
+	CHECK_EQUAL(2, verifier.keysChecked());
+	CHECK(!verifier.success());
+	verifier.checkKeys(block.data() + 3, 2);
+	CHECK_EQUAL(4, verifier.keysChecked());
+	CHECK(verifier.success());
+}
+
 } /* namespace search */
 } /* namespace labynkyr */
@@ -0,0 +1,114 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * DESRoundKeyVerifierTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/verify/DESRoundKeyVerifier.hpp"
+#include "test/search/verify/VerifierTestKeys.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+std::vector<uint8_t> const desKey = {0x13, 0x34, 0x57, 0x79, 0x9B, 0xBC, 0xDF, 0xF1};
+std::vector<uint8_t> const plaintext = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+std::vector<uint8_t> const ciphertext = {0x85, 0xE8, 0x13, 0x54, 0x0F, 0x0A, 0xB4, 0x05};
+
+}
+
+TEST(DESRoundKeyVerifier_checkKeys_firstAndLastRound) {
+	// Round keys are checked as they arrive, and reported as enumerated rather than as the DES key they complete to
+	for(uint32_t const round : {1, 16}) {
+		for(BitslicedDESWidth const width : {BitslicedDES64Width, BitslicedDES256Width}) {
+			std::vector<uint8_t> const roundKey = BitslicedDES::roundKey(desKey, round);
+			std::vector<uint8_t> const block = keyBlock(roundKey, 10, 7);
+			DESRoundKeyVerifier verifier(plaintext, ciphertext, round, width);
+			CHECK_EQUAL(width, verifier.getWidth());
+			verifier.checkKeys(block.data() + 1, 7);
+			CHECK(!verifier.success());
+			CHECK_THROW(verifier.getDESKey(), std::logic_error);
+			verifier.checkKeys(block.data() + 1 + 7 * 6, 3);
+			CHECK_EQUAL(10, verifier.keysChecked());
+			CHECK(verifier.success());
+			CHECK_ARRAY_EQUAL(roundKey, verifier.correctKey().asBytes(), roundKey.size());
+			CHECK(desKey == verifier.getDESKey());
+		}
+	}
+}
+
+TEST(DESRoundKeyVerifier_checkKey_otherRoundRejected) {
+	// The last round key of the correct DES key is not a first round key of it
+	DESRoundKeyVerifier verifier(plaintext, ciphertext, 1);
+	verifier.checkKey(BitslicedDES::roundKey(desKey, 16));
+	verifier.flush();
+	CHECK(!verifier.success());
+	CHECK_THROW(verifier.correctKey(), std::logic_error);
+}
+
+TEST(DESRoundKeyVerifier_invalidArguments) {
+	CHECK_THROW(DESRoundKeyVerifier(plaintext, ciphertext, 0), std::invalid_argument);
+	CHECK_THROW(DESRoundKeyVerifier(plaintext, ciphertext, 17), std::invalid_argument);
+	CHECK_THROW(DESRoundKeyVerifier(std::vector<uint8_t>(16), ciphertext, 1), std::invalid_argument);
+	DESRoundKeyVerifier verifier(plaintext, ciphertext, 1);
+	CHECK_THROW(verifier.correctKey(), std::logic_error);
+}
+
+TEST(DESRoundKeyVerifierFactory_newVerifier) {
+	DESRoundKeyVerifierFactory verifierFactory(plaintext, ciphertext, 16);
+	auto verifier = verifierFactory.newVerifier();
+	verifier->checkKey(BitslicedDES::roundKey(desKey, 16));
+	CHECK(verifier->success());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
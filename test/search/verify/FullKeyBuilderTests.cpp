@@ -0,0 +1,143 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * FullKeyBuilderTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/verify/FullKeyBuilder.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+/**
+ *
+ * Bit by bit reference packing: bit b of subkey i is bit i * VecLenBits + b of the key, least significant bit first
+ */
+template<uint32_t VecCount, uint32_t VecLenBits, typename SubkeyType>
+std::vector<uint8_t> referenceKey(std::vector<SubkeyType> const & subkeys) {
+	std::vector<uint8_t> key((VecCount * VecLenBits + 7) / 8, 0);
+	for(uint32_t vectorIndex = 0 ; vectorIndex < VecCount ; vectorIndex++) {
+		for(uint32_t bitIndex = 0 ; bitIndex < VecLenBits ; bitIndex++) {
+			uint32_t const keyBit = vectorIndex * VecLenBits + bitIndex;
+			uint32_t const bit = (static_cast<uint64_t>(subkeys[vectorIndex]) >> bitIndex) & 1;
+			key[keyBit / 8] |= static_cast<uint8_t>(bit << (keyBit % 8));
+		}
+	}
+	return key;
+}
+
+template<uint32_t VecCount, uint32_t VecLenBits, typename SubkeyType>
+std::vector<SubkeyType> pseudoRandomSubkeys(uint32_t seed) {
+	std::vector<SubkeyType> subkeys(VecCount);
+	uint64_t state = seed;
+	for(auto & subkey : subkeys) {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+		// Deliberately leave bits above VecLenBits set, which must be ignored
+		subkey = static_cast<SubkeyType>(state >> 11);
+	}
+	return subkeys;
+}
+
+template<uint32_t VecCount, uint32_t VecLenBits, typename SubkeyType>
+void checkPacking() {
+	typedef FullKeyBuilder<VecCount, VecLenBits, SubkeyType> Builder;
+	for(uint32_t seed = 1 ; seed <= 16 ; seed++) {
+		std::vector<SubkeyType> const subkeys = pseudoRandomSubkeys<VecCount, VecLenBits, SubkeyType>(seed);
+		std::vector<uint8_t> const expected = referenceKey<VecCount, VecLenBits, SubkeyType>(subkeys);
+
+		std::vector<uint8_t> packed(expected.size() + 1, 0xA5);
+		Builder::fullKey(subkeys, packed.data() + 1);
+		CHECK_ARRAY_EQUAL(expected.data(), packed.data() + 1, expected.size());
+		CHECK_EQUAL(0xA5, packed[0]);
+
+		// Incremental: start from a different key and replace the subkeys one at a time
+		std::vector<uint8_t> incremental(expected.size());
+		Builder::fullKey(pseudoRandomSubkeys<VecCount, VecLenBits, SubkeyType>(seed + 100), incremental.data());
+		for(uint32_t vectorIndex = 0 ; vectorIndex < VecCount ; vectorIndex++) {
+			Builder::setSubkey(vectorIndex, subkeys[vectorIndex], incremental.data());
+		}
+		CHECK_ARRAY_EQUAL(expected.data(), incremental.data(), expected.size());
+	}
+}
+
+} /*namespace */
+
+TEST(FullKeyBuilder_fullKey_matchesReference) {
+	checkPacking<16, 8, uint8_t>();
+	checkPacking<8, 6, uint8_t>();
+	checkPacking<3, 5, uint8_t>();
+	checkPacking<13, 10, uint16_t>();
+	checkPacking<11, 12, uint16_t>();
+	checkPacking<8, 16, uint16_t>();
+	checkPacking<5, 24, uint32_t>();
+	checkPacking<3, 60, uint64_t>();
+	checkPacking<2, 64, uint64_t>();
+}
+
+TEST(FullKeyBuilder_fullKey_clearsUnusedBits) {
+	std::vector<uint8_t> key(2, 0xFF);
+	std::vector<uint8_t> const subkeys = {0x3F, 0x3F};
+	FullKeyBuilder<2, 6, uint8_t>::fullKey(subkeys, key.data());
+	CHECK_EQUAL(0xFF, key[0]);
+	CHECK_EQUAL(0x0F, key[1]);
+}
+
+TEST(FullKeyBuilder_fullKey_vectorKeepsUnusedBits) {
+	std::vector<uint8_t> key(2, 0xF0);
+	std::vector<uint16_t> const subkeys = {0x155};
+	FullKeyBuilder<1, 10, uint16_t>::fullKey(subkeys, key);
+	CHECK_EQUAL(0x55, key[0]);
+	CHECK_EQUAL(0xF1, key[1]);
+}
+
+} /*namespace search */
+} /*namespace labynkyr */
@@ -0,0 +1,166 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * GroupedKeyVerifierTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/verify/GroupedKeyVerifier.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+/**
+ *
+ * Checks 16-bit keys in groups of 4, recording every group it is given, and accepts the key whose first byte is 0xFF
+ */
+class RecordingGroupedKeyVerifier : public GroupedKeyVerifier<16> {
+public:
+	RecordingGroupedKeyVerifier()
+	: GroupedKeyVerifier<16>(4)
+	, groups()
+	, groupKeyCounts()
+	{
+	}
+
+	std::vector<std::vector<uint8_t>> groups;
+	std::vector<uint64_t> groupKeyCounts;
+private:
+	void checkGroup(uint8_t const * keys, uint64_t keyCount) override {
+		groups.push_back(std::vector<uint8_t>(keys, keys + 2 * keysPerCall));
+		groupKeyCounts.push_back(keyCount);
+		for(uint64_t keyIndex = 0 ; keyIndex < keyCount ; keyIndex++) {
+			if(keys[keyIndex * 2] == 0xFF) {
+				setFound(keys + keyIndex * 2);
+			}
+		}
+	}
+};
+
+std::vector<uint8_t> keyBlock(uint32_t keyCount, uint8_t first) {
+	std::vector<uint8_t> keys(2 * keyCount);
+	for(uint32_t keyIndex = 0 ; keyIndex < keyCount ; keyIndex++) {
+		keys[keyIndex * 2] = static_cast<uint8_t>(first + keyIndex);
+		keys[keyIndex * 2 + 1] = 0;
+	}
+	return keys;
+}
+
+}
+
+TEST(GroupedKeyVerifier_checkKeys_fullGroupsInPlace) {
+	RecordingGroupedKeyVerifier verifier;
+	std::vector<uint8_t> const keys = keyBlock(10, 0);
+	verifier.checkKeys(keys.data(), 10);
+	// Two groups straight from the block, and two keys left in the buffer until the flush
+	CHECK_EQUAL(2, verifier.groups.size());
+	CHECK_EQUAL(10, verifier.keysChecked());
+	verifier.flush();
+	CHECK_EQUAL(3, verifier.groups.size());
+	CHECK_EQUAL(2, verifier.groupKeyCounts[2]);
+	CHECK_EQUAL(8, verifier.groups[2][0]);
+	CHECK_EQUAL(9, verifier.groups[2][2]);
+	// A second flush has nothing to check
+	verifier.flush();
+	CHECK_EQUAL(3, verifier.groups.size());
+}
+
+TEST(GroupedKeyVerifier_checkKeys_completesBufferFirst) {
+	RecordingGroupedKeyVerifier verifier;
+	std::vector<uint8_t> const first = keyBlock(3, 0);
+	std::vector<uint8_t> const second = keyBlock(5, 3);
+	verifier.checkKeys(first.data(), 3);
+	CHECK_EQUAL(0, verifier.groups.size());
+	verifier.checkKeys(second.data(), 5);
+	verifier.flush();
+	// Keys are checked in the order they arrive, across calls
+	CHECK_EQUAL(2, verifier.groups.size());
+	for(uint32_t groupIndex = 0 ; groupIndex < 2 ; groupIndex++) {
+		CHECK_EQUAL(4, verifier.groupKeyCounts[groupIndex]);
+		for(uint32_t keyIndex = 0 ; keyIndex < 4 ; keyIndex++) {
+			CHECK_EQUAL(groupIndex * 4 + keyIndex, verifier.groups[groupIndex][keyIndex * 2]);
+		}
+	}
+}
+
+TEST(GroupedKeyVerifier_checkKey_partialGroupHoldsStaleKeys) {
+	RecordingGroupedKeyVerifier verifier;
+	std::vector<uint8_t> const keys = keyBlock(6, 0);
+	for(uint32_t keyIndex = 0 ; keyIndex < 6 ; keyIndex++) {
+		verifier.checkKey(std::vector<uint8_t>(keys.begin() + keyIndex * 2, keys.begin() + keyIndex * 2 + 2));
+	}
+	CHECK_EQUAL(1, verifier.groups.size());
+	verifier.flush();
+	// The flushed group is always full size, but only its first two keys are new
+	CHECK_EQUAL(2, verifier.groups.size());
+	CHECK_EQUAL(8, verifier.groups[1].size());
+	CHECK_EQUAL(2, verifier.groupKeyCounts[1]);
+	CHECK_EQUAL(4, verifier.groups[1][0]);
+	CHECK_EQUAL(5, verifier.groups[1][2]);
+	CHECK_EQUAL(6, verifier.keysChecked());
+}
+
+TEST(GroupedKeyVerifier_success_stopsChecking) {
+	RecordingGroupedKeyVerifier verifier;
+	std::vector<uint8_t> const keys = keyBlock(12, 0xFC);
+	verifier.checkKeys(keys.data(), 12);
+	CHECK(verifier.success());
+	CHECK(std::vector<uint8_t>({0xFF, 0}) == verifier.correctKey().asBytes());
+	// Later groups are counted but not checked
+	CHECK_EQUAL(1, verifier.groups.size());
+	CHECK_EQUAL(12, verifier.keysChecked());
+	RecordingGroupedKeyVerifier notFound;
+	CHECK_THROW(notFound.correctKey(), std::logic_error);
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
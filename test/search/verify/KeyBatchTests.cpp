@@ -0,0 +1,166 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * KeyBatchTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/verify/KeyBatch.hpp"
+
+#include "src/labynkyr/search/verify/ComparisonKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+#include "src/labynkyr/search/CancellationToken.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+/**
+ *
+ * Only implements checkKey, so that the default KeyVerifier#checkKeys is used
+ */
+class SingleKeyListVerifier : public ListKeyVerifier<12> {
+public:
+	void checkKeys(uint8_t const * candidateKeys, uint64_t keyCount) override {
+		KeyVerifier<12>::checkKeys(candidateKeys, keyCount);
+	}
+};
+
+TEST(KeyBatch_invalidBatchSize) {
+	ListKeyVerifier<16> verifier;
+	CHECK_THROW(KeyBatch<16> keyBatch(verifier, 0), std::invalid_argument);
+}
+
+TEST(KeyBatch_alignment) {
+	ListKeyVerifier<16> verifier;
+	KeyBatch<16> keyBatch(verifier, 3);
+	CHECK_EQUAL(0, reinterpret_cast<uintptr_t>(keyBatch.nextKey()) % KeyBatch<16>::Alignment);
+	CHECK_EQUAL(3, keyBatch.getBatchSize());
+}
+
+TEST(KeyBatch_commit_fullBatch) {
+	ListKeyVerifier<16> verifier;
+	KeyBatch<16> keyBatch(verifier, 2);
+	keyBatch.nextKey()[0] = 0x01;
+	keyBatch.nextKey()[1] = 0x02;
+	keyBatch.commit();
+	CHECK_EQUAL(1, keyBatch.pending());
+	CHECK_EQUAL(0, verifier.keysChecked());
+	keyBatch.nextKey()[0] = 0x03;
+	keyBatch.nextKey()[1] = 0x04;
+	keyBatch.commit();
+	CHECK_EQUAL(0, keyBatch.pending());
+	CHECK_EQUAL(2, verifier.keysChecked());
+	std::vector<uint8_t> const expectedKey1 = {0x01, 0x02};
+	std::vector<uint8_t> const expectedKey2 = {0x03, 0x04};
+	CHECK_ARRAY_EQUAL(expectedKey1, verifier.keys().at(0), 2);
+	CHECK_ARRAY_EQUAL(expectedKey2, verifier.keys().at(1), 2);
+}
+
+TEST(KeyBatch_flush) {
+	ListKeyVerifier<16> verifier;
+	KeyBatch<16> keyBatch(verifier, 4);
+	keyBatch.commit();
+	keyBatch.commit();
+	keyBatch.commit();
+	CHECK_EQUAL(0, verifier.keysChecked());
+	keyBatch.flush();
+	CHECK_EQUAL(3, verifier.keysChecked());
+	CHECK_EQUAL(0, keyBatch.pending());
+	// Nothing left to hand over
+	keyBatch.flush();
+	CHECK_EQUAL(3, verifier.keysChecked());
+}
+
+TEST(KeyBatch_defaultCheckKeys) {
+	SingleKeyListVerifier verifier;
+	KeyBatch<12> keyBatch(verifier, 2);
+	keyBatch.nextKey()[0] = 0x01;
+	keyBatch.nextKey()[1] = 0x0F;
+	keyBatch.commit();
+	keyBatch.nextKey()[0] = 0x02;
+	keyBatch.nextKey()[1] = 0x0E;
+	keyBatch.commit();
+	CHECK_EQUAL(2, verifier.keysChecked());
+	std::vector<uint8_t> const expectedKey1 = {0x01, 0x0F};
+	std::vector<uint8_t> const expectedKey2 = {0x02, 0x0E};
+	CHECK_ARRAY_EQUAL(expectedKey1, verifier.keys().at(0), 2);
+	CHECK_ARRAY_EQUAL(expectedKey2, verifier.keys().at(1), 2);
+}
+
+TEST(KeyBatch_cancellationToken_raisedOnSuccess) {
+	std::vector<uint8_t> const targetKey = {0x02, 0x00};
+	ComparisonKeyVerifier<16> verifier(targetKey);
+	CancellationToken token;
+	KeyBatch<16> keyBatch(verifier, 2, &token);
+	keyBatch.nextKey()[0] = 0x01;
+	keyBatch.commit();
+	keyBatch.nextKey()[0] = 0x02;
+	// The key is only seen by the verifier once the batch is full
+	CHECK(!keyBatch.isStopped());
+	CHECK(keyBatch.commit());
+	CHECK(keyBatch.isStopped());
+	CHECK(token.isCancelled());
+}
+
+TEST(KeyBatch_cancellationToken_raisedElsewhere) {
+	ListKeyVerifier<16> verifier;
+	CancellationToken token;
+	KeyBatch<16> keyBatch(verifier, 2, &token);
+	CHECK(!keyBatch.isStopped());
+	token.cancel();
+	CHECK(keyBatch.isStopped());
+	keyBatch.commit();
+	keyBatch.commit();
+	// Raising the token does not stop keys already in the batch being verified
+	CHECK_EQUAL(2, verifier.keysChecked());
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
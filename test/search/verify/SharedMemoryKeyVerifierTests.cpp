@@ -0,0 +1,193 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * SharedMemoryKeyVerifierTests.cpp
+ *
+ */
+
+#include "src/labynkyr/search/verify/SharedMemoryKeyVerifier.hpp"
+
+#include "src/labynkyr/search/CancellationToken.hpp"
+#include "src/labynkyr/search/verify/ComparisonKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/ListKeyVerifier.hpp"
+#include "src/labynkyr/search/verify/SharedMemoryKeyConsumer.hpp"
+#include "src/labynkyr/search/verify/SharedMemoryRing.hpp"
+
+#include <unittest++/UnitTest++.h>
+
+#include <stdint.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+namespace {
+
+std::string ringName(std::string const & test) {
+	std::stringstream name;
+	name << "/labynkyr-test-" << test << "-" << ::getpid();
+	return name.str();
+}
+
+std::vector<uint8_t> keyBlock(uint32_t keyCount) {
+	std::vector<uint8_t> keys(keyCount * 2);
+	for(uint32_t keyIndex = 0 ; keyIndex < keyCount ; keyIndex++) {
+		keys[keyIndex * 2] = static_cast<uint8_t>(keyIndex);
+		keys[keyIndex * 2 + 1] = static_cast<uint8_t>(0xA0 + keyIndex);
+	}
+	return keys;
+}
+
+}
+
+TEST(SharedMemoryKeyVerifier_consumer_verifiesEveryKey) {
+	std::string const name = ringName("every");
+	// Two slots of three keys, so the producer has to wait for the consumer
+	std::unique_ptr<SharedMemoryKeyVerifier<16>> verifier(new SharedMemoryKeyVerifier<16>(name, 2, 3));
+	ListKeyVerifier<16> localVerifier;
+	SharedMemoryKeyConsumer<16> consumer(name, localVerifier);
+	std::thread consumerThread([&consumer]() { consumer.run(); });
+
+	std::vector<uint8_t> const keys = keyBlock(20);
+	verifier->checkKeys(keys.data(), 19);
+	verifier->checkKey(std::vector<uint8_t>(keys.begin() + 38, keys.end()));
+	verifier->flush();
+	CHECK_EQUAL(20, verifier->keysChecked());
+	CHECK_EQUAL(20, verifier->keysVerified());
+	CHECK(!verifier->success());
+
+	verifier.reset();
+	consumerThread.join();
+	auto const received = localVerifier.keys();
+	CHECK_EQUAL(20, received.size());
+	for(uint32_t keyIndex = 0 ; keyIndex < received.size() ; keyIndex++) {
+		CHECK(std::vector<uint8_t>(keys.begin() + keyIndex * 2, keys.begin() + keyIndex * 2 + 2) == received[keyIndex]);
+	}
+}
+
+TEST(SharedMemoryKeyVerifier_consumer_success) {
+	std::string const name = ringName("success");
+	std::unique_ptr<SharedMemoryKeyVerifier<16>> verifier(new SharedMemoryKeyVerifier<16>(name, 4, 8));
+	std::vector<uint8_t> const targetKey = {0x05, 0xA5};
+	ComparisonKeyVerifier<16> localVerifier(targetKey);
+	SharedMemoryKeyConsumer<16> consumer(name, localVerifier);
+	std::thread consumerThread([&consumer]() { consumer.run(); });
+
+	std::vector<uint8_t> const keys = keyBlock(20);
+	verifier->checkKeys(keys.data(), 20);
+	verifier->flush();
+	CHECK(verifier->success());
+	CHECK(targetKey == verifier->correctKey().asBytes());
+
+	verifier.reset();
+	consumerThread.join();
+}
+
+TEST(SharedMemoryKeyVerifier_consumerDetached_throws) {
+	std::string const name = ringName("detached");
+	SharedMemoryKeyVerifier<16> verifier(name, 1, 2);
+	// A consumer that attaches and leaves without releasing anything
+	SharedMemoryRing::open(name).reset();
+
+	std::vector<uint8_t> const keys = keyBlock(4);
+	CHECK_THROW(verifier.checkKeys(keys.data(), 4), std::runtime_error);
+	CHECK_THROW(verifier.flush(), std::runtime_error);
+}
+
+TEST(SharedMemoryKeyVerifier_cancelled_stopsWaiting) {
+	// No consumer is ever attached, so the producer can only be released by the token
+	SharedMemoryKeyVerifier<16> verifier(ringName("cancelled"), 1, 2);
+	CancellationToken cancellationToken;
+	verifier.setCancellationToken(cancellationToken);
+
+	std::vector<uint8_t> const keys = keyBlock(4);
+	std::thread producerThread([&]() {
+		verifier.checkKeys(keys.data(), 4);
+		verifier.flush();
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	cancellationToken.cancel();
+	producerThread.join();
+	CHECK(!verifier.success());
+	CHECK_EQUAL(0, verifier.keysVerified());
+}
+
+TEST(SharedMemoryKeyVerifier_correctKey_notFound) {
+	SharedMemoryKeyVerifier<16> verifier(ringName("notfound"));
+	CHECK(!verifier.success());
+	CHECK_THROW(verifier.correctKey(), std::logic_error);
+}
+
+TEST(SharedMemoryKeyVerifierFactory_ringName) {
+	std::string const prefix = ringName("factory");
+	SharedMemoryKeyVerifierFactory<16> factory(prefix);
+	auto verifierA = factory.newVerifier();
+	auto verifierB = factory.newVerifier();
+	CHECK_EQUAL(prefix + "-0", factory.ringName(0));
+	ListKeyVerifier<16> localVerifier;
+	SharedMemoryKeyConsumer<16> consumer(factory.ringName(1), localVerifier);
+	// Keys of the wrong length
+	ListKeyVerifier<24> wrongVerifier;
+	CHECK_THROW(SharedMemoryKeyConsumer<24>(factory.ringName(0), wrongVerifier), std::runtime_error);
+}
+
+TEST(SharedMemoryKeyConsumer_missingRing) {
+	ListKeyVerifier<16> localVerifier;
+	CHECK_THROW(SharedMemoryKeyConsumer<16>(ringName("missing"), localVerifier), std::runtime_error);
+}
+
+TEST(SharedMemoryRing_create_invalidArguments) {
+	CHECK_THROW(SharedMemoryRing::create("no-slash", 16, 4, 4), std::invalid_argument);
+	CHECK_THROW(SharedMemoryRing::create(ringName("invalid"), 16, 0, 4), std::invalid_argument);
+}
+
+} /* namespace search */
+} /* namespace labynkyr */
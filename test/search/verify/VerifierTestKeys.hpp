@@ -0,0 +1,86 @@
+/*
+ * University of Bristol – Open Access Software Licence
+ * Copyright (c) 2016, The University of Bristol, a chartered
+ * corporation having Royal Charter number RC000648 and a charity
+ * (number X1121) and its place of administration being at Senate
+ * House, Tyndall Avenue, Bristol, BS8 1TH, United Kingdom.
+ * All rights reserved
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above
+ * copyright notice, this list of conditions and the following
+ * disclaimer in the documentation and/or other materials provided
+ * with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ * STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ * OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * Any use of the software for scientific publications or commercial
+ * purposes should be reported to the University of Bristol
+ * (OSI-notifications@bristol.ac.uk and quote reference 2514). This is
+ * for impact and usage monitoring purposes only.
+ *
+ * Enquiries about further applications and development opportunities
+ * are welcome. Please contact elisabeth.oswald@bristol.ac.uk
+*/
+/*
+ * VerifierTestKeys.hpp
+ *
+ */
+
+#ifndef LABYNKYR_TEST_SEARCH_VERIFY_VERIFIERTESTKEYS_HPP_
+#define LABYNKYR_TEST_SEARCH_VERIFY_VERIFIERTESTKEYS_HPP_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace labynkyr {
+namespace search {
+
+// FIPS-197 Appendix C.1
+std::vector<uint8_t> const fipsKey = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f};
+std::vector<uint8_t> const fipsLastRoundKey = {0x13, 0x11, 0x1d, 0x7f, 0xe3, 0x94, 0x4a, 0x17, 0xf3, 0x07, 0xa7, 0x8b, 0x4d, 0x2b, 0x30, 0xc5};
+std::vector<uint8_t> const fipsPlaintext = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+std::vector<uint8_t> const fipsCiphertext = {0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a};
+
+/**
+ *
+ * Build a block of candidate keys for a verifier.  The keys start at block.data() + 1, so that they are not aligned.
+ *
+ * @param key the correct key
+ * @param keyCount
+ * @param position the index of the correct key in the block
+ * @return keyCount wrong keys with the correct key at position
+ */
+inline std::vector<uint8_t> keyBlock(std::vector<uint8_t> const & key, uint32_t keyCount, uint32_t position) {
+	std::vector<uint8_t> block(1 + keyCount * key.size());
+	for(uint32_t index = 1 ; index < block.size() ; index++) {
+		block[index] = static_cast<uint8_t>(index * 31);
+	}
+	std::copy(key.begin(), key.end(), block.begin() + 1 + position * key.size());
+	return block;
+}
+
+} /*namespace search */
+} /*namespace labynkyr */
+
+#endif /* LABYNKYR_TEST_SEARCH_VERIFY_VERIFIERTESTKEYS_HPP_ */